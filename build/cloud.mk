@@ -3,23 +3,39 @@ CLOUD_SERVER_SOURCES = \
 	$(SRC)/Tracking/SkyLines/Assemble.cpp \
 	$(SRC)/Cloud/Serialiser.cpp \
 	$(SRC)/Cloud/Client.cpp \
+	$(SRC)/Cloud/ClientGrid.cpp \
 	$(SRC)/Cloud/Thermal.cpp \
 	$(SRC)/Cloud/Data.cpp \
 	$(SRC)/Cloud/Sender.cpp \
+	$(SRC)/Cloud/SnapshotWriter.cpp \
+	$(SRC)/Cloud/Log.cpp \
+	$(SRC)/Cloud/StatsListener.cpp \
+	$(SRC)/Cloud/Stats.cpp \
+	$(SRC)/Cloud/Shard.cpp \
+	$(SRC)/Cloud/Server.cpp \
+	$(SRC)/Cloud/Worker.cpp \
+	$(SRC)/Cloud/Supervisor.cpp \
 	$(SRC)/Cloud/Main.cpp
-CLOUD_SERVER_DEPENDS = ASYNC LIBNET IO OS GEO MATH UTIL
+CLOUD_SERVER_DEPENDS = ASYNC LIBNET IO OS THREAD GEO MATH UTIL
 $(eval $(call link-program,xcsoar-cloud-server,CLOUD_SERVER))
 
 CLOUD_TO_KML_SOURCES = \
 	$(SRC)/Tracking/SkyLines/Assemble.cpp \
 	$(SRC)/Cloud/Serialiser.cpp \
 	$(SRC)/Cloud/Client.cpp \
+	$(SRC)/Cloud/ClientGrid.cpp \
 	$(SRC)/Cloud/Thermal.cpp \
 	$(SRC)/Cloud/Data.cpp \
 	$(SRC)/Cloud/ToKML.cpp
 CLOUD_TO_KML_DEPENDS = ASYNC LIBNET IO OS GEO MATH UTIL
 $(eval $(call link-program,xcsoar-cloud-to-kml,CLOUD_TO_KML))
 
+CLOUD_LOAD_SOURCES = \
+	$(SRC)/Tracking/SkyLines/Assemble.cpp \
+	$(SRC)/Cloud/LoadGenerator.cpp
+CLOUD_LOAD_DEPENDS = LIBNET IO OS GEO MATH UTIL
+$(eval $(call link-program,xcsoar-cloud-load,CLOUD_LOAD))
+
 ifeq ($(TARGET),UNIX)
-OPTIONAL_OUTPUTS += $(CLOUD_SERVER_BIN) $(CLOUD_TO_KML_BIN)
+OPTIONAL_OUTPUTS += $(CLOUD_SERVER_BIN) $(CLOUD_TO_KML_BIN) $(CLOUD_LOAD_BIN)
 endif
@@ -44,7 +44,8 @@ LIBCOMPUTER_SOURCES = \
 	$(SRC)/Computer/BasicComputer.cpp \
 	$(SRC)/Computer/GroundSpeedComputer.cpp \
 	$(SRC)/Computer/AutoQNH.cpp \
-	$(SRC)/Computer/Settings.cpp
+	$(SRC)/Computer/Settings.cpp \
+	$(SRC)/Computer/StageTimer.cpp
 
 LIBCOMPUTER_DEPENDS = AIRSPACE TASK GEO LIBNMEA
 
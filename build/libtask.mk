@@ -15,6 +15,7 @@ TASK_SOURCES = \
 	$(TASK_SRC_DIR)/Ordered/OrderedTask.cpp \
 	$(TASK_SRC_DIR)/Ordered/TaskAdvance.cpp \
 	$(TASK_SRC_DIR)/Ordered/SmartTaskAdvance.cpp \
+	$(TASK_SRC_DIR)/Ordered/TargetOptimiserState.cpp \
 	$(TASK_SRC_DIR)/Ordered/Points/IntermediatePoint.cpp \
 	$(TASK_SRC_DIR)/Ordered/Points/OrderedTaskPoint.cpp \
 	$(TASK_SRC_DIR)/Ordered/Points/StartPoint.cpp \
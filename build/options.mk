@@ -30,12 +30,6 @@ endif
 # (e.g. "address,undefined").
 SANITIZE ?= n
 
-# show map renderer times?
-STOP_WATCH ?= n
-ifeq ($(STOP_WATCH),y)
-  TARGET_CPPFLAGS += -DSTOP_WATCH
-endif
-
 # compile without UI?
 HEADLESS ?= n
 
@@ -55,6 +49,32 @@ ifeq ($(GREYSCALE),y)
   TARGET_CPPFLAGS += -DGREYSCALE
 endif
 
+# rasterise the map in parallel bands (memory canvas only)?  This
+# only pays off with several processor cores.
+DEFERRED_MAP ?= n
+
+ifeq ($(DEFERRED_MAP),y)
+  TARGET_CPPFLAGS += -DDEFERRED_MAP
+endif
+
+# keep the triangulated airspace polygons in OpenGL buffers between
+# frames (OpenGL only)?  Not yet verified on a GL target, therefore
+# disabled by default.
+AIRSPACE_GL_CACHE ?= n
+
+ifeq ($(AIRSPACE_GL_CACHE),y)
+  TARGET_CPPFLAGS += -DAIRSPACE_GL_CACHE
+endif
+
+# upload only the changed topography shapes into a retained OpenGL
+# vertex buffer (OpenGL only)?  Not yet verified on a GL target,
+# therefore disabled by default.
+TOPOGRAPHY_VERTEX_POOL ?= n
+
+ifeq ($(TOPOGRAPHY_VERTEX_POOL),y)
+  TARGET_CPPFLAGS += -DTOPOGRAPHY_VERTEX_POOL
+endif
+
 # When enabled, the Androidpackage org.xcsoar.testing is created, with
 # a red Activity icon, to allow simultaneous installation of "stable"
 # and "testing".
@@ -86,6 +86,7 @@ endif
 ifeq ($(FREETYPE),y)
 SCREEN_SOURCES += \
 	$(CANVAS_SRC_DIR)/freetype/Font.cpp \
+	$(CANVAS_SRC_DIR)/freetype/GlyphCache.cpp \
 	$(CANVAS_SRC_DIR)/freetype/Init.cpp
 endif
 
@@ -193,6 +194,7 @@ SCREEN_SOURCES += \
 	$(CANVAS_SRC_DIR)/custom/Bitmap.cpp \
 	$(CANVAS_SRC_DIR)/custom/ResourceBitmap.cpp \
 	$(CANVAS_SRC_DIR)/memory/Export.cpp \
+	$(CANVAS_SRC_DIR)/memory/Damage.cpp \
 	$(WINDOW_SRC_DIR)/poll/TopWindow.cpp \
 	$(WINDOW_SRC_DIR)/fb/TopWindow.cpp \
 	$(CANVAS_SRC_DIR)/fb/TopCanvas.cpp \
@@ -240,6 +242,7 @@ SCREEN_SOURCES += \
 	$(CANVAS_SRC_DIR)/memory/RawBitmap.cpp \
 	$(CANVAS_SRC_DIR)/memory/VirtualCanvas.cpp \
 	$(CANVAS_SRC_DIR)/memory/SubCanvas.cpp \
+	$(CANVAS_SRC_DIR)/memory/CommandList.cpp \
 	$(CANVAS_SRC_DIR)/memory/Canvas.cpp
 MEMORY_CANVAS_CPPFLAGS = -DUSE_MEMORY_CANVAS
 endif
@@ -268,6 +271,11 @@ ifeq ($(LIBPNG),y)
 SCREEN_DEPENDS += IO
 endif
 
+ifeq ($(USE_MEMORY_CANVAS),y)
+# CommandList.cpp uses class ParallelPool
+SCREEN_DEPENDS += THREAD
+endif
+
 $(eval $(call link-library,screen,SCREEN))
 
 ifeq ($(USE_FB)$(VFB),yy)
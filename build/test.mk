@@ -76,6 +76,13 @@ TEST_NAMES = \
 	test_pressure \
 	test_task \
 	TestOverwritingRingBuffer \
+	TestStageTimer \
+	TestVarioSynthesiser \
+	TestDamageTracker \
+	TestDither \
+	TestLabelBlock \
+	TestVertexPool TestShapeGrid \
+	TestTraceSync \
 	TestDateTime TestRoughTime TestWrapClock \
 	TestTransponderCode \
 	TestMath \
@@ -93,6 +100,7 @@ TEST_NAMES = \
 	TestFileUtil TestPolars TestCSVLine TestGlidePolar \
 	test_replay_task TestProjection TestFlatPoint TestFlatLine TestFlatGeoPoint \
 	TestMacCready TestOrderedTask TestAATPoint \
+	TestAlternateTask \
 	TestPlanes \
 	TestTaskPoint \
 	TestTaskWaypoint \
@@ -122,6 +130,14 @@ TEST_NAMES += \
 	TestDriver
 endif
 
+ifeq ($(USE_MEMORY_CANVAS),y)
+TEST_NAMES += TestCanvasCommandList
+endif
+
+ifeq ($(FREETYPE),y)
+TEST_NAMES += TestGlyphCache
+endif
+
 TESTS = $(call name-to-bin,$(TEST_NAMES))
 
 TEST_HEX_STRING_SOURCES = \
@@ -157,6 +173,76 @@ TEST_OVERWRITING_RING_BUFFER_SOURCES = \
 TEST_OVERWRITING_RING_BUFFER_DEPENDS = MATH
 $(eval $(call link-program,TestOverwritingRingBuffer,TEST_OVERWRITING_RING_BUFFER))
 
+TEST_STAGE_TIMER_SOURCES = \
+	$(SRC)/Computer/StageTimer.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestStageTimer.cpp
+TEST_STAGE_TIMER_DEPENDS = MATH
+$(eval $(call link-program,TestStageTimer,TEST_STAGE_TIMER))
+
+TEST_VARIO_SYNTHESISER_SOURCES = \
+	$(SRC)/Audio/ToneSynthesiser.cpp \
+	$(SRC)/Audio/VarioSynthesiser.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestVarioSynthesiser.cpp
+TEST_VARIO_SYNTHESISER_DEPENDS = MATH
+$(eval $(call link-program,TestVarioSynthesiser,TEST_VARIO_SYNTHESISER))
+
+TEST_DAMAGE_TRACKER_SOURCES = \
+	$(SRC)/ui/canvas/memory/Damage.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestDamageTracker.cpp
+TEST_DAMAGE_TRACKER_CPPFLAGS = $(SCREEN_CPPFLAGS)
+$(eval $(call link-program,TestDamageTracker,TEST_DAMAGE_TRACKER))
+
+TEST_DITHER_SOURCES = \
+	$(SRC)/ui/canvas/memory/Dither.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestDither.cpp
+$(eval $(call link-program,TestDither,TEST_DITHER))
+
+TEST_LABEL_BLOCK_SOURCES = \
+	$(SRC)/Renderer/LabelBlock.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestLabelBlock.cpp
+$(eval $(call link-program,TestLabelBlock,TEST_LABEL_BLOCK))
+
+TEST_VERTEX_POOL_SOURCES = \
+	$(SRC)/Topography/VertexPool.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestVertexPool.cpp
+$(eval $(call link-program,TestVertexPool,TEST_VERTEX_POOL))
+
+TEST_SHAPE_GRID_SOURCES = \
+	$(SRC)/Topography/ShapeGrid.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestShapeGrid.cpp
+TEST_SHAPE_GRID_DEPENDS = GEO MATH
+$(eval $(call link-program,TestShapeGrid,TEST_SHAPE_GRID))
+
+TEST_CANVAS_COMMAND_LIST_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestCanvasCommandList.cpp
+TEST_CANVAS_COMMAND_LIST_DEPENDS = SCREEN THREAD MATH UTIL
+$(eval $(call link-program,TestCanvasCommandList,TEST_CANVAS_COMMAND_LIST))
+
+TEST_GLYPH_CACHE_SOURCES = \
+	$(SRC)/Look/FontDescription.cpp \
+	$(TEST_SRC_DIR)/FakeAsset.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestGlyphCache.cpp
+TEST_GLYPH_CACHE_DEPENDS = SCREEN OS IO THREAD MATH UTIL
+$(eval $(call link-program,TestGlyphCache,TEST_GLYPH_CACHE))
+
+TEST_TRACE_SYNC_SOURCES = \
+	$(SRC)/Engine/Trace/Point.cpp \
+	$(SRC)/Engine/Trace/Trace.cpp \
+	$(SRC)/Engine/Trace/Vector.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestTraceSync.cpp
+TEST_TRACE_SYNC_DEPENDS = GEO MATH UTIL
+$(eval $(call link-program,TestTraceSync,TEST_TRACE_SYNC))
+
 TEST_IGC_PARSER_SOURCES = \
 	$(SRC)/IGC/IGCParser.cpp \
 	$(TEST_SRC_DIR)/tap.c \
@@ -240,6 +326,15 @@ TEST_ORDERED_TASK_OBJS = $(call SRC_TO_OBJ,$(TEST_ORDERED_TASK_SOURCES))
 TEST_ORDERED_TASK_DEPENDS = TASK ROUTE GLIDE WAYPOINT GEO TIME MATH UTIL
 $(eval $(call link-program,TestOrderedTask,TEST_ORDERED_TASK))
 
+TEST_ALTERNATE_TASK_SOURCES = \
+	$(SRC)/Engine/Navigation/Aircraft.cpp \
+	$(SRC)/Engine/Util/Gradient.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestAlternateTask.cpp
+TEST_ALTERNATE_TASK_OBJS = $(call SRC_TO_OBJ,$(TEST_ALTERNATE_TASK_SOURCES))
+TEST_ALTERNATE_TASK_DEPENDS = TASK ROUTE GLIDE WAYPOINT GEO TIME MATH UTIL
+$(eval $(call link-program,TestAlternateTask,TEST_ALTERNATE_TASK))
+
 TEST_AAT_POINT_SOURCES = \
 	$(SRC)/Engine/Util/Gradient.cpp \
 	$(SRC)/Engine/Navigation/Aircraft.cpp \
@@ -734,6 +829,10 @@ DEBUG_PROGRAM_NAMES = \
 	FlightTable \
 	BenchmarkProjection \
 	BenchmarkFAITriangleSector \
+	BenchmarkCloudClients \
+	BenchmarkFleetReplay \
+	BenchmarkVarioSynthesiser \
+	BenchmarkDither \
 	DumpTextFile DumpTextZip DumpTextInflate \
 	DumpHexColor \
 	RunXMLParser \
@@ -835,6 +934,10 @@ ifeq ($(LUA),y)
 DEBUG_PROGRAM_NAMES += RunLua
 endif
 
+ifeq ($(USE_MEMORY_CANVAS),y)
+DEBUG_PROGRAM_NAMES += BenchmarkCanvasReplay BenchmarkMapWindow
+endif
+
 DEBUG_PROGRAMS = $(call name-to-bin,$(DEBUG_PROGRAM_NAMES))
 
 ifeq ($(LUA),y)
@@ -903,6 +1006,81 @@ BENCHMARK_FAI_TRIANGLE_SECTOR_SOURCES = \
 BENCHMARK_FAI_TRIANGLE_SECTOR_DEPENDS = GEO MATH
 $(eval $(call link-program,BenchmarkFAITriangleSector,BENCHMARK_FAI_TRIANGLE_SECTOR))
 
+BENCHMARK_CLOUD_CLIENTS_SOURCES = \
+	$(SRC)/Tracking/SkyLines/Assemble.cpp \
+	$(SRC)/Cloud/Serialiser.cpp \
+	$(SRC)/Cloud/Client.cpp \
+	$(SRC)/Cloud/ClientGrid.cpp \
+	$(TEST_SRC_DIR)/BenchmarkCloudClients.cpp
+BENCHMARK_CLOUD_CLIENTS_DEPENDS = LIBNET IO OS GEO MATH UTIL
+$(eval $(call link-program,BenchmarkCloudClients,BENCHMARK_CLOUD_CLIENTS))
+
+BENCHMARK_FLEET_REPLAY_SOURCES = \
+	$(DEBUG_REPLAY_SOURCES) \
+	$(SRC)/NMEA/Aircraft.cpp \
+	$(SRC)/TransponderCode.cpp \
+	$(SRC)/RadioFrequency.cpp \
+	$(SRC)/Atmosphere/CuSonde.cpp \
+	$(SRC)/Engine/Navigation/Aircraft.cpp \
+	$(SRC)/Engine/Trace/Point.cpp \
+	$(SRC)/Engine/Trace/Trace.cpp \
+	$(SRC)/Engine/Trace/Vector.cpp \
+	$(SRC)/Engine/Util/Gradient.cpp \
+	$(SRC)/Airspace/ActivePredicate.cpp \
+	$(SRC)/Airspace/ProtectedAirspaceWarningManager.cpp \
+	$(SRC)/Airspace/AirspaceComputerSettings.cpp \
+	$(SRC)/FlightStatistics.cpp \
+	$(SRC)/Task/LoadFile.cpp \
+	$(SRC)/Task/ProtectedTaskManager.cpp \
+	$(SRC)/Task/ProtectedRoutePlanner.cpp \
+	$(SRC)/Task/RoutePlannerGlue.cpp \
+	$(SRC)/Task/TaskFile.cpp \
+	$(SRC)/Task/TaskFileXCSoar.cpp \
+	$(SRC)/Task/TaskFileSeeYou.cpp \
+	$(SRC)/Task/TaskFileIGC.cpp \
+	$(SRC)/Task/Deserialiser.cpp \
+	$(SRC)/Waypoint/WaypointReaderBase.cpp \
+	$(SRC)/Waypoint/WaypointReaderSeeYou.cpp \
+	$(SRC)/Waypoint/Factory.cpp \
+	$(SRC)/XML/Node.cpp \
+	$(SRC)/XML/Parser.cpp \
+	$(SRC)/XML/DataNode.cpp \
+	$(SRC)/XML/DataNodeXML.cpp \
+	$(SRC)/Units/Units.cpp \
+	$(SRC)/Units/Settings.cpp \
+	$(SRC)/Logger/Settings.cpp \
+	$(SRC)/TeamCode/TeamCode.cpp \
+	$(SRC)/TeamCode/Settings.cpp \
+	$(SRC)/Math/SunEphemeris.cpp \
+	$(SRC)/Operation/Operation.cpp \
+	$(TEST_SRC_DIR)/FakeLogFile.cpp \
+	$(TEST_SRC_DIR)/FakeMessage.cpp \
+	$(TEST_SRC_DIR)/FakeProfile.cpp \
+	$(TEST_SRC_DIR)/BenchmarkFleetReplay.cpp
+BENCHMARK_FLEET_REPLAY_DEPENDS = \
+	TERRAIN LIBCOMPUTER \
+	$(DEBUG_REPLAY_DEPENDS) \
+	CONTEST TASK ROUTE GLIDE WAYPOINT AIRSPACE ZZIP UTIL GEO MATH TIME
+$(eval $(call link-program,BenchmarkFleetReplay,BENCHMARK_FLEET_REPLAY))
+
+BENCHMARK_VARIO_SYNTHESISER_SOURCES = \
+	$(SRC)/Audio/ToneSynthesiser.cpp \
+	$(SRC)/Audio/VarioSynthesiser.cpp \
+	$(TEST_SRC_DIR)/BenchmarkVarioSynthesiser.cpp
+BENCHMARK_VARIO_SYNTHESISER_DEPENDS = MATH UTIL
+$(eval $(call link-program,BenchmarkVarioSynthesiser,BENCHMARK_VARIO_SYNTHESISER))
+
+BENCHMARK_DITHER_SOURCES = \
+	$(SRC)/ui/canvas/memory/Dither.cpp \
+	$(TEST_SRC_DIR)/BenchmarkDither.cpp
+BENCHMARK_DITHER_DEPENDS = UTIL
+$(eval $(call link-program,BenchmarkDither,BENCHMARK_DITHER))
+
+BENCHMARK_CANVAS_REPLAY_SOURCES = \
+	$(TEST_SRC_DIR)/BenchmarkCanvasReplay.cpp
+BENCHMARK_CANVAS_REPLAY_DEPENDS = SCREEN THREAD MATH UTIL
+$(eval $(call link-program,BenchmarkCanvasReplay,BENCHMARK_CANVAS_REPLAY))
+
 DUMP_TEXT_FILE_SOURCES = \
 	$(TEST_SRC_DIR)/DumpTextFile.cpp
 DUMP_TEXT_FILE_DEPENDS = IO OS ZZIP UTIL
@@ -1767,6 +1945,7 @@ RUN_MAP_WINDOW_SOURCES = \
 	$(SRC)/Renderer/AircraftRenderer.cpp \
 	$(SRC)/Renderer/AirspaceRenderer.cpp \
 	$(SRC)/Renderer/AirspaceRendererGL.cpp \
+	$(SRC)/Renderer/AirspaceGeometryCache.cpp \
 	$(SRC)/Renderer/AirspaceRendererOther.cpp \
 	$(SRC)/Renderer/AirspaceLabelList.cpp \
 	$(SRC)/Renderer/AirspaceLabelRenderer.cpp \
@@ -1873,6 +2052,12 @@ RUN_MAP_WINDOW_DEPENDS = \
 	JASPER ZZIP LIBNMEA GEO MATH TIME UTIL
 $(eval $(call link-program,RunMapWindow,RUN_MAP_WINDOW))
 
+BENCHMARK_MAP_WINDOW_SOURCES = \
+	$(filter-out $(TEST_SRC_DIR)/RunMapWindow.cpp,$(RUN_MAP_WINDOW_SOURCES)) \
+	$(TEST_SRC_DIR)/BenchmarkMapWindow.cpp
+BENCHMARK_MAP_WINDOW_DEPENDS = $(RUN_MAP_WINDOW_DEPENDS)
+$(eval $(call link-program,BenchmarkMapWindow,BENCHMARK_MAP_WINDOW))
+
 RUN_LIST_CONTROL_SOURCES = \
 	$(MORE_SCREEN_SOURCES) \
 	$(SRC)/Look/DialogLook.cpp \
@@ -4,12 +4,65 @@
 #include "ToneSynthesiser.hpp"
 #include "Math/FastTrig.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
 #include <cassert>
 
+/**
+ * The amplitude of #ISINETABLE.
+ */
+static constexpr int ISINE_AMPLITUDE = 1024;
+
+/**
+ * Convert a volume (0..100) to a 16.16 fixed point factor which
+ * scales #ISINETABLE values to the int16_t sample range.  This
+ * replaces the per-sample division of the scalar implementation.
+ */
+static constexpr int
+VolumeToGain(unsigned volume) noexcept
+{
+  return (32767 / ISINE_AMPLITUDE) * (int)std::min(volume, 100u)
+    * 65536 / 100;
+}
+
+/* the product must not overflow in the kernel below */
+static_assert((int64_t)ISINE_AMPLITUDE * VolumeToGain(100) <= INT32_MAX);
+
+/**
+ * Render one block of samples.  The phase and the scaling loops have
+ * no dependencies between iterations and get vectorised by the
+ * compiler; only the table lookup remains a (cheap) gather.
+ *
+ * @return the new angle
+ */
+[[gnu::hot]]
+static unsigned
+RenderBlock(int16_t *__restrict buffer, size_t n,
+            unsigned angle, unsigned increment, int gain) noexcept
+{
+  assert(n <= ToneSynthesiser::BLOCK_SIZE);
+
+  std::array<unsigned, ToneSynthesiser::BLOCK_SIZE> phase;
+  for (size_t i = 0; i < n; ++i)
+    phase[i] = NormalizeIntAngle(angle + i * increment);
+
+  std::array<int, ToneSynthesiser::BLOCK_SIZE> value;
+  for (size_t i = 0; i < n; ++i)
+    value[i] = ISINETABLE[phase[i]];
+
+  for (size_t i = 0; i < n; ++i)
+    buffer[i] = (value[i] * gain) >> 16;
+
+  return NormalizeIntAngle(angle + n * increment);
+}
+
 void
 ToneSynthesiser::SetTone(unsigned tone_hz)
 {
-  increment = ISINETABLE.size() * tone_hz / sample_rate;
+  increment.store(ISINETABLE.size() * tone_hz / sample_rate,
+                  std::memory_order_relaxed);
 }
 
 void
@@ -17,9 +70,15 @@ ToneSynthesiser::Synthesise(int16_t *buffer, size_t n)
 {
   assert(angle < ISINETABLE.size());
 
-  for (int16_t *end = buffer + n; buffer != end; ++buffer) {
-    *buffer = ISINETABLE[angle] * (32767 / 1024) * (int)volume / 100;
-    angle = (angle + increment) & (ISINETABLE.size() - 1);
+  /* load the parameters once per call */
+  const unsigned _increment = increment.load(std::memory_order_relaxed);
+  const int gain = VolumeToGain(volume.load(std::memory_order_relaxed));
+
+  while (n > 0) {
+    const size_t o = std::min(n, BLOCK_SIZE);
+    angle = RenderBlock(buffer, o, angle, _increment, gain);
+    buffer += o;
+    n -= o;
   }
 }
 
@@ -28,9 +87,11 @@ ToneSynthesiser::ToZero() const
 {
   assert(angle < ISINETABLE.size());
 
-  if (angle < increment)
+  const unsigned _increment = increment.load(std::memory_order_relaxed);
+
+  if (angle < _increment)
     /* close enough */
     return 0;
 
-  return (ISINETABLE.size() - angle) / increment;
+  return (ISINETABLE.size() - angle) / _increment;
 }
@@ -5,13 +5,31 @@
 
 #include "PCMSynthesiser.hpp"
 
+#include <atomic>
+
 /**
  * This class generates tones with a sine wave.
+ *
+ * SetVolume() and SetTone() may be called from any thread while the
+ * audio thread is inside Synthesise(); they do not lock, and the new
+ * values take effect with the next block.
  */
 class ToneSynthesiser : public PCMSynthesiser {
-  unsigned volume = 100, angle = 0, increment = 0;
+  std::atomic<unsigned> volume{100}, increment{0};
+
+  /**
+   * The current position in #ISINETABLE.  Only accessed by the audio
+   * thread.
+   */
+  unsigned angle = 0;
 
 public:
+  /**
+   * The maximum number of samples rendered by one pass of the block
+   * kernel.
+   */
+  static constexpr size_t BLOCK_SIZE = 64;
+
   explicit ToneSynthesiser(unsigned _sample_rate) : sample_rate(_sample_rate) {
   }
 
@@ -26,7 +44,7 @@ public:
    * means full volume
    */
   void SetVolume(unsigned _volume) {
-    volume = _volume;
+    volume.store(_volume, std::memory_order_relaxed);
   }
 
   void SetTone(unsigned tone_hz);
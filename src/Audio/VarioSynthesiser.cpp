@@ -15,27 +15,47 @@
 static constexpr int min_vario = -500, max_vario = 500;
 
 unsigned
-VarioSynthesiser::VarioToFrequency(int ivario)
+VarioSynthesiser::VarioToFrequency(int ivario) const
 {
+  const unsigned min = min_frequency.load(std::memory_order_relaxed);
+  const unsigned zero = zero_frequency.load(std::memory_order_relaxed);
+  const unsigned max = max_frequency.load(std::memory_order_relaxed);
+
   return ivario > 0
-    ? (zero_frequency + (unsigned)ivario * (max_frequency - zero_frequency)
-       / (unsigned)max_vario)
-    : (zero_frequency - (unsigned)(ivario * (int)(zero_frequency - min_frequency) / min_vario));
+    ? (zero + (unsigned)ivario * (max - zero) / (unsigned)max_vario)
+    : (zero - (unsigned)(ivario * (int)(zero - min) / min_vario));
 }
 
 void
-VarioSynthesiser::SetVario(double vario)
+VarioSynthesiser::SetVario(double _vario)
 {
-  const std::lock_guard lock{mutex};
+  vario.store(Clamp((int)(_vario * 100), min_vario, max_vario),
+              std::memory_order_relaxed);
+  Post();
+}
 
-  const int ivario = Clamp((int)(vario * 100), min_vario, max_vario);
+void
+VarioSynthesiser::PollParameters()
+{
+  const unsigned g = generation.load(std::memory_order_acquire);
+  if (g == applied_generation)
+    return;
 
-  if (dead_band_enabled && InDeadBand(ivario)) {
+  applied_generation = g;
+
+  const int ivario = vario.load(std::memory_order_relaxed);
+  if (ivario == SILENCE ||
+      (dead_band_enabled.load(std::memory_order_relaxed) &&
+       InDeadBand(ivario)))
     /* inside the "dead band" */
-    UnsafeSetSilence();
-    return;
-  }
+    ApplySilence();
+  else
+    ApplyVario(ivario);
+}
 
+void
+VarioSynthesiser::ApplyVario(int ivario)
+{
   /* update the ToneSynthesiser base class */
   SetTone(VarioToFrequency(ivario));
 
@@ -43,9 +63,12 @@ VarioSynthesiser::SetVario(double vario)
     /* while climbing, the vario sound gets interrupted by silence
        periodically */
 
+    const unsigned min_period = min_period_ms.load(std::memory_order_relaxed);
+    const unsigned max_period = max_period_ms.load(std::memory_order_relaxed);
+
     const unsigned period_ms = sample_rate
-      * (min_period_ms + (max_vario - ivario)
-         * (max_period_ms - min_period_ms) / max_vario)
+      * (min_period + (max_vario - ivario)
+         * (max_period - min_period) / max_vario)
       / 1000;
 
     silence_count = period_ms / 3;
@@ -67,14 +90,7 @@ VarioSynthesiser::SetVario(double vario)
 }
 
 void
-VarioSynthesiser::SetSilence()
-{
-  const std::lock_guard lock{mutex};
-  UnsafeSetSilence();
-}
-
-void
-VarioSynthesiser::UnsafeSetSilence()
+VarioSynthesiser::ApplySilence()
 {
   audible_count = 0;
   silence_count = 1;
@@ -88,11 +104,10 @@ VarioSynthesiser::UnsafeSetSilence()
   silence_remaining = 0;
 }
 
-
 void
 VarioSynthesiser::Synthesise(int16_t *buffer, size_t n)
 {
-  const std::lock_guard lock{mutex};
+  PollParameters();
 
   assert(audible_count > 0 || silence_count > 0);
 
@@ -4,82 +4,103 @@
 #pragma once
 
 #include "ToneSynthesiser.hpp"
-#include "thread/Mutex.hxx"
+
+#include <atomic>
+#include <limits>
 
 /**
  * This class generates vario sound.
+ *
+ * The public setters may be called from any thread.  They do not
+ * lock; instead, they post the new parameters to a "mailbox" of
+ * atomic variables and bump #generation.  The audio thread picks up
+ * the new parameters at the beginning of the next Synthesise() call,
+ * so it never waits for the calculation thread.
  */
 class VarioSynthesiser final : public ToneSynthesiser {
   /**
-   * This mutex protects all atttributes below.  It is locked
-   * automatically by all public methods.
+   * The #vario value which requests silence.
    */
-  Mutex mutex;
+  static constexpr int SILENCE = std::numeric_limits<int>::min();
 
-  /**
-   * The number of audible samples in each period.
-   */
-  size_t audible_count;
+  /* the parameter mailbox, written by any thread */
 
   /**
-   * The number of silent samples in each period.  If this is zero,
-   * then no silence will be generated (continuous tone).
+   * Incremented after each parameter update.
    */
-  size_t silence_count;
+  std::atomic<unsigned> generation{0};
 
   /**
-   * The number of audible/silence samples remaining in the current
-   * period.  These two attributes will be reset to the according
-   * _count value when both reach zero.
+   * The current vario value [cm/s] or #SILENCE.
    */
-  size_t audible_remaining, silence_remaining;
+  std::atomic<int> vario{SILENCE};
 
-  bool dead_band_enabled;
+  std::atomic_bool dead_band_enabled{false};
 
   /**
    * The tone frequency for #min_vario.
    */
-  unsigned min_frequency;
+  std::atomic<unsigned> min_frequency{200};
 
   /**
    * The tone frequency for stationary altitude.
    */
-  unsigned zero_frequency;
+  std::atomic<unsigned> zero_frequency{500};
 
   /**
    * The tone frequency for #max_vario.
    */
-  unsigned max_frequency;
+  std::atomic<unsigned> max_frequency{1500};
 
   /**
    * The minimum silence+audible period for #max_vario.
    */
-  unsigned min_period_ms;
+  std::atomic<unsigned> min_period_ms{150};
 
   /**
    * The maximum silence+audible period for #min_vario.
    */
-  unsigned max_period_ms;
+  std::atomic<unsigned> max_period_ms{600};
 
   /**
    * The vario range of the "dead band" during which no sound is emitted
    * [cm/s].
    */
-  int min_dead, max_dead;
+  std::atomic<int> min_dead{-30}, max_dead{10};
+
+  /* the following attributes are only accessed by the audio thread */
+
+  /**
+   * The #generation which was last applied by Synthesise().
+   */
+  unsigned applied_generation = 0;
+
+  /**
+   * The number of audible samples in each period.
+   */
+  size_t audible_count = 0;
+
+  /**
+   * The number of silent samples in each period.  If this is zero,
+   * then no silence will be generated (continuous tone).
+   */
+  size_t silence_count = 1;
+
+  /**
+   * The number of audible/silence samples remaining in the current
+   * period.  These two attributes will be reset to the according
+   * _count value when both reach zero.
+   */
+  size_t audible_remaining = 0, silence_remaining = 0;
 
 public:
   explicit VarioSynthesiser(unsigned sample_rate)
-    :ToneSynthesiser(sample_rate),
-     audible_count(0), silence_count(1),
-     audible_remaining(0), silence_remaining(0),
-     dead_band_enabled(false),
-     min_frequency(200), zero_frequency(500), max_frequency(1500),
-     min_period_ms(150), max_period_ms(600),
-     min_dead(-30), max_dead(10) {}
+    :ToneSynthesiser(sample_rate) {}
 
   /**
-   * Update the vario value.  This calculates a new tone frequency and
-   * a new "silence" rate (for positive vario values).
+   * Update the vario value.  The audio thread will calculate a new
+   * tone frequency and a new "silence" rate (for positive vario
+   * values).
    *
    * @param vario the current vario value [m/s]
    */
@@ -88,38 +109,45 @@ public:
   /**
    * Produce silence from now on.
    */
-  void SetSilence();
+  void SetSilence() {
+    vario.store(SILENCE, std::memory_order_relaxed);
+    Post();
+  }
 
   /**
    * Enable/disable the dead band silence
    */
   void SetDeadBand(bool enabled) {
-    dead_band_enabled = enabled;
+    dead_band_enabled.store(enabled, std::memory_order_relaxed);
+    Post();
   }
 
   /**
    * Set the base frequencies for minimum, zero and maximum lift
    */
   void SetFrequencies(unsigned min, unsigned zero, unsigned max) {
-    min_frequency = min;
-    zero_frequency = zero;
-    max_frequency = max;
+    min_frequency.store(min, std::memory_order_relaxed);
+    zero_frequency.store(zero, std::memory_order_relaxed);
+    max_frequency.store(max, std::memory_order_relaxed);
+    Post();
   }
 
   /**
    * Set the time periods for minimum and maximum lift
    */
   void SetPeriods(unsigned min, unsigned max) {
-    min_period_ms = min;
-    max_period_ms = max;
+    min_period_ms.store(min, std::memory_order_relaxed);
+    max_period_ms.store(max, std::memory_order_relaxed);
+    Post();
   }
 
   /**
    * Set the vario range of the "dead band" during which no sound is emitted
    */
   void SetDeadBandRange(double min, double max) {
-    min_dead = (int)(min * 100);
-    max_dead = (int)(max * 100);
+    min_dead.store((int)(min * 100), std::memory_order_relaxed);
+    max_dead.store((int)(max * 100), std::memory_order_relaxed);
+    Post();
   }
 
   /* methods from class PCMSynthesiser */
@@ -127,19 +155,43 @@ public:
 
 private:
   /**
-   * Same as SetSilence(), but doesn't lock the mutex.
+   * Publish the parameters stored before this call to the audio
+   * thread.
+   */
+  void Post() {
+    generation.fetch_add(1, std::memory_order_release);
+  }
+
+  /**
+   * Apply the parameters from the mailbox if they have changed.
+   * Called by the audio thread.  A parameter update which races with
+   * this method bumps #generation again, and will therefore be
+   * applied by the next call.
+   */
+  void PollParameters();
+
+  /**
+   * Calculate the tone and the period for the given vario value.
+   * Called by the audio thread.
+   *
+   * @param ivario the current vario value [cm/s]
+   */
+  void ApplyVario(int ivario);
+
+  /**
+   * Switch to silence.  Called by the audio thread.
    */
-  void UnsafeSetSilence();
+  void ApplySilence();
 
   /**
    * Convert a vario value to a tone frequency.
    *
    * @param ivario the current vario value [cm/s]
    */
-  [[gnu::const]]
-  unsigned VarioToFrequency(int ivario);
+  unsigned VarioToFrequency(int ivario) const;
 
-  bool InDeadBand(int ivario) {
-    return ivario >= min_dead && ivario <= max_dead;
+  bool InDeadBand(int ivario) const {
+    return ivario >= min_dead.load(std::memory_order_relaxed) &&
+      ivario <= max_dead.load(std::memory_order_relaxed);
   }
 };
@@ -51,6 +51,9 @@ CalculationThread::Tick() noexcept
   const ScopeLockCPU cpu;
 #endif
 
+  const ScopeStageTimer timer(glide_computer.GetStageTimes(),
+                              ComputerStage::TICK);
+
   bool gps_updated;
 
   // update and transfer master info to glide computer
@@ -3,16 +3,13 @@
 
 #include "Client.hpp"
 #include "Serialiser.hpp"
-#include "Geo/Boost/RangeBox.hpp"
 #include "Tracking/SkyLines/Protocol.hpp"
 #include "Tracking/SkyLines/Assemble.hpp"
 #include "Tracking/SkyLines/Import.hpp"
 #include "net/AddressInfo.hxx"
 #include "net/Resolver.hxx"
 
-#include <boost/geometry/algorithms/distance.hpp>
-#include <boost/geometry/algorithms/intersection.hpp>
-#include <boost/geometry/strategies/strategies.hpp>
+#include <cassert>
 
 CloudClientContainer::CloudClientContainer()
   :key_set(typename KeySet::bucket_traits(key_buckets, N_KEY_BUCKETS)) {}
@@ -38,6 +35,24 @@ CloudClientContainer::Find(uint64_t key)
     : nullptr;
 }
 
+void
+CloudClientContainer::SetIdSequence(unsigned first, unsigned stride) noexcept
+{
+  assert(first > 0);
+  assert(stride > 0);
+
+  id_first = first;
+  id_stride = stride;
+  AlignNextId();
+}
+
+void
+CloudClientContainer::AlignNextId() noexcept
+{
+  next_id += (id_first % id_stride + id_stride - next_id % id_stride)
+    % id_stride;
+}
+
 CloudClient &
 CloudClientContainer::Make(SocketAddress address,
                            uint64_t key,
@@ -47,8 +62,9 @@ CloudClientContainer::Make(SocketAddress address,
   auto result = key_set.insert_check(key, key_set.hash_function(),
                                      key_set.key_eq(), hint);
   if (result.second) {
-    auto client = std::make_shared<CloudClient>(address, key, next_id++,
+    auto client = std::make_shared<CloudClient>(address, key, next_id,
                                                 location, altitude);
+    next_id += id_stride;
     Insert(*client);
     return *client;
   } else {
@@ -58,6 +74,32 @@ CloudClientContainer::Make(SocketAddress address,
   }
 }
 
+CloudClient &
+CloudClientContainer::MakeGhost(uint64_t key, unsigned id,
+                                const GeoPoint &location, int altitude)
+{
+  KeySet::insert_commit_data hint;
+  auto result = key_set.insert_check(key, key_set.hash_function(),
+                                     key_set.key_eq(), hint);
+  if (result.second) {
+    auto client = std::make_shared<CloudClient>(AllocatedSocketAddress(),
+                                                key, id, location, altitude);
+    client->ghost = true;
+    Insert(*client);
+    return *client;
+  } else {
+    auto &client = *result.first;
+    if (client.ghost) {
+      client.stamp = std::chrono::steady_clock::now();
+      list.erase(list.iterator_to(client));
+      list.push_front(client);
+      UpdateLocation(client, location, altitude);
+    }
+
+    return client;
+  }
+}
+
 void
 CloudClientContainer::Refresh(CloudClient &client,
                               SocketAddress address)
@@ -74,12 +116,17 @@ CloudClientContainer::Refresh(CloudClient &client,
                               const GeoPoint &location, int altitude)
 {
   Refresh(client, address);
+  UpdateLocation(client, location, altitude);
+}
 
+void
+CloudClientContainer::UpdateLocation(CloudClient &client,
+                                     const GeoPoint &location,
+                                     int altitude) noexcept
+{
   if (location != client.location) {
-    auto ptr = client.shared_from_this();
-    rtree.remove(ptr);
     client.location = location;
-    rtree.insert(ptr);
+    grid.Move(client);
   }
 
   client.altitude = altitude;
@@ -90,8 +137,8 @@ CloudClientContainer::Insert(CloudClient &client)
 {
   list.push_front(client);
   key_set.insert(client);
-  id_set.push_back(client);
-  rtree.insert(client.shared_from_this());
+  id_set.insert(client);
+  grid.Insert(client.shared_from_this());
 }
 
 void
@@ -100,7 +147,10 @@ CloudClientContainer::Remove(CloudClient &client)
   list.erase(list.iterator_to(client));
   key_set.erase(key_set.iterator_to(client));
   id_set.erase(id_set.iterator_to(client));
-  rtree.remove(client.shared_from_this());
+  client.CloudClientDirtyHook::unlink();
+
+  /* this may release the last reference, so it must be last */
+  grid.Remove(client);
 }
 
 void
@@ -110,11 +160,11 @@ CloudClientContainer::Expire(std::chrono::steady_clock::time_point before)
     Remove(list.back());
 }
 
-CloudClientContainer::query_iterator_range
-CloudClientContainer::QueryWithinRange(GeoPoint location, double range) const
+void
+CloudClientContainer::MarkDirty(CloudClient &client) noexcept
 {
-  const auto q = boost::geometry::index::intersects(BoostRangeBox(location, range));
-  return {rtree.qbegin(q), rtree.qend()};
+  if (!client.CloudClientDirtyHook::is_linked())
+    dirty.push_back(client);
 }
 
 inline Serialiser &
@@ -195,6 +245,9 @@ CloudClientContainer::Save(Serialiser &s) const
   s.Write32(next_id);
 
   for (const auto &client : list) {
+    if (client.ghost)
+      continue;
+
     s.Write8(1);
     client.Save(s);
   }
@@ -214,4 +267,6 @@ CloudClientContainer::Load(Deserialiser &s)
   }
 
   s.Read8();
+
+  AlignNextId();
 }
@@ -3,26 +3,34 @@
 
 #pragma once
 
-#include "Geo/Boost/GeoPoint.hpp"
+#include "ClientGrid.hpp"
+#include "Geo/GeoPoint.hpp"
 #include "net/AllocatedSocketAddress.hxx"
 
 #include <boost/intrusive/list.hpp>
 #include <boost/intrusive/set.hpp>
 #include <boost/intrusive/unordered_set.hpp>
-#include <boost/geometry/index/rtree.hpp>
-#include <boost/range/iterator_range_core.hpp>
 #include <memory>
 #include <chrono>
+#include <utility>
 
 class Serialiser;
 class Deserialiser;
 
+/**
+ * The #CloudClient hook for CloudClientContainer::dirty.
+ */
+using CloudClientDirtyHook =
+  boost::intrusive::list_base_hook<boost::intrusive::tag<struct CloudClientDirtyTag>,
+                                   boost::intrusive::link_mode<boost::intrusive::auto_unlink>>;
+
 /**
  * A client which has submitted data to us recently.
  */
 struct CloudClient
   : std::enable_shared_from_this<CloudClient>,
     boost::intrusive::list_base_hook<boost::intrusive::link_mode<boost::intrusive::normal_link>>,
+    CloudClientDirtyHook,
     boost::intrusive::set_base_hook<boost::intrusive::link_mode<boost::intrusive::normal_link>>,
     boost::intrusive::unordered_set_base_hook<boost::intrusive::link_mode<boost::intrusive::normal_link>>
 {
@@ -74,6 +82,20 @@ struct CloudClient
    */
   int altitude;
 
+  /**
+   * The cell of #CloudClientGrid which contains this client and the
+   * position within it.  Managed by #CloudClientGrid.
+   */
+  unsigned grid_cell;
+  std::size_t grid_index;
+
+  /**
+   * Is this a copy of a client owned by another shard of a
+   * multi-threaded server?  Ghosts are only visible to queries; they
+   * never receive data and are not saved.
+   */
+  bool ghost = false;
+
   struct KeyHash {
     constexpr std::size_t operator()(uint64_t key) const {
       return key;
@@ -126,27 +148,14 @@ struct CloudClient
   static CloudClient Load(Deserialiser &s);
 };
 
-using CloudClientPtr = std::shared_ptr<CloudClient>;
-
-/**
- * Helper for boost::geometry::index::rtree.
- */
-struct CloudClientIndexable {
-  typedef GeoPoint result_type;
-
-  [[gnu::pure]]
-  result_type operator()(const CloudClientPtr &client) const {
-    return client->location;
-  }
-};
-
 class CloudClientContainer {
-  typedef boost::geometry::index::rtree<CloudClientPtr, boost::geometry::index::rstar<16>,
-                                        CloudClientIndexable> Tree;
-
   typedef boost::intrusive::list<CloudClient,
                                  boost::intrusive::constant_time_size<false>> List;
 
+  typedef boost::intrusive::list<CloudClient,
+                                 boost::intrusive::base_hook<CloudClientDirtyHook>,
+                                 boost::intrusive::constant_time_size<false>> DirtyList;
+
   typedef boost::intrusive::unordered_set<CloudClient,
                                           boost::intrusive::hash<CloudClient::KeyHash>,
                                           boost::intrusive::equal<CloudClient::KeyEqual>,
@@ -158,9 +167,9 @@ class CloudClientContainer {
 
   /**
    * A geospatial container of all clients, for fast geographic
-   * lookups.
+   * lookups.  It owns the #CloudClient objects.
    */
-  Tree rtree;
+  CloudClientGrid grid;
 
   /**
    * A linked list of clients, sorted by last fix, with fresh items at
@@ -168,6 +177,12 @@ class CloudClientContainer {
    */
   List list;
 
+  /**
+   * Clients whose location has changed since the last
+   * ConsumeDirty() call, in the order of the first change.
+   */
+  DirtyList dirty;
+
   /**
    * Map (secret) key to #CloudClient.
    */
@@ -183,6 +198,11 @@ class CloudClientContainer {
    */
   unsigned next_id = 1;
 
+  /**
+   * See SetIdSequence().
+   */
+  unsigned id_first = 1, id_stride = 1;
+
   static constexpr size_t N_KEY_BUCKETS = 65521;
   typename KeySet::bucket_type key_buckets[N_KEY_BUCKETS];
 
@@ -215,12 +235,28 @@ public:
   [[gnu::pure]]
   CloudClient *Find(uint64_t key);
 
+  /**
+   * Assign only ids which are congruent to #first modulo #stride
+   * (also after Load()).
+   * This allows several containers to generate unique ids without
+   * coordination.
+   */
+  void SetIdSequence(unsigned first, unsigned stride) noexcept;
+
   /**
    * Create a new #CloudClient, or refresh the existing one.
    */
   CloudClient &Make(SocketAddress address,
                     uint64_t key, const GeoPoint &location, int altitude);
 
+  /**
+   * Create or update a ghost client (see CloudClient::ghost) with
+   * the id assigned by its owner.  If a regular client with that key
+   * exists, it is returned unmodified.
+   */
+  CloudClient &MakeGhost(uint64_t key, unsigned id,
+                         const GeoPoint &location, int altitude);
+
   void Refresh(CloudClient &client,
                SocketAddress address);
 
@@ -238,12 +274,62 @@ public:
 
   void Expire(std::chrono::steady_clock::time_point before);
 
-  typedef Tree::const_query_iterator query_iterator;
-  typedef boost::iterator_range<query_iterator> query_iterator_range;
+  /**
+   * Like Expire(), but invoke the function on each client before it
+   * is removed.
+   */
+  template<typename F>
+  void Expire(std::chrono::steady_clock::time_point before, F &&f) {
+    while (!list.empty() && list.back().stamp < before) {
+      f(std::as_const(list.back()));
+      Remove(list.back());
+    }
+  }
+
+  /**
+   * Remember that the location of this client has changed, to be
+   * processed by the next ConsumeDirty() call.
+   */
+  void MarkDirty(CloudClient &client) noexcept;
+
+  bool HasDirty() const noexcept {
+    return !dirty.empty();
+  }
+
+  /**
+   * Invoke the function on each client which was passed to
+   * MarkDirty() since the last call, and clear the dirty list.
+   * Clients which have been removed in the meantime are not
+   * visited.
+   */
+  template<typename F>
+  void ConsumeDirty(F &&f) {
+    while (!dirty.empty()) {
+      auto &client = dirty.front();
+      dirty.pop_front();
+      f(client);
+    }
+  }
 
   [[gnu::pure]]
-  query_iterator_range QueryWithinRange(GeoPoint location, double range) const;
+  CloudClientGrid::Query QueryWithinRange(GeoPoint location,
+                                          double range) const noexcept {
+    return grid.QueryWithinRange(location, range);
+  }
 
+  /**
+   * Save all clients except for ghosts.
+   */
   void Save(Serialiser &s) const;
   void Load(Deserialiser &s);
+
+private:
+  void UpdateLocation(CloudClient &client,
+                      const GeoPoint &location, int altitude) noexcept;
+
+  /**
+   * Round #next_id up to the sequence configured by
+   * SetIdSequence().
+   */
+  void AlignNextId() noexcept;
 };
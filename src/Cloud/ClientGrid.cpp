@@ -0,0 +1,165 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "ClientGrid.hpp"
+#include "Client.hpp"
+#include "Geo/Boost/RangeBox.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+inline unsigned
+CloudClientGrid::RowOf(double latitude) noexcept
+{
+  const int row = (int)std::floor((latitude + 90) / CELL_SIZE);
+  return std::clamp(row, 0, int(N_ROWS) - 1);
+}
+
+inline int
+CloudClientGrid::ColumnOf(double longitude) noexcept
+{
+  /* not wrapped; the caller is responsible for that */
+  return (int)std::floor((longitude + 180) / CELL_SIZE);
+}
+
+static constexpr unsigned
+WrapColumn(int column, unsigned n_columns) noexcept
+{
+  const int n = int(n_columns);
+  return unsigned(((column % n) + n) % n);
+}
+
+inline unsigned
+CloudClientGrid::CellOf(GeoPoint location) noexcept
+{
+  return RowOf(location.latitude.Degrees()) * N_COLUMNS +
+    WrapColumn(ColumnOf(location.longitude.Degrees()), N_COLUMNS);
+}
+
+inline bool
+CloudClientGrid::IsNearCell(unsigned cell, GeoPoint location) noexcept
+{
+  const double south = (cell / N_COLUMNS) * CELL_SIZE - 90;
+  const double west = (cell % N_COLUMNS) * CELL_SIZE - 180;
+
+  const double latitude = location.latitude.Degrees();
+  const double longitude = location.longitude.Degrees();
+
+  return latitude >= south - SLACK &&
+    latitude <= south + CELL_SIZE + SLACK &&
+    longitude >= west - SLACK &&
+    longitude <= west + CELL_SIZE + SLACK;
+}
+
+void
+CloudClientGrid::Insert(CloudClientPtr client) noexcept
+{
+  const unsigned cell = CellOf(client->location);
+  auto &bucket = cells[cell];
+
+  client->grid_cell = cell;
+  client->grid_index = bucket.size();
+  bucket.push_back(std::move(client));
+}
+
+void
+CloudClientGrid::Remove(CloudClient &client) noexcept
+{
+  auto i = cells.find(client.grid_cell);
+  assert(i != cells.end());
+
+  auto &bucket = i->second;
+  assert(client.grid_index < bucket.size());
+  assert(bucket[client.grid_index].get() == &client);
+
+  /* move the last item into the gap */
+  if (client.grid_index + 1 < bucket.size()) {
+    auto &last = bucket.back();
+    last->grid_index = client.grid_index;
+    std::swap(bucket[client.grid_index], last);
+  }
+
+  /* this may destroy the client, so it must not be accessed
+     afterwards */
+  bucket.pop_back();
+
+  if (bucket.empty())
+    cells.erase(i);
+}
+
+void
+CloudClientGrid::Move(CloudClient &client) noexcept
+{
+  if (IsNearCell(client.grid_cell, client.location))
+    return;
+
+  auto ptr = client.shared_from_this();
+  Remove(client);
+  Insert(std::move(ptr));
+}
+
+CloudClientGrid::Query
+CloudClientGrid::QueryWithinRange(GeoPoint location,
+                                  double range) const noexcept
+{
+  const auto box = BoostRangeBox(location, range);
+
+  Query q(*this);
+  q.south = box.min_corner().latitude.Degrees();
+  q.north = box.max_corner().latitude.Degrees();
+  q.west = box.min_corner().longitude.Degrees();
+  q.east = box.max_corner().longitude.Degrees();
+
+  q.row_begin = RowOf(q.south - SLACK);
+  q.row_end = RowOf(q.north + SLACK) + 1;
+
+  double width = q.east - q.west;
+  if (width < 0)
+    /* crosses the date line */
+    width += 360;
+
+  q.first_column = ColumnOf(q.west - SLACK);
+  const int last_column = ColumnOf(q.west + width + SLACK);
+  q.n_columns = std::min(unsigned(last_column - q.first_column + 1),
+                         N_COLUMNS);
+
+  return q;
+}
+
+inline bool
+CloudClientGrid::Query::Contains(const GeoPoint &p) const noexcept
+{
+  const double latitude = p.latitude.Degrees();
+  if (latitude < south || latitude > north)
+    return false;
+
+  const double longitude = p.longitude.Degrees();
+  return west <= east
+    ? longitude >= west && longitude <= east
+    : longitude >= west || longitude <= east;
+}
+
+void
+CloudClientGrid::Query::Seek(const_iterator &i) const noexcept
+{
+  while (i.row < row_end) {
+    if (i.bucket == nullptr)
+      i.bucket = grid.FindBucket(i.row,
+                                 WrapColumn(first_column + int(i.column),
+                                            N_COLUMNS));
+
+    if (i.bucket != nullptr)
+      for (; i.index < i.bucket->size(); ++i.index)
+        if (Contains((*i.bucket)[i.index]->location))
+          return;
+
+    /* go to the next cell */
+    i.bucket = nullptr;
+    i.index = 0;
+    if (++i.column == n_columns) {
+      i.column = 0;
+      ++i.row;
+    }
+  }
+}
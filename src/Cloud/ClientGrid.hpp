@@ -0,0 +1,191 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Geo/GeoPoint.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+struct CloudClient;
+using CloudClientPtr = std::shared_ptr<CloudClient>;
+
+/**
+ * A spatial index for moving #CloudClient objects.  It is a uniform
+ * grid of latitude/longitude cells, and only the occupied cells are
+ * allocated.
+ *
+ * Each client remains in its cell as long as it does not leave the
+ * cell's bounds plus a slack margin; queries are widened by that
+ * margin.  Therefore, the small moves between two fixes usually
+ * don't modify the index at all, and if they do, moving a client to
+ * another cell costs O(1).
+ */
+class CloudClientGrid {
+  /**
+   * The size of a cell in degrees.  It should be in the order of
+   * magnitude of the query range.
+   */
+  static constexpr double CELL_SIZE = 0.5;
+
+  /**
+   * The distance in degrees a client may move beyond the bounds of
+   * its cell before it is moved to another cell.
+   */
+  static constexpr double SLACK = 0.1;
+
+  static constexpr unsigned N_COLUMNS = 360 / CELL_SIZE;
+  static constexpr unsigned N_ROWS = 180 / CELL_SIZE;
+
+  using Bucket = std::vector<CloudClientPtr>;
+
+  /**
+   * Map cell number (row * #N_COLUMNS + column) to the clients in
+   * that cell.
+   */
+  std::unordered_map<unsigned, Bucket> cells;
+
+public:
+  /**
+   * The result of QueryWithinRange(): a range of #CloudClientPtr
+   * within the query box, in unspecified order.  It is invalidated
+   * by all modifying calls.
+   */
+  class Query {
+    friend class CloudClientGrid;
+
+    const CloudClientGrid &grid;
+
+    /* the query box in degrees; if west>east, it crosses the date
+       line */
+    double south, north, west, east;
+
+    /* the cells to be scanned */
+    unsigned row_begin, row_end;
+    int first_column;
+    unsigned n_columns;
+
+    explicit Query(const CloudClientGrid &_grid) noexcept:grid(_grid) {}
+
+  public:
+    class const_iterator {
+      friend class Query;
+
+      const Query *query;
+
+      /* the current cell: its row and its position within the
+         scanned columns */
+      unsigned row, column;
+
+      const Bucket *bucket;
+      std::size_t index;
+
+      const_iterator(const Query &_query, unsigned _row) noexcept
+        :query(&_query), row(_row), column(0),
+         bucket(nullptr), index(0) {}
+
+    public:
+      using iterator_category = std::forward_iterator_tag;
+      using difference_type = std::ptrdiff_t;
+      using value_type = const CloudClientPtr;
+      using pointer = const CloudClientPtr *;
+      using reference = const CloudClientPtr &;
+
+      bool operator==(const const_iterator &other) const noexcept {
+        return row == other.row && column == other.column &&
+          index == other.index;
+      }
+
+      bool operator!=(const const_iterator &other) const noexcept {
+        return !(*this == other);
+      }
+
+      const_iterator &operator++() noexcept {
+        ++index;
+        query->Seek(*this);
+        return *this;
+      }
+
+      reference operator*() const noexcept {
+        return (*bucket)[index];
+      }
+
+      pointer operator->() const noexcept {
+        return &(*bucket)[index];
+      }
+    };
+
+    const_iterator begin() const noexcept {
+      const_iterator i(*this, row_begin);
+      Seek(i);
+      return i;
+    }
+
+    const_iterator end() const noexcept {
+      return const_iterator(*this, row_end);
+    }
+
+  private:
+    [[gnu::pure]]
+    bool Contains(const GeoPoint &p) const noexcept;
+
+    /**
+     * Advance the iterator to the next matching client, starting at
+     * its current position.
+     */
+    void Seek(const_iterator &i) const noexcept;
+  };
+
+  bool empty() const noexcept {
+    return cells.empty();
+  }
+
+  void clear() noexcept {
+    cells.clear();
+  }
+
+  void Insert(CloudClientPtr client) noexcept;
+
+  /**
+   * Remove the client from the grid.  This may release the last
+   * reference to it.
+   */
+  void Remove(CloudClient &client) noexcept;
+
+  /**
+   * Update the client's cell after its location has been modified.
+   */
+  void Move(CloudClient &client) noexcept;
+
+  /**
+   * Find all clients within the box which covers the given range
+   * around the location (see BoostRangeBox()).
+   */
+  [[gnu::pure]]
+  Query QueryWithinRange(GeoPoint location, double range) const noexcept;
+
+private:
+  [[gnu::const]]
+  static unsigned RowOf(double latitude) noexcept;
+
+  [[gnu::const]]
+  static int ColumnOf(double longitude) noexcept;
+
+  [[gnu::const]]
+  static unsigned CellOf(GeoPoint location) noexcept;
+
+  /**
+   * Is the location within the bounds of the cell, plus #SLACK?
+   */
+  [[gnu::const]]
+  static bool IsNearCell(unsigned cell, GeoPoint location) noexcept;
+
+  const Bucket *FindBucket(unsigned row, unsigned column) const noexcept {
+    auto i = cells.find(row * N_COLUMNS + column);
+    return i != cells.end() ? &i->second : nullptr;
+  }
+};
@@ -20,6 +20,9 @@ void
 CloudData::DumpClients()
 {
   for (const auto &client : clients) {
+    if (client.ghost)
+      continue;
+
     cout << ToString(client.address) << '\t'
          << std::hex << client.key << std::dec << '\t'
          << client.id << '\t'
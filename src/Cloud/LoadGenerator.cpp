@@ -0,0 +1,279 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * A load generator for the XCSoar Cloud server.  It simulates a
+ * number of SkyLines tracking clients flying in groups, sends fixes
+ * at a fixed rate over UDP and counts the traffic responses sent back
+ * by the server.
+ *
+ * The clients are spread over several source sockets, because a
+ * multi-threaded server (SO_REUSEPORT) distributes datagrams by
+ * source address.
+ */
+
+#include "Tracking/SkyLines/Server.hpp"
+#include "Tracking/SkyLines/Assemble.hpp"
+#include "Tracking/SkyLines/Protocol.hpp"
+#include "Geo/GeoPoint.hpp"
+#include "Math/Angle.hpp"
+#include "net/Resolver.hxx"
+#include "net/AddressInfo.hxx"
+#include "net/SocketError.hxx"
+#include "net/StaticSocketAddress.hxx"
+#include "net/UniqueSocketDescriptor.hxx"
+#include "util/ByteOrder.hxx"
+#include "util/NumberParser.hpp"
+#include "util/PrintException.hxx"
+
+#include <chrono>
+#include <iostream>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+using namespace SkyLinesTracking;
+
+struct SimulatedClient {
+  uint64_t key;
+  ::GeoPoint location;
+  int altitude;
+};
+
+struct Statistics {
+  unsigned long sent_fixes = 0;
+  unsigned long received_datagrams = 0;
+  unsigned long received_traffic = 0;
+};
+
+static unsigned
+ParsePositiveArgument(const char *s, const char *name)
+{
+  char *endptr;
+  unsigned value = ParseUnsigned(s, &endptr);
+  if (endptr == s || *endptr != 0 || value == 0)
+    throw std::runtime_error(std::string("Invalid ") + name);
+  return value;
+}
+
+/**
+ * The number of clients in one group.
+ */
+static constexpr unsigned GROUP_SIZE = 64;
+
+/**
+ * Create groups of clients within a few kilometres of each other, so
+ * every fix is relevant to all others in the group.  The groups are
+ * one degree apart, and each one straddles a meridian with an integer
+ * longitude, so a sharded server has to handle region boundaries.
+ */
+static std::vector<SimulatedClient>
+MakeClients(unsigned n)
+{
+  std::vector<SimulatedClient> clients;
+  clients.reserve(n);
+
+  for (unsigned i = 0; i < n; ++i) {
+    const unsigned group = i / GROUP_SIZE, member = i % GROUP_SIZE;
+    const ::GeoPoint origin(Angle::Degrees(5.92 + group % 16),
+                            Angle::Degrees(44.5 + group / 16 % 8));
+
+    ::GeoPoint location(origin.longitude + Angle::Degrees((member % 32) * 0.005),
+                        origin.latitude + Angle::Degrees((member / 32) * 0.005));
+    clients.push_back({0x10000 + i, location, int(1000 + (i % 100) * 10)});
+  }
+
+  return clients;
+}
+
+template<typename P>
+static void
+SendPacket(SocketDescriptor s, SocketAddress address, const P &packet)
+{
+  if (s.Write(&packet, sizeof(packet), address) < 0)
+    throw MakeSocketError("Failed to send");
+}
+
+static void
+SendFix(SocketDescriptor s, SocketAddress address,
+        SimulatedClient &client, uint32_t time)
+{
+  /* drift to the north-east to make each fix unique */
+  client.location.latitude += Angle::Degrees(0.00001);
+  client.location.longitude += Angle::Degrees(0.00001);
+
+  SendPacket(s, address,
+             MakeFix(client.key,
+                     FixPacket::FLAG_LOCATION | FixPacket::FLAG_ALTITUDE,
+                     time, client.location, Angle::Zero(),
+                     0, 0, client.altitude, 0, 0));
+}
+
+/**
+ * Receive all pending datagrams without blocking.
+ */
+static void
+Drain(SocketDescriptor s, Statistics &statistics)
+{
+  while (true) {
+    std::byte buffer[4096];
+    StaticSocketAddress address;
+    ssize_t nbytes = s.Read(buffer, sizeof(buffer), address);
+    if (nbytes < 0) {
+      const auto e = GetSocketError();
+      if (IsSocketErrorReceiveWouldBlock(e))
+        break;
+
+      throw MakeSocketError(e, "Failed to receive");
+    }
+
+    ++statistics.received_datagrams;
+
+    const auto &header = *(const Header *)buffer;
+    const auto &traffic = *(const TrafficResponsePacket *)buffer;
+    if (std::size_t(nbytes) >= sizeof(traffic) &&
+        FromBE16(header.type) == Type::TRAFFIC_RESPONSE)
+      statistics.received_traffic += traffic.traffic_count;
+  }
+}
+
+/**
+ * Wait until at least one of the sockets is readable.
+ *
+ * @return false on timeout
+ */
+static bool
+WaitReadable(std::span<const UniqueSocketDescriptor> sockets, int timeout_ms)
+{
+  std::vector<struct pollfd> pfds;
+  pfds.reserve(sockets.size());
+  for (const auto &s : sockets)
+    pfds.push_back({s.Get(), POLLIN, 0});
+
+  return poll(pfds.data(), pfds.size(), timeout_ms) > 0;
+}
+
+static void
+Drain(std::span<const UniqueSocketDescriptor> sockets, Statistics &statistics)
+{
+  for (const auto &s : sockets)
+    Drain(s, statistics);
+}
+
+int
+main(int argc, char **argv)
+try {
+  if (argc < 2 || argc > 6) {
+    cerr << "Usage: " << argv[0]
+         << " HOST[:PORT] [CLIENTS [FIXES_PER_SECOND [SECONDS [SOCKETS]]]]"
+         << endl;
+    return EXIT_FAILURE;
+  }
+
+  const unsigned n_clients = argc > 2
+    ? ParsePositiveArgument(argv[2], "number of clients")
+    : 100;
+  const unsigned rate = argc > 3
+    ? ParsePositiveArgument(argv[3], "rate")
+    : 1000;
+  const std::chrono::seconds duration(argc > 4
+                                      ? ParsePositiveArgument(argv[4],
+                                                              "duration")
+                                      : 10);
+  const unsigned n_sockets = argc > 5
+    ? ParsePositiveArgument(argv[5], "number of sockets")
+    : 1;
+
+  const auto address_list = Resolve(argv[1], Server::GetDefaultPort(),
+                                    0, SOCK_DGRAM);
+  const SocketAddress address = address_list.front();
+
+  std::vector<UniqueSocketDescriptor> sockets(n_sockets);
+  for (auto &s : sockets)
+    if (!s.Create(address.GetFamily(), SOCK_DGRAM, 0))
+      throw MakeSocketError("Failed to create socket");
+
+  /* each client always uses the same socket */
+  auto GetSocket = [&sockets](std::size_t client) -> SocketDescriptor {
+    return sockets[client % sockets.size()];
+  };
+
+  auto clients = MakeClients(n_clients);
+  Statistics statistics;
+
+  /* register all clients and subscribe them to traffic updates; this
+     is throttled to avoid overflowing the server's receive buffer */
+  for (std::size_t i = 0; i < clients.size(); ++i) {
+    SendFix(GetSocket(i), address, clients[i], 0);
+    ++statistics.sent_fixes;
+
+    if (i % GROUP_SIZE == GROUP_SIZE - 1) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      Drain(sockets, statistics);
+    }
+  }
+
+  /* give the server a moment to register the clients */
+  while (WaitReadable(sockets, 100))
+    Drain(sockets, statistics);
+
+  for (std::size_t i = 0; i < clients.size(); ++i) {
+    SendPacket(GetSocket(i), address,
+               MakeTrafficRequest(clients[i].key, false, false, true));
+
+    if (i % GROUP_SIZE == GROUP_SIZE - 1) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      Drain(sockets, statistics);
+    }
+  }
+
+  using Clock = std::chrono::steady_clock;
+  const auto start = Clock::now();
+  const auto end = start + duration;
+
+  unsigned long n_fixes = 0;
+  std::size_t next_client = 0;
+
+  for (auto now = start; now < end; now = Clock::now()) {
+    const auto elapsed =
+      std::chrono::duration_cast<std::chrono::microseconds>(now - start);
+    const unsigned long due = elapsed.count() * rate / 1000000;
+
+    for (; n_fixes < due; ++n_fixes) {
+      SendFix(GetSocket(next_client), address, clients[next_client],
+              uint32_t(elapsed.count() / 1000));
+      if (++next_client == clients.size())
+        next_client = 0;
+    }
+
+    WaitReadable(sockets, 1);
+    Drain(sockets, statistics);
+  }
+
+  statistics.sent_fixes += n_fixes;
+
+  /* collect late responses */
+  while (WaitReadable(sockets, 1000))
+    Drain(sockets, statistics);
+
+  const double seconds =
+    std::chrono::duration<double>(Clock::now() - start).count();
+
+  cout << "clients\t" << n_clients << '\n'
+       << "fixes\t" << statistics.sent_fixes << '\n'
+       << "fixes/s\t" << n_fixes / std::chrono::duration<double>(duration).count() << '\n'
+       << "responses\t" << statistics.received_datagrams << '\n'
+       << "responses/s\t" << statistics.received_datagrams / seconds << '\n'
+       << "traffic entries\t" << statistics.received_traffic << endl;
+
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
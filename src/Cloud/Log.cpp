@@ -0,0 +1,131 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Log.hpp"
+#include "Dump.hpp"
+
+#include <algorithm>
+#include <sstream>
+
+/**
+ * How long the writer thread sleeps when the ring buffer is empty.
+ */
+static constexpr std::chrono::milliseconds WRITER_INTERVAL{100};
+
+CloudLog::CloudLog(FILE *_file, Verbosity _verbosity,
+                   unsigned _fix_sample) noexcept
+  :Thread("CloudLog"),
+   file(_file), verbosity(_verbosity),
+   fix_sample(std::max(_fix_sample, 1U)),
+   ring(std::make_unique<CloudLogRecord[]>(CAPACITY)) {}
+
+CloudLog::~CloudLog() noexcept
+{
+  if (!IsDefined())
+    return;
+
+  {
+    const std::lock_guard lock{mutex};
+    stop = true;
+    cond.notify_one();
+  }
+
+  Join();
+}
+
+void
+CloudLog::Push(const CloudLogRecord &record) noexcept
+{
+  const std::size_t position = push_count.load(std::memory_order_relaxed);
+  if (position - pop_count.load(std::memory_order_acquire) >= CAPACITY) {
+    /* the writer thread doesn't keep up; don't block the event
+       loop */
+    n_dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  ring[position % CAPACITY] = record;
+  push_count.store(position + 1, std::memory_order_release);
+}
+
+inline void
+CloudLog::Write(const CloudLogRecord &record) noexcept
+{
+  std::ostringstream os;
+
+  switch (record.type) {
+  case CloudLogRecord::Type::FIX:
+    os << "FIX\t"
+       << SocketAddress(record.address) << '\t'
+       << std::hex << record.key << std::dec << '\t'
+       << record.id << '\t'
+       << record.location << '\t'
+       << record.altitude << "m\n";
+    break;
+
+  case CloudLogRecord::Type::WAVE:
+    os << "WAVE\t"
+       << SocketAddress(record.address) << '\t'
+       << std::hex << record.key << std::dec << '\t'
+       << record.id << '\t'
+       << record.location << '\t'
+       << record.location2 << '\t'
+       << record.altitude << '-' << record.top_altitude << "m\t"
+       << record.lift << "m/s\n";
+    break;
+
+  case CloudLogRecord::Type::THERMAL:
+    os << "THERMAL\t"
+       << SocketAddress(record.address) << '\t'
+       << std::hex << record.key << std::dec << '\t'
+       << record.id << '\t'
+       << record.location << '\t'
+       << record.altitude << '-' << record.top_altitude << "m\t"
+       << record.lift << "m/s\n";
+    break;
+  }
+
+  const auto line = std::move(os).str();
+  fwrite(line.data(), 1, line.size(), file);
+}
+
+std::size_t
+CloudLog::Drain() noexcept
+{
+  const std::size_t begin = pop_count.load(std::memory_order_relaxed);
+  const std::size_t end = push_count.load(std::memory_order_acquire);
+
+  for (std::size_t i = begin; i != end; ++i)
+    Write(ring[i % CAPACITY]);
+
+  pop_count.store(end, std::memory_order_release);
+
+  if (end != begin)
+    fflush(file);
+
+  return end - begin;
+}
+
+void
+CloudLog::Run() noexcept
+{
+  std::unique_lock lock{mutex};
+
+  while (!stop) {
+    std::size_t n;
+
+    {
+      const ScopeUnlock unlock(mutex);
+      n = Drain();
+    }
+
+    if (n == 0)
+      /* nothing to do; the producer doesn't notify us, so poll */
+      cond.wait_for(lock, WRITER_INTERVAL);
+  }
+
+  lock.unlock();
+
+  /* write the rest */
+  Drain();
+}
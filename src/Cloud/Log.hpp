@@ -0,0 +1,177 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "thread/Thread.hpp"
+#include "thread/Mutex.hxx"
+#include "thread/Cond.hxx"
+#include "Geo/GeoPoint.hpp"
+#include "net/StaticSocketAddress.hxx"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+
+/**
+ * One entry of the #CloudLog.  It contains raw values; formatting is
+ * done by the writer thread.
+ */
+struct CloudLogRecord {
+  enum class Type : uint8_t {
+    FIX,
+    WAVE,
+    THERMAL,
+  } type;
+
+  StaticSocketAddress address;
+  uint64_t key;
+  unsigned id;
+
+  /**
+   * FIX: the location; WAVE: the first point; THERMAL: the top
+   * location.
+   */
+  GeoPoint location;
+
+  /**
+   * WAVE: the second point.
+   */
+  GeoPoint location2;
+
+  /**
+   * FIX: the altitude; WAVE/THERMAL: the bottom altitude.
+   */
+  int altitude;
+
+  /**
+   * WAVE/THERMAL: the top altitude.
+   */
+  int top_altitude;
+
+  /**
+   * WAVE/THERMAL: the lift [m/s].
+   */
+  double lift;
+};
+
+/**
+ * An asynchronous log for the cloud server's hot path.  The event
+ * loop pushes records into a lock-free single-producer ring buffer,
+ * and a background thread formats them as TSV lines and writes them
+ * in batches.  If the writer falls behind, new records are dropped
+ * and counted instead of blocking the producer.
+ */
+class CloudLog final : Thread {
+public:
+  enum class Verbosity : uint8_t {
+    /**
+     * Log nothing.
+     */
+    NONE,
+
+    /**
+     * Log wave and thermal submissions.
+     */
+    EVENTS,
+
+    /**
+     * Log fixes, too (subject to sampling).
+     */
+    ALL,
+  };
+
+private:
+  static constexpr std::size_t CAPACITY = 4096;
+
+  FILE *const file;
+
+  const Verbosity verbosity;
+
+  /**
+   * Log only every Nth fix.
+   */
+  const unsigned fix_sample;
+
+  /**
+   * Counts fixes for #fix_sample; only accessed by the producer.
+   */
+  unsigned fix_counter = 0;
+
+  const std::unique_ptr<CloudLogRecord[]> ring;
+
+  /**
+   * The total number of records pushed (modified by the producer)
+   * and popped (modified by the writer thread).  The difference is
+   * the fill level.
+   */
+  std::atomic<std::size_t> push_count{0}, pop_count{0};
+
+  std::atomic<uint64_t> n_dropped{0};
+
+  /**
+   * Protects #stop; used only to wake up the writer thread.  The
+   * producer never locks it.
+   */
+  Mutex mutex;
+  Cond cond;
+  bool stop = false;
+
+public:
+  CloudLog(FILE *_file, Verbosity _verbosity, unsigned _fix_sample) noexcept;
+
+  /**
+   * Stops the thread after it has written all pending records.
+   */
+  ~CloudLog() noexcept;
+
+  /**
+   * Throws on error.
+   */
+  void Start() {
+    Thread::Start();
+  }
+
+  bool WantFix() noexcept {
+    if (verbosity < Verbosity::ALL)
+      return false;
+
+    if (++fix_counter < fix_sample)
+      return false;
+
+    fix_counter = 0;
+    return true;
+  }
+
+  bool WantEvents() const noexcept {
+    return verbosity >= Verbosity::EVENTS;
+  }
+
+  /**
+   * Add a record to the log.  May only be called from one thread
+   * (the event loop).  Never blocks.
+   */
+  void Push(const CloudLogRecord &record) noexcept;
+
+  /**
+   * The number of records which were discarded because the ring
+   * buffer was full.
+   */
+  uint64_t GetDroppedCount() const noexcept {
+    return n_dropped.load(std::memory_order_relaxed);
+  }
+
+private:
+  /**
+   * Format and write all pending records.
+   *
+   * @return the number of records written
+   */
+  std::size_t Drain() noexcept;
+
+  void Write(const CloudLogRecord &record) noexcept;
+
+  /* virtual methods from class Thread */
+  void Run() noexcept override;
+};
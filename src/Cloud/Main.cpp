@@ -1,388 +1,130 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 // Copyright The XCSoar Project
 
-#include "Data.hpp"
-#include "Dump.hpp"
-#include "Sender.hpp"
-#include "Serialiser.hpp"
-#include "Tracking/SkyLines/Server.hpp"
-#include "Tracking/SkyLines/Protocol.hpp"
-#include "util/ByteOrder.hxx"
+#include "Log.hpp"
+#include "Server.hpp"
+#include "Shard.hpp"
+#include "Stats.hpp"
+#include "StatsListener.hpp"
+#include "Supervisor.hpp"
+#include "Worker.hpp"
 #include "event/Loop.hxx"
-#include "event/CoarseTimerEvent.hxx"
 #include "event/SignalMonitor.hxx"
 #include "net/IPv4Address.hxx"
-#include "io/FileOutputStream.hxx"
-#include "io/FileReader.hxx"
+#include "net/Features.hxx"
+#include "util/NumberParser.hpp"
 #include "util/PrintException.hxx"
-#include "util/Exception.hxx"
-#include "util/Compiler.h"
+#include "util/StringCompare.hxx"
 #include "util/ScopeExit.hxx"
 
-#include <array>
 #include <iostream>
-#include <iomanip>
+#include <memory>
+#include <vector>
 
-#include <signal.h>
-
-// TODO: review these settings
-static constexpr double TRAFFIC_RANGE = 50000;
-static constexpr double THERMAL_RANGE = 50000;
-
-static constexpr std::chrono::steady_clock::duration MAX_TRAFFIC_AGE = std::chrono::minutes(15);
-static constexpr std::chrono::steady_clock::duration MAX_THERMAL_AGE = std::chrono::minutes(30);
-
-static constexpr std::chrono::steady_clock::duration REQUEST_EXPIRY = std::chrono::minutes(5);
-
-using std::cout;
 using std::cerr;
 using std::endl;
 
-class CloudServer final
-  : public SkyLinesTracking::Server, CloudData
-{
-  const AllocatedPath db_path;
-
-  CoarseTimerEvent save_timer, expire_timer;
-
-public:
-  CloudServer(AllocatedPath &&_db_path, EventLoop &event_loop,
-              SocketAddress bind_address)
-    :SkyLinesTracking::Server(event_loop, bind_address),
-     db_path(std::move(_db_path)),
-     save_timer(event_loop, BIND_THIS_METHOD(OnSaveTimer)),
-     expire_timer(event_loop, BIND_THIS_METHOD(OnExpireTimer))
-  {
-#ifndef _WIN32
-    SignalMonitorRegister(SIGINT, BIND_THIS_METHOD(OnQuitSignal));
-    SignalMonitorRegister(SIGTERM, BIND_THIS_METHOD(OnQuitSignal));
-    SignalMonitorRegister(SIGQUIT, BIND_THIS_METHOD(OnQuitSignal));
-
-    SignalMonitorRegister(SIGHUP, BIND_THIS_METHOD(OnReloadSignal));
-    SignalMonitorRegister(SIGUSR1, BIND_THIS_METHOD(OnDumpSignal));
-#endif
-
-    ScheduleSave();
-  }
-
-  void Load();
-  void Save();
-
-private:
-  void OnSaveTimer() noexcept {
-    Save();
-    ScheduleSave();
-  }
-
-  void ScheduleSave() {
-    save_timer.Schedule(std::chrono::minutes(1));
-  }
-
-  void OnExpireTimer() noexcept {
-    clients.Expire(GetEventLoop().SteadyNow() - std::chrono::minutes(10));
-    if (!clients.empty())
-      ScheduleExpire();
-  }
-
-  void ScheduleExpire() {
-    expire_timer.Schedule(std::chrono::minutes(5));
-  }
-
-protected:
-  /* virtual methods from class SkyLinesTracking::Server */
-  void OnFix(const Client &client,
-             std::chrono::milliseconds time_of_day,
-             const ::GeoPoint &location, int altitude) override;
-
-  void OnTrafficRequest(const Client &client,
-                        bool near) override;
-
-  void OnWaveSubmit(const Client &client,
-                    std::chrono::milliseconds time_of_day,
-                    const ::GeoPoint &a, const ::GeoPoint &b,
-                    int bottom_altitude,
-                    int top_altitude,
-                    double lift) override;
-
-  void OnThermalSubmit(const Client &client,
-                       std::chrono::milliseconds time_of_day,
-                       const ::GeoPoint &bottom_location,
-                       int bottom_altitude,
-                       const ::GeoPoint &top_location,
-                       int top_altitude,
-                       double lift) override;
-
-  void OnThermalRequest(const Client &client) override;
-
-  void OnSendError(SocketAddress address,
-                   std::exception_ptr e) noexcept override {
-    cerr << "Failed to send to " << address
-         << ": " << GetFullMessage(e)
-         << endl;
-  }
-
-  void OnError(std::exception_ptr e) override {
-    cerr << GetFullMessage(e) << endl;
-    GetEventLoop().Break();
-  }
-
-#ifndef _WIN32
-  void OnQuitSignal() noexcept {
-    GetEventLoop().Break();
-  }
-
-  void OnReloadSignal() noexcept {
-    Save();
-  }
-
-  void OnDumpSignal() noexcept {
-    DumpClients();
-  }
+int
+main(int argc, char **argv)
+try {
+  CloudLog::Verbosity verbosity = CloudLog::Verbosity::ALL;
+  unsigned fix_sample = 1;
+  unsigned n_threads = 1;
+  const char *stats_path = nullptr;
+
+  int i = 1;
+  for (; i < argc && argv[i][0] == '-'; ++i) {
+    const char *value;
+    char *endptr;
+    if ((value = StringAfterPrefix(argv[i], "--verbose=")) != nullptr) {
+      const unsigned level = ParseUnsigned(value, &endptr);
+      if (endptr == value || *endptr != 0 ||
+          level > unsigned(CloudLog::Verbosity::ALL))
+        break;
+      verbosity = CloudLog::Verbosity(level);
+    } else if ((value = StringAfterPrefix(argv[i], "--sample=")) != nullptr) {
+      fix_sample = ParseUnsigned(value, &endptr);
+      if (endptr == value || *endptr != 0 || fix_sample == 0)
+        break;
+    } else if ((value = StringAfterPrefix(argv[i], "--threads=")) != nullptr) {
+      n_threads = ParseUnsigned(value, &endptr);
+      if (endptr == value || *endptr != 0 || n_threads == 0 ||
+          n_threads > CloudShardRouter::MAX_SHARDS)
+        break;
+#ifdef HAVE_UN
+    } else if ((value = StringAfterPrefix(argv[i], "--stats=")) != nullptr) {
+      stats_path = value;
 #endif
-};
-
-void
-CloudServer::OnFix(const Client &c,
-                   std::chrono::milliseconds time_of_day,
-                   const ::GeoPoint &location, int altitude)
-{
-  (void)time_of_day; // TODO: use this parameter
-
-  CloudClient *client;
-  if (location.IsValid()) {
-    bool was_empty = clients.empty();
-
-    client = &clients.Make(c.address, c.key, location, altitude);
-
-    cout << "FIX\t"
-         << client->address << '\t'
-         << std::hex << client->key << std::dec << '\t'
-         << client->id << '\t'
-         << client->location << '\t'
-         << client->altitude << 'm'
-         << endl;
-
-    if (was_empty)
-      ScheduleExpire();
-  } else {
-    client = clients.Find(c.key);
-    if (client != nullptr)
-      clients.Refresh(*client, c.address);
-  }
-
-  /* send this new traffic location to all interested clients
-     immediately */
-  const auto now = std::chrono::steady_clock::now();
-  for (const auto &i : clients.QueryWithinRange(location, TRAFFIC_RANGE)) {
-    if (i->key == c.key)
-      /* ignore this client's own submissions - he knows them
-         already */
-      continue;
-
-    if (now > i->wants_traffic)
-      /* not interested (anymore) */
-      continue;
-
-    TrafficResponseSender s(*this, i->address, i->key);
-    s.Add(client->id, 0, //TODO: time?
-          client->location, client->altitude);
-    s.Flush();
-  }
-}
-
-void
-CloudServer::OnTrafficRequest(const Client &c, bool near)
-{
-  if (!near)
-    /* "near" is the only selection flag we know */
-    return;
-
-  auto *client = clients.Find(c.key);
-  if (client == nullptr)
-    /* we don't send our data to clients who didn't sent anything to
-       us yet */
-    return;
-
-  const auto now = std::chrono::steady_clock::now();
-
-  client->wants_traffic = now + REQUEST_EXPIRY;
-
-  const auto min_stamp = now - MAX_TRAFFIC_AGE;
-
-  TrafficResponseSender s(*this, c.address, c.key);
-
-  unsigned n = 0;
-  for (const auto &traffic : clients.QueryWithinRange(client->location,
-                                                      TRAFFIC_RANGE)) {
-    if (traffic.get() == client)
-      continue;
-
-    if (traffic->stamp < min_stamp)
-      /* don't send stale traffic, it's probably not there anymore */
-      continue;
-
-    s.Add(traffic->id, 0, //TODO: time?
-          traffic->location, traffic->altitude);
-
-    if (++n > 64)
+    } else
       break;
   }
 
-  s.Flush();
-}
-
-void
-CloudServer::OnWaveSubmit(const Client &c,
-                          [[maybe_unused]] std::chrono::milliseconds time_of_day,
-                          const ::GeoPoint &a, const ::GeoPoint &b,
-                          int bottom_altitude,
-                          int top_altitude,
-                          double lift)
-{
-  auto *client = clients.Find(c.key);
-  if (client == nullptr)
-    /* we don't trust the client if he didn't sent anything to us
-       yet */
-    return;
-
-  cout << "WAVE\t"
-       << client->address << '\t'
-       << std::hex << client->key << std::dec << '\t'
-       << client->id << '\t'
-       << a << '\t'
-       << b << '\t'
-       << bottom_altitude << '-' << top_altitude << "m\t"
-       << lift << "m/s"
-       << endl;
-}
-
-void
-CloudServer::OnThermalSubmit(const Client &c,
-                             [[maybe_unused]] std::chrono::milliseconds time_of_day,
-                             const ::GeoPoint &bottom_location,
-                             int bottom_altitude,
-                             const ::GeoPoint &top_location,
-                             int top_altitude,
-                             double lift)
-{
-  auto *client = clients.Find(c.key);
-  if (client == nullptr)
-    /* we don't trust the client if he didn't sent anything to us
-       yet */
-    return;
-
-  cout << "THERMAL\t"
-       << client->address << '\t'
-       << std::hex << client->key << std::dec << '\t'
-       << client->id << '\t'
-       << top_location << '\t'
-       << bottom_altitude << '-' << top_altitude << "m\t"
-       << lift << "m/s"
-       << endl;
-
-  const auto &thermal =
-    thermals.Make(c.key,
-                  AGeoPoint(bottom_location, bottom_altitude),
-                  AGeoPoint(top_location, top_altitude),
-                  lift);
-
-  /* send this new thermal to all interested clients immediately */
-  const auto now = std::chrono::steady_clock::now();
-  for (const auto &i : clients.QueryWithinRange(bottom_location,
-                                                THERMAL_RANGE)) {
-    if (i->key == c.key)
-      /* ignore this client's own submissions - he knows them
-         already */
-      continue;
-
-    if (now > i->wants_thermals)
-      /* not interested (anymore) */
-      continue;
-
-    ThermalResponseSender s(*this, i->address, i->key);
-    s.Add(thermal.Pack());
-    s.Flush();
+  if (i != argc - 1) {
+    cerr << "Usage: " << argv[0]
+         << " [--verbose=0|1|2] [--sample=N] [--threads=N]"
+#ifdef HAVE_UN
+         << " [--stats=SOCKETPATH]"
+#endif
+         << " DBPATH" << endl;
+    return EXIT_FAILURE;
   }
-}
 
-void
-CloudServer::OnThermalRequest(const Client &c)
-{
-  auto *client = clients.Find(c.key);
-  if (client == nullptr)
-    /* we don't send our data to clients who didn't sent anything to
-       us yet */
-    return;
+  const Path db_path(argv[i]);
 
-  const auto now = std::chrono::steady_clock::now();
+  CheckShardFiles(db_path, n_threads);
 
-  client->wants_thermals = now + REQUEST_EXPIRY;
+  CloudStatsBoard stats_board(n_threads);
 
-  const auto min_time = now - MAX_THERMAL_AGE;
-
-  ThermalResponseSender s(*this, c.address, c.key);
-
-  unsigned n = 0;
-  for (const auto &thermal : thermals.QueryWithinRange(client->location,
-                                                       THERMAL_RANGE)) {
-    if (thermal->client_key == c.key)
-      /* ignore this client's own submissions - he knows them
-         already */
-      continue;
+  EventLoop event_loop;
+  SignalMonitorInit(event_loop);
+  AtScopeExit() { SignalMonitorFinish(); };
 
-    if (thermal->time < min_time)
-      /* don't send old thermals, they're useless */
-      continue;
+  std::unique_ptr<StatsListener> stats_listener;
+  if (stats_path != nullptr)
+    stats_listener = std::make_unique<StatsListener>(event_loop, stats_path,
+                                                     BIND_METHOD(stats_board, &CloudStatsBoard::MakeReport));
 
-    s.Add(thermal->Pack());
+  if (n_threads > 1) {
+    /* multi-threaded mode: this thread only handles signals and the
+       stats socket */
+    CloudShardRouter router(n_threads);
+    LoadSplitCells(router, db_path);
 
-    if (++n > 256)
-      break;
-  }
+    /* this blocks the signals before the worker threads inherit the
+       signal mask */
+    CloudSupervisor supervisor(event_loop, router, db_path);
 
-  s.Flush();
-}
+    std::vector<std::unique_ptr<CloudWorker>> workers;
+    workers.reserve(n_threads);
+    for (unsigned shard = 0; shard < n_threads; ++shard)
+      workers.emplace_back(std::make_unique<CloudWorker>(router, shard,
+                                                         db_path,
+                                                         stats_board,
+                                                         verbosity,
+                                                         fix_sample))
+        ->Start();
 
-void
-CloudServer::Load()
-{
-  FileReader fr(db_path);
-  Deserialiser s(fr);
-  CloudData::Load(s);
-}
+    event_loop.Run();
 
-void
-CloudServer::Save()
-{
-  cout << "Saving data to " << db_path.c_str() << endl;
+    router.Broadcast(CloudShardMessage(CloudShardMessage::Type::QUIT));
+    for (auto &worker : workers)
+      worker->Join();
 
-  FileOutputStream fos(db_path);
+    SaveSplitCells(router, db_path);
 
-  {
-    Serialiser s(fos);
-    CloudData::Save(s);
-    s.Flush();
+    return EXIT_SUCCESS;
   }
 
-  fos.Commit();
-}
-
-int
-main(int argc, char **argv)
-try {
-  if (argc != 2) {
-    cerr << "Usage: " << argv[0] << " DBPATH" << endl;
-    return EXIT_FAILURE;
-  }
-
-  const Path db_path(argv[1]);
-
-  EventLoop event_loop;
-  SignalMonitorInit(event_loop);
-  AtScopeExit() { SignalMonitorFinish(); };
+  CloudLog log(stdout, verbosity, fix_sample);
 
   CloudServer server(db_path, event_loop,
-                     IPv4Address(CloudServer::GetDefaultPort()));
+                     IPv4Address(CloudServer::GetDefaultPort()), log,
+                     stats_board);
+
+  /* start the thread only after the CloudServer constructor has
+     blocked the signals handled by the SignalMonitor, because the
+     new thread inherits the signal mask */
+  log.Start();
 
   try {
     server.Load();
@@ -400,3 +142,4 @@ try {
   PrintException(exception);
   return EXIT_FAILURE;
 }
+
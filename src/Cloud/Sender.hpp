@@ -13,13 +13,19 @@
 struct GeoPoint;
 
 class TrafficResponseSender {
-  SkyLinesTracking::Server &server;
-  const SocketAddress address;
-
   static constexpr size_t MAX_TRAFFIC_SIZE = 1024;
+
+public:
+  /**
+   * The maximum number of traffic entries in one packet.
+   */
   static constexpr size_t MAX_TRAFFIC =
     MAX_TRAFFIC_SIZE / sizeof(SkyLinesTracking::TrafficResponsePacket::Traffic);
 
+private:
+  SkyLinesTracking::Server &server;
+  const SocketAddress address;
+
   struct Packet {
     SkyLinesTracking::TrafficResponsePacket header;
     std::array<SkyLinesTracking::TrafficResponsePacket::Traffic, MAX_TRAFFIC> traffic;
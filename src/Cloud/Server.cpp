@@ -0,0 +1,794 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Server.hpp"
+#include "Dump.hpp"
+#include "Log.hpp"
+#include "Sender.hpp"
+#include "Serialiser.hpp"
+#include "Stats.hpp"
+#include "Tracking/SkyLines/Protocol.hpp"
+#include "Tracking/SkyLines/Import.hpp"
+#include "util/ByteOrder.hxx"
+#include "event/SignalMonitor.hxx"
+#include "io/FileOutputStream.hxx"
+#include "io/FileReader.hxx"
+#include "io/StringOutputStream.hxx"
+#include "util/Exception.hxx"
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+
+#include <signal.h>
+
+// TODO: review these settings
+static constexpr double TRAFFIC_RANGE = 50000;
+static constexpr double THERMAL_RANGE = 50000;
+
+static constexpr std::chrono::steady_clock::duration MAX_TRAFFIC_AGE = std::chrono::minutes(15);
+static constexpr std::chrono::steady_clock::duration MAX_THERMAL_AGE = std::chrono::minutes(30);
+
+static constexpr std::chrono::steady_clock::duration REQUEST_EXPIRY = std::chrono::minutes(5);
+
+/**
+ * Traffic updates are collected and sent to subscribers in this
+ * interval.
+ */
+static constexpr std::chrono::steady_clock::duration TRAFFIC_INTERVAL = std::chrono::seconds(1);
+
+/**
+ * The counters reported by the stats socket are updated in this
+ * interval.
+ */
+static constexpr std::chrono::steady_clock::duration STATS_PUBLISH_INTERVAL = std::chrono::seconds(1);
+
+/**
+ * The rates reported by the stats socket are averaged over this
+ * interval.
+ */
+static constexpr std::chrono::steady_clock::duration STATS_INTERVAL = std::chrono::seconds(10);
+
+/**
+ * A region cell is split (see CloudShardRouter::Split()) when one
+ * shard owns more than this number of clients in it.
+ */
+static constexpr unsigned SPLIT_CELL_CLIENTS = 500;
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+CloudServer::CloudServer(AllocatedPath &&_db_path, EventLoop &event_loop,
+                         SocketAddress bind_address, CloudLog &_log,
+                         CloudStatsBoard &_stats_board,
+                         CloudShardRouter *_router, unsigned _shard)
+  :SkyLinesTracking::Server(event_loop, bind_address, _router != nullptr),
+   snapshot_writer(event_loop, std::move(_db_path),
+                   BIND_THIS_METHOD(OnSnapshotError)),
+   log(_log), stats_board(_stats_board),
+   router(_router), shard(_shard),
+   inbox_event(event_loop, BIND_THIS_METHOD(OnInboxEvent)),
+   outbox_event(event_loop, BIND_THIS_METHOD(FlushOutbox)),
+   save_timer(event_loop, BIND_THIS_METHOD(OnSaveTimer)),
+   expire_timer(event_loop, BIND_THIS_METHOD(OnExpireTimer)),
+   stats_timer(event_loop, BIND_THIS_METHOD(OnStatsTimer)),
+   traffic_timer(event_loop, BIND_THIS_METHOD(OnTrafficTimer))
+{
+  if (router != nullptr) {
+    /* each shard assigns its own subset of the public ids */
+    clients.SetIdSequence(shard + 1, router->size());
+    outbox.resize(router->size());
+    router->GetInbox(shard).Attach(inbox_event);
+  } else {
+#ifndef _WIN32
+    SignalMonitorRegister(SIGINT, BIND_THIS_METHOD(OnQuitSignal));
+    SignalMonitorRegister(SIGTERM, BIND_THIS_METHOD(OnQuitSignal));
+    SignalMonitorRegister(SIGQUIT, BIND_THIS_METHOD(OnQuitSignal));
+
+    SignalMonitorRegister(SIGHUP, BIND_THIS_METHOD(OnReloadSignal));
+    SignalMonitorRegister(SIGUSR1, BIND_THIS_METHOD(OnDumpSignal));
+#endif
+  }
+
+  ScheduleSave();
+
+  stats_previous = stats_current = SampleStats();
+  stats_timer.Schedule(STATS_PUBLISH_INTERVAL);
+}
+
+CloudServer::~CloudServer() noexcept
+{
+  if (router != nullptr)
+    router->GetInbox(shard).Detach();
+}
+
+void
+CloudServer::OnSnapshotError(std::exception_ptr e) noexcept
+{
+  cerr << "Failed to save data: " << GetFullMessage(e) << endl;
+}
+
+void
+CloudServer::OnExpireTimer() noexcept
+{
+  const auto before = GetEventLoop().SteadyNow() - std::chrono::minutes(10);
+  if (router != nullptr)
+    clients.Expire(before, [this](const CloudClient &client){
+      if (!client.ghost)
+        router->Release(client.key, shard);
+    });
+  else
+    clients.Expire(before);
+
+  if (!clients.empty())
+    ScheduleExpire();
+}
+
+void
+CloudServer::MarkTrafficDirty(CloudClient &client) noexcept
+{
+  clients.MarkDirty(client);
+  if (!traffic_timer.IsPending())
+    traffic_timer.Schedule(TRAFFIC_INTERVAL);
+}
+
+void
+CloudServer::OnSendError(SocketAddress address,
+                         std::exception_ptr e) noexcept
+{
+  cerr << "Failed to send to " << address
+       << ": " << GetFullMessage(e)
+       << endl;
+}
+
+void
+CloudServer::OnError(std::exception_ptr e)
+{
+  cerr << GetFullMessage(e) << endl;
+  GetEventLoop().Break();
+}
+
+void
+CloudServer::OnFix(const Client &c,
+                   std::chrono::milliseconds time_of_day,
+                   const ::GeoPoint &location, int altitude)
+{
+  (void)time_of_day; // TODO: use this parameter
+
+  ++n_fixes;
+
+  CloudClient *client;
+  if (location.IsValid()) {
+    bool was_empty = clients.empty();
+
+    if (router != nullptr)
+      ClaimClient(c.key);
+
+    client = &clients.Make(c.address, c.key, location, altitude);
+    client->ghost = false;
+
+    if (log.WantFix()) {
+      CloudLogRecord record;
+      record.type = CloudLogRecord::Type::FIX;
+      record.address = c.address;
+      record.key = client->key;
+      record.id = client->id;
+      record.location = client->location;
+      record.altitude = client->altitude;
+      log.Push(record);
+    }
+
+    if (was_empty)
+      ScheduleExpire();
+  } else {
+    client = FindOwned(c.key);
+    if (client != nullptr)
+      clients.Refresh(*client, c.address);
+  }
+
+  /* send this new traffic location to all interested clients with
+     the next traffic tick */
+  if (location.IsValid())
+    MarkTrafficDirty(*client);
+}
+
+void
+CloudServer::OnTrafficTimer() noexcept
+{
+  const auto now = std::chrono::steady_clock::now();
+
+  /* join the dirty clients with their interested neighbours */
+  assert(traffic_updates.empty());
+  clients.ConsumeDirty([this, now](const CloudClient &traffic){
+    if (router != nullptr && !traffic.ghost)
+      ExportGhost(traffic);
+
+    for (const auto &i : clients.QueryWithinRange(traffic.location,
+                                                  TRAFFIC_RANGE)) {
+      if (i.get() == &traffic)
+        /* ignore this client's own submissions - he knows them
+           already */
+        continue;
+
+      if (now > i->wants_traffic)
+        /* not interested (anymore) */
+        continue;
+
+      traffic_updates.push_back({i.get(), &traffic,
+                                 i->location.DistanceS(traffic.location)});
+    }
+  });
+
+  /* group by subscriber, nearest traffic first */
+  std::sort(traffic_updates.begin(), traffic_updates.end(),
+            [](const TrafficUpdate &a, const TrafficUpdate &b){
+              return a.subscriber != b.subscriber
+                ? a.subscriber->id < b.subscriber->id
+                : a.distance < b.distance;
+            });
+
+  /* send one packet to each subscriber; if there are too many
+     updates, only the nearest ones are sent */
+  for (auto i = traffic_updates.begin(); i != traffic_updates.end();) {
+    const CloudClient &subscriber = *i->subscriber;
+
+    TrafficResponseSender s(*this, subscriber.address, subscriber.key);
+    unsigned n = 0;
+    for (; i != traffic_updates.end() && i->subscriber == &subscriber; ++i) {
+      if (n++ < TrafficResponseSender::MAX_TRAFFIC)
+        s.Add(i->traffic->id, 0, //TODO: time?
+              i->traffic->location, i->traffic->altitude);
+    }
+
+    s.Flush();
+  }
+
+  traffic_updates.clear();
+
+  if (router != nullptr)
+    FlushOutbox();
+}
+
+void
+CloudServer::OnTrafficRequest(const Client &c, bool near)
+{
+  if (!near)
+    /* "near" is the only selection flag we know */
+    return;
+
+  auto *client = FindOwned(c.key);
+  if (client == nullptr)
+    /* we don't send our data to clients who didn't sent anything to
+       us yet */
+    return;
+
+  const auto now = std::chrono::steady_clock::now();
+
+  client->wants_traffic = now + REQUEST_EXPIRY;
+
+  const auto min_stamp = now - MAX_TRAFFIC_AGE;
+
+  TrafficResponseSender s(*this, c.address, c.key);
+
+  unsigned n = 0;
+  for (const auto &traffic : clients.QueryWithinRange(client->location,
+                                                      TRAFFIC_RANGE)) {
+    if (traffic.get() == client)
+      continue;
+
+    if (traffic->stamp < min_stamp)
+      /* don't send stale traffic, it's probably not there anymore */
+      continue;
+
+    s.Add(traffic->id, 0, //TODO: time?
+          traffic->location, traffic->altitude);
+
+    if (++n > 64)
+      break;
+  }
+
+  s.Flush();
+}
+
+void
+CloudServer::OnWaveSubmit(const Client &c,
+                          [[maybe_unused]] std::chrono::milliseconds time_of_day,
+                          const ::GeoPoint &a, const ::GeoPoint &b,
+                          int bottom_altitude,
+                          int top_altitude,
+                          double lift)
+{
+  auto *client = FindOwned(c.key);
+  if (client == nullptr)
+    /* we don't trust the client if he didn't sent anything to us
+       yet */
+    return;
+
+  if (log.WantEvents()) {
+    CloudLogRecord record;
+    record.type = CloudLogRecord::Type::WAVE;
+    record.address = c.address;
+    record.key = client->key;
+    record.id = client->id;
+    record.location = a;
+    record.location2 = b;
+    record.altitude = bottom_altitude;
+    record.top_altitude = top_altitude;
+    record.lift = lift;
+    log.Push(record);
+  }
+}
+
+void
+CloudServer::OnThermalSubmit(const Client &c,
+                             [[maybe_unused]] std::chrono::milliseconds time_of_day,
+                             const ::GeoPoint &bottom_location,
+                             int bottom_altitude,
+                             const ::GeoPoint &top_location,
+                             int top_altitude,
+                             double lift)
+{
+  auto *client = FindOwned(c.key);
+  if (client == nullptr)
+    /* we don't trust the client if he didn't sent anything to us
+       yet */
+    return;
+
+  if (log.WantEvents()) {
+    CloudLogRecord record;
+    record.type = CloudLogRecord::Type::THERMAL;
+    record.address = c.address;
+    record.key = client->key;
+    record.id = client->id;
+    record.location = top_location;
+    record.altitude = bottom_altitude;
+    record.top_altitude = top_altitude;
+    record.lift = lift;
+    log.Push(record);
+  }
+
+  const auto &thermal =
+    thermals.Make(c.key,
+                  AGeoPoint(bottom_location, bottom_altitude),
+                  AGeoPoint(top_location, top_altitude),
+                  lift);
+
+  PublishThermal(thermal);
+
+  if (router != nullptr)
+    /* copy it to the neighbouring shards, which will publish it to
+       their clients */
+    ExportThermal(thermal, CloudShardMessage::Type::GHOST_THERMAL);
+}
+
+void
+CloudServer::PublishThermal(const CloudThermal &thermal) noexcept
+{
+  /* send this new thermal to all interested clients immediately */
+  const auto now = std::chrono::steady_clock::now();
+  for (const auto &i : clients.QueryWithinRange(thermal.bottom_location,
+                                                THERMAL_RANGE)) {
+    if (i->key == thermal.client_key)
+      /* ignore this client's own submissions - he knows them
+         already */
+      continue;
+
+    if (now > i->wants_thermals)
+      /* not interested (anymore) */
+      continue;
+
+    ThermalResponseSender s(*this, i->address, i->key);
+    s.Add(thermal.Pack());
+    s.Flush();
+  }
+}
+
+void
+CloudServer::OnThermalRequest(const Client &c)
+{
+  auto *client = FindOwned(c.key);
+  if (client == nullptr)
+    /* we don't send our data to clients who didn't sent anything to
+       us yet */
+    return;
+
+  const auto now = std::chrono::steady_clock::now();
+
+  client->wants_thermals = now + REQUEST_EXPIRY;
+
+  const auto min_time = now - MAX_THERMAL_AGE;
+
+  ThermalResponseSender s(*this, c.address, c.key);
+
+  unsigned n = 0;
+  for (const auto &thermal : thermals.QueryWithinRange(client->location,
+                                                       THERMAL_RANGE)) {
+    if (thermal->client_key == c.key)
+      /* ignore this client's own submissions - he knows them
+         already */
+      continue;
+
+    if (thermal->time < min_time)
+      /* don't send old thermals, they're useless */
+      continue;
+
+    s.Add(thermal->Pack());
+
+    if (++n > 256)
+      break;
+  }
+
+  s.Flush();
+}
+
+void
+CloudServer::OnStatsTimer() noexcept
+{
+  const auto now = GetEventLoop().SteadyNow();
+  if (now - stats_current.time >= STATS_INTERVAL) {
+    stats_previous = stats_current;
+    stats_current = SampleStats();
+
+    if (router != nullptr)
+      SplitDenseCells();
+  }
+
+  const auto &a = stats_previous, &b = stats_current;
+  const double seconds =
+    std::max(std::chrono::duration<double>(b.time - a.time).count(), 1.);
+
+  CloudStats stats;
+  stats.clients = std::count_if(clients.begin(), clients.end(),
+                                [](const CloudClient &client){
+                                  return !client.ghost;
+                                });
+  stats.thermals = std::count_if(thermals.begin(), thermals.end(),
+                                 [](const CloudThermal &thermal){
+                                   return !thermal.ghost;
+                                 });
+  stats.fixes = n_fixes;
+  stats.fixes_rate = (b.fixes - a.fixes) / seconds;
+  stats.received = GetReceivedCount();
+  stats.received_rate = (b.received - a.received) / seconds;
+  stats.sent = GetSentCount();
+  stats.sent_rate = (b.sent - a.sent) / seconds;
+  stats.log_dropped = log.GetDroppedCount();
+  stats_board.Publish(shard, stats);
+
+  stats_timer.Schedule(STATS_PUBLISH_INTERVAL);
+}
+
+bool
+CloudServer::RouteDatagram(SocketAddress address,
+                           std::span<const std::byte> buffer) noexcept
+{
+  if (router == nullptr ||
+      buffer.size() > CloudShardMessage::MAX_DATAGRAM_SIZE)
+    return false;
+
+  const unsigned target = GetDatagramShard(buffer);
+  if (target == shard || target == CloudShardRouter::NO_SHARD)
+    return false;
+
+  /* the datagrams of one receive batch are sent together by
+     FlushOutbox() */
+  auto &m = outbox[target].emplace_back(CloudShardMessage::Type::DATAGRAM);
+  m.address = address;
+  m.size = buffer.size();
+  std::copy(buffer.begin(), buffer.end(), m.data.begin());
+
+  if (!outbox_event.IsPending())
+    outbox_event.Schedule();
+
+  return true;
+}
+
+unsigned
+CloudServer::GetDatagramShard(std::span<const std::byte> buffer) const noexcept
+{
+  using namespace SkyLinesTracking;
+
+  if (buffer.size() < sizeof(Header))
+    return CloudShardRouter::NO_SHARD;
+
+  const auto &header = *(const Header *)buffer.data();
+
+  /* fixes are handled by the shard owning the region; everything
+     else by the shard owning the client */
+  const auto &fix = *(const FixPacket *)buffer.data();
+  if (FromBE16(header.type) == FIX && buffer.size() >= sizeof(fix) &&
+      (FromBE32(fix.flags) & FixPacket::FLAG_LOCATION) != 0) {
+    const auto location = ImportGeoPoint(fix.location);
+    if (location.IsValid())
+      return router->GetRegionShard(location);
+  }
+
+  return router->LookupOwner(FromBE64(header.key));
+}
+
+void
+CloudServer::ClaimClient(uint64_t key) noexcept
+{
+  const auto *client = clients.Find(key);
+  if (client != nullptr && !client->ghost)
+    /* we own it already */
+    return;
+
+  const unsigned previous = router->Claim(key, shard);
+  if (previous != CloudShardRouter::NO_SHARD && previous != shard) {
+    CloudShardMessage m(CloudShardMessage::Type::RELEASE);
+    m.sender = shard;
+    m.key = key;
+    router->Send(previous, std::move(m));
+  }
+}
+
+void
+CloudServer::ExportGhost(const CloudClient &client) noexcept
+{
+  router->ForEachRegionShard(client.location, TRAFFIC_RANGE,
+                             [&](unsigned other){
+    if (other == shard)
+      return;
+
+    auto &m = outbox[other].emplace_back(CloudShardMessage::Type::GHOST_CLIENT);
+    m.key = client.key;
+    m.id = client.id;
+    m.location = client.location;
+    m.altitude = client.altitude;
+  });
+}
+
+void
+CloudServer::ExportThermal(const CloudThermal &thermal,
+                           CloudShardMessage::Type type) noexcept
+{
+  router->ForEachRegionShard(thermal.bottom_location, THERMAL_RANGE,
+                             [&](unsigned other){
+    if (other == shard)
+      return;
+
+    CloudShardMessage m(type);
+    m.key = thermal.client_key;
+    m.location = thermal.bottom_location;
+    m.altitude = thermal.bottom_location.altitude;
+    m.location2 = thermal.top_location;
+    m.top_altitude = thermal.top_location.altitude;
+    m.lift = thermal.lift;
+    router->Send(other, std::move(m));
+  });
+}
+
+void
+CloudServer::FlushOutbox() noexcept
+{
+  outbox_event.Cancel();
+
+  for (unsigned i = 0; i < outbox.size(); ++i)
+    if (!outbox[i].empty())
+      router->Send(i, std::move(outbox[i]));
+}
+
+void
+CloudServer::SplitDenseCells() noexcept
+{
+  std::vector<unsigned> n_clients(CloudShardRouter::N_CELLS);
+  for (const auto &client : clients)
+    if (!client.ghost)
+      ++n_clients[CloudShardRouter::GetCell(client.location)];
+
+  for (unsigned cell = 0; cell < n_clients.size(); ++cell) {
+    if (n_clients[cell] <= SPLIT_CELL_CLIENTS || !router->Split(cell))
+      continue;
+
+    cout << "Splitting region cell " << cell << " with "
+         << n_clients[cell] << " clients" << endl;
+
+    /* the clients follow with their next fix */
+    MoveThermals(cell);
+  }
+}
+
+void
+CloudServer::MoveThermals(unsigned cell) noexcept
+{
+  for (auto &thermal : thermals) {
+    if (thermal.ghost ||
+        CloudShardRouter::GetCell(thermal.bottom_location) != cell ||
+        router->GetRegionShard(thermal.bottom_location) == shard)
+      continue;
+
+    /* the new owner saves it from now on */
+    thermal.ghost = true;
+    ExportThermal(thermal, CloudShardMessage::Type::THERMAL);
+  }
+}
+
+void
+CloudServer::OnInboxEvent() noexcept
+{
+  router->GetInbox(shard).Consume(inbox_messages);
+
+  for (auto &message : inbox_messages) {
+    try {
+      OnShardMessage(message);
+    } catch (...) {
+      cerr << GetFullMessage(std::current_exception()) << endl;
+    }
+  }
+
+  inbox_messages.clear();
+}
+
+void
+CloudServer::OnShardMessage(CloudShardMessage &message)
+{
+  switch (message.type) {
+  case CloudShardMessage::Type::DATAGRAM:
+    InjectDatagram(message.address, message.GetDatagram());
+    break;
+
+  case CloudShardMessage::Type::GHOST_CLIENT:
+    OnGhostClient(message);
+    break;
+
+  case CloudShardMessage::Type::GHOST_THERMAL:
+    OnGhostThermal(message);
+    break;
+
+  case CloudShardMessage::Type::THERMAL:
+    OnMovedThermal(message);
+    break;
+
+  case CloudShardMessage::Type::RELEASE:
+    OnRelease(message);
+    break;
+
+  case CloudShardMessage::Type::HANDOVER:
+    if (auto *client = FindOwned(message.key)) {
+      client->wants_traffic = std::max(client->wants_traffic,
+                                       message.wants_traffic);
+      client->wants_thermals = std::max(client->wants_thermals,
+                                        message.wants_thermals);
+    }
+    break;
+
+  case CloudShardMessage::Type::QUIT:
+    GetEventLoop().Break();
+    break;
+
+  case CloudShardMessage::Type::SAVE:
+    SaveAsync();
+    break;
+
+  case CloudShardMessage::Type::DUMP:
+    DumpClients();
+    break;
+  }
+}
+
+void
+CloudServer::OnGhostClient(const CloudShardMessage &message)
+{
+  bool was_empty = clients.empty();
+
+  auto &client = clients.MakeGhost(message.key, message.id,
+                                   message.location, message.altitude);
+  if (!client.ghost)
+    /* we own this client meanwhile */
+    return;
+
+  if (was_empty)
+    ScheduleExpire();
+
+  /* send it to our subscribers with the next traffic tick */
+  MarkTrafficDirty(client);
+}
+
+void
+CloudServer::OnGhostThermal(const CloudShardMessage &message)
+{
+  auto &thermal =
+    thermals.Make(message.key,
+                  AGeoPoint(message.location, message.altitude),
+                  AGeoPoint(message.location2, message.top_altitude),
+                  message.lift);
+  thermal.ghost = true;
+
+  PublishThermal(thermal);
+}
+
+void
+CloudServer::OnMovedThermal(const CloudShardMessage &message)
+{
+  const bool ghost = router->GetRegionShard(message.location) != shard;
+
+  /* this shard may have a ghost of it already */
+  for (const auto &i : thermals.QueryWithinRange(message.location2, 1)) {
+    if (i->client_key == message.key &&
+        i->bottom_location == message.location) {
+      i->ghost = i->ghost && ghost;
+      return;
+    }
+  }
+
+  auto &thermal =
+    thermals.Make(message.key,
+                  AGeoPoint(message.location, message.altitude),
+                  AGeoPoint(message.location2, message.top_altitude),
+                  message.lift);
+  thermal.ghost = ghost;
+}
+
+void
+CloudServer::OnRelease(const CloudShardMessage &message)
+{
+  auto *client = FindOwned(message.key);
+  if (client == nullptr)
+    return;
+
+  /* the new owner inherits the subscriptions */
+  CloudShardMessage m(CloudShardMessage::Type::HANDOVER);
+  m.key = client->key;
+  m.wants_traffic = client->wants_traffic;
+  m.wants_thermals = client->wants_thermals;
+  router->Send(message.sender, std::move(m));
+
+  clients.Remove(*client);
+}
+
+void
+CloudServer::Load()
+{
+  FileReader fr(snapshot_writer.GetPath());
+  Deserialiser s(fr);
+  CloudData::Load(s);
+
+  if (router != nullptr)
+    for (const auto &client : clients)
+      router->Claim(client.key, shard);
+}
+
+std::string
+CloudServer::MakeSnapshot()
+{
+  StringOutputStream sos;
+
+  {
+    Serialiser s(sos);
+    CloudData::Save(s);
+    s.Flush();
+  }
+
+  return std::move(sos).GetValue();
+}
+
+void
+CloudServer::SaveAsync() noexcept
+try {
+  cout << "Saving data to " << snapshot_writer.GetPath().c_str() << endl;
+
+  snapshot_writer.Submit(MakeSnapshot());
+} catch (...) {
+  OnSnapshotError(std::current_exception());
+}
+
+void
+CloudServer::Save()
+{
+  snapshot_writer.WaitDone();
+
+  const Path db_path = snapshot_writer.GetPath();
+  cout << "Saving data to " << db_path.c_str() << endl;
+
+  FileOutputStream fos(db_path);
+
+  {
+    Serialiser s(fos);
+    CloudData::Save(s);
+    s.Flush();
+  }
+
+  fos.Commit();
+}
@@ -0,0 +1,297 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Data.hpp"
+#include "Shard.hpp"
+#include "SnapshotWriter.hpp"
+#include "Tracking/SkyLines/Server.hpp"
+#include "event/CoarseTimerEvent.hxx"
+#include "event/DeferEvent.hxx"
+#include "event/FineTimerEvent.hxx"
+#include "event/InjectEvent.hxx"
+#include "event/Loop.hxx"
+
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <span>
+#include <string>
+#include <vector>
+
+class CloudLog;
+class CloudStatsBoard;
+
+/**
+ * The cloud server, or one shard of it (see #CloudShardRouter).
+ */
+class CloudServer final
+  : public SkyLinesTracking::Server, CloudData
+{
+  SnapshotWriter snapshot_writer;
+
+  CloudLog &log;
+
+  CloudStatsBoard &stats_board;
+
+  /**
+   * The router of a multi-threaded server; nullptr if this is the
+   * only shard.
+   */
+  CloudShardRouter *const router;
+
+  /**
+   * The number of this shard.
+   */
+  const unsigned shard;
+
+  /**
+   * Delivers the messages from the #CloudShardInbox.
+   */
+  InjectEvent inbox_event;
+
+  /**
+   * The messages being handled by OnInboxEvent().  This is a member
+   * only to reuse its allocation.
+   */
+  std::vector<CloudShardMessage> inbox_messages;
+
+  /**
+   * Messages for each other shard: ghost updates collected by
+   * OnTrafficTimer() and datagrams forwarded by RouteDatagram().
+   * They are sent in one batch per shard, to take each inbox lock
+   * only once.
+   */
+  std::vector<std::vector<CloudShardMessage>> outbox;
+
+  /**
+   * Sends the datagrams forwarded by RouteDatagram() after the
+   * current receive batch.
+   */
+  DeferEvent outbox_event;
+
+  CoarseTimerEvent save_timer, expire_timer, stats_timer;
+
+  /**
+   * A #FineTimerEvent because the traffic latency is bounded by
+   * #TRAFFIC_INTERVAL only if this timer is accurate.
+   */
+  FineTimerEvent traffic_timer;
+
+  /**
+   * The total number of fixes received.
+   */
+  uint64_t n_fixes = 0;
+
+  /**
+   * A snapshot of the counters, for calculating rates.
+   */
+  struct StatsSample {
+    std::chrono::steady_clock::time_point time;
+    uint64_t fixes, received, sent;
+  };
+
+  /**
+   * The two most recent samples; the rates are calculated from their
+   * difference.
+   */
+  StatsSample stats_previous, stats_current;
+
+  /**
+   * A traffic update: the subscriber and the client whose new
+   * location shall be sent to it.  This is a member only to reuse
+   * its allocation.
+   */
+  struct TrafficUpdate {
+    const CloudClient *subscriber, *traffic;
+    double distance;
+  };
+
+  std::vector<TrafficUpdate> traffic_updates;
+
+public:
+  /**
+   * @param _router the router of a multi-threaded server, or nullptr
+   * if this is the only shard; a shard does not handle signals (that
+   * is the main thread's job)
+   */
+  CloudServer(AllocatedPath &&_db_path, EventLoop &event_loop,
+              SocketAddress bind_address, CloudLog &_log,
+              CloudStatsBoard &_stats_board,
+              CloudShardRouter *_router=nullptr, unsigned _shard=0);
+
+  ~CloudServer() noexcept;
+
+  void Load();
+
+  /**
+   * Save the data synchronously, after all pending snapshots have
+   * been written.
+   */
+  void Save();
+
+private:
+  StatsSample SampleStats() const noexcept {
+    return {
+      GetEventLoop().SteadyNow(),
+      n_fixes, GetReceivedCount(), GetSentCount(),
+    };
+  }
+
+  void OnStatsTimer() noexcept;
+
+  /**
+   * Serialise the data into a memory buffer.
+   */
+  std::string MakeSnapshot();
+
+  /**
+   * Save the data in the #SnapshotWriter thread.  Only the
+   * serialisation into memory blocks the event loop.
+   */
+  void SaveAsync() noexcept;
+
+  void OnSnapshotError(std::exception_ptr e) noexcept;
+
+  void OnSaveTimer() noexcept {
+    SaveAsync();
+    ScheduleSave();
+  }
+
+  void ScheduleSave() {
+    save_timer.Schedule(std::chrono::minutes(1));
+  }
+
+  void OnExpireTimer() noexcept;
+
+  void ScheduleExpire() {
+    expire_timer.Schedule(std::chrono::minutes(5));
+  }
+
+  void OnTrafficTimer() noexcept;
+
+  /**
+   * Look up a client owned by this shard, i.e. ignore ghosts.
+   */
+  [[gnu::pure]]
+  CloudClient *FindOwned(uint64_t key) noexcept {
+    auto *client = clients.Find(key);
+    return client != nullptr && !client->ghost
+      ? client
+      : nullptr;
+  }
+
+  /**
+   * Send a new thermal to all interested clients of this shard.
+   */
+  void PublishThermal(const CloudThermal &thermal) noexcept;
+
+  /* multi-threaded mode (#router is set) */
+
+  /**
+   * Which shard shall handle this (unparsed) datagram?
+   *
+   * @return the shard or CloudShardRouter::NO_SHARD
+   */
+  [[gnu::pure]]
+  unsigned GetDatagramShard(std::span<const std::byte> buffer) const noexcept;
+
+  /**
+   * Make this shard the owner of the client (which is about to be
+   * created or converted from a ghost), and tell the previous owner
+   * to release it.
+   */
+  void ClaimClient(uint64_t key) noexcept;
+
+  /**
+   * Copy a (dirty) client owned by this shard to all other shards
+   * whose region is within #TRAFFIC_RANGE.
+   */
+  void ExportGhost(const CloudClient &client) noexcept;
+
+  /**
+   * Copy a thermal to all other shards whose region is within
+   * #THERMAL_RANGE.
+   */
+  void ExportThermal(const CloudThermal &thermal,
+                     CloudShardMessage::Type type) noexcept;
+
+  /**
+   * Send the messages collected in #outbox.
+   */
+  void FlushOutbox() noexcept;
+
+  /**
+   * Split the cells in which this shard owns too many clients (see
+   * CloudShardRouter::Split()).
+   */
+  void SplitDenseCells() noexcept;
+
+  /**
+   * Hand over this shard's thermals in a cell which has just been
+   * split to their new owners.
+   */
+  void MoveThermals(unsigned cell) noexcept;
+
+  void OnInboxEvent() noexcept;
+  void OnShardMessage(CloudShardMessage &message);
+  void OnGhostClient(const CloudShardMessage &message);
+  void OnGhostThermal(const CloudShardMessage &message);
+  void OnMovedThermal(const CloudShardMessage &message);
+  void OnRelease(const CloudShardMessage &message);
+
+  /**
+   * Mark the client's location as changed; it will be sent to all
+   * interested clients by the next OnTrafficTimer() call.
+   */
+  void MarkTrafficDirty(CloudClient &client) noexcept;
+
+protected:
+  /* virtual methods from class SkyLinesTracking::Server */
+  bool RouteDatagram(SocketAddress address,
+                     std::span<const std::byte> buffer) noexcept override;
+
+  void OnFix(const Client &client,
+             std::chrono::milliseconds time_of_day,
+             const ::GeoPoint &location, int altitude) override;
+
+  void OnTrafficRequest(const Client &client,
+                        bool near) override;
+
+  void OnWaveSubmit(const Client &client,
+                    std::chrono::milliseconds time_of_day,
+                    const ::GeoPoint &a, const ::GeoPoint &b,
+                    int bottom_altitude,
+                    int top_altitude,
+                    double lift) override;
+
+  void OnThermalSubmit(const Client &client,
+                       std::chrono::milliseconds time_of_day,
+                       const ::GeoPoint &bottom_location,
+                       int bottom_altitude,
+                       const ::GeoPoint &top_location,
+                       int top_altitude,
+                       double lift) override;
+
+  void OnThermalRequest(const Client &client) override;
+
+  void OnSendError(SocketAddress address,
+                   std::exception_ptr e) noexcept override;
+
+  void OnError(std::exception_ptr e) override;
+
+#ifndef _WIN32
+  void OnQuitSignal() noexcept {
+    GetEventLoop().Break();
+  }
+
+  void OnReloadSignal() noexcept {
+    SaveAsync();
+  }
+
+  void OnDumpSignal() noexcept {
+    DumpClients();
+  }
+#endif
+};
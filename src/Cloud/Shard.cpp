@@ -0,0 +1,215 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Shard.hpp"
+#include "Geo/Boost/RangeBox.hpp"
+#include "event/InjectEvent.hxx"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iterator>
+#include <utility>
+
+void
+CloudShardInbox::Attach(InjectEvent &_event) noexcept
+{
+  const std::scoped_lock lock{mutex};
+  assert(event == nullptr);
+  event = &_event;
+
+  if (!queue.empty())
+    event->Schedule();
+}
+
+void
+CloudShardInbox::Detach() noexcept
+{
+  const std::scoped_lock lock{mutex};
+  event = nullptr;
+}
+
+void
+CloudShardInbox::Push(CloudShardMessage &&message) noexcept
+{
+  const std::scoped_lock lock{mutex};
+  queue.push_back(std::move(message));
+
+  /* the event is scheduled while holding the mutex, so Detach()
+     cannot destroy it meanwhile */
+  if (event != nullptr)
+    event->Schedule();
+}
+
+void
+CloudShardInbox::Push(std::vector<CloudShardMessage> &&messages) noexcept
+{
+  const std::scoped_lock lock{mutex};
+  if (queue.empty())
+    queue.swap(messages);
+  else {
+    std::move(messages.begin(), messages.end(), std::back_inserter(queue));
+    messages.clear();
+  }
+
+  if (event != nullptr)
+    event->Schedule();
+}
+
+void
+CloudShardInbox::Consume(std::vector<CloudShardMessage> &dest) noexcept
+{
+  assert(dest.empty());
+
+  const std::scoped_lock lock{mutex};
+  dest.swap(queue);
+}
+
+CloudShardRouter::CloudShardRouter(unsigned _n_shards) noexcept
+  :n_shards(_n_shards),
+   inboxes(std::make_unique<CloudShardInbox[]>(_n_shards))
+{
+  assert(n_shards > 0);
+  assert(n_shards <= MAX_SHARDS);
+}
+
+CloudShardRouter::~CloudShardRouter() noexcept = default;
+
+[[gnu::const]]
+static unsigned
+RowOf(double latitude, double cell_size, unsigned n_rows) noexcept
+{
+  const int row = (int)std::floor((latitude + 90) / cell_size);
+  return std::clamp(row, 0, int(n_rows) - 1);
+}
+
+[[gnu::const]]
+static unsigned
+ColumnOf(double longitude, double cell_size, unsigned n_columns) noexcept
+{
+  const int column = (int)std::floor((longitude + 180) / cell_size);
+  return unsigned(column % int(n_columns) + int(n_columns)) % n_columns;
+}
+
+unsigned
+CloudShardRouter::GetCellShard(unsigned cell) const noexcept
+{
+  /* a multiplicative hash spreads the cells of a dense region over
+     the shards; since a cell is much larger than a query box, this
+     does not scatter the queries */
+  return ((cell * 2654435761u) >> 16) % n_shards;
+}
+
+unsigned
+CloudShardRouter::GetSubCellShard(unsigned row, unsigned column) const noexcept
+{
+  const unsigned cell = (row / SPLIT) * N_COLUMNS + column / SPLIT;
+  const unsigned shard = GetCellShard(cell);
+  if (!IsSplit(cell))
+    return shard;
+
+  /* deal the sub-cells out to the shards, starting with the one
+     which owned the whole cell; with this numbering, each 2x2 block
+     of sub-cells gets 4 consecutive numbers, i.e. different shards */
+  const unsigned sub_cell = (row % SPLIT) * 2 + column % SPLIT;
+  return (shard + sub_cell) % n_shards;
+}
+
+unsigned
+CloudShardRouter::GetCell(GeoPoint location) noexcept
+{
+  return RowOf(location.latitude.Degrees(), CELL_SIZE, N_ROWS) * N_COLUMNS +
+    ColumnOf(location.longitude.Degrees(), CELL_SIZE, N_COLUMNS);
+}
+
+std::vector<unsigned>
+CloudShardRouter::GetSplitCells() const noexcept
+{
+  std::vector<unsigned> result;
+  for (unsigned cell = 0; cell < N_CELLS; ++cell)
+    if (IsSplit(cell))
+      result.push_back(cell);
+  return result;
+}
+
+unsigned
+CloudShardRouter::GetRegionShard(GeoPoint location) const noexcept
+{
+  return GetSubCellShard(RowOf(location.latitude.Degrees(),
+                               SUB_CELL_SIZE, N_SUB_ROWS),
+                         ColumnOf(location.longitude.Degrees(),
+                                  SUB_CELL_SIZE, N_SUB_COLUMNS));
+}
+
+uint64_t
+CloudShardRouter::GetRegionShards(GeoPoint location,
+                                  double range) const noexcept
+{
+  const auto box = BoostRangeBox(location, range);
+  const auto &sw = box.min_corner(), &ne = box.max_corner();
+
+  const unsigned row_begin = RowOf(sw.latitude.Degrees(),
+                                   SUB_CELL_SIZE, N_SUB_ROWS);
+  const unsigned row_end = RowOf(ne.latitude.Degrees(),
+                                 SUB_CELL_SIZE, N_SUB_ROWS) + 1;
+
+  /* if the box crosses the date line, the column range wraps
+     around */
+  const unsigned first_column = ColumnOf(sw.longitude.Degrees(),
+                                         SUB_CELL_SIZE, N_SUB_COLUMNS);
+  const unsigned last_column = ColumnOf(ne.longitude.Degrees(),
+                                        SUB_CELL_SIZE, N_SUB_COLUMNS);
+  const unsigned n_columns =
+    (last_column + N_SUB_COLUMNS - first_column) % N_SUB_COLUMNS + 1;
+
+  uint64_t mask = 0;
+  for (unsigned row = row_begin; row < row_end; ++row)
+    for (unsigned i = 0; i < n_columns; ++i)
+      mask |= uint64_t(1) << GetSubCellShard(row, (first_column + i) %
+                                             N_SUB_COLUMNS);
+
+  return mask;
+}
+
+unsigned
+CloudShardRouter::LookupOwner(uint64_t key) const noexcept
+{
+  const auto &stripe = GetStripe(key);
+  const std::scoped_lock lock{stripe.mutex};
+
+  auto i = stripe.owners.find(key);
+  return i != stripe.owners.end()
+    ? i->second
+    : NO_SHARD;
+}
+
+unsigned
+CloudShardRouter::Claim(uint64_t key, unsigned shard) noexcept
+{
+  auto &stripe = GetStripe(key);
+  const std::scoped_lock lock{stripe.mutex};
+
+  auto [i, inserted] = stripe.owners.try_emplace(key, shard);
+  if (inserted)
+    return NO_SHARD;
+
+  return std::exchange(i->second, shard);
+}
+
+void
+CloudShardRouter::Release(uint64_t key, unsigned shard) noexcept
+{
+  auto &stripe = GetStripe(key);
+  const std::scoped_lock lock{stripe.mutex};
+
+  auto i = stripe.owners.find(key);
+  if (i != stripe.owners.end() && i->second == shard)
+    stripe.owners.erase(i);
+}
+
+void
+CloudShardRouter::Broadcast(const CloudShardMessage &message) noexcept
+{
+  for (unsigned i = 0; i < n_shards; ++i)
+    Send(i, CloudShardMessage(message));
+}
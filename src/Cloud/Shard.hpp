@@ -0,0 +1,368 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "thread/Mutex.hxx"
+#include "Geo/GeoPoint.hpp"
+#include "net/StaticSocketAddress.hxx"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+class InjectEvent;
+
+/**
+ * A message from one shard of the cloud server to another one (or
+ * from the main thread to a shard).
+ */
+struct CloudShardMessage {
+  /**
+   * The maximum size of a forwarded datagram.  Larger datagrams are
+   * not forwarded; all client requests are much smaller.
+   */
+  static constexpr std::size_t MAX_DATAGRAM_SIZE = 256;
+
+  enum class Type : uint8_t {
+    /**
+     * A datagram which was received by another shard's socket, but
+     * belongs to this shard.  Uses #address and #data.
+     */
+    DATAGRAM,
+
+    /**
+     * The location of a client owned by another shard, which is
+     * within range of this shard's region.  Uses #key, #id,
+     * #location and #altitude.
+     */
+    GHOST_CLIENT,
+
+    /**
+     * A thermal submitted to another shard, which is within range
+     * of this shard's region.  Uses #key, #location, #altitude,
+     * #location2, #top_altitude and #lift.
+     */
+    GHOST_THERMAL,
+
+    /**
+     * Another shard has taken over the client with the specified
+     * #key; remove it from this shard and reply with
+     * #Type::HANDOVER.
+     */
+    RELEASE,
+
+    /**
+     * The subscriptions of a client which has moved from the
+     * sending shard to this one.  Uses #key, #wants_traffic and
+     * #wants_thermals.
+     */
+    HANDOVER,
+
+    /**
+     * A thermal which has moved to this shard's region because a
+     * cell was split (see CloudShardRouter::Split()).  Unlike
+     * #GHOST_THERMAL, it is not published again.  Uses the same
+     * attributes as #GHOST_THERMAL.
+     */
+    THERMAL,
+
+    /* commands from the main thread */
+    QUIT,
+    SAVE,
+    DUMP,
+  };
+
+  Type type;
+
+  /**
+   * The shard which has sent this message (#Type::RELEASE only).
+   */
+  unsigned sender;
+
+  uint16_t size;
+
+  StaticSocketAddress address;
+
+  std::array<std::byte, MAX_DATAGRAM_SIZE> data;
+
+  uint64_t key;
+  unsigned id;
+
+  GeoPoint location, location2;
+  int altitude, top_altitude;
+  double lift;
+
+  std::chrono::steady_clock::time_point wants_traffic, wants_thermals;
+
+  explicit CloudShardMessage(Type _type) noexcept:type(_type) {}
+
+  std::span<std::byte> GetDatagram() noexcept {
+    return {data.data(), size};
+  }
+};
+
+/**
+ * The queue of #CloudShardMessage objects addressed to one shard.
+ * Messages can be pushed from any thread; they are delivered in the
+ * shard's #EventLoop through an #InjectEvent.
+ */
+class CloudShardInbox {
+  Mutex mutex;
+
+  /**
+   * The event which will deliver the messages; nullptr while the
+   * shard is not running.  Protected by #mutex.
+   */
+  InjectEvent *event = nullptr;
+
+  /**
+   * Protected by #mutex.
+   */
+  std::vector<CloudShardMessage> queue;
+
+public:
+  /**
+   * Start delivering messages to the given event (including the ones
+   * which have been pushed before).
+   */
+  void Attach(InjectEvent &_event) noexcept;
+
+  /**
+   * Stop delivering messages.  Messages pushed afterwards are queued
+   * until Attach() is called again.
+   */
+  void Detach() noexcept;
+
+  /**
+   * This method is thread-safe.
+   */
+  void Push(CloudShardMessage &&message) noexcept;
+
+  /**
+   * Push a batch of messages at once.  This method is thread-safe.
+   */
+  void Push(std::vector<CloudShardMessage> &&messages) noexcept;
+
+  /**
+   * Move all pending messages to the given vector, which must be
+   * empty.  Call this in the #InjectEvent callback.
+   */
+  void Consume(std::vector<CloudShardMessage> &dest) noexcept;
+};
+
+/**
+ * Routes data between the shards of a multi-threaded cloud server.
+ * Each shard runs in its own thread and owns a region of the world,
+ * i.e. all clients and thermals located in it.
+ *
+ * The world is divided into cells of #CELL_SIZE degrees, and each
+ * cell is assigned to a shard by a hash function.  The cells are much
+ * larger than the query boxes, so most queries lie within one cell,
+ * and no query touches more than 2x2 cells; data near the boundary
+ * of a region is copied ("ghosted") into the neighbouring shards.
+ *
+ * A cell which contains too many clients for one thread (e.g. the
+ * Alps on a summer weekend) can be split into #SPLIT x #SPLIT
+ * sub-cells, which are assigned to different shards.  The shards do
+ * not synchronise on this: clients move to their new shard with
+ * their next fix (through Claim() and #CloudShardMessage::Type::RELEASE),
+ * and a datagram which is routed by the old map meanwhile is handled
+ * by the old shard.
+ *
+ * Requests which don't contain a location are routed to the shard
+ * which owns the client; this class keeps a thread-safe directory
+ * of client keys for that.
+ *
+ * All public methods are thread-safe.
+ */
+class CloudShardRouter {
+  /**
+   * The size of a region cell in degrees.  This must be much larger
+   * than the box covering the traffic and thermal query range (50 km
+   * radius, i.e. about 1 by 1.5 degrees in central Europe), or else
+   * most queries would span several cells and thus several shards.
+   */
+  static constexpr double CELL_SIZE = 10;
+
+  static constexpr unsigned N_COLUMNS = 360 / CELL_SIZE;
+  static constexpr unsigned N_ROWS = 180 / CELL_SIZE;
+
+  /**
+   * A split cell is divided into this number of rows and columns.
+   * The sub-cells (2.5 degrees) are still larger than a query box,
+   * but more queries touch two of them.
+   */
+  static constexpr unsigned SPLIT = 4;
+
+  static constexpr double SUB_CELL_SIZE = CELL_SIZE / SPLIT;
+  static constexpr unsigned N_SUB_COLUMNS = N_COLUMNS * SPLIT;
+  static constexpr unsigned N_SUB_ROWS = N_ROWS * SPLIT;
+
+  /**
+   * The number of independently locked parts of the key directory,
+   * to reduce lock contention.
+   */
+  static constexpr std::size_t N_STRIPES = 64;
+
+  struct DirectoryStripe {
+    mutable Mutex mutex;
+
+    /**
+     * Map client key to the owning shard.
+     */
+    std::unordered_map<uint64_t, unsigned> owners;
+  };
+
+  const unsigned n_shards;
+
+  const std::unique_ptr<CloudShardInbox[]> inboxes;
+
+  std::array<DirectoryStripe, N_STRIPES> directory;
+
+public:
+  /**
+   * The number of region cells.
+   */
+  static constexpr unsigned N_CELLS = N_ROWS * N_COLUMNS;
+
+private:
+  /**
+   * Which cells have been split?
+   */
+  std::array<std::atomic<bool>, N_CELLS> split_cells{};
+
+public:
+  /**
+   * The maximum number of shards.
+   */
+  static constexpr unsigned MAX_SHARDS = 64;
+
+  /**
+   * Returned by LookupOwner() and Claim() if the key is unknown.
+   */
+  static constexpr unsigned NO_SHARD = ~0u;
+
+  explicit CloudShardRouter(unsigned _n_shards) noexcept;
+  ~CloudShardRouter() noexcept;
+
+  unsigned size() const noexcept {
+    return n_shards;
+  }
+
+  CloudShardInbox &GetInbox(unsigned shard) noexcept {
+    return inboxes[shard];
+  }
+
+  /**
+   * Determine the cell containing this location.
+   */
+  [[gnu::const]]
+  static unsigned GetCell(GeoPoint location) noexcept;
+
+  [[gnu::pure]]
+  bool IsSplit(unsigned cell) const noexcept {
+    return split_cells[cell].load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Split a dense cell into sub-cells which are distributed over
+   * the shards.  Cells are never merged again.
+   *
+   * @return true if the cell has been split by this call, false if
+   * it was already split
+   */
+  bool Split(unsigned cell) noexcept {
+    return !split_cells[cell].exchange(true, std::memory_order_relaxed);
+  }
+
+  [[gnu::pure]]
+  std::vector<unsigned> GetSplitCells() const noexcept;
+
+  /**
+   * Which shard owns the region containing this location?
+   */
+  [[gnu::pure]]
+  unsigned GetRegionShard(GeoPoint location) const noexcept;
+
+  /**
+   * Invoke the function once for each shard owning a part of the
+   * box which covers the given range around the location (see
+   * BoostRangeBox()).
+   */
+  template<typename F>
+  void ForEachRegionShard(GeoPoint location, double range, F &&f) const {
+    uint64_t mask = GetRegionShards(location, range);
+    for (unsigned shard = 0; mask != 0; ++shard, mask >>= 1)
+      if (mask & 1)
+        f(shard);
+  }
+
+  /**
+   * Look up the shard which owns the client.
+   *
+   * @return the shard or #NO_SHARD
+   */
+  unsigned LookupOwner(uint64_t key) const noexcept;
+
+  /**
+   * Make the specified shard the owner of the client.
+   *
+   * @return the previous owner or #NO_SHARD
+   */
+  unsigned Claim(uint64_t key, unsigned shard) noexcept;
+
+  /**
+   * Forget the owner of the client, but only if it is still the
+   * specified shard.
+   */
+  void Release(uint64_t key, unsigned shard) noexcept;
+
+  void Send(unsigned shard, CloudShardMessage &&message) noexcept {
+    inboxes[shard].Push(std::move(message));
+  }
+
+  void Send(unsigned shard,
+            std::vector<CloudShardMessage> &&messages) noexcept {
+    inboxes[shard].Push(std::move(messages));
+  }
+
+  /**
+   * Send a copy of the message to all shards.
+   */
+  void Broadcast(const CloudShardMessage &message) noexcept;
+
+private:
+  /**
+   * Determine the shards owning a part of the range box.
+   *
+   * @return a bit mask of shard numbers
+   */
+  [[gnu::pure]]
+  uint64_t GetRegionShards(GeoPoint location, double range) const noexcept;
+
+  [[gnu::pure]]
+  unsigned GetCellShard(unsigned cell) const noexcept;
+
+  /**
+   * Determine the shard owning the sub-cell with the given
+   * coordinates (in units of #SUB_CELL_SIZE).  If the cell containing
+   * it has not been split, this is the shard owning the cell.
+   */
+  [[gnu::pure]]
+  unsigned GetSubCellShard(unsigned row, unsigned column) const noexcept;
+
+  DirectoryStripe &GetStripe(uint64_t key) noexcept {
+    return directory[key % N_STRIPES];
+  }
+
+  const DirectoryStripe &GetStripe(uint64_t key) const noexcept {
+    return directory[key % N_STRIPES];
+  }
+};
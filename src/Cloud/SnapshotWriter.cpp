@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "SnapshotWriter.hpp"
+#include "io/FileOutputStream.hxx"
+#include "util/SpanCast.hxx"
+
+SnapshotWriter::SnapshotWriter(EventLoop &event_loop,
+                               AllocatedPath &&_path,
+                               ErrorCallback _error_callback) noexcept
+  :StandbyThread("SnapshotWriter"),
+   path(std::move(_path)),
+   error_callback(_error_callback),
+   error_event(event_loop, BIND_THIS_METHOD(OnError)) {}
+
+SnapshotWriter::~SnapshotWriter() noexcept
+{
+  LockStop();
+}
+
+void
+SnapshotWriter::Submit(std::string &&snapshot)
+{
+  const std::lock_guard lock{mutex};
+  next = std::move(snapshot);
+  has_next = true;
+  Trigger();
+}
+
+void
+SnapshotWriter::OnError() noexcept
+{
+  std::exception_ptr e;
+
+  {
+    const std::lock_guard lock{mutex};
+    std::swap(e, error);
+  }
+
+  if (e)
+    error_callback(std::move(e));
+}
+
+void
+SnapshotWriter::Tick() noexcept
+{
+  while (has_next && !IsStopped()) {
+    const std::string snapshot = std::move(next);
+    has_next = false;
+
+    try {
+      const ScopeUnlock unlock(mutex);
+
+      FileOutputStream fos(path);
+      fos.Write(AsBytes(snapshot));
+      fos.Commit();
+    } catch (...) {
+      error = std::current_exception();
+      error_event.Schedule();
+    }
+  }
+}
@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "thread/StandbyThread.hpp"
+#include "event/InjectEvent.hxx"
+#include "system/Path.hpp"
+#include "util/BindMethod.hxx"
+
+#include <exception>
+#include <string>
+
+/**
+ * A thread which writes serialised snapshots of the #CloudData to
+ * the database file, so the event loop doesn't block on disk I/O.
+ *
+ * If a new snapshot is submitted while the previous one is still
+ * being written, only the newest pending one will be written.
+ */
+class SnapshotWriter final : StandbyThread {
+  const AllocatedPath path;
+
+  using ErrorCallback = BoundMethod<void(std::exception_ptr e) noexcept>;
+  const ErrorCallback error_callback;
+
+  /**
+   * Moves #error to the #EventLoop thread.
+   */
+  InjectEvent error_event;
+
+  /* the following attributes are protected by StandbyThread::mutex */
+
+  /**
+   * The snapshot to be written next.
+   */
+  std::string next;
+
+  bool has_next = false;
+
+  std::exception_ptr error;
+
+public:
+  SnapshotWriter(EventLoop &event_loop, AllocatedPath &&_path,
+                 ErrorCallback _error_callback) noexcept;
+
+  /**
+   * Stops the thread, discarding a pending snapshot.
+   */
+  ~SnapshotWriter() noexcept;
+
+  Path GetPath() const noexcept {
+    return path;
+  }
+
+  /**
+   * Schedule writing this snapshot.
+   *
+   * Throws if the thread could not be started.
+   */
+  void Submit(std::string &&snapshot);
+
+  /**
+   * Wait until all submitted snapshots have been written.
+   */
+  void WaitDone() noexcept {
+    LockWaitDone();
+  }
+
+private:
+  void OnError() noexcept;
+
+  /* virtual methods from class StandbyThread */
+  void Tick() noexcept override;
+};
@@ -0,0 +1,30 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Stats.hpp"
+
+#include <sstream>
+
+std::string
+CloudStatsBoard::MakeReport() noexcept
+{
+  CloudStats total;
+  for (unsigned i = 0; i < n_slots; ++i) {
+    const std::scoped_lock lock{slots[i].mutex};
+    total += slots[i].stats;
+  }
+
+  std::ostringstream os;
+  os << "clients\t" << total.clients << '\n'
+     << "thermals\t" << total.thermals << '\n'
+     << "fixes\t" << total.fixes << '\n'
+     << "fixes/s\t" << total.fixes_rate << '\n'
+     << "packets_in\t" << total.received << '\n'
+     << "packets_in/s\t" << total.received_rate << '\n'
+     << "packets_out\t" << total.sent << '\n'
+     << "packets_out/s\t" << total.sent_rate << '\n'
+     << "log_dropped\t" << total.log_dropped << '\n';
+  if (n_slots > 1)
+    os << "shards\t" << n_slots << '\n';
+  return std::move(os).str();
+}
@@ -0,0 +1,61 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "thread/Mutex.hxx"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/**
+ * The counters of a #CloudServer, published periodically for the
+ * stats socket, which may be served by another thread.
+ */
+struct CloudStats {
+  uint64_t clients = 0, thermals = 0, fixes = 0;
+  uint64_t received = 0, sent = 0, log_dropped = 0;
+  double fixes_rate = 0, received_rate = 0, sent_rate = 0;
+
+  CloudStats &operator+=(const CloudStats &other) noexcept {
+    clients += other.clients;
+    thermals += other.thermals;
+    fixes += other.fixes;
+    received += other.received;
+    sent += other.sent;
+    log_dropped += other.log_dropped;
+    fixes_rate += other.fixes_rate;
+    received_rate += other.received_rate;
+    sent_rate += other.sent_rate;
+    return *this;
+  }
+};
+
+/**
+ * The most recently published #CloudStats of each shard.  This class
+ * is thread-safe.
+ */
+class CloudStatsBoard {
+  struct Slot {
+    Mutex mutex;
+    CloudStats stats;
+  };
+
+  const unsigned n_slots;
+  const std::unique_ptr<Slot[]> slots;
+
+public:
+  explicit CloudStatsBoard(unsigned _n_slots) noexcept
+    :n_slots(_n_slots), slots(std::make_unique<Slot[]>(_n_slots)) {}
+
+  void Publish(unsigned i, const CloudStats &stats) noexcept {
+    const std::scoped_lock lock{slots[i].mutex};
+    slots[i].stats = stats;
+  }
+
+  /**
+   * Generate a TSV report of the sum of all counters.
+   */
+  std::string MakeReport() noexcept;
+};
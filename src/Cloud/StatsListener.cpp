@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "StatsListener.hpp"
+#include "net/AllocatedSocketAddress.hxx"
+#include "net/SocketError.hxx"
+#include "net/UniqueSocketDescriptor.hxx"
+
+#include <unistd.h>
+
+static UniqueSocketDescriptor
+CreateListenLocal(const char *path)
+{
+  AllocatedSocketAddress address;
+  address.SetLocal(path);
+
+  /* remove the stale socket of a previous process */
+  unlink(path);
+
+  UniqueSocketDescriptor s;
+  if (!s.CreateNonBlock(AF_LOCAL, SOCK_STREAM, 0))
+    throw MakeSocketError("Failed to create socket");
+
+  if (!s.Bind(address))
+    throw MakeSocketError("Failed to bind socket");
+
+  if (!s.Listen(8))
+    throw MakeSocketError("Failed to listen");
+
+  return s;
+}
+
+StatsListener::StatsListener(EventLoop &event_loop, const char *path,
+                             Callback _callback)
+  :socket(event_loop, BIND_THIS_METHOD(OnSocketReady),
+          CreateListenLocal(path).Release()),
+   callback(_callback)
+{
+  socket.ScheduleRead();
+}
+
+void
+StatsListener::OnSocketReady(unsigned) noexcept
+{
+  UniqueSocketDescriptor connection(socket.GetSocket().AcceptNonBlock());
+  if (!connection.IsDefined())
+    return;
+
+  /* the text is small enough to fit into the socket buffer; if it
+     doesn't, the client receives a truncated response */
+  const std::string text = callback();
+  (void)connection.Write(text.data(), text.size());
+}
@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "event/SocketEvent.hxx"
+#include "util/BindMethod.hxx"
+
+#include <string>
+
+/**
+ * Listens on a local (AF_LOCAL) stream socket.  Each client which
+ * connects receives the text returned by the callback, and the
+ * connection is closed.
+ */
+class StatsListener {
+  SocketEvent socket;
+
+  using Callback = BoundMethod<std::string() noexcept>;
+  const Callback callback;
+
+public:
+  /**
+   * Throws on error.
+   */
+  StatsListener(EventLoop &event_loop, const char *path,
+                Callback _callback);
+
+  ~StatsListener() noexcept {
+    socket.Close();
+  }
+
+private:
+  void OnSocketReady(unsigned events) noexcept;
+};
@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Supervisor.hpp"
+#include "Shard.hpp"
+#include "Worker.hpp"
+#include "event/Loop.hxx"
+#include "event/SignalMonitor.hxx"
+#include "util/PrintException.hxx"
+
+#include <signal.h>
+
+CloudSupervisor::CloudSupervisor(EventLoop &_event_loop,
+                                 CloudShardRouter &_router,
+                                 Path _db_path) noexcept
+  :event_loop(_event_loop), router(_router), db_path(_db_path)
+{
+#ifndef _WIN32
+  SignalMonitorRegister(SIGINT, BIND_THIS_METHOD(OnQuitSignal));
+  SignalMonitorRegister(SIGTERM, BIND_THIS_METHOD(OnQuitSignal));
+  SignalMonitorRegister(SIGQUIT, BIND_THIS_METHOD(OnQuitSignal));
+
+  SignalMonitorRegister(SIGHUP, BIND_THIS_METHOD(OnReloadSignal));
+  SignalMonitorRegister(SIGUSR1, BIND_THIS_METHOD(OnDumpSignal));
+#endif
+}
+
+#ifndef _WIN32
+
+void
+CloudSupervisor::OnQuitSignal() noexcept
+{
+  event_loop.Break();
+}
+
+void
+CloudSupervisor::OnReloadSignal() noexcept
+{
+  router.Broadcast(CloudShardMessage(CloudShardMessage::Type::SAVE));
+
+  try {
+    SaveSplitCells(router, db_path);
+  } catch (...) {
+    PrintException(std::current_exception());
+  }
+}
+
+void
+CloudSupervisor::OnDumpSignal() noexcept
+{
+  router.Broadcast(CloudShardMessage(CloudShardMessage::Type::DUMP));
+}
+
+#endif
@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "system/Path.hpp"
+
+class EventLoop;
+class CloudShardRouter;
+
+/**
+ * Handles the signals of a multi-threaded server and forwards them
+ * to all shards.
+ */
+class CloudSupervisor {
+  EventLoop &event_loop;
+  CloudShardRouter &router;
+
+  const Path db_path;
+
+public:
+  /**
+   * This blocks the signals; construct it before the worker threads
+   * are started, because they inherit the signal mask.
+   */
+  CloudSupervisor(EventLoop &_event_loop, CloudShardRouter &_router,
+                  Path _db_path) noexcept;
+
+private:
+#ifndef _WIN32
+  void OnQuitSignal() noexcept;
+  void OnReloadSignal() noexcept;
+  void OnDumpSignal() noexcept;
+#endif
+};
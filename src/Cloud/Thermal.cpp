@@ -116,6 +116,9 @@ CloudThermalContainer::Save(Serialiser &s) const
   s.Write8(1);
 
   for (const auto &thermal : list) {
+    if (thermal.ghost)
+      continue;
+
     s.Write8(1);
     thermal.Save(s);
   }
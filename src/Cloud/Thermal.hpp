@@ -34,6 +34,12 @@ struct CloudThermal
 
   double lift;
 
+  /**
+   * Is this a copy of a thermal owned by another shard of a
+   * multi-threaded server?  Ghosts are not saved.
+   */
+  bool ghost = false;
+
   CloudThermal(uint64_t _client_key,
                const AGeoPoint &_bottom_location,
                const AGeoPoint &_top_location,
@@ -105,6 +111,14 @@ public:
     return list.end();
   }
 
+  List::iterator begin() {
+    return list.begin();
+  }
+
+  List::iterator end() {
+    return list.end();
+  }
+
   /**
    * Create a new #CloudThermal, or refresh the existing one.
    */
@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Worker.hpp"
+#include "Server.hpp"
+#include "Serialiser.hpp"
+#include "Shard.hpp"
+#include "event/Loop.hxx"
+#include "net/IPv4Address.hxx"
+#include "io/FileOutputStream.hxx"
+#include "io/FileReader.hxx"
+#include "system/FileUtil.hpp"
+#include "util/PrintException.hxx"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using std::cerr;
+using std::endl;
+
+/**
+ * Determine the path of the database file of one shard of a
+ * multi-threaded server.
+ */
+static AllocatedPath
+MakeShardPath(Path db_path, unsigned shard) noexcept
+{
+  return db_path + ("." + std::to_string(shard)).c_str();
+}
+
+static AllocatedPath
+MakeSplitCellsPath(Path db_path) noexcept
+{
+  return db_path + ".cells";
+}
+
+void
+CheckShardFiles(Path db_path, unsigned n_shards)
+{
+  unsigned saved_shards = 0;
+  for (unsigned shard = 0; shard < CloudShardRouter::MAX_SHARDS; ++shard)
+    if (File::Exists(MakeShardPath(db_path, shard)))
+      saved_shards = shard + 1;
+
+  if (n_shards == 1) {
+    if (saved_shards > 0)
+      throw std::runtime_error("The database was saved with --threads=" +
+                               std::to_string(saved_shards));
+  } else if (File::Exists(db_path)) {
+    throw std::runtime_error("The database was saved without --threads");
+  } else if (saved_shards > 0 && saved_shards != n_shards) {
+    throw std::runtime_error("The database was saved with --threads=" +
+                             std::to_string(saved_shards));
+  }
+}
+
+void
+LoadSplitCells(CloudShardRouter &router, Path db_path)
+{
+  const auto path = MakeSplitCellsPath(db_path);
+  if (!File::Exists(path))
+    return;
+
+  FileReader fr(path);
+  Deserialiser s(fr);
+
+  for (unsigned n = s.Read32(); n > 0; --n) {
+    const unsigned cell = s.Read32();
+    if (cell >= CloudShardRouter::N_CELLS)
+      throw std::runtime_error("Bad cell number");
+
+    router.Split(cell);
+  }
+}
+
+void
+SaveSplitCells(const CloudShardRouter &router, Path db_path)
+{
+  const auto cells = router.GetSplitCells();
+
+  FileOutputStream fos(MakeSplitCellsPath(db_path));
+
+  {
+    Serialiser s(fos);
+    s.Write32(cells.size());
+    for (const unsigned cell : cells)
+      s.Write32(cell);
+    s.Flush();
+  }
+
+  fos.Commit();
+}
+
+CloudWorker::CloudWorker(CloudShardRouter &_router, unsigned _shard,
+                         Path _db_path, CloudStatsBoard &_stats_board,
+                         CloudLog::Verbosity verbosity,
+                         unsigned fix_sample) noexcept
+  :Thread("cloud"),
+   router(_router), shard(_shard),
+   db_path(MakeShardPath(_db_path, _shard)),
+   stats_board(_stats_board),
+   log(stdout, verbosity, fix_sample) {}
+
+void
+CloudWorker::Run() noexcept
+try {
+  EventLoop event_loop;
+
+  CloudServer server(Path(db_path), event_loop,
+                     IPv4Address(CloudServer::GetDefaultPort()), log,
+                     stats_board, &router, shard);
+
+  try {
+    server.Load();
+  } catch (const std::runtime_error &e) {
+    cerr << "Failed to load database " << db_path.c_str() << endl;
+    PrintException(e);
+  }
+
+  event_loop.Run();
+
+  server.Save();
+} catch (...) {
+  PrintException(std::current_exception());
+}
@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Log.hpp"
+#include "thread/Thread.hpp"
+#include "system/Path.hpp"
+
+class CloudShardRouter;
+class CloudStatsBoard;
+
+/**
+ * Verify that the existing database files were written with the
+ * specified number of threads.  The files are not re-sharded, because
+ * each shard loads only its own file; starting with a different
+ * number of threads would lose or misplace clients and thermals.
+ *
+ * Throws on mismatch.
+ */
+void
+CheckShardFiles(Path db_path, unsigned n_shards);
+
+/**
+ * Restore the split cells (see CloudShardRouter::Split()) saved by
+ * SaveSplitCells().  Does nothing if there is no such file.
+ *
+ * Throws on error.
+ */
+void
+LoadSplitCells(CloudShardRouter &router, Path db_path);
+
+/**
+ * Save the split cells next to the database files, so the shards
+ * find their data in their regions after a restart.
+ *
+ * Throws on error.
+ */
+void
+SaveSplitCells(const CloudShardRouter &router, Path db_path);
+
+/**
+ * A thread which runs one shard of a multi-threaded server.
+ */
+class CloudWorker final : Thread {
+  CloudShardRouter &router;
+  const unsigned shard;
+
+  const AllocatedPath db_path;
+
+  CloudStatsBoard &stats_board;
+
+  CloudLog log;
+
+public:
+  /**
+   * @param _db_path the path of the database file; each shard saves
+   * its data in a separate file with the shard number appended
+   */
+  CloudWorker(CloudShardRouter &_router, unsigned _shard,
+              Path _db_path, CloudStatsBoard &_stats_board,
+              CloudLog::Verbosity verbosity, unsigned fix_sample) noexcept;
+
+  void Start() {
+    log.Start();
+    Thread::Start();
+  }
+
+  using Thread::Join;
+
+private:
+  /* virtual methods from class Thread */
+  void Run() noexcept override;
+};
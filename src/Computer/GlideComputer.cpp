@@ -9,8 +9,6 @@
 
 using namespace std::chrono;
 
-static PeriodClock last_team_code_update;
-
 GlideComputer::GlideComputer(const ComputerSettings &_settings,
                              const Waypoints &_way_points,
                              Airspaces &_airspace_database,
@@ -54,6 +52,8 @@ GlideComputer::Initialise()
 bool
 GlideComputer::ProcessGPS(bool force)
 {
+  const ScopeStageTimer timer(stage_times, ComputerStage::PROCESS_GPS);
+
   const MoreData &basic = Basic();
   DerivedInfo &calculated = SetCalculated();
   const ComputerSettings &settings = GetComputerSettings();
@@ -78,20 +78,29 @@ GlideComputer::ProcessGPS(bool force)
   calculated.Expire(basic.clock);
 
   // Process basic information
-  air_data_computer.ProcessBasic(Basic(), SetCalculated(),
-                                 settings);
+  {
+    const ScopeStageTimer timer2(stage_times, ComputerStage::AIR_DATA);
+    air_data_computer.ProcessBasic(Basic(), SetCalculated(),
+                                   settings);
+  }
 
   // Process basic task information
   const bool last_finished = calculated.ordered_task_stats.task_finished;
 
-  task_computer.ProcessBasicTask(basic,
-                                 calculated,
-                                 settings,
-                                 force);
+  {
+    const ScopeStageTimer timer2(stage_times, ComputerStage::TASK);
+    task_computer.ProcessBasicTask(basic,
+                                   calculated,
+                                   settings,
+                                   force);
+  }
 
   CalculateWorkingBand();
 
-  task_computer.ProcessMoreTask(basic, calculated, settings);
+  {
+    const ScopeStageTimer timer2(stage_times, ComputerStage::ROUTE);
+    task_computer.ProcessMoreTask(basic, calculated, settings);
+  }
 
   if (!last_finished && calculated.ordered_task_stats.task_finished)
     OnFinishTask();
@@ -105,9 +114,12 @@ GlideComputer::ProcessGPS(bool force)
   task_computer.ProcessAutoTask(basic, calculated);
 
   // Process extended information
-  air_data_computer.ProcessVertical(Basic(),
-                                    SetCalculated(),
-                                    settings);
+  {
+    const ScopeStageTimer timer2(stage_times, ComputerStage::VERTICAL);
+    air_data_computer.ProcessVertical(Basic(),
+                                      SetCalculated(),
+                                      settings);
+  }
 
   stats_computer.ProcessClimbEvents(calculated);
 
@@ -133,7 +145,11 @@ GlideComputer::ProcessGPS(bool force)
   CalculateVarioScale();
 
   // Update the ConditionMonitors
-  condition_monitors.Update(Basic(), Calculated(), settings);
+  {
+    const ScopeStageTimer timer2(stage_times,
+                                 ComputerStage::CONDITION_MONITORS);
+    condition_monitors.Update(Basic(), Calculated(), settings);
+  }
 
   return idle_clock.CheckUpdate(milliseconds(500));
 }
@@ -141,21 +157,34 @@ GlideComputer::ProcessGPS(bool force)
 void
 GlideComputer::ProcessIdle(bool exhaustive)
 {
+  const ScopeStageTimer timer(stage_times, ComputerStage::PROCESS_IDLE);
+
   const MoreData &basic = Basic();
   DerivedInfo &calculated = SetCalculated();
 
   // Log GPS fixes for internal usage
   // (snail trail, stats, contest, ...)
-  stats_computer.DoLogging(basic, calculated);
-  log_computer.Run(basic, calculated, GetComputerSettings().logger);
+  {
+    const ScopeStageTimer timer2(stage_times, ComputerStage::LOG);
+    stats_computer.DoLogging(basic, calculated);
+    log_computer.Run(basic, calculated, GetComputerSettings().logger);
+  }
 
   task_computer.ProcessIdle(basic, calculated, GetComputerSettings(),
-                            exhaustive);
+                            stage_times, exhaustive);
 
-  warning_computer.Update(GetComputerSettings(), basic,
-                          calculated, calculated.airspace_warnings);
+  {
+    const ScopeStageTimer timer2(stage_times,
+                                 ComputerStage::AIRSPACE_WARNING);
+    warning_computer.Update(GetComputerSettings(), basic,
+                            calculated, calculated.airspace_warnings);
+  }
 
-  idle_condition_monitors.Update(basic, calculated, GetComputerSettings());
+  {
+    const ScopeStageTimer timer2(stage_times,
+                                 ComputerStage::IDLE_CONDITION_MONITORS);
+    idle_condition_monitors.Update(basic, calculated, GetComputerSettings());
+  }
 
   // Calculate summary of flight
   if (basic.location_available)
@@ -12,6 +12,7 @@
 #include "LogComputer.hpp"
 #include "WarningComputer.hpp"
 #include "CuComputer.hpp"
+#include "StageTimer.hpp"
 #include "Engine/Contest/Solvers/Retrospective.hpp"
 #include "ConditionMonitor/ConditionMonitors.hpp"
 #include "ConditionMonitor/MoreConditionMonitors.hpp"
@@ -46,12 +47,24 @@ class GlideComputer : public GlideComputerBlackboard
 
   PeriodClock idle_clock;
 
+  /**
+   * Throttles CalculateOwnTeamCode().
+   */
+  PeriodClock last_team_code_update;
+
   /**
    * This object is used to check whether to update
    * DerivedInfo::trace_history.
    */
   DeltaTime trace_history_time;
 
+  /**
+   * The durations of the calculation stages.  Written only by the
+   * thread which calls ProcessGPS() and ProcessIdle(); readable from
+   * any thread.
+   */
+  ComputerStageTimes stage_times;
+
 public:
   GlideComputer(const ComputerSettings &_settings,
                 const Waypoints &_way_points,
@@ -141,6 +154,14 @@ public:
     return retrospective;
   }
 
+  ComputerStageTimes &GetStageTimes() noexcept {
+    return stage_times;
+  }
+
+  const ComputerStageTimes &GetStageTimes() const noexcept {
+    return stage_times;
+  }
+
   void SetContestIncremental(bool incremental) {
     task_computer.SetContestIncremental(incremental);
   }
@@ -30,6 +30,12 @@ class GlideRatioCalculator {
    */
   unsigned short size;
 
+  /**
+   * The number of consecutive samples which were ignored because
+   * their distance was implausible.
+   */
+  unsigned short errs;
+
   bool valid;
 
 public:
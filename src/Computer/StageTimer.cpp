@@ -0,0 +1,88 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "StageTimer.hpp"
+#include "util/Macros.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+static const TCHAR *const stage_names[] = {
+  _T("Tick"),
+  _T("ProcessGPS"),
+  _T("Air data"),
+  _T("Task"),
+  _T("Route/reach"),
+  _T("Vertical"),
+  _T("Conditions"),
+  _T("ProcessIdle"),
+  _T("Logging"),
+  _T("Contest"),
+  _T("Task (idle)"),
+  _T("Airspace warnings"),
+  _T("Conditions (idle)"),
+};
+
+static_assert(ARRAY_SIZE(stage_names) == unsigned(ComputerStage::COUNT));
+
+const TCHAR *
+ToString(ComputerStage stage) noexcept
+{
+  return stage_names[unsigned(stage)];
+}
+
+void
+StageStatistics::Add(std::chrono::steady_clock::duration duration) noexcept
+{
+  using namespace std::chrono;
+
+  const auto us = std::clamp<microseconds::rep>(duration_cast<microseconds>(duration).count(),
+                                                0,
+                                                std::numeric_limits<uint32_t>::max());
+  const uint32_t value = us;
+
+  /* only this thread writes, therefore plain load/store pairs are
+     sufficient */
+  const uint32_t n = count.load(std::memory_order_relaxed);
+  samples[n % N_SAMPLES].store(value, std::memory_order_relaxed);
+  count.store(n + 1, std::memory_order_release);
+
+  if (value > max_ever.load(std::memory_order_relaxed))
+    max_ever.store(value, std::memory_order_relaxed);
+}
+
+StageStatistics::Snapshot
+StageStatistics::GetSnapshot() const noexcept
+{
+  Snapshot s{};
+  s.count = count.load(std::memory_order_acquire);
+  s.max_ever = max_ever.load(std::memory_order_relaxed);
+  s.n = std::min(s.count, N_SAMPLES);
+  if (s.n == 0)
+    return s;
+
+  std::array<uint32_t, N_SAMPLES> window;
+  for (unsigned i = 0; i < s.n; ++i)
+    window[i] = samples[(s.count - s.n + i) % N_SAMPLES].load(std::memory_order_relaxed);
+
+  s.last = window[s.n - 1];
+
+  uint64_t sum = 0;
+  for (unsigned i = 0; i < s.n; ++i) {
+    const uint32_t value = window[i];
+    sum += value;
+
+    const unsigned bucket = std::bit_width(value / FIRST_BUCKET);
+    ++s.histogram[std::min(bucket, N_BUCKETS - 1)];
+  }
+
+  s.mean = sum / s.n;
+
+  std::sort(window.begin(), window.begin() + s.n);
+  s.p50 = window[s.n / 2];
+  s.p90 = window[s.n * 9 / 10];
+  s.max = window[s.n - 1];
+
+  return s;
+}
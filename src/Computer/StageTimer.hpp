@@ -0,0 +1,203 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <tchar.h>
+
+/**
+ * The stages of the calculation pipeline which are measured by
+ * #ScopeStageTimer.
+ */
+enum class ComputerStage : uint8_t {
+  /**
+   * One CalculationThread::Tick(), including waiting for locks.
+   */
+  TICK,
+
+  PROCESS_GPS,
+
+  /**
+   * GlideComputerAirData::ProcessBasic()
+   */
+  AIR_DATA,
+
+  /**
+   * TaskComputer::ProcessBasicTask()
+   */
+  TASK,
+
+  /**
+   * #RouteComputer: reach and terrain warning.
+   */
+  ROUTE,
+
+  /**
+   * GlideComputerAirData::ProcessVertical(): circling, thermals,
+   * wind.
+   */
+  VERTICAL,
+
+  /**
+   * #ConditionMonitors in ProcessGPS().
+   */
+  CONDITION_MONITORS,
+
+  PROCESS_IDLE,
+
+  /**
+   * #StatsComputer and #LogComputer.
+   */
+  LOG,
+
+  /**
+   * #ContestComputer
+   */
+  CONTEST,
+
+  /**
+   * TaskManager::UpdateIdle()
+   */
+  TASK_IDLE,
+
+  /**
+   * #WarningComputer
+   */
+  AIRSPACE_WARNING,
+
+  /**
+   * #MoreConditionMonitors in ProcessIdle().
+   */
+  IDLE_CONDITION_MONITORS,
+
+  COUNT
+};
+
+[[gnu::const]]
+const TCHAR *
+ToString(ComputerStage stage) noexcept;
+
+/**
+ * Collects the durations of one #ComputerStage in a ring buffer of
+ * recent samples.
+ *
+ * There is exactly one writer (the thread which runs the stage), and
+ * any number of readers in other threads.  Neither side takes a
+ * lock; a reader may see a sample which was overwritten while it was
+ * copying the buffer, which is good enough for statistics.
+ */
+class StageStatistics {
+public:
+  /**
+   * The number of samples in the rolling window.
+   */
+  static constexpr unsigned N_SAMPLES = 64;
+
+  /**
+   * The number of histogram buckets.  The first one covers durations
+   * below #FIRST_BUCKET microseconds, and each following one has
+   * twice the size of its predecessor; the last one collects
+   * everything larger.
+   */
+  static constexpr unsigned N_BUCKETS = 16;
+  static constexpr uint32_t FIRST_BUCKET = 32;
+
+  /**
+   * A copy of the statistics with derived values.  All durations
+   * are in microseconds.
+   */
+  struct Snapshot {
+    /**
+     * The total number of samples since startup.
+     */
+    uint32_t count;
+
+    /**
+     * The number of samples in the rolling window.
+     */
+    unsigned n;
+
+    uint32_t last, mean, p50, p90, max;
+
+    /**
+     * The largest sample since startup.
+     */
+    uint32_t max_ever;
+
+    /**
+     * Histogram of the samples in the rolling window.
+     */
+    std::array<unsigned, N_BUCKETS> histogram;
+
+    /**
+     * Returns the exclusive upper bound of the histogram bucket in
+     * microseconds (except for the last one, which is unbounded).
+     */
+    static constexpr uint32_t GetBucketLimit(unsigned bucket) noexcept {
+      return FIRST_BUCKET << bucket;
+    }
+  };
+
+private:
+  std::array<std::atomic<uint32_t>, N_SAMPLES> samples{};
+
+  std::atomic<uint32_t> count{0};
+
+  std::atomic<uint32_t> max_ever{0};
+
+public:
+  /**
+   * Add a sample.  Must be called only by the writer thread.
+   */
+  void Add(std::chrono::steady_clock::duration duration) noexcept;
+
+  /**
+   * This method is thread-safe.  It is not "pure", because the
+   * writer thread may add samples between two calls.
+   */
+  Snapshot GetSnapshot() const noexcept;
+};
+
+/**
+ * The #StageStatistics of all #ComputerStage values.
+ */
+class ComputerStageTimes {
+  std::array<StageStatistics, unsigned(ComputerStage::COUNT)> stages;
+
+public:
+  StageStatistics &operator[](ComputerStage stage) noexcept {
+    return stages[unsigned(stage)];
+  }
+
+  const StageStatistics &operator[](ComputerStage stage) const noexcept {
+    return stages[unsigned(stage)];
+  }
+};
+
+/**
+ * Measure the time until this object is destroyed and add it to the
+ * #StageStatistics.  The overhead is two steady_clock::now() calls.
+ */
+class ScopeStageTimer {
+  StageStatistics &statistics;
+
+  const std::chrono::steady_clock::time_point start;
+
+public:
+  explicit ScopeStageTimer(StageStatistics &_statistics) noexcept
+    :statistics(_statistics), start(std::chrono::steady_clock::now()) {}
+
+  ScopeStageTimer(ComputerStageTimes &times, ComputerStage stage) noexcept
+    :ScopeStageTimer(times[stage]) {}
+
+  ~ScopeStageTimer() noexcept {
+    statistics.Add(std::chrono::steady_clock::now() - start);
+  }
+
+  ScopeStageTimer(const ScopeStageTimer &) = delete;
+  ScopeStageTimer &operator=(const ScopeStageTimer &) = delete;
+};
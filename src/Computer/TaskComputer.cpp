@@ -9,6 +9,7 @@
 #include "NMEA/MoreData.hpp"
 #include "NMEA/Derived.hpp"
 #include "Settings.hpp"
+#include "StageTimer.hpp"
 
 #include <algorithm>
 
@@ -128,16 +129,23 @@ Predicted(const ContestSettings &settings,
 void
 TaskComputer::ProcessIdle(const MoreData &basic, DerivedInfo &calculated,
                           const ComputerSettings &settings_computer,
+                          ComputerStageTimes &stage_times,
                           bool exhaustive)
 {
-  contest.SetPredicted(Predicted(settings_computer.contest, basic,
-                                 calculated.task_stats.current_leg));
+  {
+    const ScopeStageTimer timer(stage_times, ComputerStage::CONTEST);
 
-  if (exhaustive)
-    contest.SolveExhaustive(settings_computer.contest,
-                            calculated.contest_stats);
-  else
-    contest.Solve(settings_computer.contest, calculated.contest_stats);
+    contest.SetPredicted(Predicted(settings_computer.contest, basic,
+                                   calculated.task_stats.current_leg));
+
+    if (exhaustive)
+      contest.SolveExhaustive(settings_computer.contest,
+                              calculated.contest_stats);
+    else
+      contest.Solve(settings_computer.contest, calculated.contest_stats);
+  }
+
+  const ScopeStageTimer timer(stage_times, ComputerStage::TASK_IDLE);
 
   const AircraftState as = ToAircraftState(basic, calculated);
 
@@ -12,6 +12,7 @@
 struct NMEAInfo;
 class ProtectedTaskManager;
 class ProtectedAirspaceWarningManager;
+class ComputerStageTimes;
 
 class TaskComputer
 {
@@ -81,7 +82,12 @@ public:
    */
   void ProcessAutoTask(const NMEAInfo &basic, const DerivedInfo &calculated);
 
+  /**
+   * @param stage_times receives the durations of
+   * #ComputerStage::CONTEST and #ComputerStage::TASK_IDLE
+   */
   void ProcessIdle(const MoreData &basic, DerivedInfo &calculated,
                    const ComputerSettings &settings_computer,
+                   ComputerStageTimes &stage_times,
                    bool exhaustive=false);
 };
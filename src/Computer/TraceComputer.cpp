@@ -48,6 +48,28 @@ TraceComputer::LockedCopyTo(TracePointVector &v,
   full.GetPoints(v, min_time, location, resolution);
 }
 
+bool
+TraceComputer::LockedSyncTo(TracePointVector &v,
+                            Serial &append_serial,
+                            Serial &modify_serial) const
+{
+  const std::lock_guard lock{mutex};
+
+  if (full.GetAppendSerial() == append_serial)
+    /* unmodified */
+    return false;
+
+  if (full.GetModifySerial() == modify_serial) {
+    full.SyncPoints(v);
+  } else {
+    full.GetPoints(v);
+    modify_serial = full.GetModifySerial();
+  }
+
+  append_serial = full.GetAppendSerial();
+  return true;
+}
+
 void
 TraceComputer::Update(const ComputerSettings &settings_computer,
                       const MoreData &basic, const DerivedInfo &calculated)
@@ -70,6 +70,21 @@ public:
                     std::chrono::duration<unsigned> min_time,
                     const GeoPoint &location, double resolution) const;
 
+  /**
+   * Update a copy of all trace points which was obtained by an
+   * earlier call.  Only the points which were appended since then are
+   * copied, unless the trace was thinned or cleared meanwhile.  The
+   * trace is locked, and the method may be called from any thread.
+   *
+   * @param append_serial the GetAppendSerial() value of the copy; it
+   * is updated by this method
+   * @param modify_serial the GetModifySerial() value of the copy; it
+   * is updated by this method
+   * @return true if the copy was modified
+   */
+  bool LockedSyncTo(TracePointVector &v,
+                    Serial &append_serial, Serial &modify_serial) const;
+
   void Update(const ComputerSettings &settings_computer,
               const MoreData &basic, const DerivedInfo &calculated);
 };
@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "TimingStatusPanel.hpp"
+#include "Computer/StageTimer.hpp"
+#include "Interface.hpp"
+#include "Dialogs/Error.hpp"
+#include "Language/Language.hpp"
+#include "LocalPath.hpp"
+#include "Message.hpp"
+#include "io/FileOutputStream.hxx"
+#include "io/BufferedOutputStream.hxx"
+#include "system/Path.hpp"
+#include "util/StaticString.hxx"
+
+/**
+ * The row of the first stage; row 0 is the column header.
+ */
+static constexpr unsigned FIRST_STAGE_ROW = 1;
+
+[[gnu::const]]
+static double
+ToMilliseconds(uint32_t us) noexcept
+{
+  return us / 1000.;
+}
+
+void
+TimingStatusPanel::Refresh() noexcept
+{
+  StaticString<64> buffer;
+
+  for (unsigned i = 0; i < unsigned(ComputerStage::COUNT); ++i) {
+    const auto s = stage_times[ComputerStage(i)].GetSnapshot();
+    if (s.n == 0) {
+      ClearText(FIRST_STAGE_ROW + i);
+      continue;
+    }
+
+    buffer.Format(_T("%.1f / %.1f / %.1f"),
+                  ToMilliseconds(s.mean), ToMilliseconds(s.p90),
+                  ToMilliseconds(s.max));
+    SetText(FIRST_STAGE_ROW + i, buffer);
+  }
+}
+
+static void
+WriteStageTimes(BufferedOutputStream &os, const ComputerStageTimes &times)
+{
+  os.Write("# durations in microseconds; the rolling window covers the last ");
+  os.Fmt("{} samples\n", StageStatistics::N_SAMPLES);
+  os.Write("stage\tcount\tlast\tmean\tp50\tp90\tmax\tmax_ever\n");
+
+  for (unsigned i = 0; i < unsigned(ComputerStage::COUNT); ++i) {
+    const auto s = times[ComputerStage(i)].GetSnapshot();
+    os.Write(ToString(ComputerStage(i)));
+    os.Fmt("\t{}\t{}\t{}\t{}\t{}\t{}\t{}\n",
+           s.count, s.last, s.mean, s.p50, s.p90, s.max, s.max_ever);
+  }
+
+  for (unsigned i = 0; i < unsigned(ComputerStage::COUNT); ++i) {
+    const auto s = times[ComputerStage(i)].GetSnapshot();
+    if (s.n == 0)
+      continue;
+
+    os.Write("\n");
+    os.Write(ToString(ComputerStage(i)));
+    os.Write("\n");
+
+    for (unsigned b = 0; b < StageStatistics::N_BUCKETS; ++b) {
+      if (s.histogram[b] == 0)
+        continue;
+
+      if (b == StageStatistics::N_BUCKETS - 1)
+        os.Fmt(">={}\t{}\n",
+               StageStatistics::Snapshot::GetBucketLimit(b - 1),
+               s.histogram[b]);
+      else
+        os.Fmt("<{}\t{}\n",
+               StageStatistics::Snapshot::GetBucketLimit(b),
+               s.histogram[b]);
+    }
+  }
+}
+
+void
+TimingStatusPanel::Save() noexcept
+try {
+  const auto path = LocalPath(_T("xcsoar-timing.txt"));
+
+  FileOutputStream file(path);
+  BufferedOutputStream buffered(file);
+  WriteStageTimes(buffered, stage_times);
+  buffered.Flush();
+  file.Commit();
+
+  Message::AddMessage(_("File saved"), path.c_str());
+} catch (...) {
+  ShowError(std::current_exception(), _("Error"));
+}
+
+void
+TimingStatusPanel::Prepare([[maybe_unused]] ContainerWindow &parent,
+                           [[maybe_unused]] const PixelRect &rc) noexcept
+{
+  AddReadOnly(_("Stage"), nullptr, _T("avg / 90% / max [ms]"));
+
+  for (unsigned i = 0; i < unsigned(ComputerStage::COUNT); ++i)
+    AddReadOnly(ToString(ComputerStage(i)));
+
+  AddButton(_("Save"), [this](){ Save(); });
+}
+
+void
+TimingStatusPanel::Show(const PixelRect &rc) noexcept
+{
+  Refresh();
+  CommonInterface::GetLiveBlackboard().AddListener(rate_limiter);
+  StatusPanel::Show(rc);
+}
+
+void
+TimingStatusPanel::Hide() noexcept
+{
+  StatusPanel::Hide();
+  CommonInterface::GetLiveBlackboard().RemoveListener(rate_limiter);
+  rate_limiter.Cancel();
+}
+
+void
+TimingStatusPanel::OnCalculatedUpdate([[maybe_unused]] const MoreData &basic,
+                                      [[maybe_unused]] const DerivedInfo &calculated)
+{
+  Refresh();
+}
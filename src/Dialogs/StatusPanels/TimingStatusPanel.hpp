@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "StatusPanel.hpp"
+#include "Blackboard/RateLimitedBlackboardListener.hpp"
+
+class ComputerStageTimes;
+
+/**
+ * Shows the durations of the calculation stages measured by
+ * #ComputerStageTimes, and allows saving them to a file.
+ */
+class TimingStatusPanel final
+  : public StatusPanel,
+    private NullBlackboardListener {
+  const ComputerStageTimes &stage_times;
+
+  RateLimitedBlackboardListener rate_limiter;
+
+public:
+  TimingStatusPanel(const DialogLook &look,
+                    const ComputerStageTimes &_stage_times) noexcept
+    :StatusPanel(look), stage_times(_stage_times),
+     rate_limiter(*this, std::chrono::seconds(2),
+                  std::chrono::milliseconds(500)) {}
+
+  /* virtual methods from class StatusPanel */
+  void Refresh() noexcept override;
+
+  /* virtual methods from class Widget */
+  void Prepare(ContainerWindow &parent, const PixelRect &rc) noexcept override;
+  void Show(const PixelRect &rc) noexcept override;
+  void Hide() noexcept override;
+
+private:
+  void Save() noexcept;
+
+  /* virtual methods from class BlackboardListener */
+  void OnCalculatedUpdate(const MoreData &basic,
+                          const DerivedInfo &calculated) override;
+};
@@ -13,7 +13,9 @@
 #include "StatusPanels/RulesStatusPanel.hpp"
 #include "StatusPanels/SystemStatusPanel.hpp"
 #include "StatusPanels/TimesStatusPanel.hpp"
+#include "StatusPanels/TimingStatusPanel.hpp"
 #include "Components.hpp"
+#include "Computer/GlideComputer.hpp"
 #include "Engine/Waypoint/Waypoints.hpp"
 #include "Interface.hpp"
 #include "Language/Language.hpp"
@@ -64,6 +66,7 @@ dlgStatusShowModal(int start_page)
   const auto *TaskIcon = enable_icons ? &icons.hBmpTabTask : nullptr;
   const auto *RulesIcon = enable_icons ? &icons.hBmpTabRules : nullptr;
   const auto *TimesIcon = enable_icons ? &icons.hBmpTabTimes : nullptr;
+  const auto *TimingIcon = enable_icons ? &icons.hBmpTabCalculator : nullptr;
 
   widget.AddTab(std::make_unique<FlightStatusPanel>(look,
                                                     std::move(nearest_waypoint)),
@@ -81,6 +84,11 @@ dlgStatusShowModal(int start_page)
   widget.AddTab(std::make_unique<TimesStatusPanel>(look),
                 _("Times"), TimesIcon);
 
+  if (glide_computer != nullptr)
+    widget.AddTab(std::make_unique<TimingStatusPanel>(look,
+                                                      glide_computer->GetStageTimes()),
+                  _("Timing"), TimingIcon);
+
   /* restore previous page */
 
   if (start_page != -1) {
@@ -242,6 +242,7 @@ GlidePolar::IsGlidePossible(const GlideState &task) const
   return true;
 }
 
+#if 0
 /**
  * Finds speed to fly for a given MacCready setting
  * Intended to be used temporarily.
@@ -301,13 +302,32 @@ public:
     return Vopt + m_head_wind;
   }
 };
+#endif
 
 double
 GlidePolar::SpeedToFly(const double stf_sink_rate, const double head_wind) const
 {
   assert(IsValid());
+
+#if 0
+  // this method to be used if polar is not parabolic
   GlidePolarSpeedToFly gp_stf(*this, stf_sink_rate, head_wind, Vmin, Vmax);
   return gp_stf.solve(Vmax);
+#else
+  /* the speed which minimises the MacCready-adjusted sink rate over
+     the ground speed; this is the zero of the derivative of
+     (a*V^2 + b*V + c + mc + s) / (V - w), see
+     GetBestGlideRatioSpeed() */
+  const auto v_lower = std::max(head_wind + 1, Vmin);
+
+  const auto s = head_wind * head_wind +
+    (mc + stf_sink_rate + polar.c + polar.b * head_wind) / polar.a;
+  if (s < 0)
+    /* the glide ratio decreases with speed (strong lift) */
+    return std::min(v_lower, Vmax);
+
+  return std::min(std::max(head_wind + sqrt(s), v_lower), Vmax);
+#endif
 }
 
 double
@@ -7,6 +7,7 @@
 #include "GlideResult.hpp"
 #include "Math/ZeroFinder.hpp"
 
+#include <algorithm>
 #include <cassert>
 
 MacCready::MacCready(const GlideSettings &_settings,
@@ -266,6 +267,43 @@ MacCready::Solve(const GlideState &task) const
     return result;
   }
 
+  return SolveValid(task);
+}
+
+void
+MacCready::SolveEach(std::span<const GlideState> tasks,
+                     std::span<GlideResult> results) const
+{
+  assert(tasks.size() == results.size());
+
+  if (!glide_polar.IsValid()) {
+    /* can't solve without a valid GlidePolar() */
+    for (auto &result : results)
+      result.Reset();
+    return;
+  }
+
+  std::transform(tasks.begin(), tasks.end(), results.begin(),
+                 [this](const GlideState &task){
+                   return SolveValid(task);
+                 });
+}
+
+void
+MacCready::SolveEach(const GlideSettings &settings,
+                     const GlidePolar &glide_polar,
+                     std::span<const GlideState> tasks,
+                     std::span<GlideResult> results)
+{
+  const MacCready mac(settings, glide_polar);
+  mac.SolveEach(tasks, results);
+}
+
+inline GlideResult
+MacCready::SolveValid(const GlideState &task) const
+{
+  assert(glide_polar.IsValid());
+
   if (task.vector.distance <= 0)
     return SolveVertical(task);
 
@@ -367,11 +405,15 @@ MacCready::OptimiseGlide(const GlideState &task, const bool allow_partial) const
 {
   assert(glide_polar.GetMC() <= 0);
 
-  MacCreadyVopt mc_vopt(task, *this,
-                       glide_polar.GetVMin(), glide_polar.GetVMax(),
-                       allow_partial);
+  const auto v_min = glide_polar.GetVMin(), v_max = glide_polar.GetVMax();
+  MacCreadyVopt mc_vopt(task, *this, v_min, v_max, allow_partial);
 
-  return mc_vopt.Result(glide_polar.GetVMin());
+  /* the best glide ratio speed for the head wind component is exact
+     without cross wind, and a good initial guess otherwise */
+  const auto v_init =
+    std::clamp(glide_polar.GetBestGlideRatioSpeed(task.head_wind),
+               v_min, v_max);
+  return mc_vopt.Result(v_init);
 }
 
 /*
@@ -5,6 +5,8 @@
 
 #include "util/Compiler.h"
 
+#include <span>
+
 struct GlideSettings;
 struct GlideState;
 struct GlideResult;
@@ -85,6 +87,23 @@ public:
                            const GlidePolar &glide_polar,
                            const GlideState &task);
 
+  /**
+   * Convenience wrapper which calls Solve() for each task, e.g. for a
+   * list of landable candidates.  The #MacCready object and the
+   * #GlidePolar check are set up only once, but each task is still
+   * solved on its own; this is not a vectorised kernel.
+   *
+   * @param tasks The tasks for which solutions are desired
+   * @param results Receives one glide result per task
+   */
+  void SolveEach(std::span<const GlideState> tasks,
+                 std::span<GlideResult> results) const;
+
+  static void SolveEach(const GlideSettings &settings,
+                        const GlidePolar &glide_polar,
+                        std::span<const GlideState> tasks,
+                        std::span<GlideResult> results);
+
   /**
    * Calculates the glide solution for a classical MacCready theory task
    * with no climb component (pure glide).  This is used internally to
@@ -107,6 +126,12 @@ public:
                          const bool allow_partial = false) const;
 
 private:
+  /**
+   * Like Solve(), but assumes that the #GlidePolar is valid.
+   */
+  [[gnu::pure]]
+  GlideResult SolveValid(const GlideState &task) const;
+
   /**
    * Calculates the glide solution for a classical MacCready theory task
    * with no climb component (pure glide).  This is used internally to
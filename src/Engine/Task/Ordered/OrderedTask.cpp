@@ -6,6 +6,7 @@
 #include "Points/OrderedTaskPoint.hpp"
 #include "Points/StartPoint.hpp"
 #include "Points/FinishPoint.hpp"
+#include "Points/AATPoint.hpp"
 #include "Task/Solvers/TaskMacCreadyTravelled.hpp"
 #include "Task/Solvers/TaskMacCreadyRemaining.hpp"
 #include "Task/Solvers/TaskMacCreadyTotal.hpp"
@@ -96,6 +97,7 @@ void
 OrderedTask::SetTaskBehaviour(const TaskBehaviour &tb)
 {
   AbstractTask::SetTaskBehaviour(tb);
+  target_optimiser.Reset();
 
   ::SetTaskBehaviour(task_points, tb);
   ::SetTaskBehaviour(optional_start_points, tb);
@@ -124,6 +126,7 @@ void
 OrderedTask::UpdateGeometry()
 {
   UpdateStatsGeometry();
+  target_optimiser.Reset();
 
   if (task_points.empty())
     return;
@@ -593,9 +596,21 @@ OrderedTask::UpdateIdle(const AircraftState &state,
 
   if (HasStart() && task_behaviour.optimise_targets_range &&
       GetOrderedTaskSettings().aat_min_time.count() > 0) {
+    const auto t_target = GetOrderedTaskSettings().aat_min_time +
+      task_behaviour.optimise_targets_margin;
+
+    /* skip the search if nothing has changed noticeably since the
+       last one; else use its results as initial guesses */
+    const auto t_remaining = fdim(t_target, stats.total.time_elapsed);
+    if (target_optimiser.IsUpToDate(state, glide_polar, t_remaining,
+                                    active_task_point,
+                                    task_behaviour.optimise_targets_bearing,
+                                    GetPoints()))
+      return true;
 
-    CalcMinTarget(state, glide_polar,
-                  GetOrderedTaskSettings().aat_min_time + task_behaviour.optimise_targets_margin);
+    target_optimiser.min_target =
+      CalcMinTarget(state, glide_polar, t_target,
+                    target_optimiser.min_target);
 
     if (task_behaviour.optimise_targets_bearing &&
         task_points[active_task_point]->GetType() == TaskPointType::AAT) {
@@ -605,8 +620,16 @@ OrderedTask::UpdateIdle(const AircraftState &state,
       TaskOptTarget tot(tps, active_task_point, state,
                         task_behaviour.glide, glide_polar,
                         *ap, task_projection, *taskpoint_start);
-      tot.search(0.5);
+      target_optimiser.opt_target =
+        tot.search(target_optimiser.opt_target >= 0
+                   ? target_optimiser.opt_target
+                   : 0.5);
     }
+
+    target_optimiser.Update(state, glide_polar, t_remaining,
+                            active_task_point,
+                            task_behaviour.optimise_targets_bearing,
+                            GetPoints(), GetTargetResolution());
     retval = true;
   }
 
@@ -1027,10 +1050,40 @@ OrderedTask::CalcEffectiveMC(const AircraftState &aircraft,
 }
 
 
+double
+OrderedTask::GetTargetResolution() const noexcept
+{
+  /* no adjustable target: don't skip any search */
+  double resolution = 0;
+
+  if (!stats.has_targets)
+    return resolution;
+
+  bool found = false;
+  for (unsigned i = active_task_point; i < task_points.size(); ++i) {
+    if (task_points[i]->GetType() != TaskPointType::AAT)
+      continue;
+
+    const AATPoint &ap = (const AATPoint &)*task_points[i];
+    if (ap.IsTargetLocked())
+      continue;
+
+    const double r = TaskMinTarget::TOLERANCE *
+      ap.GetLocationMin().Distance(ap.GetLocationMax());
+    if (!found || r < resolution) {
+      resolution = r;
+      found = true;
+    }
+  }
+
+  return resolution;
+}
+
 inline double
 OrderedTask::CalcMinTarget(const AircraftState &aircraft,
                            const GlidePolar &glide_polar,
-                           const FloatDuration t_target) noexcept
+                           const FloatDuration t_target,
+                           double p_start) noexcept
 {
   if (stats.has_targets) {
     // only perform scan if modification is possible
@@ -1040,7 +1093,7 @@ OrderedTask::CalcMinTarget(const AircraftState &aircraft,
     TaskMinTarget bmt(tps, active_task_point, aircraft,
                       task_behaviour.glide, glide_polar,
                       t_rem, *taskpoint_start);
-    auto p = bmt.search(0);
+    auto p = bmt.search(p_start);
     return p;
   }
 
@@ -1098,6 +1151,7 @@ OrderedTask::Reset() noexcept
   stats.task_finished = false;
   stats.start.task_started = false;
   task_advance.Reset();
+  target_optimiser.Reset();
   SetActiveTaskPoint(0);
   UpdateStatsGeometry();
 }
@@ -6,6 +6,7 @@
 #include "Geo/Flat/TaskProjection.hpp"
 #include "Task/AbstractTask.hpp"
 #include "SmartTaskAdvance.hpp"
+#include "TargetOptimiserState.hpp"
 #include "Waypoint/Ptr.hpp"
 #include "util/DereferenceIterator.hxx"
 #include "util/StaticString.hxx"
@@ -69,6 +70,11 @@ private:
   std::unique_ptr<AbstractTaskFactory> active_factory;
   OrderedTaskSettings ordered_settings;
   SmartTaskAdvance task_advance;
+
+  /**
+   * Results of the last AAT target optimisation in UpdateIdle().
+   */
+  TargetOptimiserState target_optimiser;
   std::unique_ptr<TaskDijkstraMin> dijkstra_min;
   std::unique_ptr<TaskDijkstraMax> dijkstra_max;
 
@@ -437,12 +443,23 @@ private:
    *
    * @param state_now Aircraft state
    * @param t_target Desired time for remainder of task (s)
+   * @param p_start Initial guess of the target range parameter
+   * (0-1), e.g. the result of the previous call
    *
    * @return Target range parameter (0-1)
    */
   double CalcMinTarget(const AircraftState &state_now,
                        const GlidePolar &glide_polar,
-                       const FloatDuration t_target) noexcept;
+                       const FloatDuration t_target,
+                       double p_start=0) noexcept;
+
+  /**
+   * Determine how precisely CalcMinTarget() places the targets [m]:
+   * its tolerance applied to the smallest adjustable AAT area ahead.
+   * Returns 0 if there is no adjustable target.
+   */
+  [[gnu::pure]]
+  double GetTargetResolution() const noexcept;
 
   /**
    * Sets previous/next taskpoint pointers for task point at specified
@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "TargetOptimiserState.hpp"
+#include "Navigation/Aircraft.hpp"
+#include "GlideSolvers/GlidePolar.hpp"
+
+#include <math.h>
+
+/**
+ * Calculate the magnitude of the difference between two speed
+ * vectors.
+ */
+[[gnu::pure]]
+static double
+VectorDifference(const SpeedVector a, const SpeedVector b) noexcept
+{
+  const double cos_delta = (a.bearing - b.bearing).cos();
+  return sqrt(fmax(a.norm * a.norm + b.norm * b.norm
+                   - 2 * a.norm * b.norm * cos_delta, 0.));
+}
+
+TargetOptimiserState::Inputs
+TargetOptimiserState::MakeInputs(const AircraftState &state,
+                                 const GlidePolar &glide_polar,
+                                 FloatDuration t_remaining,
+                                 unsigned active_task_point,
+                                 bool optimise_bearing) noexcept
+{
+  return {
+    state.location,
+    state.altitude,
+    state.wind,
+    glide_polar.GetMC(),
+    glide_polar.GetBugs(),
+    glide_polar.GetBallast(),
+    t_remaining,
+    active_task_point,
+    optimise_bearing,
+  };
+}
+
+bool
+TargetOptimiserState::IsUpToDate(const Inputs &inputs) const noexcept
+{
+  return inputs.active_task_point == last.active_task_point &&
+    inputs.optimise_bearing == last.optimise_bearing &&
+    inputs.bugs == last.bugs &&
+    inputs.ballast == last.ballast &&
+    fabs(inputs.mc - last.mc) < MC_TOLERANCE &&
+    fabs(inputs.altitude - last.altitude) < ALTITUDE_TOLERANCE &&
+    std::chrono::abs(inputs.t_remaining - last.t_remaining) < TIME_TOLERANCE &&
+    VectorDifference(inputs.wind, last.wind) < WIND_TOLERANCE &&
+    inputs.location.Distance(last.location) < location_tolerance;
+}
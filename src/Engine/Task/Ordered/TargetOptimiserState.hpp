@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Geo/GeoPoint.hpp"
+#include "Geo/SpeedVector.hpp"
+#include "time/FloatDuration.hxx"
+
+#include <vector>
+
+struct AircraftState;
+class GlidePolar;
+
+/**
+ * Remembers the inputs and the results of the last AAT target
+ * optimisation performed by OrderedTask::UpdateIdle().  The results
+ * are used as initial guesses for the next search, and the search is
+ * skipped altogether if none of the inputs has changed by more than
+ * a small tolerance.
+ */
+class TargetOptimiserState {
+  /* tolerances below which a new search is not worth the effort */
+  static constexpr double ALTITUDE_TOLERANCE = 10; // m
+  static constexpr double WIND_TOLERANCE = 0.5; // m/s
+  static constexpr double MC_TOLERANCE = 0.05; // m/s
+  static constexpr FloatDuration TIME_TOLERANCE{5}; // s
+
+  struct Inputs {
+    GeoPoint location;
+    double altitude;
+    SpeedVector wind;
+    double mc, bugs, ballast;
+    FloatDuration t_remaining;
+    unsigned active_task_point;
+    bool optimise_bearing;
+  } last;
+
+  /**
+   * The location of all task points (the target for AAT points) as
+   * left behind by the last search.  This detects targets which
+   * were moved by somebody else.
+   */
+  std::vector<GeoPoint> locations;
+
+  /**
+   * Aircraft movements shorter than this [m] are ignored; see
+   * Update().
+   */
+  double location_tolerance = 0;
+
+  bool valid = false;
+
+public:
+  /**
+   * The result of the last TaskMinTarget search (target range
+   * parameter).
+   */
+  double min_target = 0;
+
+  /**
+   * The result of the last TaskOptTarget search (isoline parameter),
+   * or a negative value if there is none.
+   */
+  double opt_target = -1;
+
+  /**
+   * Forget everything, e.g. after the task has been modified.
+   */
+  void Reset() noexcept {
+    valid = false;
+    locations.clear();
+    min_target = 0;
+    opt_target = -1;
+  }
+
+  /**
+   * Check whether the last search is still good enough for the
+   * given inputs.
+   *
+   * @param tps the task points
+   */
+  template<typename T>
+  [[gnu::pure]]
+  bool IsUpToDate(const AircraftState &state, const GlidePolar &glide_polar,
+                  FloatDuration t_remaining, unsigned active_task_point,
+                  bool optimise_bearing, const T &tps) const noexcept {
+    if (!valid ||
+        !IsUpToDate(MakeInputs(state, glide_polar, t_remaining,
+                               active_task_point, optimise_bearing)))
+      return false;
+
+    auto l = locations.begin();
+    for (const auto &tp : tps) {
+      if (l == locations.end() || tp.GetLocationRemaining() != *l)
+        return false;
+      ++l;
+    }
+
+    return l == locations.end();
+  }
+
+  /**
+   * Remember the inputs of a search which has just been completed.
+   *
+   * @param _location_tolerance the distance [m] the aircraft may move
+   * before the search is repeated; this should be the resolution of
+   * the search (i.e. how precisely it places the targets), because a
+   * search after a shorter movement could not yield a target which is
+   * noticeably different
+   */
+  template<typename T>
+  void Update(const AircraftState &state, const GlidePolar &glide_polar,
+              FloatDuration t_remaining, unsigned active_task_point,
+              bool optimise_bearing, const T &tps,
+              double _location_tolerance) noexcept {
+    last = MakeInputs(state, glide_polar, t_remaining,
+                      active_task_point, optimise_bearing);
+    location_tolerance = _location_tolerance;
+
+    locations.clear();
+    for (const auto &tp : tps)
+      locations.push_back(tp.GetLocationRemaining());
+
+    valid = true;
+  }
+
+private:
+  [[gnu::pure]]
+  static Inputs MakeInputs(const AircraftState &state,
+                           const GlidePolar &glide_polar,
+                           FloatDuration t_remaining,
+                           unsigned active_task_point,
+                           bool optimise_bearing) noexcept;
+
+  [[gnu::pure]]
+  bool IsUpToDate(const Inputs &inputs) const noexcept;
+};
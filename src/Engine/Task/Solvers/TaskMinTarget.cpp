@@ -31,12 +31,12 @@ TaskMinTarget::search(const double tp)
 
   force_current = false;
   /// @todo if search fails, force current
-  const auto p = find_zero(tp);
+  const auto p = find_zero_near(tp, WARM_START_RADIUS);
   if (valid(p)) {
     return p;
   } else {
     force_current = true;
-    return find_zero(tp);
+    return find_zero_near(tp, WARM_START_RADIUS);
   }
 }
 
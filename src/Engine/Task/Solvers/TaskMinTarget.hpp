@@ -20,8 +20,20 @@ class StartPoint;
  *   target.
  */
 class TaskMinTarget final : private ZeroFinder {
+public:
+  /**
+   * The resolution of the search, as a fraction of the distance
+   * between the minimum and the maximum location of each AAT point.
+   */
   static constexpr double TOLERANCE = 0.002;
 
+private:
+  /**
+   * Half width of the bracket around the initial guess which is
+   * searched first.
+   */
+  static constexpr double WARM_START_RADIUS = 0.05;
+
   TaskMacCreadyRemaining tm;
   GlideResult res;
   const AircraftState &aircraft;
@@ -77,7 +89,8 @@ public:
    *
    * Running this adjusts the target values for AAT task points.
    *
-   * @param p Default range (0-1)
+   * @param p Default range (0-1), e.g. the result of the previous
+   * search
    *
    * @return Range value for solution
    */
@@ -6,8 +6,8 @@
 #include "AlternateList.hpp"
 #include "Navigation/Aircraft.hpp"
 #include "Task/Visitors/TaskPointVisitor.hpp"
-#include "Task/Solvers/TaskSolution.hpp"
 #include "GlideSolvers/GlidePolar.hpp"
+#include "GlideSolvers/MacCready.hpp"
 #include "Waypoint/Waypoints.hpp"
 #include "util/Clamp.hpp"
 
@@ -98,10 +98,32 @@ IsReachable(const GlideResult &result, bool final_glide) noexcept
     : result.IsAchievable();
 }
 
+void
+AbortTask::SolveCandidates(const AircraftState &state,
+                           AlternateList &candidates,
+                           const GlidePolar &polar) noexcept
+{
+  glide_states.clear();
+  for (const auto &i : candidates)
+    /* this is what GlideState::Remaining() would calculate for an
+       UnorderedTaskPoint, without having to construct one */
+    glide_states.emplace_back(GeoVector(state.location, i.waypoint->location),
+                              std::max(0., i.waypoint->GetElevationOrZero() +
+                                       task_behaviour.safety_height_arrival),
+                              state.altitude, state.wind);
+
+  glide_results.resize(candidates.size());
+  MacCready::SolveEach(task_behaviour.glide, polar, glide_states,
+                       glide_results);
+
+  for (std::size_t i = 0; i < candidates.size(); ++i)
+    candidates[i].solution = glide_results[i];
+}
+
 bool
 AbortTask::FillReachable(const AircraftState &state,
                          AlternateList &approx_waypoints,
-                         const GlidePolar &polar, bool only_airfield,
+                         bool only_airfield,
                          bool final_glide, [[maybe_unused]] bool safety) noexcept
 {
   if (IsTaskFull() || approx_waypoints.empty())
@@ -119,10 +141,7 @@ AbortTask::FillReachable(const AircraftState &state,
       continue;
     }
 
-    UnorderedTaskPoint t(v->waypoint, task_behaviour);
-    GlideResult result =
-        TaskSolution::GlideSolutionRemaining(t, state,
-                                             task_behaviour.glide, polar);
+    const GlideResult &result = v->solution;
 
     if (IsReachable(result, final_glide)) {
       bool intersects = false;
@@ -210,19 +229,23 @@ AbortTask::UpdateSample(const AircraftState &state,
     return false;
   }
 
+  /* solve all candidates at once; the FillReachable() passes below
+     only filter and sort them */
+  SolveCandidates(state, approx_waypoints, glide_polar);
+
   // sort by arrival time
 
   // first try with final glide only
-  reachable_landable |=  FillReachable(state, approx_waypoints, glide_polar,
+  reachable_landable |=  FillReachable(state, approx_waypoints,
                                        true, true, true);
-  reachable_landable |=  FillReachable(state, approx_waypoints, glide_polar,
+  reachable_landable |=  FillReachable(state, approx_waypoints,
                                        false, true, true);
 
   // inform clients that the landable reachable scan has been performed 
   ClientUpdate(state, true);
 
   // now try without final glide constraint and not preferring airports
-  FillReachable(state, approx_waypoints, glide_polar, false, false, false);
+  FillReachable(state, approx_waypoints, false, false, false);
 
   // inform clients that the landable unreachable scan has been performed 
   ClientUpdate(state, false);
@@ -5,6 +5,8 @@
 
 #include "UnorderedTask.hpp"
 #include "UnorderedTaskPoint.hpp"
+#include "GlideSolvers/GlideState.hpp"
+#include "GlideSolvers/GlideResult.hpp"
 
 #include <vector>
 #include <cassert>
@@ -59,6 +61,10 @@ private:
   unsigned active_waypoint;
   bool reachable_landable;
 
+  /* buffers for SolveCandidates(), kept to avoid reallocation */
+  std::vector<GlideState> glide_states;
+  std::vector<GlideResult> glide_results;
+
 public:
   /** 
    * Base constructor.
@@ -135,14 +141,26 @@ protected:
   double GetAbortRange(const AircraftState &state_now,
                        const GlidePolar &glide_polar) const noexcept;
 
+  /**
+   * Calculate the glide solutions of all candidate waypoints in one
+   * pass and store them in AlternatePoint::solution.
+   *
+   * @param state Aircraft state
+   * @param candidates List of candidate waypoints
+   * @param polar Polar used for the solutions
+   */
+  void SolveCandidates(const AircraftState &state,
+                       AlternateList &candidates,
+                       const GlidePolar &polar) noexcept;
+
   /**
    * Fill abort task list with candidate waypoints given a list of
-   * waypoints satisfying approximate range queries.  Can be used
+   * waypoints satisfying approximate range queries.  Uses the
+   * solutions calculated by SolveCandidates().  Can be used
    * to add airfields only, or landpoints.
    *
    * @param state Aircraft state
    * @param approx_waypoints List of candidate waypoints
-   * @param polar Polar used for tests
    * @param only_airfield If true, only add waypoints that are airfields.
    * @param final_glide Whether solution must be glide only or climb allowed
    * @param safety Whether solution uses safety polar
@@ -151,7 +169,7 @@ protected:
    */
   bool FillReachable(const AircraftState &state,
                      AlternateList &approx_waypoints,
-                     const GlidePolar &polar, bool only_airfield,
+                     bool only_airfield,
                      bool final_glide, bool safety) noexcept;
 
 protected:
@@ -411,6 +411,22 @@ Trace::SyncPoints(TracePointerVector &v) const
   return true;
 }
 
+bool
+Trace::SyncPoints(TracePointVector &v) const
+{
+  assert(v.size() <= size());
+
+  if (v.size() == size())
+    /* no news */
+    return false;
+
+  v.reserve(size());
+  std::copy(std::prev(end(), size() - v.size()), end(),
+            std::back_inserter(v));
+  assert(v.size() == size());
+  return true;
+}
+
 void
 Trace::GetPoints(TracePointVector &v, const Time min_time,
                  const GeoPoint &location, double min_distance) const
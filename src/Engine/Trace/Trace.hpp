@@ -382,6 +382,16 @@ public:
    */
   bool SyncPoints(TracePointerVector &v) const;
 
+  /**
+   * Copy the points which were appended to this object to the given
+   * #TracePointVector, which must have been obtained by GetPoints()
+   * earlier.  This must not be called after thinning has occurred,
+   * see GetModifySerial().
+   *
+   * @return true if new points were added
+   */
+  bool SyncPoints(TracePointVector &v) const;
+
   /**
    * Fill the vector with trace points, not before #min_time, minimum
    * resolution #min_distance.
@@ -0,0 +1,196 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "BulkWaypoints.hpp"
+#include "Geo/Flat/FlatProjection.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+BulkWaypoints::BulkWaypoints() noexcept = default;
+
+std::size_t
+BulkWaypoints::FindSlot(unsigned id) const noexcept
+{
+  /* records are appended in ascending id order, and the chunks keep
+     erased records, so a binary search over the chunks works */
+  std::size_t low = 0, high = records.size();
+  while (low < high) {
+    const std::size_t middle = (low + high) / 2;
+    if (GetRecord(middle).id < id)
+      low = middle + 1;
+    else
+      high = middle;
+  }
+
+  return low < records.size() && GetRecord(low).id == id
+    ? low
+    : records.size();
+}
+
+WaypointPtr
+BulkWaypoints::Append(Waypoint &&wp) noexcept
+{
+  assert(records.empty() || GetRecord(records.size() - 1).id < wp.id);
+
+  if (chunks.empty() || chunks.back()->size() >= CHUNK_SIZE) {
+    chunks.emplace_back(std::make_shared<Chunk>());
+    chunks.back()->reserve(CHUNK_SIZE);
+  }
+
+  comments.Intern(wp.comment);
+
+  const auto &chunk = chunks.back();
+  chunk->emplace_back(std::move(wp));
+
+  /* the new pointer shares ownership of its chunk */
+  records.emplace_back(chunk, &chunk->back());
+  ++n_live;
+  optimised = false;
+
+  return records.back();
+}
+
+bool
+BulkWaypoints::Erase(const Waypoint &wp) noexcept
+{
+  const std::size_t slot = FindSlot(wp.id);
+  if (slot >= records.size() || records[slot].get() != &wp)
+    return false;
+
+  /* the index still refers to this slot until the next Optimise(),
+     but all queries skip nullptr records */
+  records[slot].reset();
+  --n_live;
+  return true;
+}
+
+void
+BulkWaypoints::Clear() noexcept
+{
+  /* existing WaypointPtr instances keep their chunks alive */
+  chunks.clear();
+  chunks.shrink_to_fit();
+  comments.Clear();
+  records.clear();
+  records.shrink_to_fit();
+  n_live = 0;
+  ClearIndex();
+  optimised = true;
+}
+
+WaypointPtr
+BulkWaypoints::LookupId(unsigned id) const noexcept
+{
+  const std::size_t slot = FindSlot(id);
+  return slot < records.size()
+    ? records[slot]
+    : nullptr;
+}
+
+void
+BulkWaypoints::ClearIndex() noexcept
+{
+  index_x.clear();
+  index_y.clear();
+  index_items.clear();
+  cell_offsets.clear();
+}
+
+unsigned
+BulkWaypoints::ClampColumn(int64_t x) const noexcept
+{
+  return std::clamp<int64_t>((x - grid_origin.x) / int64_t(cell_size),
+                             0, columns - 1);
+}
+
+unsigned
+BulkWaypoints::ClampRow(int64_t y) const noexcept
+{
+  return std::clamp<int64_t>((y - grid_origin.y) / int64_t(cell_size),
+                             0, rows - 1);
+}
+
+void
+BulkWaypoints::Optimise(const FlatProjection &projection) noexcept
+{
+  ClearIndex();
+  optimised = true;
+
+  if (n_live == 0)
+    return;
+
+  /* pass 1: project all records and determine the bounds */
+
+  int left = std::numeric_limits<int>::max(), top = left;
+  int right = std::numeric_limits<int>::min(), bottom = right;
+
+  for (std::size_t i = 0; i < records.size(); ++i) {
+    if (records[i] == nullptr)
+      continue;
+
+    Waypoint &wp = GetRecord(i);
+    wp.Project(projection);
+
+    left = std::min(left, wp.flat_location.x);
+    right = std::max(right, wp.flat_location.x);
+    top = std::min(top, wp.flat_location.y);
+    bottom = std::max(bottom, wp.flat_location.y);
+  }
+
+  /* choose a grid with roughly ITEMS_PER_CELL items per cell */
+
+  const uint64_t width = uint64_t(int64_t(right) - left) + 1;
+  const uint64_t height = uint64_t(int64_t(bottom) - top) + 1;
+  const uint64_t n_cells = std::max<uint64_t>(n_live / ITEMS_PER_CELL, 1);
+
+  grid_origin = FlatGeoPoint(left, top);
+  cell_size = std::max<unsigned>(std::ceil(std::sqrt(double(width) * height /
+                                                     n_cells)),
+                                 1);
+
+  /* degenerate (e.g. nearly collinear) distributions may need far
+     more cells than items; limit the grid size */
+  while (true) {
+    columns = width / cell_size + 1;
+    rows = height / cell_size + 1;
+    if (uint64_t(columns) * rows <= 4 * n_cells + 16)
+      break;
+
+    cell_size *= 2;
+  }
+
+  /* pass 2: counting sort into the grid cells */
+
+  cell_offsets.assign(std::size_t(columns) * rows + 1, 0);
+
+  const auto GetCell = [this](const FlatGeoPoint &p) -> std::size_t {
+    return std::size_t(unsigned(p.y - grid_origin.y) / cell_size) * columns
+      + unsigned(p.x - grid_origin.x) / cell_size;
+  };
+
+  for (std::size_t i = 0; i < records.size(); ++i)
+    if (records[i] != nullptr)
+      ++cell_offsets[GetCell(records[i]->flat_location) + 1];
+
+  for (std::size_t i = 1; i < cell_offsets.size(); ++i)
+    cell_offsets[i] += cell_offsets[i - 1];
+
+  index_x.resize(n_live);
+  index_y.resize(n_live);
+  index_items.resize(n_live);
+
+  std::vector<unsigned> fill(cell_offsets.begin(), cell_offsets.end() - 1);
+  for (std::size_t i = 0; i < records.size(); ++i) {
+    if (records[i] == nullptr)
+      continue;
+
+    const FlatGeoPoint &p = records[i]->flat_location;
+    const unsigned position = fill[GetCell(p)]++;
+    index_x[position] = p.x;
+    index_y[position] = p.y;
+    index_items[position] = i;
+  }
+}
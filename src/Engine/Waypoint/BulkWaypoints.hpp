@@ -0,0 +1,312 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Ptr.hpp"
+#include "Waypoint.hpp"
+#include "util/StringPool.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+class FlatProjection;
+
+/**
+ * A compact store for waypoints which are loaded in bulk from
+ * waypoint files and are (almost) never modified at runtime.  It is
+ * used by #Waypoints next to its #QuadTree, which holds the user
+ * waypoints.
+ *
+ * The records are allocated in chunks of #CHUNK_SIZE; each
+ * #WaypointPtr handed out is an aliasing std::shared_ptr referring to
+ * its chunk, so there is no per-waypoint heap allocation and no
+ * per-waypoint control block.  A #WaypointPtr which outlives Clear()
+ * (e.g. one held by a task while the waypoint file is reloaded) keeps
+ * only its own chunk alive, not the whole old store.
+ *
+ * Waypoints with the same comment share one buffer (see
+ * #StringPool).
+ *
+ * The spatial index is a uniform grid over the flat projected
+ * coordinates.  The coordinates are kept in separate arrays sorted by
+ * grid cell (structure of arrays), so range queries scan contiguous
+ * memory and only touch the #Waypoint records of matching items.
+ * Rebuilding the index after loading is a single linear pass.
+ *
+ * Records cannot be modified after they have been appended.  Erasing
+ * a record only unlinks it; its memory is released when the store is
+ * cleared and the last #WaypointPtr referring to its chunk is gone.
+ */
+class BulkWaypoints {
+  /**
+   * The number of records per chunk.
+   */
+  static constexpr std::size_t CHUNK_SIZE = 256;
+
+  /**
+   * The average number of items per grid cell the index aims for.
+   */
+  static constexpr std::size_t ITEMS_PER_CELL = 8;
+
+  /**
+   * A chunk is a std::vector which is reserved to #CHUNK_SIZE
+   * elements and never grows beyond, therefore the addresses of its
+   * elements remain stable.
+   */
+  using Chunk = std::vector<Waypoint>;
+
+  std::vector<std::shared_ptr<Chunk>> chunks;
+
+  /**
+   * The comments of all records.
+   */
+  StringPool comments;
+
+  /**
+   * All records in the order they were appended, which is also the
+   * order of #Waypoint::id.  Erased records are nullptr.
+   */
+  std::vector<WaypointPtr> records;
+
+  /**
+   * The number of non-erased items in #records.
+   */
+  unsigned n_live = 0;
+
+  /**
+   * Is the spatial index up to date?
+   */
+  bool optimised = true;
+
+  /* the spatial index; the following three arrays are sorted by
+     grid cell in row-major order */
+
+  std::vector<int> index_x, index_y;
+
+  /**
+   * Indexes into #records.
+   */
+  std::vector<unsigned> index_items;
+
+  /**
+   * For each grid cell, the offset of its first item in the index
+   * arrays.  The last element is the total number of items.
+   */
+  std::vector<unsigned> cell_offsets;
+
+  FlatGeoPoint grid_origin;
+  unsigned cell_size, columns, rows;
+
+public:
+  class const_iterator {
+    friend class BulkWaypoints;
+
+    using Base = std::vector<WaypointPtr>::const_iterator;
+    Base i, end;
+
+    const_iterator(Base _i, Base _end) noexcept
+      :i(_i), end(_end) {
+      SkipErased();
+    }
+
+    void SkipErased() noexcept {
+      while (i != end && *i == nullptr)
+        ++i;
+    }
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = const WaypointPtr;
+    using pointer = const WaypointPtr *;
+    using reference = const WaypointPtr &;
+
+    bool operator==(const const_iterator &other) const noexcept {
+      return i == other.i;
+    }
+
+    bool operator!=(const const_iterator &other) const noexcept {
+      return i != other.i;
+    }
+
+    const_iterator &operator++() noexcept {
+      ++i;
+      SkipErased();
+      return *this;
+    }
+
+    reference operator*() const noexcept {
+      return *i;
+    }
+
+    pointer operator->() const noexcept {
+      return &*i;
+    }
+  };
+
+  BulkWaypoints() noexcept;
+  BulkWaypoints(const BulkWaypoints &) = delete;
+  BulkWaypoints &operator=(const BulkWaypoints &) = delete;
+
+  bool IsEmpty() const noexcept {
+    return n_live == 0;
+  }
+
+  unsigned size() const noexcept {
+    return n_live;
+  }
+
+  /**
+   * Is the spatial index up to date?  Returns true if the store is
+   * empty.
+   */
+  bool IsOptimised() const noexcept {
+    return optimised;
+  }
+
+  void ScheduleOptimise() noexcept {
+    optimised = false;
+  }
+
+  /**
+   * Move a waypoint into the store.  Its #Waypoint::id must have
+   * been assigned already and must be larger than all ids in this
+   * store.  Optimise() must be called before spatial queries can find
+   * the new record.
+   */
+  WaypointPtr Append(Waypoint &&wp) noexcept;
+
+  /**
+   * Remove the specified waypoint from the store.
+   *
+   * @return false if the waypoint is not in this store
+   */
+  bool Erase(const Waypoint &wp) noexcept;
+
+  void Clear() noexcept;
+
+  [[gnu::pure]]
+  WaypointPtr LookupId(unsigned id) const noexcept;
+
+  /**
+   * Project all records and rebuild the spatial index.
+   */
+  void Optimise(const FlatProjection &projection) noexcept;
+
+  /**
+   * Invoke the visitor on all records within the specified range
+   * (in flat projected units).
+   */
+  template<typename V>
+  void VisitWithinRange(FlatGeoPoint location, unsigned range,
+                        V &&visitor) const {
+    ForEachCandidate(location, range,
+                     [&](unsigned item, uint64_t){
+                       visitor(records[item]);
+                     });
+  }
+
+  /**
+   * Find the nearest record within the specified range (in flat
+   * projected units) which matches the predicate.
+   *
+   * @return a pointer to the record (or nullptr if none was found)
+   * and its squared distance
+   */
+  template<typename P>
+  [[gnu::pure]]
+  std::pair<const WaypointPtr *, uint64_t>
+  FindNearestIf(FlatGeoPoint location, unsigned range,
+                P &&predicate) const noexcept {
+    const WaypointPtr *nearest = nullptr;
+    uint64_t nearest_square_distance = Square(range);
+
+    ForEachCandidate(location, range,
+                     [&](unsigned item, uint64_t square_distance){
+                       if (square_distance <= nearest_square_distance &&
+                           predicate(*records[item])) {
+                         nearest = &records[item];
+                         nearest_square_distance = square_distance;
+                       }
+                     });
+
+    return {nearest, nearest_square_distance};
+  }
+
+  const_iterator begin() const noexcept {
+    return {records.begin(), records.end()};
+  }
+
+  const_iterator end() const noexcept {
+    return {records.end(), records.end()};
+  }
+
+private:
+  static constexpr uint64_t Square(int64_t x) noexcept {
+    return uint64_t(x * x);
+  }
+
+  Waypoint &GetRecord(std::size_t i) noexcept {
+    return (*chunks[i / CHUNK_SIZE])[i % CHUNK_SIZE];
+  }
+
+  const Waypoint &GetRecord(std::size_t i) const noexcept {
+    return (*chunks[i / CHUNK_SIZE])[i % CHUNK_SIZE];
+  }
+
+  /**
+   * Find the #records slot of the specified id.  Erased records are
+   * still in their chunks, so this works even if there are holes.
+   *
+   * @return the slot or records.size() if the id is unknown
+   */
+  [[gnu::pure]]
+  std::size_t FindSlot(unsigned id) const noexcept;
+
+  void ClearIndex() noexcept;
+
+  [[gnu::pure]]
+  unsigned ClampColumn(int64_t x) const noexcept;
+
+  [[gnu::pure]]
+  unsigned ClampRow(int64_t y) const noexcept;
+
+  /**
+   * Call the function with each live item (index into #records)
+   * within the specified range and its squared distance.
+   */
+  template<typename F>
+  void ForEachCandidate(FlatGeoPoint location, unsigned range,
+                        F &&f) const {
+    if (index_items.empty())
+      return;
+
+    const uint64_t square_range = Square(range);
+    const unsigned column_begin = ClampColumn(int64_t(location.x) - range);
+    const unsigned column_end = ClampColumn(int64_t(location.x) + range) + 1;
+    const unsigned row_begin = ClampRow(int64_t(location.y) - range);
+    const unsigned row_end = ClampRow(int64_t(location.y) + range) + 1;
+
+    for (unsigned row = row_begin; row < row_end; ++row) {
+      /* thanks to the row-major order, the selected cells of one row
+         are contiguous in the index arrays */
+      const unsigned begin = cell_offsets[row * columns + column_begin];
+      const unsigned end = cell_offsets[row * columns + column_end];
+
+      for (unsigned i = begin; i < end; ++i) {
+        const uint64_t square_distance =
+          Square(int64_t(index_x[i]) - location.x) +
+          Square(int64_t(index_y[i]) - location.y);
+        if (square_distance > square_range)
+          continue;
+
+        const unsigned item = index_items[i];
+        if (records[item] != nullptr)
+          f(item, square_distance);
+      }
+    }
+  }
+};
@@ -5,6 +5,7 @@
 
 #include "Origin.hpp"
 #include "util/tstring.hpp"
+#include "util/SharedString.hpp"
 #include "Geo/GeoPoint.hpp"
 #include "Geo/Flat/FlatGeoPoint.hpp"
 #include "RadioFrequency.hpp"
@@ -84,8 +85,12 @@ struct Waypoint {
 
   /** Name of waypoint */
   tstring name;
-  /** Additional comment text for waypoint */
-  tstring comment;
+  /**
+   * Additional comment text for waypoint.  Many waypoints in a file
+   * have the same comment, therefore #BulkWaypoints lets them share
+   * one buffer.
+   */
+  SharedString comment;
   /** Airfield or additional (long) details */
   tstring details;
   /** Additional files to be displayed in the WayointDetails dialog */
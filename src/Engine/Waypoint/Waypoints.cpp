@@ -76,11 +76,11 @@ Waypoints::Waypoints() noexcept = default;
 void
 Waypoints::Optimise() noexcept
 {
-  if (waypoint_tree.IsEmpty() || waypoint_tree.HaveBounds())
+  if (IsEmpty() || IsOptimised())
     /* empty or already optimised */
     return;
 
-  task_projection.Update();
+  const bool projection_changed = task_projection.Update();
 
   for (auto &i : waypoint_tree) {
     // TODO: eliminate this const_cast hack
@@ -89,6 +89,23 @@ Waypoints::Optimise() noexcept
   }
 
   waypoint_tree.Optimise();
+
+  /* the bulk index is rebuilt in one linear pass, but skip even that
+     if nothing has changed there */
+  if (projection_changed || !bulk_waypoints.IsOptimised())
+    bulk_waypoints.Optimise(task_projection);
+}
+
+inline void
+Waypoints::Register(Waypoint &w) noexcept
+{
+  if (IsEmpty())
+    task_projection.Reset(w.location);
+
+  w.flags.watched = w.origin == WaypointOrigin::WATCHED;
+
+  task_projection.Scan(w.location);
+  w.id = next_id++;
 }
 
 void
@@ -100,14 +117,10 @@ Waypoints::Append(WaypointPtr wp) noexcept
   if (waypoint_tree.HaveBounds()) {
     w.Project(task_projection);
     if (!waypoint_tree.IsWithinBounds(wp))
-      ScheduleOptimise();
-  } else if (IsEmpty())
-    task_projection.Reset(w.location);
-
-  w.flags.watched = w.origin == WaypointOrigin::WATCHED;
+      ScheduleOptimiseTree();
+  }
 
-  task_projection.Scan(w.location);
-  w.id = next_id++;
+  Register(w);
 
   waypoint_tree.Add(wp);
   name_tree.Add(wp);
@@ -115,6 +128,46 @@ Waypoints::Append(WaypointPtr wp) noexcept
   ++serial;
 }
 
+WaypointPtr
+Waypoints::Append(Waypoint &&wp) noexcept
+{
+  if (!IsBulkOrigin(wp.origin)) {
+    auto ptr = std::make_shared<Waypoint>(std::move(wp));
+    Append(ptr);
+    return ptr;
+  }
+
+  Register(wp);
+
+  auto ptr = bulk_waypoints.Append(std::move(wp));
+  name_tree.Add(ptr);
+
+  ++serial;
+  return ptr;
+}
+
+/**
+ * Choose the nearer one of the #WaypointTree and #BulkWaypoints
+ * search results.
+ */
+template<typename Tree>
+static WaypointPtr
+PickNearest(const Tree &tree,
+            const std::pair<typename Tree::const_iterator,
+                            typename Tree::distance_type> &found,
+            const std::pair<const WaypointPtr *, uint64_t> &bulk_found) noexcept
+{
+  if (found.first == tree.end())
+    return bulk_found.first != nullptr
+      ? *bulk_found.first
+      : nullptr;
+
+  if (bulk_found.first != nullptr && bulk_found.second < found.second)
+    return *bulk_found.first;
+
+  return *found.first;
+}
+
 WaypointPtr
 Waypoints::GetNearest(const GeoPoint &loc, double range) const noexcept
 {
@@ -125,11 +178,11 @@ Waypoints::GetNearest(const GeoPoint &loc, double range) const noexcept
   const WaypointTree::Point point(flat_location.x, flat_location.y);
   const unsigned mrange = task_projection.ProjectRangeInteger(loc, range);
   const auto found = waypoint_tree.FindNearest(point, mrange);
+  const auto bulk_found =
+    bulk_waypoints.FindNearestIf(flat_location, mrange,
+                                 [](const Waypoint &){ return true; });
 
-  if (found.first == waypoint_tree.end())
-    return nullptr;
-
-  return *found.first;
+  return PickNearest(waypoint_tree, found, bulk_found);
 }
 
 static constexpr bool
@@ -158,11 +211,10 @@ Waypoints::GetNearestIf(const GeoPoint &loc, double range,
                                                  [predicate](const WaypointPtr &ptr){
                                                    return predicate(*ptr);
                                                  });
+  const auto bulk_found =
+    bulk_waypoints.FindNearestIf(flat_location, mrange, predicate);
 
-  if (found.first == waypoint_tree.end())
-    return nullptr;
-
-  return *found.first;
+  return PickNearest(waypoint_tree, found, bulk_found);
 }
 
 WaypointPtr
@@ -190,7 +242,7 @@ Waypoints::LookupLocation(const GeoPoint &loc,
 WaypointPtr
 Waypoints::FindHome() noexcept
 {
-  for (const auto &wp : waypoint_tree) {
+  for (const auto &wp : *this) {
     if (wp->flags.home) {
       home = wp;
       return wp;
@@ -215,6 +267,9 @@ Waypoints::SetHome(const unsigned id) noexcept
 WaypointPtr
 Waypoints::LookupId(const unsigned id) const noexcept
 {
+  if (auto wp = bulk_waypoints.LookupId(id))
+    return wp;
+
   for (const auto &wp : waypoint_tree)
     if (wp->id == id)
       return wp;
@@ -234,6 +289,7 @@ Waypoints::VisitWithinRange(const GeoPoint &loc, const double range,
   const unsigned mrange = task_projection.ProjectRangeInteger(loc, range);
 
   waypoint_tree.VisitWithinRange(point, mrange, visitor);
+  bulk_waypoints.VisitWithinRange(flat_location, mrange, visitor);
 }
 
 void
@@ -250,6 +306,7 @@ Waypoints::Clear() noexcept
   home = nullptr;
   name_tree.Clear();
   waypoint_tree.clear();
+  bulk_waypoints.Clear();
   next_id = 1;
 }
 
@@ -259,6 +316,12 @@ Waypoints::Erase(WaypointPtr &&wp) noexcept
   if (home == wp)
     home = nullptr;
 
+  if (bulk_waypoints.Erase(*wp)) {
+    name_tree.Remove(wp);
+    ++serial;
+    return;
+  }
+
   auto f = waypoint_tree.FindNearestIf(waypoint_tree.GetPosition(wp), 0,
                                        [&wp](const WaypointPtr &ptr){
                                          return ptr == wp;
@@ -290,7 +353,7 @@ Waypoints::EraseUserMarkers() noexcept
 void
 Waypoints::Replace(const WaypointPtr &orig, Waypoint &&replacement) noexcept
 {
-  assert(!waypoint_tree.IsEmpty());
+  assert(!IsEmpty());
 
   name_tree.Remove(orig);
 
@@ -302,12 +365,20 @@ Waypoints::Replace(const WaypointPtr &orig, Waypoint &&replacement) noexcept
     const WaypointTree::Point point(replacement.flat_location.x,
                                     replacement.flat_location.y);
     if (!waypoint_tree.IsWithinBounds(point))
-      ScheduleOptimise();
+      ScheduleOptimiseTree();
   }
 
-  WaypointPtr new_ptr(new Waypoint(std::move(replacement)));
+  auto new_ptr = std::make_shared<Waypoint>(std::move(replacement));
   name_tree.Add(new_ptr);
 
+  if (bulk_waypoints.Erase(*orig)) {
+    /* the bulk store is read-only; the modified waypoint moves to the
+       tree */
+    waypoint_tree.Add(std::move(new_ptr));
+    ++serial;
+    return;
+  }
+
   auto f = waypoint_tree.FindNearestIf(waypoint_tree.GetPosition(orig), 0,
                                        [&orig](const WaypointPtr &ptr){
                                          return ptr == orig;
@@ -5,6 +5,7 @@
 
 #include "Ptr.hpp"
 #include "Waypoint.hpp"
+#include "BulkWaypoints.hpp"
 #include "Geo/Flat/TaskProjection.hpp"
 #include "util/RadixTree.hpp"
 #include "util/QuadTree.hxx"
@@ -18,6 +19,11 @@ using WaypointVisitor = std::function<void(const WaypointPtr &)>;
 /**
  * Container for waypoints using kd-tree representation internally for
  * fast geospatial lookups.
+ *
+ * Waypoints loaded from waypoint files (see IsBulkOrigin()) are kept
+ * in a compact read-only #BulkWaypoints store; all others (user
+ * waypoints, markers, takeoff points) live in a #QuadTree which is
+ * cheap to modify.
  */
 class Waypoints {
   /**
@@ -61,13 +67,59 @@ class Waypoints {
   unsigned next_id = 1;
 
   WaypointTree waypoint_tree;
+  BulkWaypoints bulk_waypoints;
   WaypointNameTree name_tree;
   TaskProjection task_projection;
 
   WaypointPtr home;
 
 public:
-  using const_iterator = WaypointTree::const_iterator;
+  /**
+   * Iterates over the #BulkWaypoints first, then over the
+   * #WaypointTree.
+   */
+  class const_iterator {
+    friend class Waypoints;
+
+    BulkWaypoints::const_iterator bulk, bulk_end;
+    WaypointTree::const_iterator tree;
+
+    const_iterator(BulkWaypoints::const_iterator _bulk,
+                   BulkWaypoints::const_iterator _bulk_end,
+                   WaypointTree::const_iterator _tree) noexcept
+      :bulk(_bulk), bulk_end(_bulk_end), tree(_tree) {}
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = const WaypointPtr;
+    using pointer = const WaypointPtr *;
+    using reference = const WaypointPtr &;
+
+    bool operator==(const const_iterator &other) const noexcept {
+      return bulk == other.bulk && tree == other.tree;
+    }
+
+    bool operator!=(const const_iterator &other) const noexcept {
+      return !(*this == other);
+    }
+
+    const_iterator &operator++() noexcept {
+      if (bulk != bulk_end)
+        ++bulk;
+      else
+        ++tree;
+      return *this;
+    }
+
+    reference operator*() const noexcept {
+      return bulk != bulk_end ? *bulk : *tree;
+    }
+
+    pointer operator->() const noexcept {
+      return &**this;
+    }
+  };
 
   /**
    * Constructor.  Task projection is updated after call to Optimise().
@@ -99,13 +151,12 @@ public:
    * Optimise() must be called after inserting waypoints prior to
    * performing any queries, but can be done in batches.
    *
+   * Waypoints with a file origin (see IsBulkOrigin()) are moved
+   * into the compact #BulkWaypoints store.
+   *
    * @param wp Waypoint to add to internal store
    */
-  WaypointPtr Append(Waypoint &&wp) noexcept {
-    WaypointPtr ptr(new Waypoint(std::move(wp)));
-    Append(ptr);
-    return ptr;
-  }
+  WaypointPtr Append(Waypoint &&wp) noexcept;
 
   /**
    * Erase waypoint from the internal store.  Requires Optimise() to
@@ -155,8 +206,8 @@ public:
    * Prepare and enable the next Optimise() call.
    */
   void ScheduleOptimise() noexcept {
-    waypoint_tree.Flatten();
-    waypoint_tree.ClearBounds();
+    ScheduleOptimiseTree();
+    bulk_waypoints.ScheduleOptimise();
   }
 
   /**
@@ -172,7 +223,7 @@ public:
    */
   [[gnu::pure]]
   unsigned size() const noexcept {
-    return waypoint_tree.size();
+    return bulk_waypoints.size() + waypoint_tree.size();
   }
 
   /**
@@ -182,7 +233,7 @@ public:
    */
   [[gnu::pure]]
   bool IsEmpty() const noexcept {
-    return waypoint_tree.IsEmpty();
+    return bulk_waypoints.IsEmpty() && waypoint_tree.IsEmpty();
   }
 
   /**
@@ -341,7 +392,8 @@ public:
    * @return First waypoint in store
    */
   const_iterator begin() const noexcept {
-    return waypoint_tree.begin();
+    return {bulk_waypoints.begin(), bulk_waypoints.end(),
+            waypoint_tree.begin()};
   }
 
   /**
@@ -350,6 +402,45 @@ public:
    * @return End waypoint in store
    */
   const_iterator end() const noexcept {
-    return waypoint_tree.end();
+    return {bulk_waypoints.end(), bulk_waypoints.end(),
+            waypoint_tree.end()};
+  }
+
+private:
+  /**
+   * Are waypoints from this origin loaded in bulk from a file and
+   * hardly ever modified, i.e. shall they go to #BulkWaypoints?
+   */
+  static constexpr bool IsBulkOrigin(WaypointOrigin origin) noexcept {
+    switch (origin) {
+    case WaypointOrigin::NONE:
+    case WaypointOrigin::USER:
+      break;
+
+    case WaypointOrigin::PRIMARY:
+    case WaypointOrigin::ADDITIONAL:
+    case WaypointOrigin::WATCHED:
+    case WaypointOrigin::MAP:
+      return true;
+    }
+
+    return false;
+  }
+
+  [[gnu::pure]]
+  bool IsOptimised() const noexcept {
+    return (waypoint_tree.IsEmpty() || waypoint_tree.HaveBounds()) &&
+      bulk_waypoints.IsOptimised();
   }
+
+  void ScheduleOptimiseTree() noexcept {
+    waypoint_tree.Flatten();
+    waypoint_tree.ClearBounds();
+  }
+
+  /**
+   * Initialise the attributes of a new waypoint which are managed by
+   * this class.
+   */
+  void Register(Waypoint &wp) noexcept;
 };
@@ -190,6 +190,7 @@ void eventResetTask(const TCHAR *misc);
 void eventLockScreen(const TCHAR *misc);
 void eventExchangeFrequencies(const TCHAR *misc);
 void eventUploadIGCFile(const TCHAR *misc);
+void eventMapProfiler(const TCHAR *misc);
 // -------
 
 } // namespace InputEvents
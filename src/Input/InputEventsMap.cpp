@@ -17,6 +17,11 @@
 #include "Math/Constants.hpp"
 #include "util/Clamp.hpp"
 #include "Screen/Layout.hpp"
+#include "Dialogs/Error.hpp"
+#include "LocalPath.hpp"
+#include "io/FileOutputStream.hxx"
+#include "io/BufferedOutputStream.hxx"
+#include "system/Path.hpp"
 
 // eventAutoZoom - Turn on|off|toggle AutoZoom
 // misc:
@@ -132,6 +137,50 @@ InputEvents::eventPan(const TCHAR *misc)
   XCSoarInterface::SendMapSettings(true);
 }
 
+/**
+ * Control the map frame profiler (see #MapFrameProfiler).
+ *
+ *  on             Start profiling and show the results on the map
+ *  off            Stop profiling
+ *  toggle         Toggle profiling
+ *  dump           Save the recent frames to xcsoar-map-profile.txt
+ */
+void
+InputEvents::eventMapProfiler(const TCHAR *misc)
+{
+  GlueMapWindow *map_window = UIGlobals::GetMap();
+  if (map_window == nullptr)
+    return;
+
+  auto &profiler = map_window->GetFrameProfiler();
+
+  if (StringIsEqual(misc, _T("on")))
+    profiler.SetEnabled(true);
+  else if (StringIsEqual(misc, _T("off")))
+    profiler.SetEnabled(false);
+  else if (StringIsEqual(misc, _T("toggle")))
+    profiler.SetEnabled(!profiler.IsEnabled());
+  else if (StringIsEqual(misc, _T("dump"))) {
+    try {
+      const auto path = LocalPath(_T("xcsoar-map-profile.txt"));
+
+      FileOutputStream file(path);
+      BufferedOutputStream buffered(file);
+      profiler.Write(buffered);
+      buffered.Flush();
+      file.Commit();
+
+      Message::AddMessage(_("File saved"), path.c_str());
+    } catch (...) {
+      ShowError(std::current_exception(), _("Error"));
+    }
+
+    return;
+  }
+
+  map_window->QuickRedraw();
+}
+
 void
 InputEvents::sub_PanCursor(int dx, int dy)
 {
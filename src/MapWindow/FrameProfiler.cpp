@@ -0,0 +1,182 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "FrameProfiler.hpp"
+#include "io/BufferedOutputStream.hxx"
+#include "util/Macros.hpp"
+
+#ifdef ENABLE_OPENGL
+#include "ui/opengl/System.hpp"
+#endif
+
+#include <algorithm>
+
+static const TCHAR *const layer_names[] = {
+  _T("Preparation"),
+  _T("Terrain"),
+  _T("RASP"),
+  _T("Topography"),
+  _T("Overlays"),
+  _T("NOAA"),
+  _T("Final glide shading"),
+  _T("Airspace"),
+  _T("Contest"),
+  _T("Task"),
+  _T("Waypoints"),
+  _T("Trail"),
+  _T("Thermals"),
+  _T("Topography labels"),
+  _T("Glide"),
+  _T("Navigation"),
+  _T("Traffic"),
+  _T("Aircraft"),
+  _T("Gauges"),
+  _T("Rasterisation"),
+};
+
+static_assert(ARRAY_SIZE(layer_names) == MapFrameProfiler::N_LAYERS);
+
+const TCHAR *
+ToString(MapLayer layer) noexcept
+{
+  return layer_names[unsigned(layer)];
+}
+
+/**
+ * Wait until all drawing commands have been executed.
+ */
+static void
+Sync() noexcept
+{
+#ifdef ENABLE_OPENGL
+  glFinish();
+#endif
+}
+
+template<typename D>
+static uint32_t
+ToMicroseconds(D duration) noexcept
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+void
+MapFrameProfiler::SetEnabled(bool _enabled) noexcept
+{
+  if (enabled.exchange(_enabled) == _enabled)
+    return;
+
+  if (_enabled) {
+    /* start with fresh statistics */
+    const std::scoped_lock lock{mutex};
+    frames.clear();
+  }
+}
+
+void
+MapFrameProfiler::BeginFrame() noexcept
+{
+  active = IsEnabled();
+  if (!active)
+    return;
+
+  Sync();
+
+  frame = {};
+  current_layer = MapLayer::PREPARE;
+  frame_start = layer_start = Clock::now();
+}
+
+inline void
+MapFrameProfiler::FinishLayer(Clock::time_point now) noexcept
+{
+  frame.layers[unsigned(current_layer)] += ToMicroseconds(now - layer_start);
+  layer_start = now;
+}
+
+void
+MapFrameProfiler::SwitchLayer(MapLayer layer) noexcept
+{
+  Sync();
+  FinishLayer(Clock::now());
+  current_layer = layer;
+}
+
+void
+MapFrameProfiler::EndFrame() noexcept
+{
+  if (!active)
+    return;
+
+  active = false;
+
+  Sync();
+  const auto now = Clock::now();
+  FinishLayer(now);
+  frame.total = ToMicroseconds(now - frame_start);
+
+  const std::scoped_lock lock{mutex};
+  frames.push(frame);
+}
+
+MapFrameProfiler::Summary
+MapFrameProfiler::GetSummary() const noexcept
+{
+  Summary summary{};
+  std::array<uint64_t, N_LAYERS> sums{};
+  uint64_t total_sum = 0;
+
+  {
+    const std::scoped_lock lock{mutex};
+    for (const auto &i : frames) {
+      ++summary.n_frames;
+
+      total_sum += i.total;
+      summary.max_total = std::max(summary.max_total, i.total);
+
+      for (unsigned j = 0; j < N_LAYERS; ++j) {
+        sums[j] += i.layers[j];
+        summary.max[j] = std::max(summary.max[j], i.layers[j]);
+      }
+    }
+  }
+
+  if (summary.n_frames > 0) {
+    summary.mean_total = total_sum / summary.n_frames;
+    for (unsigned j = 0; j < N_LAYERS; ++j)
+      summary.mean[j] = sums[j] / summary.n_frames;
+  }
+
+  return summary;
+}
+
+void
+MapFrameProfiler::Write(BufferedOutputStream &os) const
+{
+  const auto summary = GetSummary();
+
+  os.Write("# map frame durations in microseconds\n");
+  os.Write("layer\tmean\tmax\n");
+  for (unsigned i = 0; i < N_LAYERS; ++i) {
+    os.Write(ToString(MapLayer(i)));
+    os.Fmt("\t{}\t{}\n", summary.mean[i], summary.max[i]);
+  }
+  os.Fmt("total\t{}\t{}\n", summary.mean_total, summary.max_total);
+
+  /* one row per frame, oldest first */
+  os.Write("\nframe");
+  for (unsigned i = 0; i < N_LAYERS; ++i) {
+    os.Write('\t');
+    os.Write(ToString(MapLayer(i)));
+  }
+  os.Write("\ttotal\n");
+
+  const std::scoped_lock lock{mutex};
+  unsigned n = 0;
+  for (const auto &frame : frames) {
+    os.Fmt("{}", n++);
+    for (const auto i : frame.layers)
+      os.Fmt("\t{}", i);
+    os.Fmt("\t{}\n", frame.total);
+  }
+}
@@ -0,0 +1,187 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "thread/Mutex.hxx"
+#include "util/OverwritingRingBuffer.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <tchar.h>
+
+class BufferedOutputStream;
+
+/**
+ * The layers of the moving map, in the order they are drawn by
+ * MapWindow::Render().
+ */
+enum class MapLayer : uint8_t {
+  /**
+   * The parallel layer preparation, see MapWindow::PrepareLayers().
+   */
+  PREPARE,
+
+  TERRAIN,
+  RASP,
+  TOPOGRAPHY,
+  OVERLAYS,
+  NOAA,
+  FINAL_GLIDE_SHADING,
+  AIRSPACE,
+  CONTEST,
+  TASK,
+  WAYPOINTS,
+  TRAIL,
+
+  /**
+   * Waves and the thermal estimate.
+   */
+  THERMALS,
+
+  TOPOGRAPHY_LABELS,
+  GLIDE,
+
+  /**
+   * Off-track indicator, track bearing, best cruise track, wind and
+   * compass.
+   */
+  NAVIGATION,
+
+  TRAFFIC,
+
+  /**
+   * The own aircraft and airspace intersections.
+   */
+  AIRCRAFT,
+
+  /**
+   * The gauges drawn by #GlueMapWindow on top of the map.
+   */
+  GAUGES,
+
+  /**
+   * The parallel rasterisation of the recorded drawing operations
+   * in deferred mode, see Canvas::EndDeferred().
+   */
+  RASTERISE,
+
+  COUNT
+};
+
+[[gnu::const]]
+const TCHAR *
+ToString(MapLayer layer) noexcept;
+
+/**
+ * An opt-in profiler which measures how long each #MapLayer takes to
+ * draw.  The renderer calls BeginFrame(), then Mark() at each layer
+ * boundary, and finally EndFrame(); this costs nearly nothing while
+ * the profiler is disabled.
+ *
+ * With OpenGL, the drawing commands are executed asynchronously, and
+ * therefore Mark() calls glFinish() while the profiler is enabled, to
+ * attribute the GPU time to the right layer.  This makes the frame
+ * slower than it would be without the profiler.
+ *
+ * The most recent frames are kept in a ring buffer which may be
+ * read from any thread.
+ */
+class MapFrameProfiler {
+public:
+  static constexpr unsigned N_LAYERS = unsigned(MapLayer::COUNT);
+
+  /**
+   * The number of frames kept in the ring buffer.
+   */
+  static constexpr unsigned N_FRAMES = 64;
+
+  /**
+   * The durations of one frame in microseconds.
+   */
+  struct Frame {
+    std::array<uint32_t, N_LAYERS> layers;
+    uint32_t total;
+  };
+
+  /**
+   * Statistics over the frames in the ring buffer.  All durations
+   * are in microseconds.
+   */
+  struct Summary {
+    unsigned n_frames;
+
+    uint32_t mean_total, max_total;
+
+    std::array<uint32_t, N_LAYERS> mean, max;
+  };
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  std::atomic_bool enabled{false};
+
+  /* the following fields are only accessed by the rendering
+     thread */
+
+  /**
+   * Is a frame being measured currently?
+   */
+  bool active = false;
+
+  MapLayer current_layer;
+
+  Clock::time_point frame_start, layer_start;
+
+  Frame frame;
+
+  mutable Mutex mutex;
+
+  /**
+   * Protected by #mutex.
+   */
+  OverwritingRingBuffer<Frame, N_FRAMES> frames;
+
+public:
+  bool IsEnabled() const noexcept {
+    return enabled.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Enable or disable the profiler.  It takes effect with the next
+   * frame.  This method is thread-safe.
+   */
+  void SetEnabled(bool _enabled) noexcept;
+
+  void BeginFrame() noexcept;
+
+  /**
+   * The previous layer is finished, and the specified one begins.
+   * Marking the same layer several times per frame adds up.
+   */
+  void Mark(MapLayer layer) noexcept {
+    if (active)
+      SwitchLayer(layer);
+  }
+
+  void EndFrame() noexcept;
+
+  /**
+   * This method is thread-safe.
+   */
+  Summary GetSummary() const noexcept;
+
+  /**
+   * Write all frames in the ring buffer and a summary as a
+   * tab-separated table.  This method is thread-safe.
+   *
+   * Throws on I/O error.
+   */
+  void Write(BufferedOutputStream &os) const;
+
+private:
+  void SwitchLayer(MapLayer layer) noexcept;
+  void FinishLayer(Clock::time_point now) noexcept;
+};
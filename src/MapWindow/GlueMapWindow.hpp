@@ -206,8 +206,7 @@ protected:
   /* virtual methods from class MapWindow */
   void Render(Canvas &canvas, const PixelRect &rc) noexcept override;
   void DrawThermalEstimate(Canvas &canvas) const noexcept override;
-  void RenderTrail(Canvas &canvas,
-                   const PixelPoint aircraft_pos) noexcept override;
+  void PrepareTrail() noexcept override;
   void RenderTrackBearing(Canvas &canvas,
                           const PixelPoint aircraft_pos) noexcept override;
 
@@ -247,6 +246,11 @@ private:
                      const NMEAInfo &info) const noexcept;
   void DrawCrossHairs(Canvas &canvas) const noexcept;
   void DrawPanInfo(Canvas &canvas) const noexcept;
+
+  /**
+   * Show the #MapFrameProfiler results.
+   */
+  void DrawFrameProfile(Canvas &canvas) const noexcept;
   void DrawThermalBand(Canvas &canvas, const PixelRect &rc) const noexcept;
   void DrawFinalGlide(Canvas &canvas, const PixelRect &rc) const noexcept;
   void DrawVario(Canvas &canvas, const PixelRect &rc) const noexcept;
@@ -396,6 +396,9 @@ GlueMapWindow::OnPaintBuffer(Canvas &canvas) noexcept
   if (IsPanning())
     DrawPanInfo(canvas);
 
+  if (frame_profiler.IsEnabled())
+    DrawFrameProfile(canvas);
+
 #ifdef ENABLE_OPENGL
   LeaveDrawThread();
 #endif
@@ -438,7 +441,7 @@ GlueMapWindow::Render(Canvas &canvas, const PixelRect &rc) noexcept
   MapWindow::Render(canvas, rc);
 
   if (IsNearSelf()) {
-    draw_sw.Mark("DrawGlueMisc");
+    frame_profiler.Mark(MapLayer::GAUGES);
     if (GetMapSettings().show_thermal_profile)
       DrawThermalBand(canvas, rc);
     DrawStallRatio(canvas, rc);
@@ -23,6 +23,8 @@
 #include "Input/InputEvents.hpp"
 #include "Renderer/MapScaleRenderer.hpp"
 
+#include <algorithm>
+
 #include <stdio.h>
 
 void
@@ -141,6 +143,55 @@ GlueMapWindow::DrawPanInfo(Canvas &canvas) const noexcept
   }
 }
 
+void
+GlueMapWindow::DrawFrameProfile(Canvas &canvas) const noexcept
+{
+  /* the number of layers to be shown, the most expensive ones
+     first */
+  static constexpr unsigned N_LINES = 6;
+
+  const auto summary = frame_profiler.GetSummary();
+  if (summary.n_frames == 0)
+    return;
+
+  TextInBoxMode mode;
+  mode.shape = LabelShape::OUTLINED;
+
+  const Font &font = *look.overlay.overlay_font;
+  canvas.Select(font);
+
+  const unsigned padding = Layout::FastScale(4);
+  const unsigned height = font.GetHeight();
+  PixelPoint p(padding, padding);
+
+  StaticString<64> buffer;
+  buffer.Format(_T("Frame %.1f ms (max %.1f)"),
+                summary.mean_total / 1000., summary.max_total / 1000.);
+  TextInBox(canvas, buffer, p, mode, render_projection.GetScreenSize());
+  p.y += height;
+
+  std::array<unsigned, MapFrameProfiler::N_LAYERS> order;
+  for (unsigned i = 0; i < order.size(); ++i)
+    order[i] = i;
+
+  std::partial_sort(order.begin(), order.begin() + N_LINES, order.end(),
+                    [&summary](unsigned a, unsigned b){
+                      return summary.mean[a] > summary.mean[b];
+                    });
+
+  for (unsigned i = 0; i < N_LINES; ++i) {
+    const unsigned layer = order[i];
+    if (summary.mean[layer] == 0)
+      break;
+
+    buffer.Format(_T("%s %.1f ms (max %.1f)"),
+                  ToString(MapLayer(layer)),
+                  summary.mean[layer] / 1000., summary.max[layer] / 1000.);
+    TextInBox(canvas, buffer, p, mode, render_projection.GetScreenSize());
+    p.y += height;
+  }
+}
+
 void
 GlueMapWindow::DrawGPSStatus(Canvas &canvas, const PixelRect &rc,
                              const NMEAInfo &info) const noexcept
@@ -379,26 +430,25 @@ GlueMapWindow::DrawThermalEstimate(Canvas &canvas) const noexcept
 }
 
 void
-GlueMapWindow::RenderTrail(Canvas &canvas,
-                           const PixelPoint aircraft_pos) noexcept
+GlueMapWindow::PrepareTrail() noexcept
 {
   TimeStamp min_time;
   switch(GetMapSettings().trail.length) {
-  case TrailSettings::Length::OFF:
-    return;
   case TrailSettings::Length::LONG:
     min_time = std::max(Basic().time - std::chrono::hours{1}, TimeStamp{});
     break;
   case TrailSettings::Length::SHORT:
     min_time = std::max(Basic().time - std::chrono::minutes{10}, TimeStamp{});
     break;
+  case TrailSettings::Length::OFF:
+    /* TrailRenderer::PrepareTrail() clears the trail */
   case TrailSettings::Length::FULL:
   default:
     min_time = {}; // full
     break;
   }
 
-  DrawTrail(canvas, aircraft_pos, min_time,
+  LoadTrail(min_time,
             GetMapSettings().trail.wind_drift_enabled && InCirclingMode());
 }
 
@@ -14,6 +14,9 @@
 #include "ui/canvas/opengl/Scissor.hpp"
 #endif
 
+#ifdef USE_MEMORY_CANVAS
+#endif
+
 /**
  * Constructor of the MapWindow class
  */
@@ -24,7 +27,14 @@ MapWindow::MapWindow(const MapLook &_look,
    waypoint_renderer(nullptr, look.waypoint),
    airspace_renderer(look.airspace),
    airspace_label_renderer(look.airspace),
-   trail_renderer(look.trail) {}
+   trail_renderer(look.trail)
+{
+#if defined(ENABLE_OPENGL) && defined(AIRSPACE_GL_CACHE)
+  /* the map is redrawn continuously, which makes it worth keeping
+     the airspace geometry on the GPU */
+  airspace_renderer.EnableGeometryCache();
+#endif
+}
 
 MapWindow::~MapWindow() noexcept
 {
@@ -120,9 +130,26 @@ MapWindow::OnPaintBuffer(Canvas &canvas) noexcept
     const ScopeUnlock unlock{mutex};
 #endif
 
+#ifdef USE_MEMORY_CANVAS
+    const bool deferred = deferred_rendering;
+    if (deferred)
+      canvas.BeginDeferred(command_list);
+#endif
+
     // Render the moving map
+    frame_profiler.BeginFrame();
     Render(canvas, GetClientRect());
-    draw_sw.Finish();
+
+#ifdef USE_MEMORY_CANVAS
+    if (deferred) {
+      /* the layers above have only been recorded; the rasterisation
+         is measured separately */
+      frame_profiler.Mark(MapLayer::RASTERISE);
+      canvas.EndDeferred();
+    }
+#endif
+
+    frame_profiler.EndFrame();
   }
 
 #ifndef ENABLE_OPENGL
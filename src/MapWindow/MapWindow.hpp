@@ -9,8 +9,11 @@
 #ifndef ENABLE_OPENGL
 #include "ui/canvas/BufferCanvas.hpp"
 #endif
+#ifdef USE_MEMORY_CANVAS
+#include "ui/canvas/memory/CommandList.hpp"
+#endif
 #include "Renderer/LabelBlock.hpp"
-#include "Screen/StopWatch.hpp"
+#include "FrameProfiler.hpp"
 #include "MapWindowBlackboard.hpp"
 #include "Renderer/AirspaceLabelRenderer.hpp"
 #include "Renderer/BackgroundRenderer.hpp"
@@ -18,6 +21,7 @@
 #include "Renderer/TrailRenderer.hpp"
 #include "Weather/Features.hpp"
 #include "Tracking/SkyLines/Features.hpp"
+#include "thread/Parallel.hpp"
 
 #include <memory>
 
@@ -53,6 +57,26 @@ class MapWindow :
   BufferCanvas buffer_canvas;
 #endif
 
+#ifdef USE_MEMORY_CANVAS
+  /**
+   * Records the drawing operations of OnPaintBuffer(), to rasterise
+   * them on all processors.
+   */
+  CanvasCommandList command_list;
+
+  /**
+   * Rasterise the map in parallel bands (see Canvas::BeginDeferred())?
+   * This is off by default, because recording and replaying the
+   * drawing operations costs time which is only regained on several
+   * processor cores; the build option DEFERRED_MAP enables it.
+   */
+#ifdef DEFERRED_MAP
+  bool deferred_rendering = true;
+#else
+  bool deferred_rendering = false;
+#endif
+#endif
+
   LabelBlock label_block;
 
 protected:
@@ -126,6 +150,12 @@ protected:
 
   TrailRenderer trail_renderer;
 
+  /**
+   * Runs the jobs of PrepareLayers().  Its threads live as long as
+   * this window, instead of being started and joined for each frame.
+   */
+  ParallelPool prepare_pool{"MapPrepare"};
+
   ProtectedTaskManager *task = nullptr;
   const ProtectedRoutePlanner *route_planner = nullptr;
   GlideComputer *glide_computer = nullptr;
@@ -161,10 +191,9 @@ protected:
 #endif
 
   /**
-   * The #StopWatch used to benchmark the DrawThread,
-   * i.e. OnPaintBuffer().
+   * Measures the layers drawn by OnPaintBuffer().
    */
-  ScreenStopWatch draw_sw;
+  MapFrameProfiler frame_profiler;
 
   friend class DrawThread;
 
@@ -252,6 +281,20 @@ public:
     return visible_projection;
   }
 
+  MapFrameProfiler &GetFrameProfiler() noexcept {
+    return frame_profiler;
+  }
+
+#ifdef USE_MEMORY_CANVAS
+  /**
+   * Enable or disable the parallel band rasterisation.  Must be
+   * called while the map is not being drawn.
+   */
+  void SetDeferredRendering(bool enable) noexcept {
+    deferred_rendering = enable;
+  }
+#endif
+
   [[gnu::pure]]
   GeoPoint GetLocation() const noexcept {
     return visible_projection.IsValid()
@@ -276,9 +319,14 @@ protected:
                            const PixelRect &rc) const noexcept;
   void DrawWaypoints(Canvas &canvas) noexcept;
 
-  void DrawTrail(Canvas &canvas, PixelPoint aircraft_pos,
-                 TimeStamp min_time, bool enable_traildrift = false) noexcept;
-  virtual void RenderTrail(Canvas &canvas, PixelPoint aircraft_pos) noexcept;
+  void LoadTrail(TimeStamp min_time, bool enable_traildrift = false) noexcept;
+
+  /**
+   * Prepare the trail for RenderTrail() by calling LoadTrail().  This
+   * is called by PrepareLayers(), possibly in a worker thread.
+   */
+  virtual void PrepareTrail() noexcept;
+  void RenderTrail(Canvas &canvas, PixelPoint aircraft_pos) noexcept;
   virtual void RenderTrackBearing(Canvas &canvas, PixelPoint aircraft_pos) noexcept;
 
 #ifdef HAVE_SKYLINES_TRACKING
@@ -298,6 +346,15 @@ protected:
   void DrawFLARMTraffic(Canvas &canvas, PixelPoint aircraft_pos) const noexcept;
   void DrawGLinkTraffic(Canvas &canvas) const noexcept;
 
+  /**
+   * Run the CPU-side preparation of the terrain, topography and trail
+   * layers (culling, projection, image generation) in parallel.  The
+   * jobs don't share mutable state, and none of them touches the
+   * #Canvas; drawing the layers afterwards only submits the prepared
+   * primitives.
+   */
+  void PrepareLayers() noexcept;
+
   // thread, main functions
   /**
    * Renders all the components of the moving map
@@ -368,6 +425,14 @@ private:
    */
   void RenderAirspace(Canvas &canvas) noexcept;
 
+  /**
+   * Renders the airspace labels.  This must be called after the
+   * waypoint labels have been placed, because those have priority in
+   * the #LabelBlock.
+   * @param canvas The drawing canvas
+   */
+  void RenderAirspaceLabels(Canvas &canvas) noexcept;
+
   /**
    * Renders the NOAA stations
    * @param canvas The drawing canvas
@@ -24,11 +24,51 @@ MapWindow::RenderTrackBearing(Canvas &canvas,
   DrawTrackBearing(canvas, aircraft_pos, false);
 }
 
+void
+MapWindow::PrepareLayers() noexcept
+{
+  enum Job : unsigned {
+#ifndef ENABLE_OPENGL
+    /* with OpenGL, the terrain image is generated into a texture,
+       which must be done in the OpenGL thread */
+    TERRAIN,
+#endif
+    TOPOGRAPHY,
+    TRAIL,
+    N_JOBS
+  };
+
+  const auto &settings = GetMapSettings();
+
+  background.SetShadingAngle(render_projection, settings.terrain,
+                             Calculated());
+
+  prepare_pool.For(N_JOBS, [this, &settings](unsigned job){
+    switch (Job(job)) {
+#ifndef ENABLE_OPENGL
+    case TERRAIN:
+      background.Prepare(render_projection, settings.terrain);
+      break;
+#endif
+
+    case TOPOGRAPHY:
+      if (topography_renderer != nullptr && settings.topography_enabled)
+        topography_renderer->Prepare(render_projection);
+      break;
+
+    case TRAIL:
+      PrepareTrail();
+      break;
+
+    case N_JOBS:
+      break;
+    }
+  });
+}
+
 inline void
 MapWindow::RenderTerrain(Canvas &canvas) noexcept
 {
-  background.SetShadingAngle(render_projection, GetMapSettings().terrain,
-                             Calculated());
   background.Draw(canvas, render_projection, GetMapSettings().terrain);
 }
 
@@ -112,13 +152,18 @@ MapWindow::RenderAirspace(Canvas &canvas) noexcept
                            Basic(), Calculated(),
                            GetComputerSettings().airspace,
                            GetMapSettings().airspace);
+  }
+}
 
+inline void
+MapWindow::RenderAirspaceLabels(Canvas &canvas) noexcept
+{
+  if (GetMapSettings().airspace.enable)
     airspace_label_renderer.Draw(canvas,
-                                 render_projection,
+                                 render_projection, label_block,
                                  Basic(), Calculated(),
                                  GetComputerSettings().airspace,
                                  GetMapSettings().airspace);
-  }
 }
 
 inline void
@@ -173,6 +218,8 @@ MapWindow::Render(Canvas &canvas, const PixelRect &rc) noexcept
     return;
   }
 
+  PrepareLayers();
+
   // Calculate screen position of the aircraft
   PixelPoint aircraft_pos{0,0};
   if (basic.location_available)
@@ -187,72 +234,77 @@ MapWindow::Render(Canvas &canvas, const PixelRect &rc) noexcept
   //////////////////////////////////////////////// items on ground
 
   // Render terrain, groundline and topography
-  draw_sw.Mark("RenderTerrain");
+  frame_profiler.Mark(MapLayer::TERRAIN);
   RenderTerrain(canvas);
 
-  draw_sw.Mark("RenderRasp");
+  frame_profiler.Mark(MapLayer::RASP);
   RenderRasp(canvas);
 
-  draw_sw.Mark("RenderTopography");
+  frame_profiler.Mark(MapLayer::TOPOGRAPHY);
   RenderTopography(canvas);
 
-  draw_sw.Mark("RenderOverlays");
+  frame_profiler.Mark(MapLayer::OVERLAYS);
   RenderOverlays(canvas);
 
-  draw_sw.Mark("DrawNOAAStations");
+  frame_profiler.Mark(MapLayer::NOAA);
   RenderNOAAStations(canvas);
 
   //////////////////////////////////////////////// glide range info
 
-  draw_sw.Mark("RenderFinalGlideShading");
+  frame_profiler.Mark(MapLayer::FINAL_GLIDE_SHADING);
   RenderFinalGlideShading(canvas);
 
   //////////////////////////////////////////////// airspace
 
   // Render airspace
-  draw_sw.Mark("RenderAirspace");
+  frame_profiler.Mark(MapLayer::AIRSPACE);
   RenderAirspace(canvas);
 
   //////////////////////////////////////////////// task
 
   // Render task, waypoints
-  draw_sw.Mark("DrawContest");
+  frame_profiler.Mark(MapLayer::CONTEST);
   DrawContest(canvas);
 
-  draw_sw.Mark("DrawTask");
+  frame_profiler.Mark(MapLayer::TASK);
   DrawTask(canvas);
 
-  draw_sw.Mark("DrawWaypoints");
+  frame_profiler.Mark(MapLayer::WAYPOINTS);
   DrawWaypoints(canvas);
 
   //////////////////////////////////////////////// aircraft level items
   // Render the snail trail
+  frame_profiler.Mark(MapLayer::TRAIL);
   RenderTrail(canvas, aircraft_pos);
 
+  frame_profiler.Mark(MapLayer::THERMALS);
   DrawWaves(canvas);
 
   // Render estimate of thermal location
   DrawThermalEstimate(canvas);
 
   //////////////////////////////////////////////// text items
+  // Render airspace labels after the waypoints, so they don't take
+  // the space of task and landable waypoint labels
+  frame_profiler.Mark(MapLayer::AIRSPACE);
+  RenderAirspaceLabels(canvas);
+
   // Render topography on top of airspace, to keep the text readable
-  draw_sw.Mark("RenderTopographyLabels");
+  frame_profiler.Mark(MapLayer::TOPOGRAPHY_LABELS);
   RenderTopographyLabels(canvas);
 
   //////////////////////////////////////////////// navigation overlays
   // Render glide through terrain range
-  draw_sw.Mark("RenderGlide");
+  frame_profiler.Mark(MapLayer::GLIDE);
   RenderGlide(canvas);
 
-  draw_sw.Mark("RenderMisc1");
+  frame_profiler.Mark(MapLayer::NAVIGATION);
   // Render weather/terrain max/min values
   DrawTaskOffTrackIndicator(canvas);
 
   // Render track bearing (projected track ground/air relative)
-  draw_sw.Mark("DrawTrackBearing");
   RenderTrackBearing(canvas, aircraft_pos);
 
-  draw_sw.Mark("RenderMisc2");
   DrawBestCruiseTrack(canvas, aircraft_pos);
 
   // Draw wind vector at aircraft
@@ -264,6 +316,7 @@ MapWindow::Render(Canvas &canvas, const PixelRect &rc) noexcept
 
   //////////////////////////////////////////////// traffic
   // Draw traffic
+  frame_profiler.Mark(MapLayer::TRAFFIC);
 
 #ifdef HAVE_SKYLINES_TRACKING
   DrawSkyLinesTraffic(canvas);
@@ -277,6 +330,7 @@ MapWindow::Render(Canvas &canvas, const PixelRect &rc) noexcept
 
   //////////////////////////////////////////////// own aircraft
   // Finally, draw you!
+  frame_profiler.Mark(MapLayer::AIRCRAFT);
   if (basic.location_available)
     AircraftRenderer::Draw(canvas, GetMapSettings(), look.aircraft,
                            basic.attitude.heading - render_projection.GetScreenAngle(),
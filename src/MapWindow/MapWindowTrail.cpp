@@ -6,22 +6,26 @@
 #include "Computer/GlideComputer.hpp"
 
 void
-MapWindow::RenderTrail(Canvas &canvas, const PixelPoint aircraft_pos) noexcept
+MapWindow::PrepareTrail() noexcept
 {
   auto min_time = std::max(Basic().time - std::chrono::minutes{10},
                            TimeStamp{});
 
-  DrawTrail(canvas, aircraft_pos, min_time);
+  LoadTrail(min_time);
 }
 
 void
-MapWindow::DrawTrail(Canvas &canvas, const PixelPoint aircraft_pos,
-                     TimeStamp min_time,
-                     bool enable_traildrift) noexcept
+MapWindow::LoadTrail(TimeStamp min_time, bool enable_traildrift) noexcept
 {
   if (glide_computer)
-    trail_renderer.Draw(canvas, glide_computer->GetTraceComputer(),
-                        render_projection, min_time,
-                        enable_traildrift, aircraft_pos,
-                        Basic(), Calculated(), GetMapSettings().trail);
+    trail_renderer.PrepareTrail(glide_computer->GetTraceComputer(),
+                                render_projection, min_time,
+                                enable_traildrift,
+                                Basic(), Calculated(), GetMapSettings().trail);
+}
+
+void
+MapWindow::RenderTrail(Canvas &canvas, const PixelPoint aircraft_pos) noexcept
+{
+  trail_renderer.DrawPreparedTrail(canvas, aircraft_pos);
 }
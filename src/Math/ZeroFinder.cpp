@@ -2,6 +2,7 @@
 // Copyright The XCSoar Project
 #include "ZeroFinder.hpp"
 
+#include <algorithm>
 #include <limits>
 
 #include <math.h>
@@ -110,26 +111,41 @@ double
 ZeroFinder::find_zero(const double xstart) noexcept
 {
   if ((xmin<=xstart) || (xstart<=xmax) ||
-      (f(xstart)> sqrt_epsilon))
-    return find_zero_actual(xstart);
+      (f(xstart)> sqrt_epsilon)) {
+    const double fa = f(xmin);
+    return find_zero_actual(xmin, fa, xmax, f(xmax));
+  }
   return xstart;
 }
 
+double
+ZeroFinder::find_zero_near(const double xstart, const double radius) noexcept
+{
+  const double a = std::max(xstart - radius, xmin);
+  const double b = std::min(xstart + radius, xmax);
+  if (a >= b)
+    return find_zero(xstart);
+
+  const double fa = f(a);
+  const double fb = f(b);
+  if ((fa > 0 && fb > 0) || (fa < 0 && fb < 0))
+    // no zero in this bracket
+    return find_zero(xstart);
+
+  return find_zero_actual(a, fa, b, fb);
+}
+
 inline double
-ZeroFinder::find_zero_actual([[maybe_unused]] const double xstart) noexcept
+ZeroFinder::find_zero_actual(double a, double fa,
+                             double b, double fb) noexcept
 {
-  double a, b, c; // Abscissae, descr. see above
-  double fa; // f(a)
-  double fb; // f(b)
+  double c; // Abscissae, descr. see above
   double fc; // f(c)
 
   bool b_best = true; // b is best and last called
 
-  c = a = xmin;  
-  fc = fa = f(a);  
-
-  b = xmax;  
-  fb = f(b);
+  c = a;
+  fc = fa;
 
   // Main iteration loop
   for (;;) {
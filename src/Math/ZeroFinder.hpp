@@ -55,6 +55,21 @@ public:
   [[gnu::pure]]
   double find_zero(double xstart) noexcept;
 
+  /**
+   * Like find_zero(), but first search a small bracket around xstart,
+   * which saves iterations if xstart is the solution of a previous
+   * search of a function which has changed only slightly.  Falls
+   * back to searching the whole range if the bracket does not
+   * contain a zero.
+   *
+   * @param xstart Initial guess of x
+   * @param radius Half width of the initial bracket
+   *
+   * @return x value of best solution
+   */
+  [[gnu::pure]]
+  double find_zero_near(double xstart, double radius) noexcept;
+
   /**
    * Find value of x that minimises f(x)
    * Method used is a variant of a bisector search.
@@ -68,8 +83,14 @@ public:
   double find_min(double xstart) noexcept;
 
 private:
+  /**
+   * @param a the lower bound of the bracket
+   * @param fa f(a)
+   * @param b the upper bound of the bracket
+   * @param fb f(b)
+   */
   [[gnu::pure]]
-  double find_zero_actual(double xstart) noexcept;
+  double find_zero_actual(double a, double fa, double b, double fb) noexcept;
 
   [[gnu::pure]]
   double find_min_actual(double xstart) noexcept;
@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#ifdef ENABLE_OPENGL
+
+#include "AirspaceGeometryCache.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AbstractAirspace.hpp"
+#include "Geo/SearchPointVector.hpp"
+#include "Math/Point2D.hpp"
+#include "ui/canvas/opengl/Buffer.hpp"
+#include "ui/canvas/opengl/Geo.hpp"
+#include "ui/canvas/opengl/Shaders.hpp"
+#include "ui/canvas/opengl/Program.hpp"
+#include "ui/canvas/opengl/Triangulate.hpp"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <vector>
+
+/**
+ * Don't triangulate vertices which are closer than this [radians].
+ * This is roughly one meter, much less than a pixel at any sensible
+ * map scale.
+ */
+static constexpr float MIN_VERTEX_DISTANCE = 1.5e-7;
+
+AirspaceGeometryCache::AirspaceGeometryCache() noexcept = default;
+AirspaceGeometryCache::~AirspaceGeometryCache() noexcept = default;
+
+void
+AirspaceGeometryCache::Update(const Airspaces &_airspaces) noexcept
+{
+  if (&_airspaces == airspaces && _airspaces.GetSerial() == serial)
+    /* cache is clean */
+    return;
+
+  airspaces = &_airspaces;
+  serial = _airspaces.GetSerial();
+  items.clear();
+
+  reference = _airspaces.GetProjection().IsValid()
+    ? _airspaces.GetProjection().GetCenter()
+    : GeoPoint::Zero();
+
+  std::vector<FloatPoint2D> vertex_data;
+  std::vector<GLushort> index_data;
+
+  for (const auto &i : _airspaces.QueryAll()) {
+    const AbstractAirspace &airspace = i.GetAirspace();
+    if (airspace.GetShape() != AbstractAirspace::Shape::POLYGON)
+      continue;
+
+    const SearchPointVector &points = airspace.GetPoints();
+    if (points.size() < 3 || points.size() >= 0x10000)
+      /* too large for 16 bit indices; these will be drawn the old
+         way */
+      continue;
+
+    Item item;
+    item.bounds = points.CalculateGeoBounds();
+    item.first_vertex = vertex_data.size();
+    item.n_vertices = points.size();
+
+    for (const auto &p : points) {
+      const GeoPoint delta = p.GetLocation() - reference;
+      vertex_data.emplace_back(float(delta.longitude.Native()),
+                               float(delta.latitude.Native()));
+    }
+
+    /* the indices are relative to the airspace's first vertex */
+    item.first_index = index_data.size();
+    index_data.resize(item.first_index + 3 * (item.n_vertices - 2));
+    item.n_indices =
+      PolygonToTriangles(vertex_data.data() + item.first_vertex,
+                         item.n_vertices,
+                         index_data.data() + item.first_index,
+                         MIN_VERTEX_DISTANCE);
+    index_data.resize(item.first_index + item.n_indices);
+
+    items.emplace(&airspace, item);
+  }
+
+  if (vertices == nullptr)
+    vertices = std::make_unique<GLArrayBuffer>();
+  vertices->Load(vertex_data.size() * sizeof(vertex_data.front()),
+                 vertex_data.data());
+
+  if (indices == nullptr)
+    indices = std::make_unique<GLElementArrayBuffer>();
+  indices->Load(index_data.size() * sizeof(index_data.front()),
+                index_data.data());
+}
+
+glm::mat4
+AirspaceGeometryCache::GetMatrix(const WindowProjection &projection) const noexcept
+{
+  return ToGLM(projection, reference);
+}
+
+AirspaceGeometryCache::Scope::Scope(const AirspaceGeometryCache &cache,
+                                    const glm::mat4 &matrix) noexcept
+{
+  OpenGL::solid_shader->Use();
+  glUniformMatrix4fv(OpenGL::solid_modelview, 1, GL_FALSE,
+                     glm::value_ptr(matrix));
+
+  cache.vertices->Bind();
+  cache.indices->Bind();
+}
+
+AirspaceGeometryCache::Scope::~Scope() noexcept
+{
+  GLElementArrayBuffer::Unbind();
+  GLArrayBuffer::Unbind();
+
+  glUniformMatrix4fv(OpenGL::solid_modelview, 1, GL_FALSE,
+                     glm::value_ptr(glm::mat4(1)));
+}
+
+void
+AirspaceGeometryCache::Scope::DrawFill(const Item &item) noexcept
+{
+  if (item.n_indices == 0)
+    return;
+
+  const FloatPoint2D *const vertex_buffer = nullptr;
+  const GLushort *const index_buffer = nullptr;
+
+  vp.Update(GL_FLOAT, vertex_buffer + item.first_vertex);
+  glDrawElements(GL_TRIANGLES, item.n_indices, GL_UNSIGNED_SHORT,
+                 index_buffer + item.first_index);
+}
+
+void
+AirspaceGeometryCache::Scope::DrawOutline(const Item &item) noexcept
+{
+  const FloatPoint2D *const vertex_buffer = nullptr;
+
+  vp.Update(GL_FLOAT, vertex_buffer + item.first_vertex);
+  glDrawArrays(GL_LINE_LOOP, 0, item.n_vertices);
+}
+
+#endif /* ENABLE_OPENGL */
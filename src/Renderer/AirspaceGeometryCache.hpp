@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Geo/GeoPoint.hpp"
+#include "Geo/GeoBounds.hpp"
+#include "ui/canvas/opengl/VertexPointer.hpp"
+#include "util/Serial.hpp"
+
+#include <glm/mat4x4.hpp>
+
+#include <memory>
+#include <unordered_map>
+
+class Airspaces;
+class AbstractAirspace;
+class GLArrayBuffer;
+class GLElementArrayBuffer;
+class WindowProjection;
+
+/**
+ * Keeps the outlines and the triangulated interiors of all polygon
+ * airspaces in OpenGL buffer objects.
+ *
+ * The vertices are stored in angles relative to a reference location,
+ * just like #TopographyFile stores its shapes; therefore they do not
+ * depend on the map projection, which is applied by the modelview
+ * matrix in the shader.  The buffers are rebuilt only when the
+ * airspace database changes, and drawing an airspace costs one or
+ * two draw calls without any per-vertex CPU work.
+ */
+class AirspaceGeometryCache {
+public:
+  struct Item {
+    GeoBounds bounds;
+
+    /**
+     * The first outline vertex in the array buffer and the number of
+     * vertices.
+     */
+    unsigned first_vertex, n_vertices;
+
+    /**
+     * The first index of the interior triangles (#GL_TRIANGLES) in
+     * the element array buffer and the number of indices.
+     */
+    unsigned first_index, n_indices;
+  };
+
+private:
+  const Airspaces *airspaces = nullptr;
+  Serial serial;
+
+  /**
+   * The location which all vertices are relative to.
+   */
+  GeoPoint reference;
+
+  std::unique_ptr<GLArrayBuffer> vertices;
+  std::unique_ptr<GLElementArrayBuffer> indices;
+
+  std::unordered_map<const AbstractAirspace *, Item> items;
+
+public:
+  AirspaceGeometryCache() noexcept;
+  ~AirspaceGeometryCache() noexcept;
+
+  AirspaceGeometryCache(const AirspaceGeometryCache &) = delete;
+  AirspaceGeometryCache &operator=(const AirspaceGeometryCache &) = delete;
+
+  /**
+   * Rebuild the buffers if the airspace database has changed since
+   * the last call.  Must be called in the OpenGL thread.
+   */
+  void Update(const Airspaces &airspaces) noexcept;
+
+  /**
+   * Forget the cached geometry; it will be rebuilt by the next
+   * Update() call.
+   */
+  void Flush() noexcept {
+    airspaces = nullptr;
+    items.clear();
+  }
+
+  /**
+   * Returns the cached geometry of the specified airspace, or nullptr
+   * if it is not cached (e.g. because it is a circle).
+   */
+  [[gnu::pure]]
+  const Item *Find(const AbstractAirspace &airspace) const noexcept {
+    auto i = items.find(&airspace);
+    return i != items.end() ? &i->second : nullptr;
+  }
+
+  /**
+   * Calculate the modelview matrix for the given projection.
+   */
+  [[gnu::pure]]
+  glm::mat4 GetMatrix(const WindowProjection &projection) const noexcept;
+
+  /**
+   * Selects the solid shader, the buffers and the modelview matrix
+   * for drawing cached geometry; the destructor restores the
+   * defaults expected by #Canvas.  Create it only for the duration of
+   * the draw calls, and don't use #Canvas while it exists.
+   */
+  class Scope {
+    ScopeVertexPointer vp;
+
+  public:
+    Scope(const AirspaceGeometryCache &_cache,
+          const glm::mat4 &matrix) noexcept;
+    ~Scope() noexcept;
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+    /**
+     * Draw the interior with the current color and stencil settings.
+     */
+    void DrawFill(const Item &item) noexcept;
+
+    /**
+     * Draw the outline as a #GL_LINE_LOOP; the caller is responsible
+     * for binding the #Pen, and only thin pens (width up to 2) are
+     * supported.
+     */
+    void DrawOutline(const Item &item) noexcept;
+  };
+};
@@ -3,6 +3,7 @@
 
 #include "AirspaceLabelRenderer.hpp"
 #include "AirspaceRendererSettings.hpp"
+#include "LabelBlock.hpp"
 #include "Projection/WindowProjection.hpp"
 #include "Look/AirspaceLook.hpp"
 #include "Airspace/Airspaces.hpp"
@@ -39,6 +40,7 @@ public:
 void
 AirspaceLabelRenderer::Draw(Canvas &canvas,
                             const WindowProjection &projection,
+                            LabelBlock &label_block,
                             const MoreData &basic, const DerivedInfo &calculated,
                             const AirspaceComputerSettings &computer_settings,
                             const AirspaceRendererSettings &settings) noexcept
@@ -56,12 +58,13 @@ AirspaceLabelRenderer::Draw(Canvas &canvas,
                                    aircraft, awc);
 
   DrawInternal(canvas,
-               projection, visible, computer_settings.warnings);
+               projection, label_block, visible, computer_settings.warnings);
 }
 
 inline void
 AirspaceLabelRenderer::DrawInternal(Canvas &canvas,
                                     const WindowProjection &projection,
+                                    LabelBlock &label_block,
                                     AirspacePredicate visible,
                                     const AirspaceWarningConfig &config) noexcept
 {
@@ -83,14 +86,15 @@ AirspaceLabelRenderer::DrawInternal(Canvas &canvas,
   canvas.Select(look.label_brush);
   canvas.SetBackgroundTransparent();
 
-  // draw
+  // draw, most important labels first
   for (const auto &label : labels)
-    DrawLabel(canvas, projection, label);
+    DrawLabel(canvas, projection, label_block, label);
 }
 
 inline void
 AirspaceLabelRenderer::DrawLabel(Canvas &canvas,
                                  const WindowProjection &projection,
+                                 LabelBlock &label_block,
                                  const AirspaceLabelList::Label &label) noexcept
 {
   TCHAR topText[NAME_SIZE + 1];
@@ -113,6 +117,10 @@ AirspaceLabelRenderer::DrawLabel(Canvas &canvas,
   rect.top = pos.y;
   rect.right = rect.left + labelWidth;
   rect.bottom = rect.top + labelHeight;
+
+  if (!label_block.check(rect))
+    return;
+
   canvas.DrawRectangle(rect);
 
 #ifdef USE_GDI
@@ -16,6 +16,7 @@ class Airspaces;
 class ProtectedAirspaceWarningManager;
 class Canvas;
 class WindowProjection;
+class LabelBlock;
 
 class AirspaceLabelRenderer
 {
@@ -55,18 +56,22 @@ public:
 private:
   void DrawInternal(Canvas &canvas,
                     const WindowProjection &projection,
+                    LabelBlock &label_block,
                     AirspacePredicate visible,
                     const AirspaceWarningConfig &config) noexcept;
 
   void DrawLabel(Canvas &canvas, const WindowProjection &projection,
+                 LabelBlock &label_block,
                  const AirspaceLabelList::Label &label) noexcept;
 
 public:
    /**
-   * Draw labels that are visible according to standard rules.
+   * Draw labels that are visible according to standard rules.  Labels
+   * overlapping with a label in the #LabelBlock are skipped.
    */
   void Draw(Canvas &canvas,
             const WindowProjection &projection,
+            LabelBlock &label_block,
             const MoreData &basic, const DerivedInfo &calculated,
             const AirspaceComputerSettings &computer_settings,
             const AirspaceRendererSettings &settings) noexcept;
@@ -33,6 +33,17 @@ public:
   }
 };
 
+void
+AirspaceRenderer::Flush()
+{
+#ifdef ENABLE_OPENGL
+  if (geometry_cache != nullptr)
+    geometry_cache->Flush();
+#else
+  fill_cache.Invalidate();
+#endif
+}
+
 void
 AirspaceRenderer::DrawIntersections(Canvas &canvas,
                                     const WindowProjection &projection) const
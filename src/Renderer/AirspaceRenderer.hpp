@@ -7,7 +7,11 @@
 #include "util/StaticArray.hxx"
 #include "Geo/GeoPoint.hpp"
 
-#ifndef ENABLE_OPENGL
+#ifdef ENABLE_OPENGL
+#include "AirspaceGeometryCache.hpp"
+
+#include <memory>
+#else
 #include "TransparentRendererCache.hpp"
 #include "util/Serial.hpp"
 #endif
@@ -32,7 +36,15 @@ class AirspaceRenderer
 
   StaticArray<GeoPoint,32> intersections;
 
-#ifndef ENABLE_OPENGL
+#ifdef ENABLE_OPENGL
+  /**
+   * Caches the triangulated polygons in OpenGL buffers.  This is only
+   * enabled by long-lived renderers (see EnableGeometryCache()),
+   * because building the cache costs more than drawing a single
+   * frame.
+   */
+  std::unique_ptr<AirspaceGeometryCache> geometry_cache;
+#else
   /**
    * This object caches the airspace fill.  This avoids drawing it
    * again and again each frame when nothing has changed.
@@ -46,6 +58,13 @@ public:
   AirspaceRenderer(const AirspaceLook &_look)
     :look(_look) {}
 
+#ifdef ENABLE_OPENGL
+  /**
+   * Keep the airspace geometry in OpenGL buffers between frames.
+   */
+  void EnableGeometryCache();
+#endif
+
   const AirspaceLook &GetLook() const {
     return look;
   }
@@ -69,13 +88,10 @@ public:
   void Clear() {
     airspaces = nullptr;
     warning_manager = nullptr;
+    Flush();
   }
 
-  void Flush() {
-#ifndef ENABLE_OPENGL
-    fill_cache.Invalidate();
-#endif
-  }
+  void Flush();
 
 private:
 #ifndef ENABLE_OPENGL
@@ -5,6 +5,7 @@
 
 #include "AirspaceRenderer.hpp"
 #include "AirspaceRendererSettings.hpp"
+#include "AirspaceGeometryCache.hpp"
 #include "Projection/WindowProjection.hpp"
 #include "ui/canvas/Canvas.hpp"
 #include "MapWindow/MapCanvas.hpp"
@@ -16,8 +17,72 @@
 #include "Engine/Airspace/Predicate/AirspacePredicate.hpp"
 #include "ui/canvas/opengl/Scope.hpp"
 
-class AirspaceVisitorRenderer final
+/**
+ * Base class for the airspace renderers which can draw polygons from
+ * an #AirspaceGeometryCache.
+ */
+class CachedAirspaceRenderer
   : protected MapCanvas
+{
+protected:
+  /**
+   * The geometry cache; nullptr if polygons shall be projected and
+   * triangulated each frame.
+   */
+  const AirspaceGeometryCache *const cache;
+
+  const glm::mat4 matrix;
+
+  const GeoBounds screen_bounds;
+
+  const Pen black_pen{1, COLOR_BLACK};
+
+  CachedAirspaceRenderer(Canvas &_canvas, const WindowProjection &_projection,
+                         const AirspaceGeometryCache *_cache) noexcept
+    :MapCanvas(_canvas, _projection,
+               _projection.GetScreenBounds().Scale(1.1)),
+     cache(_cache),
+     matrix(cache != nullptr ? cache->GetMatrix(_projection) : glm::mat4(1)),
+     screen_bounds(_projection.GetScreenBounds()) {}
+
+  const AirspaceGeometryCache::Item *
+  FindCached(const AbstractAirspace &airspace) const noexcept {
+    return cache != nullptr ? cache->Find(airspace) : nullptr;
+  }
+
+  bool IsVisible(const AirspaceGeometryCache::Item &item) const noexcept {
+    return screen_bounds.Overlaps(item.bounds);
+  }
+
+  void DrawCachedFill(const AirspaceGeometryCache::Item &item,
+                      const Color color) noexcept {
+    AirspaceGeometryCache::Scope scope(*cache, matrix);
+    color.Bind();
+    scope.DrawFill(item);
+  }
+
+  /**
+   * Draw the outline with the given pen, which must have been
+   * selected into the #Canvas already.
+   */
+  void DrawCachedOutline(const AbstractAirspace &airspace,
+                         const AirspaceGeometryCache::Item &item,
+                         const Pen &pen) noexcept {
+    if (pen.GetWidth() <= 2) {
+      AirspaceGeometryCache::Scope scope(*cache, matrix);
+      pen.Bind();
+      scope.DrawOutline(item);
+      pen.Unbind();
+    } else if (PreparePolygon(airspace.GetPoints())) {
+      /* thick lines are converted to triangles in screen
+         coordinates */
+      DrawPrepared();
+    }
+  }
+};
+
+class AirspaceVisitorRenderer final
+  : protected CachedAirspaceRenderer
 {
   const AirspaceLook &look;
   const AirspaceWarningCopy &warning_manager;
@@ -25,11 +90,11 @@ class AirspaceVisitorRenderer final
 
 public:
   AirspaceVisitorRenderer(Canvas &_canvas, const WindowProjection &_projection,
+                          const AirspaceGeometryCache *_cache,
                           const AirspaceLook &_look,
                           const AirspaceWarningCopy &_warnings,
                           const AirspaceRendererSettings &_settings)
-    :MapCanvas(_canvas, _projection,
-               _projection.GetScreenBounds().Scale(1.1)),
+    :CachedAirspaceRenderer(_canvas, _projection, _cache),
      look(_look), warning_manager(_warnings), settings(_settings)
   {
     glStencilMask(0xff);
@@ -80,6 +145,11 @@ private:
   }
 
   void VisitPolygon(const AirspacePolygon &airspace) {
+    if (const auto *item = FindCached(airspace)) {
+      VisitCachedPolygon(airspace, *item);
+      return;
+    }
+
     if (!PreparePolygon(airspace.GetPoints()))
       return;
 
@@ -123,6 +193,57 @@ private:
       DrawPrepared();
   }
 
+  void VisitCachedPolygon(const AbstractAirspace &airspace,
+                          const AirspaceGeometryCache::Item &item) {
+    if (!IsVisible(item))
+      return;
+
+    const AirspaceClassRendererSettings &class_settings =
+      settings.classes[airspace.GetClass()];
+
+    bool fill_airspace = warning_manager.HasWarning(airspace) ||
+      warning_manager.IsInside(airspace) ||
+      class_settings.fill_mode ==
+      AirspaceClassRendererSettings::FillMode::ALL;
+
+    if (!warning_manager.IsAcked(airspace) &&
+        class_settings.fill_mode !=
+        AirspaceClassRendererSettings::FillMode::NONE) {
+      const GLEnable<GL_STENCIL_TEST> stencil;
+
+      /* the padding stencil is drawn with a thick pen, which needs
+         screen coordinates; only the (expensive) interior comes from
+         the cache */
+      if (!fill_airspace) {
+        if (!PreparePolygon(airspace.GetPoints()))
+          return;
+
+        // set stencil for filling (bit 0)
+        SetFillStencil();
+        DrawPrepared();
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+      }
+
+      // fill interior without overpainting any previous outlines
+      {
+        SetupInterior(airspace, !fill_airspace);
+        const GLEnable<GL_BLEND> blend;
+        DrawCachedFill(item, GetInteriorColor(airspace));
+      }
+
+      if (!fill_airspace) {
+        // clear fill stencil (bit 0)
+        ClearFillStencil();
+        DrawPrepared();
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+      }
+    }
+
+    // draw outline
+    if (const Pen *pen = SetupOutline(airspace))
+      DrawCachedOutline(airspace, item, *pen);
+  }
+
 public:
   void Visit(const AbstractAirspace &airspace) {
     switch (airspace.GetShape()) {
@@ -137,17 +258,22 @@ public:
   }
 
 private:
-  bool SetupOutline(const AbstractAirspace &airspace) {
+  /**
+   * @return the selected pen or nullptr if no outline shall be drawn
+   */
+  const Pen *SetupOutline(const AbstractAirspace &airspace) {
     AirspaceClass type = airspace.GetClass();
 
+    const Pen *pen;
     if (settings.black_outline)
-      canvas.SelectBlackPen();
+      pen = &black_pen;
     else if (settings.classes[type].border_width == 0)
       // Don't draw outlines if border_width == 0
-      return false;
+      return nullptr;
     else
-      canvas.Select(look.classes[type].border_pen);
+      pen = &look.classes[type].border_pen;
 
+    canvas.Select(*pen);
     canvas.SelectHollowBrush();
 
     // set bit 1 in stencil buffer, where an outline is drawn
@@ -155,13 +281,15 @@ private:
     glStencilMask(2);
     glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
 
-    return true;
+    return pen;
+  }
+
+  Color GetInteriorColor(const AbstractAirspace &airspace) const {
+    return look.classes[airspace.GetClass()].fill_color.WithAlpha(90);
   }
 
   void SetupInterior(const AbstractAirspace &airspace,
                      bool check_fillstencil = false) {
-    const AirspaceClassLook &class_look = look.classes[airspace.GetClass()];
-
     // restrict drawing area and don't paint over previously drawn outlines
     if (check_fillstencil)
       glStencilFunc(GL_EQUAL, 1, 3);
@@ -169,7 +297,7 @@ private:
       glStencilFunc(GL_EQUAL, 0, 2);
     glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
 
-    canvas.Select(Brush(class_look.fill_color.WithAlpha(90)));
+    canvas.Select(Brush(GetInteriorColor(airspace)));
     canvas.SelectNullPen();
   }
 
@@ -195,7 +323,7 @@ private:
 };
 
 class AirspaceFillRenderer final
-  : protected MapCanvas
+  : protected CachedAirspaceRenderer
 {
   const AirspaceLook &look;
   const AirspaceWarningCopy &warning_manager;
@@ -203,11 +331,11 @@ class AirspaceFillRenderer final
 
 public:
   AirspaceFillRenderer(Canvas &_canvas, const WindowProjection &_projection,
+                       const AirspaceGeometryCache *_cache,
                        const AirspaceLook &_look,
                        const AirspaceWarningCopy &_warnings,
                        const AirspaceRendererSettings &_settings)
-    :MapCanvas(_canvas, _projection,
-               _projection.GetScreenBounds().Scale(1.1)),
+    :CachedAirspaceRenderer(_canvas, _projection, _cache),
      look(_look), warning_manager(_warnings), settings(_settings)
   {
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -229,6 +357,11 @@ private:
   }
 
   void VisitPolygon(const AirspacePolygon &airspace) {
+    if (const auto *item = FindCached(airspace)) {
+      VisitCachedPolygon(airspace, *item);
+      return;
+    }
+
     if (!PreparePolygon(airspace.GetPoints()))
       return;
 
@@ -243,6 +376,21 @@ private:
       DrawPrepared();
   }
 
+  void VisitCachedPolygon(const AbstractAirspace &airspace,
+                          const AirspaceGeometryCache::Item &item) {
+    if (!IsVisible(item))
+      return;
+
+    if (!warning_manager.IsAcked(airspace) && SetupInterior(airspace)) {
+      GLEnable<GL_BLEND> blend;
+      DrawCachedFill(item, GetInteriorColor(airspace));
+    }
+
+    // draw outline
+    if (const Pen *pen = SetupOutline(airspace))
+      DrawCachedOutline(airspace, item, *pen);
+  }
+
 public:
   void Visit(const AbstractAirspace &airspace) {
     switch (airspace.GetShape()) {
@@ -257,35 +405,49 @@ public:
   }
 
 private:
-  bool SetupOutline(const AbstractAirspace &airspace) {
+  /**
+   * @return the selected pen or nullptr if no outline shall be drawn
+   */
+  const Pen *SetupOutline(const AbstractAirspace &airspace) {
     AirspaceClass type = airspace.GetClass();
 
+    const Pen *pen;
     if (settings.black_outline)
-      canvas.SelectBlackPen();
+      pen = &black_pen;
     else if (settings.classes[type].border_width == 0)
       // Don't draw outlines if border_width == 0
-      return false;
+      return nullptr;
     else
-      canvas.Select(look.classes[type].border_pen);
+      pen = &look.classes[type].border_pen;
 
+    canvas.Select(*pen);
     canvas.SelectHollowBrush();
 
-    return true;
+    return pen;
+  }
+
+  Color GetInteriorColor(const AbstractAirspace &airspace) const {
+    return look.classes[airspace.GetClass()].fill_color.WithAlpha(48);
   }
 
   bool SetupInterior(const AbstractAirspace &airspace) {
     if (settings.fill_mode == AirspaceRendererSettings::FillMode::NONE)
       return false;
 
-    const AirspaceClassLook &class_look = look.classes[airspace.GetClass()];
-
-    canvas.Select(Brush(class_look.fill_color.WithAlpha(48)));
+    canvas.Select(Brush(GetInteriorColor(airspace)));
     canvas.SelectNullPen();
 
     return true;
   }
 };
 
+void
+AirspaceRenderer::EnableGeometryCache()
+{
+  if (geometry_cache == nullptr)
+    geometry_cache = std::make_unique<AirspaceGeometryCache>();
+}
+
 void
 AirspaceRenderer::DrawInternal(Canvas &canvas,
                                const WindowProjection &projection,
@@ -297,16 +459,24 @@ AirspaceRenderer::DrawInternal(Canvas &canvas,
     airspaces->QueryWithinRange(projection.GetGeoScreenCenter(),
                                 projection.GetScreenDistanceMeters());
 
+  const AirspaceGeometryCache *cache = nullptr;
+  if (geometry_cache != nullptr) {
+    geometry_cache->Update(*airspaces);
+    cache = geometry_cache.get();
+  }
+
   if (settings.fill_mode == AirspaceRendererSettings::FillMode::ALL ||
       settings.fill_mode == AirspaceRendererSettings::FillMode::NONE) {
-    AirspaceFillRenderer renderer(canvas, projection, look, awc, settings);
+    AirspaceFillRenderer renderer(canvas, projection, cache,
+                                  look, awc, settings);
     for (const auto &i : range) {
       const AbstractAirspace &airspace = i.GetAirspace();
       if (visible(airspace))
         renderer.Visit(airspace);
     }
   } else {
-    AirspaceVisitorRenderer renderer(canvas, projection, look, awc, settings);
+    AirspaceVisitorRenderer renderer(canvas, projection, cache,
+                                     look, awc, settings);
     for (const auto &i : range) {
       const AbstractAirspace &airspace = i.GetAirspace();
       if (visible(airspace))
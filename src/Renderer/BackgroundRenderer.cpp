@@ -26,6 +26,25 @@ BackgroundRenderer::SetTerrain(const RasterTerrain *_terrain)
   renderer.reset();
 }
 
+#ifndef ENABLE_OPENGL
+
+void
+BackgroundRenderer::Prepare(const WindowProjection &proj,
+                            const TerrainRendererSettings &terrain_settings)
+{
+  if (terrain_settings.enable && terrain != nullptr) {
+    if (!renderer)
+      renderer.reset(new TerrainRenderer(*terrain));
+
+    renderer->SetSettings(terrain_settings);
+
+    /* the result is cached; Draw() will find it unchanged */
+    renderer->Generate(proj, shading_angle);
+  }
+}
+
+#endif
+
 void
 BackgroundRenderer::Draw(Canvas& canvas,
                          const WindowProjection& proj,
@@ -34,6 +34,15 @@ public:
    */
   void Flush();
 
+#ifndef ENABLE_OPENGL
+  /**
+   * Generate the terrain image for Draw().  This does not touch the
+   * #Canvas and may therefore run in a worker thread.
+   */
+  void Prepare(const WindowProjection &proj,
+               const TerrainRendererSettings &terrain_settings);
+#endif
+
   void Draw(Canvas& canvas,
             const WindowProjection& proj,
             const TerrainRendererSettings &terrain_settings);
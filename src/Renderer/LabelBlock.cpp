@@ -4,40 +4,56 @@
 #include "LabelBlock.hpp"
 
 inline bool
-LabelBlock::Bucket::Check(const PixelRect rc) const noexcept
+LabelBlock::Overlaps(std::size_t bucket, const PixelRect rc) const noexcept
 {
-  for (auto i = blocks.begin(), end = blocks.end(); i != end; ++i)
-    if (i->OverlapsWith(rc))
-      return false;
+  for (uint32_t i = buckets[bucket]; i != NONE; i = nodes[i].next)
+    if (rects[nodes[i].rect].OverlapsWith(rc))
+      return true;
 
-  return true;
+  return false;
+}
+
+inline void
+LabelBlock::Add(std::size_t bucket, uint32_t rect) noexcept
+{
+  nodes.push_back({rect, buckets[bucket]});
+  buckets[bucket] = nodes.size() - 1;
 }
 
 void
 LabelBlock::reset() noexcept
 {
-  for (auto &i : buckets)
-    i.Clear();
+  rects.clear();
+  nodes.clear();
+  buckets.fill(NONE);
 }
 
 bool
 LabelBlock::check(const PixelRect rc) noexcept
 {
-  unsigned top = rc.top >> BUCKET_SHIFT;
-  unsigned bottom = rc.bottom >> BUCKET_SHIFT;
-
-  if (top >= BUCKET_COUNT)
-    top = BUCKET_COUNT - 1;
-
-  if (bottom < BUCKET_COUNT && !buckets[bottom].Check(rc))
-    return false;
-
-  if (top < bottom && !buckets[top].Check(rc))
-    return false;
-
-  buckets[top].Add(rc);
-  if (bottom < BUCKET_COUNT && top != bottom)
-    buckets[bottom].Add(rc);
+  /* the range of cells touched by the rectangle, including the
+     right and bottom edges, because PixelRect::OverlapsWith() treats
+     them as part of the rectangle; the arithmetic shift rounds
+     negative coordinates down */
+  const int left = rc.left >> CELL_SHIFT;
+  const int top = rc.top >> CELL_SHIFT;
+  const int right = rc.right >> CELL_SHIFT;
+  const int bottom = rc.bottom >> CELL_SHIFT;
+
+  /* a rectangle spanning several cells may be found in more than one
+     bucket, and different cells may share a bucket; both only cost a
+     redundant overlap test */
+  for (int y = top; y <= bottom; ++y)
+    for (int x = left; x <= right; ++x)
+      if (Overlaps(GetBucket(x, y), rc))
+        return false;
+
+  const uint32_t index = rects.size();
+  rects.push_back(rc);
+
+  for (int y = top; y <= bottom; ++y)
+    for (int x = left; x <= right; ++x)
+      Add(GetBucket(x, y), index);
 
   return true;
 }
@@ -4,43 +4,92 @@
 #pragma once
 
 #include "ui/dim/Rect.hpp"
-#include "util/StaticArray.hxx"
+
+#include <array>
+#include <cstdint>
+#include <vector>
 
 /**
  * Simple code to prevent text writing over map city names.
+ *
+ * The rectangles of all labels drawn so far are kept in a spatial
+ * hash: the screen is divided into square cells, and each hash bucket
+ * has a list of the rectangles touching its cells.  check() only
+ * tests the rectangles near the new one, and there is no limit on the
+ * number of labels.
+ *
+ * Labels are placed greedily in the order they are checked; callers
+ * check the most important labels first (see WaypointLabelList::Sort()
+ * and AirspaceLabelList::Sort()).
  */
 class LabelBlock {
-  static constexpr unsigned SCREEN_HEIGHT = 4096;
-  static constexpr unsigned BUCKET_SIZE = 64;
-  static constexpr unsigned BUCKET_SHIFT = 7;
-  static constexpr unsigned BUCKET_HEIGHT = 1 << BUCKET_SHIFT;
-  static constexpr unsigned BUCKET_COUNT = SCREEN_HEIGHT / BUCKET_HEIGHT;
+  /**
+   * The size of one grid cell is 2^CELL_SHIFT pixels; this is a few
+   * times the height of a typical label.
+   */
+  static constexpr unsigned CELL_SHIFT = 6;
 
   /**
-   * A bucket is responsible for hit tests in one horizontal section
-   * of the screen.
+   * The number of hash buckets; must be a power of two.
    */
-  class Bucket {
-    typedef StaticArray<PixelRect, BUCKET_SIZE> BlockArray;
-    BlockArray blocks;
-
-  public:
-    void Clear() noexcept {
-      blocks.clear();
-    }
-
-    [[gnu::pure]]
-    bool Check(const PixelRect rc) const noexcept;
-
-    void Add(const PixelRect rc) noexcept {
-      if (!blocks.full())
-        blocks.append(rc);
-    }
+  static constexpr std::size_t BUCKET_COUNT = 1024;
+
+  static constexpr uint32_t NONE = UINT32_MAX;
+
+  /**
+   * An entry in a bucket's linked list.
+   */
+  struct Node {
+    /**
+     * Index into #rects.
+     */
+    uint32_t rect;
+
+    /**
+     * Index of the next node in #nodes, or #NONE.
+     */
+    uint32_t next;
   };
 
-  Bucket buckets[BUCKET_COUNT];
+  std::vector<PixelRect> rects;
+  std::vector<Node> nodes;
+
+  /**
+   * The first node of each bucket, or #NONE.
+   */
+  std::array<uint32_t, BUCKET_COUNT> buckets;
 
 public:
+  LabelBlock() noexcept {
+    buckets.fill(NONE);
+  }
+
+  /**
+   * Check if the specified rectangle overlaps with a rectangle which
+   * was added previously.  If not, it is added.
+   *
+   * @return true if the rectangle is free and the label may be drawn
+   */
   bool check(const PixelRect rc) noexcept;
+
   void reset() noexcept;
+
+  /**
+   * Returns the number of rectangles added since the last reset().
+   */
+  std::size_t size() const noexcept {
+    return rects.size();
+  }
+
+private:
+  [[gnu::const]]
+  static std::size_t GetBucket(int x, int y) noexcept {
+    const auto h = uint32_t(x) * 0x9e3779b1u ^ uint32_t(y) * 0x85ebca77u;
+    return (h >> 16) & (BUCKET_COUNT - 1);
+  }
+
+  [[gnu::pure]]
+  bool Overlaps(std::size_t bucket, const PixelRect rc) const noexcept;
+
+  void Add(std::size_t bucket, uint32_t rect) noexcept;
 };
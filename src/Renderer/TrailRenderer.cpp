@@ -14,6 +14,13 @@
 #include "util/Clamp.hpp"
 
 #include <algorithm>
+#include <span>
+
+/**
+ * Trail points which are closer than this to the previous one [pixels]
+ * are skipped.
+ */
+static constexpr int MIN_POINT_DISTANCE = 3;
 
 bool
 TrailRenderer::LoadTrace(const TraceComputer &trace_computer)
@@ -62,7 +69,7 @@ GetAltitudeColorIndex(double alt, double min_alt, double max_alt)
 }
 
 static std::pair<double, double>
-GetMinMax(TrailSettings::Type type, const TracePointVector &trace)
+GetMinMax(TrailSettings::Type type, std::span<const TracePoint> trace)
 {
   double value_min, value_max;
 
@@ -90,18 +97,49 @@ GetMinMax(TrailSettings::Type type, const TracePointVector &trace)
   return std::make_pair(value_min, value_max);
 }
 
+inline void
+TrailRenderer::AddSegment(unsigned end, unsigned color) noexcept
+{
+  assert(end > 0);
+
+  if (!runs.empty() && runs.back().color == color &&
+      runs.back().start + runs.back().n == end)
+    /* continue the current polyline */
+    ++runs.back().n;
+  else
+    runs.push_back({end - 1, 2, color});
+}
+
 void
-TrailRenderer::Draw(Canvas &canvas, const TraceComputer &trace_computer,
-                    const WindowProjection &projection,
-                    TimeStamp min_time,
-                    bool enable_traildrift, const PixelPoint pos,
-                    const NMEAInfo &basic, const DerivedInfo &calculated,
-                    const TrailSettings &settings)
+TrailRenderer::PrepareTrail(const TraceComputer &trace_computer,
+                            const WindowProjection &projection,
+                            TimeStamp min_time,
+                            bool enable_traildrift,
+                            const NMEAInfo &basic,
+                            const DerivedInfo &calculated,
+                            const TrailSettings &settings) noexcept
 {
+  runs.clear();
+  dots.clear();
+  last_pen = nullptr;
+
   if (settings.length == TrailSettings::Length::OFF)
     return;
 
-  if (!LoadTrace(trace_computer, min_time, projection))
+  trace_computer.LockedSyncTo(full_trace, full_trace_append_serial,
+                              full_trace_modify_serial);
+
+  /* skip the trace points that are before min_time */
+  const auto min_trace_time = min_time.Cast<TracePoint::Time>();
+  const std::span<const TracePoint> trail{
+    std::partition_point(full_trace.begin(), full_trace.end(),
+                         [min_trace_time](const TracePoint &p){
+                           return p.GetTime() < min_trace_time;
+                         }),
+    full_trace.end(),
+  };
+
+  if (trail.empty())
     return;
 
   if (!basic.location_available || !calculated.wind_available)
@@ -115,72 +153,157 @@ TrailRenderer::Draw(Canvas &canvas, const TraceComputer &trace_computer,
     traildrift = basic.location - tp1;
   }
 
-  auto minmax = GetMinMax(settings.type, trace);
+  auto minmax = GetMinMax(settings.type, trail);
   auto value_min = minmax.first;
   auto value_max = minmax.second;
 
+  const bool dots_enabled =
+    settings.type == TrailSettings::Type::VARIO_1_DOTS ||
+    settings.type == TrailSettings::Type::VARIO_2_DOTS ||
+    settings.type == TrailSettings::Type::VARIO_DOTS_AND_LINES ||
+    settings.type == TrailSettings::Type::VARIO_EINK;
+  const bool dots_and_lines =
+    settings.type == TrailSettings::Type::VARIO_DOTS_AND_LINES ||
+    settings.type == TrailSettings::Type::VARIO_EINK;
+
   bool scaled_trail = settings.scaling_enabled &&
                       projection.GetMapScale() <= 6000;
 
+  /* width scaled to vario or fixed-width pens */
+  line_pens =
+    scaled_trail && settings.type != TrailSettings::Type::ALTITUDE &&
+    !dots_and_lines
+    ? look.scaled_trail_pens
+    : look.trail_pens;
+
   const GeoBounds bounds = projection.GetScreenBounds().Scale(4);
 
-  PixelPoint last_point(0, 0);
+  /* first pass: project the points and collect the segments by
+     colour */
+
+  auto *const p = Prepare(trail.size());
+  unsigned n_points = 0;
+
+  last_point = {0, 0};
   bool last_valid = false;
-  for (auto it = trace.begin(), end = trace.end(); it != end; ++it) {
+  for (const auto &i : trail) {
     const GeoPoint gp = enable_traildrift
-      ? it->GetLocation().Parametric(traildrift,
-                                     it->CalculateDrift(basic.time))
-      : it->GetLocation();
+      ? i.GetLocation().Parametric(traildrift,
+                                   i.CalculateDrift(basic.time))
+      : i.GetLocation();
     if (!bounds.IsInside(gp)) {
       /* the point is outside of the MapWindow; don't paint it */
       last_valid = false;
+      last_pen = nullptr;
       continue;
     }
 
     auto pt = projection.GeoToScreen(gp);
 
     if (last_valid) {
+      const PixelPoint delta = pt - last_point;
+      if (delta.x * delta.x + delta.y * delta.y <
+          MIN_POINT_DISTANCE * MIN_POINT_DISTANCE)
+        /* too close to the previous point */
+        continue;
+
+      const PixelPoint middle{(pt.x + last_point.x) / 2,
+                              (pt.y + last_point.y) / 2};
+
       if (settings.type == TrailSettings::Type::ALTITUDE) {
-        unsigned index = GetAltitudeColorIndex(it->GetAltitude(),
+        unsigned index = GetAltitudeColorIndex(i.GetAltitude(),
                                                value_min, value_max);
-        canvas.Select(look.trail_pens[index]);
-        canvas.DrawLinePiece(last_point, pt);
+        AddSegment(n_points, index);
+        last_pen = &line_pens[index];
       } else {
-        unsigned color_index = GetSnailColorIndex(it->GetVario(),
+        unsigned color_index = GetSnailColorIndex(i.GetVario(),
                                                   value_min, value_max);
-        if (it->GetVario() < 0 &&
-            (settings.type == TrailSettings::Type::VARIO_1_DOTS ||
-             settings.type == TrailSettings::Type::VARIO_2_DOTS ||
-             settings.type == TrailSettings::Type::VARIO_DOTS_AND_LINES ||
-             settings.type == TrailSettings::Type::VARIO_EINK)) {
-          canvas.SelectNullPen();
-          canvas.Select(look.trail_brushes[color_index]);
-          canvas.DrawCircle({(pt.x + last_point.x) / 2, (pt.y + last_point.y) / 2},
-                            look.trail_widths[color_index]);
+        if (i.GetVario() < 0 && dots_enabled) {
+          dots.push_back({middle, color_index, false});
+          last_pen = nullptr;
         } else {
           // positive vario case
-          if (settings.type == TrailSettings::Type::VARIO_DOTS_AND_LINES ||
-              settings.type == TrailSettings::Type::VARIO_EINK) {
-            canvas.Select(look.trail_brushes[color_index]);
-            canvas.Select(look.trail_pens[color_index]); //fixed-width pen
-            canvas.DrawCircle({(pt.x + last_point.x) / 2, (pt.y + last_point.y) / 2},
-                            look.trail_widths[color_index]);
-          } else if (scaled_trail)
-            // width scaled to vario
-            canvas.Select(look.scaled_trail_pens[color_index]);
-          else
-            // fixed-width pen
-            canvas.Select(look.trail_pens[color_index]);
-          canvas.DrawLinePiece(last_point, pt);
+          if (dots_and_lines)
+            dots.push_back({middle, color_index, true});
+
+          AddSegment(n_points, color_index);
+          last_pen = &line_pens[color_index];
         }
       }
     }
+
+    p[n_points++] = pt;
     last_point = pt;
     last_valid = true;
   }
 
-  if (last_valid)
+  /* group everything with the same colour, to minimise pen/brush
+     changes and draw calls */
+
+  std::stable_sort(dots.begin(), dots.end(),
+                   [](const Dot &a, const Dot &b){
+                     return a.outline != b.outline
+                       ? a.outline < b.outline
+                       : a.color < b.color;
+                   });
+
+  std::stable_sort(runs.begin(), runs.end(),
+                   [](const Run &a, const Run &b){
+                     return a.color < b.color;
+                   });
+}
+
+/**
+ * Draw one run of trail segments with the selected pen.
+ */
+static void
+DrawRun(Canvas &canvas, [[maybe_unused]] const Pen &pen,
+        const BulkPixelPoint *points, unsigned n) noexcept
+{
+#ifdef ENABLE_OPENGL
+  if (pen.GetWidth() > 2) {
+    /* the OpenGL Canvas::DrawPolyline() relies on glLineWidth() for
+       wide pens; DrawLinePiece() converts them to triangles, like
+       the trail was drawn before its segments were joined */
+    for (unsigned i = 1; i < n; ++i)
+      canvas.DrawLinePiece(points[i - 1], points[i]);
+    return;
+  }
+#endif
+
+  canvas.DrawPolyline(points, n);
+}
+
+void
+TrailRenderer::DrawPreparedTrail(Canvas &canvas, const PixelPoint pos) noexcept
+{
+  for (auto i = dots.begin(); i != dots.end();) {
+    const bool outline = i->outline;
+    const unsigned color = i->color;
+
+    if (outline)
+      canvas.Select(look.trail_pens[color]); //fixed-width pen
+    else
+      canvas.SelectNullPen();
+    canvas.Select(look.trail_brushes[color]);
+
+    for (; i != dots.end() && i->outline == outline && i->color == color; ++i)
+      canvas.DrawCircle(i->center, look.trail_widths[color]);
+  }
+
+  for (auto i = runs.begin(); i != runs.end();) {
+    const unsigned color = i->color;
+    const Pen &pen = line_pens[color];
+    canvas.Select(pen);
+
+    for (; i != runs.end() && i->color == color; ++i)
+      DrawRun(canvas, pen, points.data() + i->start, i->n);
+  }
+
+  if (last_pen != nullptr) {
+    canvas.Select(*last_pen);
     canvas.DrawLine(last_point, pos);
+  }
 }
 
 void
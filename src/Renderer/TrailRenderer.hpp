@@ -4,13 +4,17 @@
 #pragma once
 
 #include "util/AllocatedArray.hxx"
+#include "util/Serial.hpp"
 #include "Engine/Trace/Point.hpp"
 #include "Engine/Trace/Vector.hpp"
+#include "ui/dim/Point.hpp"
 #include "time/Stamp.hpp"
 
-struct PixelPoint;
+#include <vector>
+
 struct BulkPixelPoint;
 class Canvas;
+class Pen;
 class TraceComputer;
 class Projection;
 class WindowProjection;
@@ -32,6 +36,57 @@ class TrailRenderer {
   TracePointVector trace;
   AllocatedArray<BulkPixelPoint> points;
 
+  /**
+   * A copy of the full trace which is updated incrementally by the
+   * map trail Draw() method; only points appended since the previous
+   * frame are copied from the #TraceComputer.
+   */
+  TracePointVector full_trace;
+  Serial full_trace_append_serial, full_trace_modify_serial;
+
+  /**
+   * A sequence of consecutive trail segments with the same colour,
+   * drawn as one polyline.
+   */
+  struct Run {
+    /**
+     * Index of the first point in #points and the number of points.
+     */
+    unsigned start, n;
+
+    unsigned color;
+  };
+
+  /**
+   * A dot in the middle of a trail segment.
+   */
+  struct Dot {
+    PixelPoint center;
+
+    unsigned color;
+
+    /**
+     * Draw an outline with the trail pen?
+     */
+    bool outline;
+  };
+
+  /* these are kept between frames to avoid allocations */
+  std::vector<Run> runs;
+  std::vector<Dot> dots;
+
+  /**
+   * The pens for #runs chosen by PrepareTrail().
+   */
+  const Pen *line_pens = nullptr;
+
+  /**
+   * The pen for the line from the last trail point to the aircraft;
+   * nullptr if there is no such line.
+   */
+  const Pen *last_pen = nullptr;
+  PixelPoint last_point;
+
 public:
   TrailRenderer(const TrailLook &_look):look(_look) {}
 
@@ -51,11 +106,28 @@ public:
     trace.ScanBounds(bounds);
   }
 
-  void Draw(Canvas &canvas, const TraceComputer &trace_computer,
-            const WindowProjection &projection,
-            TimeStamp min_time,
-            bool enable_traildrift, PixelPoint pos, const NMEAInfo &basic,
-            const DerivedInfo &calculated, const TrailSettings &settings);
+  /**
+   * Copy and project the map trail and collect its segments by
+   * colour, without drawing anything.  This does not touch the
+   * #Canvas and may therefore run in a worker thread; call
+   * DrawPreparedTrail() afterwards.
+   */
+  void PrepareTrail(const TraceComputer &trace_computer,
+                    const WindowProjection &projection,
+                    TimeStamp min_time,
+                    bool enable_traildrift, const NMEAInfo &basic,
+                    const DerivedInfo &calculated,
+                    const TrailSettings &settings) noexcept;
+
+  /**
+   * Draw the map trail obtained by PrepareTrail().  The point buffer
+   * is shared with the other drawing methods, which must not be
+   * called in between.
+   *
+   * @param pos the aircraft position; the trail is continued with a
+   * line to it
+   */
+  void DrawPreparedTrail(Canvas &canvas, PixelPoint pos) noexcept;
 
   /**
    * Draw the trace that was obtained by LoadTrace() with the trace pen.
@@ -86,6 +158,12 @@ public:
                     const ContestTraceVector &trace);
 
 private:
+  /**
+   * Add a segment from the previous point in #points to point
+   * #end.
+   */
+  void AddSegment(unsigned end, unsigned color) noexcept;
+
   void DrawTraceVector(Canvas &canvas, const Projection &projection,
                        const TracePointVector &trace);
 };
@@ -421,6 +421,7 @@ ParseSeeYouWaypoints(TLineReader &reader, Waypoints &way_points)
 {
   const WaypointFactory factory(WaypointOrigin::NONE);
   WaypointReaderSeeYou waypoint_file(factory);
+  std::vector<Waypoint> parsed;
 
   while (true) {
     TCHAR *line = reader.ReadLine();
@@ -430,7 +431,10 @@ ParseSeeYouWaypoints(TLineReader &reader, Waypoints &way_points)
     if (StringIsEqualIgnoreCase(line, _T("-----Related Tasks-----")))
       return true;
 
-    waypoint_file.ParseLine(line, way_points);
+    waypoint_file.ParseLine(line, parsed);
+    for (auto &wp : parsed)
+      way_points.Append(std::move(wp));
+    parsed.clear();
   }
 }
 
@@ -30,6 +30,10 @@ public:
 #endif
   }
 
+  void Prepare(const WindowProjection &projection) noexcept {
+    renderer.Prepare(projection);
+  }
+
 #ifdef ENABLE_OPENGL
   void Draw(Canvas &canvas, const WindowProjection &projection) noexcept {
     renderer.Draw(canvas, projection);
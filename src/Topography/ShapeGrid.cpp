@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "ShapeGrid.hpp"
+
+#include <algorithm>
+
+static constexpr unsigned
+ToCell(Angle offset, double scale, unsigned size) noexcept
+{
+  const double cell = offset.Native() * scale;
+  return cell > 0 ? std::min(unsigned(cell), size - 1) : 0;
+}
+
+inline ShapeGrid::CellRange
+ShapeGrid::GetCellRange(const GeoBounds &area) const noexcept
+{
+  /* the area is inside #bounds; AsBearing() takes care of wrapping
+     around the date line */
+  return {
+    ToCell((area.GetWest() - bounds.GetWest()).AsBearing(), scale_x, SIZE),
+    ToCell(area.GetSouth() - bounds.GetSouth(), scale_y, SIZE),
+    ToCell((area.GetEast() - bounds.GetWest()).AsBearing(), scale_x, SIZE),
+    ToCell(area.GetNorth() - bounds.GetSouth(), scale_y, SIZE),
+  };
+}
+
+void
+ShapeGrid::Build(std::span<const GeoBounds> shapes) noexcept
+{
+  items.clear();
+  cells.fill(0);
+
+  bounds = GeoBounds::Invalid();
+  for (const auto &i : shapes) {
+    if (!bounds.IsValid()) {
+      bounds = i;
+    } else {
+      bounds.Extend(i.GetNorthWest());
+      bounds.Extend(i.GetSouthEast());
+    }
+  }
+
+  if (!bounds.IsValid())
+    return;
+
+  const double width = bounds.GetWidth().Native();
+  const double height = bounds.GetHeight().Native();
+  scale_x = width > 0 ? SIZE / width : 0;
+  scale_y = height > 0 ? SIZE / height : 0;
+
+  /* first pass: count the shapes of each cell, shifted by one */
+  for (const auto &i : shapes) {
+    const auto r = GetCellRange(i);
+    for (unsigned y = r.top; y <= r.bottom; ++y)
+      for (unsigned x = r.left; x <= r.right; ++x)
+        ++cells[y * SIZE + x + 1];
+  }
+
+  /* convert the counts to start positions */
+  for (unsigned i = 1; i < cells.size(); ++i)
+    cells[i] += cells[i - 1];
+
+  items.resize(cells.back());
+
+  /* second pass: fill the lists, using the start positions as
+     cursors, which leaves each one at the start of the next cell;
+     shift them back afterwards */
+  for (uint32_t index = 0; index < shapes.size(); ++index) {
+    const auto r = GetCellRange(shapes[index]);
+    for (unsigned y = r.top; y <= r.bottom; ++y)
+      for (unsigned x = r.left; x <= r.right; ++x)
+        items[cells[y * SIZE + x]++] = index;
+  }
+
+  std::copy_backward(cells.begin(), std::prev(cells.end()), cells.end());
+  cells.front() = 0;
+}
+
+void
+ShapeGrid::Query(const GeoBounds &area,
+                 std::vector<uint32_t> &result) const noexcept
+{
+  result.clear();
+
+  GeoBounds clipped = area;
+  if (!bounds.IsValid() || !clipped.IntersectWith(bounds))
+    return;
+
+  const auto r = GetCellRange(clipped);
+  for (unsigned y = r.top; y <= r.bottom; ++y) {
+    const unsigned row = y * SIZE;
+    result.insert(result.end(),
+                  items.begin() + cells[row + r.left],
+                  items.begin() + cells[row + r.right + 1]);
+  }
+
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+}
@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Geo/GeoBounds.hpp"
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/**
+ * A uniform grid over the bounds of a set of shapes.  It finds the
+ * shapes which may overlap an area without testing all of them.
+ *
+ * The grid must be rebuilt after the set of shapes changes.
+ */
+class ShapeGrid {
+  /**
+   * The number of columns and rows.
+   */
+  static constexpr unsigned SIZE = 32;
+
+  GeoBounds bounds = GeoBounds::Invalid();
+
+  /**
+   * Cells per #Angle::Native() unit.
+   */
+  double scale_x, scale_y;
+
+  /**
+   * The first element of each cell's list in #items; the list of
+   * cell i ends at cells[i + 1].
+   */
+  std::array<uint32_t, SIZE * SIZE + 1> cells;
+
+  /**
+   * The shape indices of all cells.  A shape is listed in every cell
+   * it touches.
+   */
+  std::vector<uint32_t> items;
+
+  struct CellRange {
+    unsigned left, top, right, bottom;
+  };
+
+public:
+  /**
+   * Rebuild the grid.
+   *
+   * @param shapes the bounds of all shapes; the shape index used by
+   * Query() is the position in this list
+   */
+  void Build(std::span<const GeoBounds> shapes) noexcept;
+
+  void Clear() noexcept {
+    bounds = GeoBounds::Invalid();
+    items.clear();
+  }
+
+  /**
+   * Find the shapes whose cells overlap the given area.  The caller
+   * still has to check the shape bounds.
+   *
+   * @param result receives the shape indices in ascending order,
+   * without duplicates
+   */
+  void Query(const GeoBounds &area,
+             std::vector<uint32_t> &result) const noexcept;
+
+private:
+  [[gnu::pure]]
+  CellRange GetCellRange(const GeoBounds &area) const noexcept;
+};
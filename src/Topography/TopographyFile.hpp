@@ -17,6 +17,7 @@
 #endif
 
 #include <cassert>
+#include <cstddef>
 #include <memory>
 
 class WindowProjection;
@@ -216,6 +217,16 @@ public:
     return const_iterator{list.end()};
   }
 
+  /**
+   * Returns the shapefile record number of a cached shape.  Unlike
+   * the #XShape address, it identifies the shape across cache
+   * updates.
+   */
+  [[gnu::pure]]
+  std::size_t GetShapeIndex(const_iterator i) const noexcept {
+    return &*i.i - shapes.data();
+  }
+
   [[gnu::pure]]
   unsigned GetSkipSteps(double map_scale) const noexcept;
 
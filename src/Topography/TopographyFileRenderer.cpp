@@ -47,6 +47,24 @@ TopographyFileRenderer::TopographyFileRenderer(const TopographyFile &_file,
 
 TopographyFileRenderer::~TopographyFileRenderer() noexcept = default;
 
+inline void
+TopographyFileRenderer::UpdateShapeGrid() noexcept
+{
+  if (file.GetSerial() == shape_grid_serial)
+    return;
+
+  shape_grid_serial = file.GetSerial();
+  grid_shapes.clear();
+
+  std::vector<GeoBounds> bounds;
+  for (const XShape &shape : file) {
+    grid_shapes.push_back(&shape);
+    bounds.push_back(shape.get_bounds());
+  }
+
+  shape_grid.Build(bounds);
+}
+
 void
 TopographyFileRenderer::UpdateVisibleShapes(const WindowProjection &projection) noexcept
 {
@@ -61,8 +79,15 @@ TopographyFileRenderer::UpdateVisibleShapes(const WindowProjection &projection)
   visible_shapes.clear();
   visible_points.clear();
   visible_labels.clear();
+#if defined(ENABLE_OPENGL) && defined(TOPOGRAPHY_VERTEX_POOL)
+  visible_offsets_dirty = true;
+#endif
 
-  for (const XShape &shape : file) {
+  UpdateShapeGrid();
+  shape_grid.Query(visible_bounds, grid_result);
+
+  for (const uint32_t i : grid_result) {
+    const XShape &shape = *grid_shapes[i];
     if (!visible_bounds.Overlaps(shape.get_bounds()))
       continue;
 
@@ -91,6 +116,136 @@ TopographyFileRenderer::UpdateVisibleShapes(const WindowProjection &projection)
 }
 
 #ifdef ENABLE_OPENGL
+#ifdef TOPOGRAPHY_VERTEX_POOL
+
+[[gnu::pure]]
+static unsigned
+CountPoints(const XShape &shape) noexcept
+{
+  const auto lines = shape.GetLines();
+  return std::accumulate(lines.begin(), lines.end(), 0u);
+}
+
+/**
+ * Allocate a new buffer with room for growth and copy the vertices
+ * of all cached shapes into it, without gaps.
+ */
+void
+TopographyFileRenderer::RebuildArrayBuffer() noexcept
+{
+  vertex_pool.Clear();
+
+  for (const XShape &shape : file) {
+    auto &range = shape_vertices.find(&shape)->second.range;
+    range.offset = vertex_pool.Allocate(range.size);
+  }
+
+  /* double the size, so the following cache updates can be patched
+     into the buffer */
+  array_buffer_capacity = std::max(vertex_pool.GetEnd() * 2, 4096u);
+
+  ShapePoint *p = (ShapePoint *)
+    array_buffer->BeginWrite(array_buffer_capacity * sizeof(*p));
+  assert(p != nullptr);
+
+  for (const XShape &shape : file) {
+    const auto &range = shape_vertices.find(&shape)->second.range;
+    std::copy_n(shape.GetPoints(), range.size, p + range.offset);
+  }
+
+  array_buffer->CommitWrite(array_buffer_capacity * sizeof(*p), p);
+}
+
+inline void
+TopographyFileRenderer::UpdateArrayBuffer() noexcept
+{
+  if (array_buffer == nullptr)
+    array_buffer = std::make_unique<GLArrayBuffer>();
+  else if (file.GetSerial() == array_buffer_serial)
+    return;
+
+  array_buffer_serial = file.GetSerial();
+
+  /* shapes may be added or moved */
+  visible_offsets_dirty = true;
+
+  /* mark the shapes which are still in the cache and collect the new
+     ones */
+  std::vector<std::pair<const XShape *, ShapeVertices *>> added;
+  for (auto i = file.begin(), end = file.end(); i != end; ++i) {
+    const XShape &shape = *i;
+    const std::size_t index = file.GetShapeIndex(i);
+
+    auto [j, inserted] = shape_vertices.try_emplace(&shape);
+    auto &vertices = j->second;
+    if (!inserted && vertices.index != index) {
+      /* the XShape was deleted, and a new one was allocated at the
+         same address */
+      vertex_pool.Free(vertices.range);
+      inserted = true;
+    }
+
+    vertices.serial = array_buffer_serial;
+
+    if (inserted) {
+      vertices.index = index;
+      vertices.range = {};
+      added.emplace_back(&shape, &vertices);
+    }
+  }
+
+  /* release the vertices of the shapes which were removed from the
+     cache */
+  std::erase_if(shape_vertices, [this](const auto &i){
+    if (i.second.serial == array_buffer_serial)
+      return false;
+
+    vertex_pool.Free(i.second.range);
+    return true;
+  });
+
+  if (added.empty())
+    return;
+
+  for (const auto &[shape, vertices] : added) {
+    const unsigned n = CountPoints(*shape);
+    vertices->range = {vertex_pool.Allocate(n), n};
+  }
+
+  if (vertex_pool.GetEnd() > array_buffer_capacity) {
+    RebuildArrayBuffer();
+    return;
+  }
+
+  /* upload only the new shapes; all others stay where they are */
+  array_buffer->Bind();
+
+  for (const auto &[shape, vertices] : added)
+    GLArrayBuffer::SubData(vertices->range.offset * sizeof(ShapePoint),
+                           vertices->range.size * sizeof(ShapePoint),
+                           shape->GetPoints());
+
+  array_buffer->Unbind();
+}
+
+inline void
+TopographyFileRenderer::UpdateVisibleOffsets() noexcept
+{
+  if (!visible_offsets_dirty)
+    return;
+
+  visible_offsets_dirty = false;
+  visible_offsets.clear();
+  visible_offsets.reserve(visible_shapes.size());
+
+  for (const XShape *shape : visible_shapes) {
+    const auto i = shape_vertices.find(shape);
+    assert(i != shape_vertices.end());
+    visible_offsets.push_back(i->second.range.offset);
+  }
+}
+
+#else
 
 inline void
 TopographyFileRenderer::UpdateArrayBuffer() noexcept
@@ -127,6 +282,16 @@ TopographyFileRenderer::UpdateArrayBuffer() noexcept
 }
 
 #endif
+#endif
+
+void
+TopographyFileRenderer::Prepare(const WindowProjection &projection) noexcept
+{
+  const std::lock_guard lock{file.mutex};
+
+  if (file.IsVisible(projection.GetMapScale()))
+    UpdateVisibleShapes(projection);
+}
 
 inline void
 TopographyFileRenderer::PaintPoints(Canvas &canvas,
@@ -158,6 +323,9 @@ TopographyFileRenderer::Paint(Canvas &canvas,
   OpenGL::solid_shader->Use();
 
   UpdateArrayBuffer();
+#ifdef TOPOGRAPHY_VERTEX_POOL
+  UpdateVisibleOffsets();
+#endif
   array_buffer->Bind();
   const ShapePoint *const buffer = nullptr;
 
@@ -195,6 +363,10 @@ TopographyFileRenderer::Paint(Canvas &canvas,
   std::vector<GLsizei> polygon_counts;
   std::vector<GLushort> polygon_indices;
 #endif
+
+#ifdef TOPOGRAPHY_VERTEX_POOL
+  const unsigned *next_offset = visible_offsets.data();
+#endif
 #endif
 
   for (const XShape *shape_p : visible_shapes) {
@@ -202,7 +374,12 @@ TopographyFileRenderer::Paint(Canvas &canvas,
 
     const auto lines = shape.GetLines();
 #ifdef ENABLE_OPENGL
-    const ShapePoint *points = buffer + shape.GetOffset();
+#ifdef TOPOGRAPHY_VERTEX_POOL
+    const unsigned offset = *next_offset++;
+#else
+    const unsigned offset = shape.GetOffset();
+#endif
+    const ShapePoint *points = buffer + offset;
 #else // !ENABLE_OPENGL
     const GeoPoint *points = shape.GetPoints();
 #endif
@@ -256,7 +433,6 @@ TopographyFileRenderer::Paint(Canvas &canvas,
         const unsigned n = *triangles.count;
 
 #ifdef GL_EXT_multi_draw_arrays
-        const unsigned offset = shape.GetOffset();
         if (GLExt::HaveMultiDrawElements() && offset + n < 0x10000) {
           /* postpone, draw many polygons with a single
              glMultiDrawElements() call */
@@ -7,8 +7,14 @@
 #include "ui/canvas/Icon.hpp"
 #include "util/Serial.hpp"
 #include "Geo/GeoBounds.hpp"
+#include "Topography/ShapeGrid.hpp"
 
 #ifdef ENABLE_OPENGL
+#ifdef TOPOGRAPHY_VERTEX_POOL
+#include "Topography/VertexPool.hpp"
+
+#include <unordered_map>
+#endif
 #else
 #include "ui/canvas/Brush.hpp"
 #include "Topography/ShapeRenderer.hpp"
@@ -54,9 +60,74 @@ class TopographyFileRenderer final
 
   std::vector<GeoPoint> visible_points;
 
+  /**
+   * A spatial index of all cached shapes for UpdateVisibleShapes().
+   * It is rebuilt when the file's serial changes.
+   */
+  ShapeGrid shape_grid;
+  Serial shape_grid_serial;
+
+  /**
+   * The shapes indexed by #shape_grid.
+   */
+  std::vector<const XShape *> grid_shapes;
+
+  /**
+   * A buffer for ShapeGrid::Query().
+   */
+  std::vector<uint32_t> grid_result;
+
 #ifdef ENABLE_OPENGL
+  /**
+   * The vertices of all cached shapes.  By default, the whole buffer
+   * is uploaded again when the file's serial changes.  With
+   * #TOPOGRAPHY_VERTEX_POOL, shapes added to the cache are uploaded
+   * into ranges managed by #vertex_pool, and the buffer is only
+   * rebuilt when it is full.
+   */
   std::unique_ptr<GLArrayBuffer> array_buffer;
   Serial array_buffer_serial;
+
+#ifdef TOPOGRAPHY_VERTEX_POOL
+  /**
+   * The size of #array_buffer in vertices.
+   */
+  unsigned array_buffer_capacity = 0;
+
+  VertexPool vertex_pool;
+
+  struct ShapeVertices {
+    /**
+     * The shapefile record number, to detect an #XShape address
+     * which was reused for a different shape.
+     */
+    std::size_t index;
+
+    VertexPool::Range range;
+
+    /**
+     * The #array_buffer_serial when this shape was last seen in
+     * the file.
+     */
+    Serial serial;
+  };
+
+  /**
+   * The location of each cached shape in #array_buffer.  This is
+   * kept here and not in #XShape because several renderers (e.g. of
+   * the main map and the task map) may share one #TopographyFile.
+   */
+  std::unordered_map<const XShape *, ShapeVertices> shape_vertices;
+
+  /**
+   * The offset of each of #visible_shapes in #array_buffer, looked
+   * up in #shape_vertices once after the visible shapes or the
+   * buffer have changed, and not for each frame.
+   */
+  std::vector<unsigned> visible_offsets;
+
+  bool visible_offsets_dirty = true;
+#endif
 #endif
 
 public:
@@ -67,6 +138,13 @@ public:
 
   ~TopographyFileRenderer() noexcept;
 
+  /**
+   * Determine the shapes which are visible with the given projection,
+   * for Paint() and PaintLabels().  This does not touch the #Canvas
+   * and may therefore run in a worker thread.
+   */
+  void Prepare(const WindowProjection &projection) noexcept;
+
   /**
    * Paints the polygons, lines and points/icons in the TopographyFile
    * @param canvas The canvas to paint on
@@ -86,10 +164,15 @@ public:
                    LabelBlock &label_block) noexcept;
 
 private:
+  void UpdateShapeGrid() noexcept;
   void UpdateVisibleShapes(const WindowProjection &projection) noexcept;
 
 #ifdef ENABLE_OPENGL
   void UpdateArrayBuffer() noexcept;
+#ifdef TOPOGRAPHY_VERTEX_POOL
+  void RebuildArrayBuffer() noexcept;
+  void UpdateVisibleOffsets() noexcept;
+#endif
 #endif
 
   void PaintPoints(Canvas &canvas, const WindowProjection &projection) noexcept;
@@ -34,6 +34,12 @@ public:
     return store;
   }
 
+  /**
+   * Prepare all files for Draw() and DrawLabels(), see
+   * TopographyFileRenderer::Prepare().
+   */
+  void Prepare(const WindowProjection &projection) noexcept;
+
   /**
    * Draws the topography to the given canvas
    * @param canvas The drawing canvas
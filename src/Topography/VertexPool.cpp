@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "VertexPool.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+unsigned
+VertexPool::Allocate(unsigned size) noexcept
+{
+  if (size == 0)
+    return end;
+
+  const auto i = std::find_if(free_ranges.begin(), free_ranges.end(),
+                              [size](const Range &r){
+                                return r.size >= size;
+                              });
+  if (i == free_ranges.end()) {
+    /* no hole is big enough: append */
+    const unsigned offset = end;
+    end += size;
+    return offset;
+  }
+
+  const unsigned offset = i->offset;
+  free_size -= size;
+
+  if (i->size == size)
+    free_ranges.erase(i);
+  else {
+    i->offset += size;
+    i->size -= size;
+  }
+
+  return offset;
+}
+
+void
+VertexPool::Free(Range range) noexcept
+{
+  assert(range.offset + range.size <= end);
+
+  if (range.size == 0)
+    return;
+
+  auto i = std::lower_bound(free_ranges.begin(), free_ranges.end(),
+                            range.offset,
+                            [](const Range &r, unsigned offset){
+                              return r.offset < offset;
+                            });
+
+  assert(i == free_ranges.end() ||
+         range.offset + range.size <= i->offset);
+
+  /* merge with the following hole */
+  if (i != free_ranges.end() && range.offset + range.size == i->offset) {
+    range.size += i->size;
+    free_size -= i->size;
+    i = free_ranges.erase(i);
+  }
+
+  /* merge with the preceding hole */
+  if (i != free_ranges.begin()) {
+    auto &previous = *std::prev(i);
+    assert(previous.offset + previous.size <= range.offset);
+
+    if (previous.offset + previous.size == range.offset) {
+      range.offset = previous.offset;
+      range.size += previous.size;
+      free_size -= previous.size;
+      i = free_ranges.erase(std::prev(i));
+    }
+  }
+
+  if (range.offset + range.size == end) {
+    /* the hole is at the end: shrink */
+    assert(i == free_ranges.end());
+    end = range.offset;
+    return;
+  }
+
+  free_ranges.insert(i, range);
+  free_size += range.size;
+}
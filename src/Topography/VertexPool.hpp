@@ -0,0 +1,72 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include <vector>
+
+/**
+ * Manages the ranges of a vertex buffer which is shared by many
+ * shapes.  New ranges reuse the space of freed ones (first fit) or
+ * are appended at the end, so existing ranges never move and only
+ * the vertices of new shapes need to be uploaded.
+ *
+ * This class only does the bookkeeping; it does not own the buffer.
+ * All offsets and sizes are in vertices.
+ */
+class VertexPool {
+public:
+  struct Range {
+    unsigned offset, size;
+  };
+
+private:
+  /**
+   * The unused ranges below #end, sorted by offset.  Adjacent free
+   * ranges are always merged.
+   */
+  std::vector<Range> free_ranges;
+
+  /**
+   * The end of the highest allocated range; the buffer must be at
+   * least this big.
+   */
+  unsigned end = 0;
+
+  /**
+   * The sum of all #free_ranges.
+   */
+  unsigned free_size = 0;
+
+public:
+  /**
+   * The minimum buffer size (in vertices) for all allocated ranges.
+   */
+  unsigned GetEnd() const noexcept {
+    return end;
+  }
+
+  /**
+   * The number of vertices in allocated ranges.
+   */
+  unsigned GetUsed() const noexcept {
+    return end - free_size;
+  }
+
+  void Clear() noexcept {
+    free_ranges.clear();
+    end = free_size = 0;
+  }
+
+  /**
+   * Allocate a range of the given size.
+   *
+   * @return the offset of the new range
+   */
+  unsigned Allocate(unsigned size) noexcept;
+
+  /**
+   * Return a range obtained from Allocate() to the pool.
+   */
+  void Free(Range range) noexcept;
+};
@@ -68,11 +68,13 @@ class XShape {
    */
   std::array<std::unique_ptr<uint16_t[]>, THINNING_LEVELS> index_count;
 
+#ifndef TOPOGRAPHY_VERTEX_POOL
   /**
    * The start offset in the #GLArrayBuffer (vertex buffer object).
    * It is managed by #TopographyFileRenderer.
    */
   mutable unsigned offset;
+#endif
 #endif
 
   BasicAllocatedString<TCHAR> label;
@@ -90,6 +92,7 @@ public:
   XShape &operator=(const XShape &) = delete;
 
 #ifdef ENABLE_OPENGL
+#ifndef TOPOGRAPHY_VERTEX_POOL
   void SetOffset(unsigned _offset) const noexcept {
     offset = _offset;
   }
@@ -97,6 +100,7 @@ public:
   unsigned GetOffset() const noexcept {
     return offset;
   }
+#endif
 
 protected:
   bool BuildIndices(unsigned thinning_level,
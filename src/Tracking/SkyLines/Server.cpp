@@ -10,13 +10,25 @@
 #include "net/UniqueSocketDescriptor.hxx"
 #include "util/CRC.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <iterator>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#endif
+
 static UniqueSocketDescriptor
-CreateBindUDP(SocketAddress address)
+CreateBindUDP(SocketAddress address, bool reuse_port)
 {
   UniqueSocketDescriptor s;
   if (!s.Create(address.GetFamily(), SOCK_DGRAM, 0))
     throw MakeSocketError("Failed to create socket");
 
+  if (reuse_port && !s.SetReusePort())
+    throw MakeSocketError("Failed to set SO_REUSEPORT");
+
   if (!s.Bind(address))
     throw MakeSocketError("Failed to connect socket");
 
@@ -25,10 +37,94 @@ CreateBindUDP(SocketAddress address)
 
 namespace SkyLinesTracking {
 
+/**
+ * A ring of receive buffers which is filled by one recvmmsg() call.
+ */
+struct Server::ReceiveBatch {
+  std::array<std::array<std::byte, MAX_RECEIVE_SIZE>, BATCH_SIZE> buffers;
+  std::array<StaticSocketAddress, BATCH_SIZE> addresses;
+
+#ifdef __linux__
+  std::array<struct iovec, BATCH_SIZE> iov;
+  std::array<struct mmsghdr, BATCH_SIZE> messages;
+
+  ReceiveBatch() noexcept {
+    for (std::size_t i = 0; i < BATCH_SIZE; ++i) {
+      iov[i].iov_base = buffers[i].data();
+      iov[i].iov_len = buffers[i].size();
+
+      auto &msg = messages[i].msg_hdr;
+      msg = {};
+      msg.msg_name = (struct sockaddr *)addresses[i];
+      msg.msg_iov = &iov[i];
+      msg.msg_iovlen = 1;
+    }
+  }
+
+  /**
+   * Reset the address lengths, which were overwritten by the
+   * previous recvmmsg() call.
+   */
+  void Prepare() noexcept {
+    for (std::size_t i = 0; i < BATCH_SIZE; ++i)
+      messages[i].msg_hdr.msg_namelen = addresses[i].GetCapacity();
+  }
+#endif
+};
+
+/**
+ * Outgoing datagrams which have been queued by SendBuffer().
+ */
+struct Server::SendQueue {
+  struct Item {
+    StaticSocketAddress address;
+    std::size_t size;
+    std::array<std::byte, MAX_SEND_SIZE> data;
+  };
+
+  std::array<Item, BATCH_SIZE> items;
+
+  std::size_t n_items = 0;
+
+  bool empty() const noexcept {
+    return n_items == 0;
+  }
+
+  bool full() const noexcept {
+    return n_items == BATCH_SIZE;
+  }
+
+  void Push(SocketAddress address,
+            std::span<const std::byte> buffer) noexcept {
+    assert(!full());
+    assert(buffer.size() <= MAX_SEND_SIZE);
+
+    auto &item = items[n_items++];
+    item.address = address;
+    item.size = buffer.size();
+    std::copy(buffer.begin(), buffer.end(), item.data.begin());
+  }
+
+  /**
+   * Remove the specified number of items from the front.
+   */
+  void Shift(std::size_t n) noexcept {
+    assert(n <= n_items);
+
+    std::move(std::next(items.begin(), n),
+              std::next(items.begin(), n_items),
+              items.begin());
+    n_items -= n;
+  }
+};
+
 Server::Server(EventLoop &event_loop,
-               SocketAddress server_address)
+               SocketAddress server_address, bool reuse_port)
   :socket(event_loop, BIND_THIS_METHOD(OnSocketReady),
-          CreateBindUDP(server_address).Release())
+          CreateBindUDP(server_address, reuse_port).Release()),
+   flush_event(event_loop, BIND_THIS_METHOD(FlushSendQueue)),
+   receive_batch(std::make_unique<ReceiveBatch>()),
+   send_queue(std::make_unique<SendQueue>())
 {
   socket.ScheduleRead();
 }
@@ -39,11 +135,12 @@ Server::~Server()
 }
 
 void
-Server::SendBuffer(SocketAddress address,
-                   std::span<const std::byte> buffer) noexcept
+Server::SendNow(SocketAddress address,
+                std::span<const std::byte> buffer) noexcept
 {
   try {
-    ssize_t nbytes = socket.GetSocket().Write(buffer.data(), buffer.size());
+    ssize_t nbytes = socket.GetSocket().Write(buffer.data(), buffer.size(),
+                                              address);
     if (nbytes < 0)
       throw MakeSocketError("Failed to send");
   } catch (...) {
@@ -51,6 +148,99 @@ Server::SendBuffer(SocketAddress address,
   }
 }
 
+void
+Server::SendBuffer(SocketAddress address,
+                   std::span<const std::byte> buffer) noexcept
+{
+  ++n_sent;
+
+  if (buffer.size() > MAX_SEND_SIZE) {
+    SendNow(address, buffer);
+    return;
+  }
+
+  if (send_queue->full()) {
+    FlushSendQueue();
+
+    if (send_queue->full()) {
+      /* the socket is still not writable; this will most likely
+         fail and report the error */
+      SendNow(address, buffer);
+      return;
+    }
+  }
+
+  send_queue->Push(address, buffer);
+
+  /* if we're not inside OnSocketReady() (e.g. called from a timer),
+     this makes sure the datagram gets sent soon; if the socket
+     buffer is full, the queue is flushed as soon as the socket
+     becomes writable */
+  if (!socket.IsWritePending())
+    flush_event.Schedule();
+}
+
+void
+Server::FlushSendQueue() noexcept
+{
+  flush_event.Cancel();
+
+  auto &queue = *send_queue;
+  if (queue.empty())
+    return;
+
+#ifdef __linux__
+  std::array<struct iovec, BATCH_SIZE> iov;
+  std::array<struct mmsghdr, BATCH_SIZE> messages;
+
+  for (std::size_t i = 0; i < queue.n_items; ++i) {
+    auto &item = queue.items[i];
+    iov[i].iov_base = item.data.data();
+    iov[i].iov_len = item.size;
+
+    auto &msg = messages[i].msg_hdr;
+    msg = {};
+    msg.msg_name = (struct sockaddr *)item.address;
+    msg.msg_namelen = item.address.GetSize();
+    msg.msg_iov = &iov[i];
+    msg.msg_iovlen = 1;
+  }
+
+  const int fd = socket.GetSocket().Get();
+  std::size_t position = 0;
+  while (position < queue.n_items) {
+    int n = sendmmsg(fd, &messages[position], queue.n_items - position,
+                     MSG_DONTWAIT);
+    if (n < 0) {
+      const auto e = GetSocketError();
+      if (IsSocketErrorSendWouldBlock(e)) {
+        /* the socket buffer is full: keep the remaining datagrams
+           and retry as soon as the socket becomes writable */
+        queue.Shift(position);
+        socket.ScheduleWrite();
+        return;
+      }
+
+      /* the datagram at this position has failed; report it and
+         continue with the next one */
+      OnSendError(queue.items[position].address,
+                  std::make_exception_ptr(MakeSocketError(e, "Failed to send")));
+      ++position;
+    } else
+      position += n;
+  }
+
+  socket.CancelWrite();
+#else
+  for (std::size_t i = 0; i < queue.n_items; ++i) {
+    const auto &item = queue.items[i];
+    SendNow(item.address, {item.data.data(), item.size});
+  }
+#endif
+
+  queue.n_items = 0;
+}
+
 void
 Server::OnPing(const Client &client, unsigned id)
 {
@@ -163,24 +353,86 @@ Server::OnDatagramReceived(Client &&client,
 }
 
 void
-Server::OnSocketReady(unsigned) noexcept
+Server::InjectDatagram(SocketAddress address,
+                       std::span<std::byte> buffer)
+{
+  Client client;
+  client.address = address;
+
+  OnDatagramReceived(std::move(client), buffer.data(), buffer.size());
+}
+
+void
+Server::OnSocketReady(unsigned events) noexcept
 try {
-  // TODO: use recvmmsg() on Linux
+  if (events & SocketEvent::WRITE) {
+    FlushSendQueue();
 
-  Client client;
-  socklen_t address_size = sizeof(client.address);
-  char buffer[4096];
+    if ((events & ~SocketEvent::WRITE) == 0)
+      return;
+  }
+
+  auto &batch = *receive_batch;
 
-  ssize_t nbytes = recvfrom(socket.GetSocket().Get(), buffer, sizeof(buffer),
-                            MSG_DONTWAIT,
-                            client.address, &address_size);
-  if (nbytes < 0)
-    throw MakeSocketError("Failed to receive");
+#ifdef __linux__
+  batch.Prepare();
+
+  int n = recvmmsg(socket.GetSocket().Get(),
+                   batch.messages.data(), batch.messages.size(),
+                   MSG_DONTWAIT, nullptr);
+  if (n < 0) {
+    const auto e = GetSocketError();
+    if (IsSocketErrorReceiveWouldBlock(e))
+      return;
 
-  client.address.SetSize(address_size);
-  // TODO: set client.key
+    throw MakeSocketError(e, "Failed to receive");
+  }
+
+  n_received += n;
+
+  for (int i = 0; i < n; ++i) {
+    auto &address = batch.addresses[i];
+    address.SetSize(batch.messages[i].msg_hdr.msg_namelen);
+
+    const std::size_t length = batch.messages[i].msg_len;
+    if (RouteDatagram(address, {batch.buffers[i].data(), length}))
+      continue;
+
+    Client client;
+    client.address = address;
+    // TODO: set client.key
+
+    OnDatagramReceived(std::move(client), batch.buffers[i].data(), length);
+  }
+#else
+  /* drain up to one batch of datagrams, one recvfrom() call per
+     datagram */
+  for (std::size_t i = 0; i < BATCH_SIZE; ++i) {
+    Client client;
+    auto &buffer = batch.buffers[i];
+    ssize_t nbytes = socket.GetSocket().Read(buffer.data(), buffer.size(),
+                                             client.address);
+    if (nbytes < 0) {
+      const auto e = GetSocketError();
+      if (IsSocketErrorReceiveWouldBlock(e))
+        break;
+
+      throw MakeSocketError(e, "Failed to receive");
+    }
+
+    ++n_received;
+
+    if (RouteDatagram(client.address, {buffer.data(), std::size_t(nbytes)}))
+      continue;
+
+    // TODO: set client.key
+
+    OnDatagramReceived(std::move(client), buffer.data(), nbytes);
+  }
+#endif
 
-  OnDatagramReceived(std::move(client), buffer, nbytes);
+  /* emit all responses which were generated by this batch */
+  FlushSendQueue();
 } catch (...) {
   socket.Close();
   OnError(std::current_exception());
@@ -4,11 +4,13 @@
 #pragma once
 
 #include "event/SocketEvent.hxx"
+#include "event/DeferEvent.hxx"
 #include "net/StaticSocketAddress.hxx"
 
 #include <chrono>
 #include <cstdint>
 #include <exception>
+#include <memory>
 #include <span>
 
 struct GeoPoint;
@@ -20,10 +22,52 @@ namespace SkyLinesTracking {
  *
  * To use this class, derive your class from it and implement the
  * virtual methods.
+ *
+ * Incoming datagrams are received in batches (with recvmmsg() on
+ * Linux), and outgoing datagrams are queued and sent in batches
+ * (with sendmmsg() on Linux) at the end of each event loop
+ * iteration.  If the socket buffer is full, the remaining datagrams
+ * stay queued until the socket becomes writable.
  */
 class Server {
+  /**
+   * The maximum number of datagrams received or sent with one
+   * system call.
+   */
+  static constexpr std::size_t BATCH_SIZE = 64;
+
+  /**
+   * The maximum size of an incoming datagram.  Larger datagrams are
+   * truncated (and will then fail the CRC check).
+   */
+  static constexpr std::size_t MAX_RECEIVE_SIZE = 4096;
+
+  /**
+   * The maximum size of a queued outgoing datagram.  Larger
+   * datagrams are sent immediately, bypassing the queue.
+   */
+  static constexpr std::size_t MAX_SEND_SIZE = 2048;
+
+  struct ReceiveBatch;
+  struct SendQueue;
+
   SocketEvent socket;
 
+  /**
+   * Flushes the #send_queue after datagrams have been queued outside
+   * of OnSocketReady().
+   */
+  DeferEvent flush_event;
+
+  const std::unique_ptr<ReceiveBatch> receive_batch;
+  const std::unique_ptr<SendQueue> send_queue;
+
+  /**
+   * The total number of datagrams received and sent (or queued for
+   * sending).
+   */
+  uint64_t n_received = 0, n_sent = 0;
+
 public:
   struct Client {
     StaticSocketAddress address;
@@ -31,7 +75,13 @@ public:
   };
 
 public:
-  Server(EventLoop &event_loop, SocketAddress server_address);
+  /**
+   * @param reuse_port set SO_REUSEPORT, which allows several
+   * #Server instances (e.g. one per thread) to share the port; the
+   * kernel distributes the incoming datagrams among them
+   */
+  Server(EventLoop &event_loop, SocketAddress server_address,
+         bool reuse_port=false);
 
   ~Server();
 
@@ -49,19 +99,59 @@ public:
     return socket.GetEventLoop();
   }
 
+  uint64_t GetReceivedCount() const noexcept {
+    return n_received;
+  }
+
+  uint64_t GetSentCount() const noexcept {
+    return n_sent;
+  }
+
+  /**
+   * Queue a datagram to be sent to the specified address.  It will
+   * be sent at the end of the current event loop iteration (or
+   * earlier if the queue is full).
+   */
   void SendBuffer(SocketAddress address,
                   std::span<const std::byte> buffer) noexcept;
 
+  /**
+   * Send all queued datagrams now.
+   */
+  void FlushSendQueue() noexcept;
+
   template<typename P>
   void SendPacket(SocketAddress address, const P &packet) noexcept {
     SendBuffer(address, std::as_bytes(std::span{&packet, 1}));
   }
 
+  /**
+   * Handle a datagram as if it had been received by this object's
+   * socket, but without calling RouteDatagram().  The buffer may be
+   * modified.
+   */
+  void InjectDatagram(SocketAddress address,
+                      std::span<std::byte> buffer);
+
 private:
   void OnDatagramReceived(Client &&client, void *data, size_t length);
+  void SendNow(SocketAddress address,
+               std::span<const std::byte> buffer) noexcept;
+
   void OnSocketReady(unsigned events) noexcept;
 
 protected:
+  /**
+   * A datagram has been received, but has not been parsed yet.  The
+   * method may pass it to another #Server instance (see
+   * InjectDatagram()) and return true; by default, it returns false,
+   * and the datagram is handled by this object.
+   */
+  virtual bool RouteDatagram([[maybe_unused]] SocketAddress address,
+                             [[maybe_unused]] std::span<const std::byte> buffer) noexcept {
+    return false;
+  }
+
   virtual void OnPing(const Client &client, unsigned id);
 
   virtual void OnFix([[maybe_unused]] const Client &client,
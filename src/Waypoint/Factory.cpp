@@ -19,3 +19,23 @@ WaypointFactory::FallbackElevation(Waypoint &waypoint) const noexcept
 
   return false;
 }
+
+void
+WaypointFactory::FallbackElevations(std::span<Waypoint> waypoints) const noexcept
+{
+  if (terrain == nullptr)
+    return;
+
+  RasterTerrain::Lease lease(*terrain);
+
+  for (auto &waypoint : waypoints) {
+    if (waypoint.has_elevation)
+      continue;
+
+    const auto h = lease->GetHeight(waypoint.location);
+    if (!h.IsSpecial()) {
+      waypoint.elevation = h.GetValue();
+      waypoint.has_elevation = true;
+    }
+  }
+}
@@ -5,6 +5,8 @@
 
 #include "Engine/Waypoint/Waypoint.hpp"
 
+#include <span>
+
 class RasterTerrain;
 
 /**
@@ -39,4 +41,10 @@ public:
    * set, false if no fallback was found
    */
   bool FallbackElevation(Waypoint &waypoint) const noexcept;
+
+  /**
+   * Call FallbackElevation() on all waypoints without elevation.  The
+   * terrain is locked only once for the whole batch.
+   */
+  void FallbackElevations(std::span<Waypoint> waypoints) const noexcept;
 };
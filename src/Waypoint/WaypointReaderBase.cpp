@@ -2,8 +2,97 @@
 // Copyright The XCSoar Project
 
 #include "WaypointReaderBase.hpp"
+#include "Engine/Waypoint/Waypoints.hpp"
 #include "Operation/ProgressListener.hpp"
 #include "io/LineReader.hpp"
+#include "thread/Parallel.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+/**
+ * The number of lines which are read into memory before they are
+ * parsed.
+ */
+static constexpr unsigned WINDOW_LINES = 8192;
+
+/**
+ * The minimum number of lines handed to a parser thread.  Smaller
+ * files are not worth starting threads.
+ */
+static constexpr unsigned MIN_CHUNK_LINES = 512;
+
+bool
+WaypointReaderBase::ParseLines(const TCHAR *const*lines, unsigned n_lines,
+                               std::vector<Waypoint> &dest)
+{
+  unsigned i = 0;
+
+  /* parse the header sequentially until the reader state has
+     settled */
+  for (; i < n_lines && !IsCloneable(); ++i) {
+    if (IsFinished())
+      return false;
+
+    ParseLine(lines[i], dest);
+  }
+
+  lines += i;
+  n_lines -= i;
+
+  const unsigned n_chunks =
+    std::min(n_lines / MIN_CHUNK_LINES,
+             max_threads > 0 ? max_threads : GetProcessorCount());
+  if (n_chunks <= 1) {
+    for (i = 0; i < n_lines; ++i) {
+      if (IsFinished())
+        return false;
+
+      ParseLine(lines[i], dest);
+    }
+
+    return !IsFinished();
+  }
+
+  struct Chunk {
+    std::unique_ptr<WaypointReaderBase> clone;
+    WaypointReaderBase *reader;
+    std::vector<Waypoint> waypoints;
+  };
+
+  ++n_parallel_windows;
+
+  std::vector<Chunk> chunks(n_chunks);
+  chunks.front().reader = this;
+  for (unsigned c = 1; c < n_chunks; ++c) {
+    chunks[c].clone = Clone();
+    chunks[c].reader = chunks[c].clone.get();
+  }
+
+  ParallelFor(n_chunks, [&chunks, lines, n_lines, n_chunks](unsigned c){
+    auto &chunk = chunks[c];
+    const unsigned end = n_lines * (c + 1) / n_chunks;
+
+    for (unsigned i = n_lines * c / n_chunks; i < end; ++i) {
+      if (chunk.reader->IsFinished())
+        break;
+
+      chunk.reader->ParseLine(lines[i], chunk.waypoints);
+    }
+  }, n_chunks);
+
+  /* merge in file order, and discard everything after the chunk
+     which has reached the end of the waypoint list */
+  for (auto &chunk : chunks) {
+    std::move(chunk.waypoints.begin(), chunk.waypoints.end(),
+              std::back_inserter(dest));
+
+    if (chunk.reader->IsFinished())
+      return false;
+  }
+
+  return true;
+}
 
 void
 WaypointReaderBase::Parse(Waypoints &way_points, TLineReader &reader,
@@ -12,13 +101,46 @@ WaypointReaderBase::Parse(Waypoints &way_points, TLineReader &reader,
   const long filesize = std::max(reader.GetSize(), 1l);
   progress.SetProgressRange(100);
 
-  // Read through the lines of the file
-  TCHAR *line;
-  for (unsigned i = 0; (line = reader.ReadLine()) != nullptr; i++) {
+  /* all lines of the current window are copied to one buffer */
+  std::vector<TCHAR> buffer;
+  std::vector<std::size_t> offsets;
+  std::vector<const TCHAR *> lines;
+  std::vector<Waypoint> waypoints;
+
+  n_parallel_windows = 0;
+
+  bool more = true;
+  while (more) {
+    buffer.clear();
+    offsets.clear();
+
+    // Read through the lines of the file
+    TCHAR *line;
+    while (offsets.size() < WINDOW_LINES &&
+           (line = reader.ReadLine()) != nullptr) {
+      offsets.push_back(buffer.size());
+      buffer.insert(buffer.end(), line, line + _tcslen(line) + 1);
+    }
+
+    if (offsets.empty())
+      break;
+
+    more = offsets.size() == WINDOW_LINES;
+
+    lines.clear();
+    for (const auto offset : offsets)
+      lines.push_back(buffer.data() + offset);
+
     // and parse them
-    ParseLine(line, way_points);
+    if (!ParseLines(lines.data(), lines.size(), waypoints))
+      more = false;
+
+    factory.FallbackElevations(waypoints);
+
+    for (auto &i : waypoints)
+      way_points.Append(std::move(i));
+    waypoints.clear();
 
-    if ((i & 0x3f) == 0)
-      progress.SetProgressPosition(reader.Tell() * 100 / filesize);
+    progress.SetProgressPosition(reader.Tell() * 100 / filesize);
   }
 }
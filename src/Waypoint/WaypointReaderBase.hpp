@@ -5,6 +5,9 @@
 
 #include "Factory.hpp"
 
+#include <memory>
+#include <vector>
+
 #include <tchar.h>
 
 class Waypoints;
@@ -16,29 +19,107 @@ class WaypointReaderBase
 protected:
   const WaypointFactory factory;
 
+private:
+  /**
+   * The maximum number of parser threads; 0 means one per
+   * processor.
+   */
+  unsigned max_threads = 0;
+
+  /**
+   * The number of windows which were split into chunks by the most
+   * recent Parse() call.
+   */
+  unsigned n_parallel_windows = 0;
+
 protected:
   explicit WaypointReaderBase(WaypointFactory _factory)
     :factory(_factory) {}
 
+  WaypointReaderBase(const WaypointReaderBase &) = default;
+
 public:
   virtual ~WaypointReaderBase() {}
 
   /**
    * Parses a waypoint file into the given waypoint list
+   *
+   * The file is read in windows of many lines.  Once the reader
+   * state has settled (see IsCloneable()), the lines of a window are
+   * parsed by several threads; afterwards, missing elevations are
+   * looked up in the terrain in one batch.
+   *
    * @param way_points The waypoint list to fill
-   * @return True if the waypoint file parsing was okay, False otherwise
    */
   void Parse(Waypoints &way_points, TLineReader &reader,
              ProgressListener &progress);
 
+  /**
+   * Override the number of parser threads.
+   *
+   * @param _max_threads the maximum number of threads; 0 means one
+   * per processor
+   */
+  void SetMaxThreads(unsigned _max_threads) noexcept {
+    max_threads = _max_threads;
+  }
+
+  /**
+   * Returns the number of windows which were split into chunks (and
+   * parsed by cloned readers) during the most recent Parse() call.
+   */
+  unsigned GetParallelWindows() const noexcept {
+    return n_parallel_windows;
+  }
+
 protected:
   /**
    * Parse a file line
+   *
+   * Waypoints without elevation are left that way; Parse() calls
+   * WaypointFactory::FallbackElevations() later.
+   *
    * @param line The line to parse
-   * @param linenum The line number in the file
-   * @param way_points The waypoint list to fill
+   * @param dest The list to append the parsed waypoint to
    * @return True if the line was parsed correctly or ignored, False if
    * parsing error occured
    */
-  virtual bool ParseLine(const TCHAR* line, Waypoints &way_points) = 0;
+  virtual bool ParseLine(const TCHAR *line, std::vector<Waypoint> &dest) = 0;
+
+  /**
+   * Can this reader be copied with Clone()?  This is true when the
+   * parser state does not depend on the lines which follow, i.e. all
+   * copies would parse those lines the same way (header lines have
+   * been consumed, no format switches can occur).
+   */
+  virtual bool IsCloneable() const noexcept {
+    return false;
+  }
+
+  /**
+   * Create a copy of this reader which is used to parse a portion of
+   * the file in another thread.  May only be called if
+   * IsCloneable() returns true.
+   */
+  virtual std::unique_ptr<WaypointReaderBase> Clone() const {
+    return nullptr;
+  }
+
+  /**
+   * Has the end of the waypoint list been reached?  All following
+   * lines will be ignored.
+   */
+  virtual bool IsFinished() const noexcept {
+    return false;
+  }
+
+private:
+  /**
+   * Parse the specified lines, some of them in parallel.
+   *
+   * @return false if IsFinished() became true for one of the readers
+   * and parsing shall stop
+   */
+  bool ParseLines(const TCHAR *const*lines, unsigned n_lines,
+                  std::vector<Waypoint> &dest);
 };
@@ -2,9 +2,11 @@
 // Copyright The XCSoar Project
 
 #include "WaypointReaderCompeGPS.hpp"
-#include "Waypoint/Waypoints.hpp"
 #include "io/LineReader.hpp"
 #include "Geo/UTM.hpp"
+#include "util/StringCompare.hxx"
+
+#include <string.h>
 
 static bool
 ParseAngle(const TCHAR *&src, Angle &angle)
@@ -119,7 +121,7 @@ ParseAltitude(const TCHAR *&src, double &dest)
 }
 
 bool
-WaypointReaderCompeGPS::ParseLine(const TCHAR *line, Waypoints &waypoints)
+WaypointReaderCompeGPS::ParseLine(const TCHAR *line, std::vector<Waypoint> &dest)
 {
   /*
    * G  WGS 84
@@ -197,8 +199,6 @@ WaypointReaderCompeGPS::ParseLine(const TCHAR *line, Waypoints &waypoints)
   // Parse altitude
   if (ParseAltitude(line, waypoint.elevation))
     waypoint.has_elevation = true;
-  else
-    factory.FallbackElevation(waypoint);
 
   // Skip whitespace
   while (*line == _T(' '))
@@ -207,7 +207,7 @@ WaypointReaderCompeGPS::ParseLine(const TCHAR *line, Waypoints &waypoints)
   // Parse waypoint name
   waypoint.comment.assign(line);
 
-  waypoints.Append(std::move(waypoint));
+  dest.emplace_back(std::move(waypoint));
   return true;
 }
 
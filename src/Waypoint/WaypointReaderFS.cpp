@@ -2,9 +2,10 @@
 // Copyright The XCSoar Project
 
 #include "WaypointReaderFS.hpp"
-#include "Waypoint/Waypoints.hpp"
 #include "Geo/UTM.hpp"
 #include "io/LineReader.hpp"
+#include "util/StringCompare.hxx"
+#include "util/tstring_view.hxx"
 
 #include <stdlib.h>
 
@@ -119,7 +120,7 @@ ParseString(tstring_view src) noexcept
 }
 
 bool
-WaypointReaderFS::ParseLine(const TCHAR *line, Waypoints &way_points)
+WaypointReaderFS::ParseLine(const TCHAR *line, std::vector<Waypoint> &dest)
 {
   //$FormatGEO
   //ACONCAGU  S 32 39 12.00    W 070 00 42.00  6962  Aconcagua
@@ -162,14 +163,12 @@ WaypointReaderFS::ParseLine(const TCHAR *line, Waypoints &way_points)
 
   if (ParseAltitude(line + (is_utm ? 32 : 41), new_waypoint.elevation))
     new_waypoint.has_elevation = true;
-  else
-    factory.FallbackElevation(new_waypoint);
 
   // Description (Characters 35-44)
   if (len > (is_utm ? 38 : 47))
     new_waypoint.comment = ParseString(line + (is_utm ? 38 : 47));
 
-  way_points.Append(std::move(new_waypoint));
+  dest.emplace_back(std::move(new_waypoint));
   return true;
 }
 
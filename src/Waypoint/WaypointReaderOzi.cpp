@@ -2,12 +2,12 @@
 // Copyright The XCSoar Project
 
 #include "WaypointReaderOzi.hpp"
-#include "Waypoint/Waypoints.hpp"
 #include "io/LineReader.hpp"
 #include "Units/System.hpp"
 #include "util/Macros.hpp"
 #include "util/ExtractParameters.hpp"
 #include "util/StringStrip.hxx"
+#include "util/StringCompare.hxx"
 
 #include <stdlib.h>
 
@@ -48,7 +48,7 @@ ParseString(const TCHAR *src, tstring &dest)
 }
 
 bool
-WaypointReaderOzi::ParseLine(const TCHAR *line, Waypoints &way_points)
+WaypointReaderOzi::ParseLine(const TCHAR *line, std::vector<Waypoint> &dest)
 {
   if (line[0] == '\0')
     return true;
@@ -97,13 +97,14 @@ WaypointReaderOzi::ParseLine(const TCHAR *line, Waypoints &way_points)
   if (ParseNumber(params[14], value) && value != -777) {
     new_waypoint.elevation = Units::ToSysUnit(value, Unit::FEET);
     new_waypoint.has_elevation = true;
-  } else
-    factory.FallbackElevation(new_waypoint);
+  }
 
   // Description
-  ParseString(params[10], new_waypoint.comment);
+  tstring comment;
+  ParseString(params[10], comment);
+  new_waypoint.comment = comment;
 
-  way_points.Append(std::move(new_waypoint));
+  dest.emplace_back(std::move(new_waypoint));
   return true;
 }
 
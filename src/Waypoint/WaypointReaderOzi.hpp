@@ -17,5 +17,13 @@ public:
 
 protected:
   /* virtual methods from class WaypointReaderBase */
-  bool ParseLine(const TCHAR *line, Waypoints &way_points) override;
+  bool ParseLine(const TCHAR *line, std::vector<Waypoint> &dest) override;
+
+  bool IsCloneable() const noexcept override {
+    return ignore_lines == 0;
+  }
+
+  std::unique_ptr<WaypointReaderBase> Clone() const override {
+    return std::make_unique<WaypointReaderOzi>(*this);
+  }
 };
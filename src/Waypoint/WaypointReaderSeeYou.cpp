@@ -3,10 +3,10 @@
 
 #include "WaypointReaderSeeYou.hpp"
 #include "Units/System.hpp"
-#include "Waypoint/Waypoints.hpp"
 #include "util/ExtractParameters.hpp"
 #include "util/Macros.hpp"
 #include "util/IterableSplitString.hxx"
+#include "util/StringCompare.hxx"
 
 #include <stdlib.h>
 
@@ -166,7 +166,7 @@ ParseStyle(const TCHAR* src, Waypoint::Type &type)
 }
 
 bool
-WaypointReaderSeeYou::ParseLine(const TCHAR* line, Waypoints &waypoints)
+WaypointReaderSeeYou::ParseLine(const TCHAR *line, std::vector<Waypoint> &dest)
 {
   enum {
     iName = 0,
@@ -255,12 +255,9 @@ WaypointReaderSeeYou::ParseLine(const TCHAR* line, Waypoints &waypoints)
 
   // Elevation (e.g. 458.0m)
   /// @todo configurable behaviour
-  if (iElevation < n_params) {
-    if (ParseAltitude(params[iElevation], new_waypoint.elevation))
-      new_waypoint.has_elevation = true;
-    else
-      factory.FallbackElevation(new_waypoint);
-  }
+  if (iElevation < n_params &&
+      ParseAltitude(params[iElevation], new_waypoint.elevation))
+    new_waypoint.has_elevation = true;
 
   // Style (e.g. 5)
   if (iStyle < n_params)
@@ -318,6 +315,6 @@ WaypointReaderSeeYou::ParseLine(const TCHAR* line, Waypoints &waypoints)
       new_waypoint.files_embed.emplace_front(i);
     }
   }
-  waypoints.Append(std::move(new_waypoint));
+  dest.emplace_back(std::move(new_waypoint));
   return true;
 }
@@ -25,5 +25,18 @@ public:
     :WaypointReaderBase(_factory) {}
 
   /* virtual methods from class WaypointReaderBase */
-  bool ParseLine(const TCHAR* line, Waypoints &way_points) override;
+  bool ParseLine(const TCHAR *line, std::vector<Waypoint> &dest) override;
+
+protected:
+  bool IsCloneable() const noexcept override {
+    return !first;
+  }
+
+  std::unique_ptr<WaypointReaderBase> Clone() const override {
+    return std::make_unique<WaypointReaderSeeYou>(*this);
+  }
+
+  bool IsFinished() const noexcept override {
+    return ignore_following;
+  }
 };
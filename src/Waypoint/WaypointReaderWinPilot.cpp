@@ -3,7 +3,6 @@
 
 #include "WaypointReaderWinPilot.hpp"
 #include "Units/System.hpp"
-#include "Waypoint/Waypoints.hpp"
 #include "util/ExtractParameters.hpp"
 #include "util/StringAPI.hxx"
 #include "util/NumberParser.hpp"
@@ -168,7 +167,7 @@ ParseFlags(const TCHAR* src, Waypoint &dest)
 }
 
 bool
-WaypointReaderWinPilot::ParseLine(const TCHAR *line, Waypoints &waypoints)
+WaypointReaderWinPilot::ParseLine(const TCHAR *line, std::vector<Waypoint> &dest)
 {
   TCHAR ctemp[4096];
   const TCHAR *params[20];
@@ -191,6 +190,9 @@ WaypointReaderWinPilot::ParseLine(const TCHAR *line, Waypoints &waypoints)
     return true;
   }
 
+  /* a file without a leading comment line is not a WELT2000 file */
+  first = false;
+
   if (_tcslen(line) >= ARRAY_SIZE(ctemp))
     /* line too long for buffer */
     return false;
@@ -222,8 +224,6 @@ WaypointReaderWinPilot::ParseLine(const TCHAR *line, Waypoints &waypoints)
   /// @todo configurable behaviour
   if (ParseAltitude(params[3], new_waypoint.elevation))
     new_waypoint.has_elevation = true;
-  else
-    factory.FallbackElevation(new_waypoint);
 
   if (n_params > 6) {
     // Description (e.g. 119.750 Airport)
@@ -235,6 +235,6 @@ WaypointReaderWinPilot::ParseLine(const TCHAR *line, Waypoints &waypoints)
   // Waypoint Flags (e.g. AT)
   ParseFlags(params[4], new_waypoint);
 
-  waypoints.Append(std::move(new_waypoint));
+  dest.emplace_back(std::move(new_waypoint));
   return true;
 }
@@ -18,5 +18,14 @@ public:
 
 protected:
   /* virtual methods from class WaypointReaderBase */
-  bool ParseLine(const TCHAR *line, Waypoints &way_points) override;
+  bool ParseLine(const TCHAR *line, std::vector<Waypoint> &dest) override;
+
+  bool IsCloneable() const noexcept override {
+    /* the format is detected from the first line */
+    return !first;
+  }
+
+  std::unique_ptr<WaypointReaderBase> Clone() const override {
+    return std::make_unique<WaypointReaderWinPilot>(*this);
+  }
 };
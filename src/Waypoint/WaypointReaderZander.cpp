@@ -2,7 +2,7 @@
 // Copyright The XCSoar Project
 
 #include "WaypointReaderZander.hpp"
-#include "Waypoint/Waypoints.hpp"
+#include "util/StringCompare.hxx"
 
 #include <stdlib.h>
 
@@ -127,7 +127,7 @@ ParseFlagsFromDescription(const TCHAR* src, Waypoint &dest)
 }
 
 bool
-WaypointReaderZander::ParseLine(const TCHAR* line, Waypoints &way_points)
+WaypointReaderZander::ParseLine(const TCHAR *line, std::vector<Waypoint> &dest)
 {
   // If (end-of-file or comment)
   if (line[0] == '\0' || line[0] == '*')
@@ -162,18 +162,19 @@ WaypointReaderZander::ParseLine(const TCHAR* line, Waypoints &way_points)
   /// @todo configurable behaviour
   if (ParseAltitude(line + 30, new_waypoint.elevation))
     new_waypoint.has_elevation = true;
-  else
-    factory.FallbackElevation(new_waypoint);
 
   // Description (Characters 35-44)
-  if (len > 35)
-    ParseString(line + 35, new_waypoint.comment, 9);
+  if (len > 35) {
+    tstring comment;
+    ParseString(line + 35, comment, 9);
+    new_waypoint.comment = comment;
+  }
 
   // Flags (Characters 45-49)
   if (len < 46 || !ParseFlags(line + 45, new_waypoint))
     if (len < 36 || !ParseFlagsFromDescription(line + 35, new_waypoint))
       new_waypoint.flags.turn_point = true;
 
-  way_points.Append(std::move(new_waypoint));
+  dest.emplace_back(std::move(new_waypoint));
   return true;
 }
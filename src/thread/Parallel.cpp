@@ -0,0 +1,201 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Parallel.hpp"
+#include "Thread.hpp"
+
+#ifdef HAVE_POSIX
+#include <unistd.h>
+#else
+#include <sysinfoapi.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+unsigned
+GetProcessorCount() noexcept
+{
+#ifdef HAVE_POSIX
+  const long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 1 ? unsigned(n) : 1;
+#else
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return std::max(unsigned(info.dwNumberOfProcessors), 1U);
+#endif
+}
+
+class ParallelJob {
+  std::atomic_uint next{0};
+  const unsigned n;
+  const std::function<void(unsigned)> &f;
+
+public:
+  ParallelJob(unsigned _n, const std::function<void(unsigned)> &_f) noexcept
+    :n(_n), f(_f) {}
+
+  void Work() noexcept {
+    for (unsigned i; (i = next.fetch_add(1, std::memory_order_relaxed)) < n;)
+      f(i);
+  }
+};
+
+namespace {
+
+class ParallelWorker final : public Thread {
+  ParallelJob &job;
+
+public:
+  explicit ParallelWorker(ParallelJob &_job) noexcept
+    :Thread("ParallelFor"), job(_job) {}
+
+protected:
+  void Run() noexcept override {
+    job.Work();
+  }
+};
+
+} // anonymous namespace
+
+void
+ParallelFor(unsigned n, const std::function<void(unsigned)> &f,
+            unsigned max_threads) noexcept
+{
+  if (max_threads == 0)
+    max_threads = GetProcessorCount();
+
+  const unsigned n_workers = std::min(n, max_threads) - (n > 0);
+
+  ParallelJob job(n, f);
+
+  std::vector<std::unique_ptr<ParallelWorker>> workers;
+  for (unsigned i = 0; i < n_workers; ++i) {
+    auto worker = std::make_unique<ParallelWorker>(job);
+
+    try {
+      worker->Start();
+    } catch (...) {
+      /* out of threads; the remaining work will be done by the
+         threads which are already running */
+      break;
+    }
+
+    workers.emplace_back(std::move(worker));
+  }
+
+  job.Work();
+
+  for (auto &worker : workers)
+    worker->Join();
+}
+
+class ParallelPool::Worker final : public Thread {
+  ParallelPool &pool;
+
+  /**
+   * The pool's generation when this worker was created; a job posted
+   * before the thread gets to run must not be missed.
+   */
+  const unsigned generation;
+
+public:
+  explicit Worker(ParallelPool &_pool) noexcept
+    :Thread(_pool.name), pool(_pool), generation(_pool.generation) {}
+
+protected:
+  void Run() noexcept override {
+    pool.RunWorker(generation);
+  }
+};
+
+ParallelPool::ParallelPool(const char *_name, unsigned _max_threads) noexcept
+  :name(_name),
+   max_threads(_max_threads > 0 ? _max_threads : GetProcessorCount()) {}
+
+ParallelPool::~ParallelPool() noexcept
+{
+  {
+    const std::lock_guard lock{mutex};
+    stop = true;
+    job_cond.notify_all();
+  }
+
+  for (auto &worker : workers)
+    worker->Join();
+}
+
+inline void
+ParallelPool::StartWorkers(unsigned n_workers) noexcept
+{
+  while (workers.size() < n_workers) {
+    auto worker = std::make_unique<Worker>(*this);
+
+    try {
+      worker->Start();
+    } catch (...) {
+      /* out of threads; make do with the workers we have */
+      break;
+    }
+
+    workers.emplace_back(std::move(worker));
+  }
+}
+
+inline void
+ParallelPool::RunWorker(unsigned seen) noexcept
+{
+  std::unique_lock lock{mutex};
+
+  while (true) {
+    job_cond.wait(lock, [this, seen]{
+      return stop || generation != seen;
+    });
+
+    if (stop)
+      break;
+
+    seen = generation;
+    ParallelJob &current = *job;
+
+    lock.unlock();
+    current.Work();
+    lock.lock();
+
+    if (--busy == 0)
+      done_cond.notify_one();
+  }
+}
+
+void
+ParallelPool::For(unsigned n, const std::function<void(unsigned)> &f) noexcept
+{
+  if (n == 0)
+    return;
+
+  ParallelJob current(n, f);
+
+  /* the calling thread is one of the workers */
+  StartWorkers(std::min(n, max_threads) - 1);
+
+  if (workers.empty()) {
+    current.Work();
+    return;
+  }
+
+  {
+    const std::lock_guard lock{mutex};
+    job = &current;
+    ++generation;
+    busy = workers.size();
+    job_cond.notify_all();
+  }
+
+  current.Work();
+
+  std::unique_lock lock{mutex};
+  done_cond.wait(lock, [this]{ return busy == 0; });
+  job = nullptr;
+}
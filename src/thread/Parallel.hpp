@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Mutex.hxx"
+#include "Cond.hxx"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+class ParallelJob;
+
+/**
+ * Determine the number of processors which are currently online.
+ * Returns at least 1.
+ */
+unsigned
+GetProcessorCount() noexcept;
+
+/**
+ * Invoke the function once for each index in the range [0, n),
+ * distributed over up to #max_threads threads (including the calling
+ * thread).  Returns after all invocations have finished.
+ *
+ * The order of invocations is unspecified; the function must be
+ * thread-safe and must not throw.  If no worker thread can be
+ * started, all invocations run in the calling thread.
+ *
+ * @param max_threads the maximum number of threads; 0 means one per
+ * processor
+ */
+void
+ParallelFor(unsigned n, const std::function<void(unsigned)> &f,
+            unsigned max_threads=0) noexcept;
+
+/**
+ * Like ParallelFor(), but the worker threads are started on the first
+ * For() call and then kept waiting for the next job, instead of being
+ * started and joined for each call.  This is meant for work which is
+ * repeated often, e.g. once per frame.
+ *
+ * For() must not be called from more than one thread at a time.
+ */
+class ParallelPool {
+  class Worker;
+
+  const char *const name;
+
+  const unsigned max_threads;
+
+  Mutex mutex;
+
+  /**
+   * Wakes up the workers when a new job is posted or when they are
+   * asked to stop.
+   */
+  Cond job_cond;
+
+  /**
+   * Signals the thread which called For() that all workers are done.
+   */
+  Cond done_cond;
+
+  std::vector<std::unique_ptr<Worker>> workers;
+
+  /**
+   * The current job; only valid while #busy is non-zero.
+   */
+  ParallelJob *job = nullptr;
+
+  /**
+   * Incremented for each new job, so a worker can tell whether it has
+   * already seen it.
+   */
+  unsigned generation = 0;
+
+  /**
+   * The number of workers which have not yet finished the current
+   * job.
+   */
+  unsigned busy = 0;
+
+  bool stop = false;
+
+public:
+  /**
+   * @param _name the name of the worker threads
+   * @param _max_threads the maximum number of threads (including
+   * the calling thread); 0 means one per processor
+   */
+  explicit ParallelPool(const char *_name,
+                        unsigned _max_threads=0) noexcept;
+
+  /**
+   * Stops and joins all worker threads.
+   */
+  ~ParallelPool() noexcept;
+
+  ParallelPool(const ParallelPool &) = delete;
+  ParallelPool &operator=(const ParallelPool &) = delete;
+
+  /**
+   * Invoke the function once for each index in the range [0, n); see
+   * ParallelFor().  Returns after all invocations have finished.
+   */
+  void For(unsigned n, const std::function<void(unsigned)> &f) noexcept;
+
+private:
+  void StartWorkers(unsigned n_workers) noexcept;
+  void RunWorker(unsigned seen) noexcept;
+};
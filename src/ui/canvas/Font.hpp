@@ -25,6 +25,7 @@ class GLTexture;
 
 #ifdef USE_FREETYPE
 typedef struct FT_FaceRec_ *FT_Face;
+class GlyphCache;
 #endif
 
 class FontDescription;
@@ -37,6 +38,11 @@ class Font {
 protected:
 #ifdef USE_FREETYPE
   FT_Face face = nullptr;
+
+  /**
+   * The rendered glyphs of #face; allocated together with it.
+   */
+  GlyphCache *glyphs = nullptr;
 #elif defined(ANDROID)
   TextUtil *text_util_object = nullptr;
 
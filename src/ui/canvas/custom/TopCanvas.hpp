@@ -32,6 +32,10 @@
 #include "../memory/Dither.hpp"
 #endif
 
+#if defined(KOBO) && defined(USE_FB)
+#include "../memory/Damage.hpp"
+#endif
+
 #include <cstdint>
 
 #ifdef SOFTWARE_ROTATE_DISPLAY
@@ -123,6 +127,19 @@ class TopCanvas
    * this flag can be set true for don't wait eInk Update complete for faster responce time.
    */
   bool frame_sync = false;
+
+#ifdef USE_FB
+  /**
+   * Finds the screen regions which have changed since the last
+   * Flip(), to submit them as partial e-ink updates.
+   */
+  DamageTracker damage;
+
+  /**
+   * The number of partial updates since the last full update.
+   */
+  unsigned n_partial_updates = 0;
+#endif
 #endif // KOBO
 
 public:
@@ -187,7 +204,9 @@ public:
   PixelSize GetPhysicalSize() const noexcept;
 
   /**
-   * Check if the screen has been resized.
+   * Check if the screen has been resized.  This also schedules a
+   * full screen update, because the display may have been rotated
+   * without changing its size.
    *
    * @return true if the screen has been resized
    */
@@ -236,6 +255,10 @@ public:
 
   void SetEnableDither(bool _enable_dither) noexcept {
     enable_dither = _enable_dither;
+#ifdef USE_FB
+    /* the whole screen needs to be converted again */
+    damage.Reset();
+#endif
   }
 #endif
 
@@ -251,4 +274,16 @@ private:
 #ifdef USE_EGL
   void CreateSurface(EGLNativeWindowType native_window);
 #endif
+
+#if defined(KOBO) && defined(USE_FB)
+  /**
+   * Convert one region of the back buffer to the frame buffer.
+   */
+  void CopyToFrameBuffer(const PixelRect &rc) noexcept;
+
+  /**
+   * Submit an e-ink update for the given region.
+   */
+  void SendUpdate(const PixelRect &rc, bool full) noexcept;
+#endif
 };
@@ -166,6 +166,20 @@ TopCanvas::TopCanvas(UI::Display &_display)
     break;
 
   };
+
+  switch (DetectKoboModel()) {
+  case KoboModel::MINI:
+  case KoboModel::TOUCH:
+  case KoboModel::GLO:
+    /* the slow CPU of these models can't afford error diffusion on
+       every screen update */
+    dither.SetMode(Dither::Mode::ORDERED);
+    break;
+
+  default:
+    dither.SetMode(Dither::Mode::ERROR_DIFFUSION);
+    break;
+  }
 #endif
 
   const auto new_size = ::GetSize(vinfo);
@@ -188,6 +202,13 @@ TopCanvas::GetNativeSize() const noexcept
 bool
 TopCanvas::CheckResize() noexcept
 {
+#ifdef KOBO
+  /* this is called after the display has been rotated; a rotation
+     by 180 degrees keeps the size, but the frame buffer contents
+     need to be written again in the new orientation */
+  damage.Reset();
+#endif
+
   return CheckResize(GetNativeSize());
 }
 
@@ -239,36 +260,49 @@ TopCanvas::Unlock() noexcept
 {
 }
 
-void
-TopCanvas::Flip()
+#if defined(KOBO) && defined(USE_FB)
+
+/**
+ * After this number of partial updates, the whole screen is refreshed
+ * to clear the ghosting left behind by partial e-ink updates.
+ */
+static constexpr unsigned FULL_REFRESH_INTERVAL = 64;
+
+/**
+ * If the damaged area is larger than this fraction (in percent) of
+ * the screen, a full update is cheaper than a partial one.
+ */
+static constexpr unsigned FULL_UPDATE_THRESHOLD = 50;
+
+inline void
+TopCanvas::CopyToFrameBuffer(const PixelRect &rc) noexcept
 {
-#ifdef USE_FB
+  const ConstImageBuffer<GreyscalePixelTraits> src{
+    buffer.At(rc.left, rc.top), buffer.pitch,
+    rc.GetWidth(), rc.GetHeight(),
+  };
+
+  uint8_t *dest = (uint8_t *)map + rc.top * map_pitch + rc.left * map_bpp;
 
-#ifdef GREYSCALE
   CopyFromGreyscale(
 #ifdef DITHER
                     dither,
 #endif
-#ifdef KOBO
                     enable_dither,
-#endif
-                    map, map_pitch, map_bpp,
-                    buffer);
-#else
-  CopyFromBGRA(map, map_pitch, map_bpp, buffer);
-#endif
-
-
-#ifdef KOBO
-  if (frame_sync)
-    Wait();
+                    dest, map_pitch, map_bpp,
+                    src, rc.GetTopLeft());
+}
 
+inline void
+TopCanvas::SendUpdate(const PixelRect &rc, bool full) noexcept
+{
   epd_update_marker++;
 
   KoboModel kobo_model = DetectKoboModel();
   struct mxcfb_update_data epd_update_data = {
     {
-      0, 0, buffer.width, buffer.height
+      uint32_t(rc.top), uint32_t(rc.left),
+      rc.GetWidth(), rc.GetHeight(),
     },
 
     uint32_t(enable_dither &&
@@ -282,18 +316,75 @@ TopCanvas::Flip()
               kobo_model == KoboModel::CLARA_2E)
              ? WAVEFORM_MODE_A2
              : WAVEFORM_MODE_AUTO),
-    UPDATE_MODE_FULL, // PARTIAL
+    uint32_t(full ? UPDATE_MODE_FULL : UPDATE_MODE_PARTIAL),
     epd_update_marker,
     TEMP_USE_AMBIENT,
     enable_dither ? EPDC_FLAG_FORCE_MONOCHROME : 0,
   };
 
   ioctl(fd, MXCFB_SEND_UPDATE, &epd_update_data);
+}
+
+void
+TopCanvas::Flip()
+{
+  /* only the regions which have changed since the last frame are
+     converted and submitted as partial updates */
+  const auto rects = damage.Update<GreyscalePixelTraits>(buffer);
+  if (rects.empty() && n_partial_updates < FULL_REFRESH_INTERVAL)
+    /* nothing has changed, and no ghosting needs to be cleared */
+    return;
+
+  const PixelRect screen{GetSize()};
+
+  unsigned damaged_area = 0;
+  for (const auto &rc : rects)
+    damaged_area += rc.GetWidth() * rc.GetHeight();
+
+  const bool full = n_partial_updates >= FULL_REFRESH_INTERVAL ||
+    damaged_area * 100 >= screen.GetWidth() * screen.GetHeight() * FULL_UPDATE_THRESHOLD;
+
+  /* the regions which were not damaged are already up to date in
+     the frame buffer, even for a full update */
+  for (const auto &rc : rects)
+    CopyToFrameBuffer(rc);
+
+  if (frame_sync)
+    Wait();
+
+  if (full) {
+    SendUpdate(screen, true);
+    n_partial_updates = 0;
+  } else {
+    for (const auto &rc : rects)
+      SendUpdate(rc, false);
+    ++n_partial_updates;
+  }
+}
+
+#else
+
+void
+TopCanvas::Flip()
+{
+#ifdef USE_FB
+
+#ifdef GREYSCALE
+  CopyFromGreyscale(
+#ifdef DITHER
+                    dither,
+#endif
+                    map, map_pitch, map_bpp,
+                    buffer);
+#else
+  CopyFromBGRA(map, map_pitch, map_bpp, buffer);
 #endif
 
 #endif /* USE_FB */
 }
 
+#endif
+
 #ifdef KOBO
 
 void
@@ -2,6 +2,7 @@
 // Copyright The XCSoar Project
 
 #include "ui/canvas/Font.hpp"
+#include "GlyphCache.hpp"
 #include "Screen/Debug.hpp"
 #include "ui/canvas/custom/Files.hpp"
 #include "Look/FontDescription.hpp"
@@ -10,10 +11,6 @@
 #include "Asset.hpp"
 #include "system/Path.hpp"
 
-#ifndef ENABLE_OPENGL
-#include "thread/Mutex.hxx"
-#endif
-
 #ifndef _UNICODE
 #include "util/UTF8.hpp"
 #endif
@@ -32,14 +29,6 @@
 #include <cassert>
 #include <cstdint>
 
-#ifndef ENABLE_OPENGL
-/**
- * libfreetype is not thread-safe; this global Mutex is used to
- * protect libfreetype from multi-threaded access.
- */
-static Mutex freetype_mutex;
-#endif
-
 static FT_Int32 load_flags = FT_LOAD_DEFAULT;
 static FT_Render_Mode render_mode = FT_RENDER_MODE_NORMAL;
 
@@ -74,7 +63,6 @@ FT_CEIL(FT_Long x) noexcept
   return FT_FLOOR(x + 63);
 }
 
-[[gnu::pure]]
 static unsigned
 NextChar(tstring_view &s) noexcept
 {
@@ -120,7 +108,7 @@ static unsigned
 GetCapitalHeight(FT_Face face) noexcept
 {
 #ifndef ENABLE_OPENGL
-  const std::lock_guard lock{freetype_mutex};
+  const std::lock_guard lock{FreeType::mutex};
 #endif
 
   FT_UInt i = FT_Get_Char_Index(face, 'M');
@@ -162,6 +150,7 @@ Font::LoadFile(const char *file, unsigned ptsize, [[maybe_unused]] bool bold, [[
   // TODO: handle bold/italic
 
   face = new_face;
+  glyphs = new GlyphCache(face, load_flags, render_mode);
 }
 
 void
@@ -205,6 +194,9 @@ Font::Destroy() noexcept
 
   assert(IsScreenInitialized());
 
+  delete glyphs;
+  glyphs = nullptr;
+
   ::FT_Done_Face(face);
   face = nullptr;
 }
@@ -223,50 +215,37 @@ ForEachChar(tstring_view text, F &&f)
   }
 }
 
-template<typename T, typename F>
+/**
+ * Lay out the text with the glyphs from the #GlyphCache; this calls
+ * FreeType only for glyphs which have not been seen before.
+ */
+template<typename F>
 static void
-ForEachGlyph(const FT_Face face, unsigned ascent_height, T &&text,
+ForEachGlyph(GlyphCache &glyphs, unsigned ascent_height, tstring_view text,
              F &&f) noexcept
 {
-  const bool use_kerning = FT_HAS_KERNING(face);
+  const bool use_kerning = glyphs.HasKerning();
 
   int x = 0;
-  unsigned prev_index = 0;
-
-#ifndef ENABLE_OPENGL
-  const std::lock_guard lock{freetype_mutex};
-#endif
+  const GlyphCache::Glyph *prev = nullptr;
 
-  ForEachChar(std::forward<T>(text),
-              [face, ascent_height, &f, use_kerning,
-               &x, &prev_index](unsigned ch){
-      const FT_UInt i = FT_Get_Char_Index(face, ch);
-      if (i == 0)
+  ForEachChar(text,
+              [&glyphs, ascent_height, &f, use_kerning,
+               &x, &prev](unsigned ch){
+      const auto &glyph = glyphs.Get(ch);
+      if (glyph.index == 0)
         return;
 
-      const FT_Error error = FT_Load_Glyph(face, i, load_flags);
-      if (error)
-        return;
-
-      const FT_GlyphSlot glyph = face->glyph;
-      const FT_Glyph_Metrics &metrics = glyph->metrics;
-
       if (use_kerning) {
-        if (prev_index != 0 && i != 0) {
-          FT_Vector delta;
-          FT_Get_Kerning(face, prev_index, i, ft_kerning_default,
-                         &delta);
-          x += delta.x >> 6;
-        }
-
-        prev_index = i;
+        if (prev != nullptr)
+          x += glyphs.GetKerning(*prev, glyph);
+
+        prev = &glyph;
       }
 
-      f(x + FT_FLOOR(metrics.horiBearingX),
-        ascent_height - FT_FLOOR(metrics.horiBearingY),
-        glyph);
+      f(x + glyph.bearing_x, int(ascent_height) - glyph.bearing_y, glyph);
 
-      x += FT_CEIL(metrics.horiAdvance);
+      x += glyph.advance;
     });
 }
 
@@ -275,13 +254,10 @@ Font::TextSize(tstring_view text) const noexcept
 {
   int maxx = 0;
 
-  ForEachGlyph(face, ascent_height, text,
-               [&maxx](int x, [[maybe_unused]] int y, const FT_GlyphSlot glyph){
-      const FT_Glyph_Metrics &metrics = glyph->metrics;
-      const int glyph_minx = FT_FLOOR(metrics.horiBearingX);
-      const int glyph_maxx = glyph_minx + FT_CEIL(metrics.width);
-
-      int z = x + glyph_maxx;
+  ForEachGlyph(*glyphs, ascent_height, text,
+               [&maxx](int x, [[maybe_unused]] int y,
+                       const GlyphCache::Glyph &glyph){
+      int z = x + glyph.bearing_x + int(glyph.width);
       if (z > maxx)
         maxx = z;
     });
@@ -299,11 +275,14 @@ MixLine(uint8_t *dest, const uint8_t *src, size_t n) noexcept
 
 static void
 RenderGlyph(uint8_t *buffer, unsigned buffer_width, unsigned buffer_height,
-            const FT_Bitmap &bitmap, int x, int y) noexcept
+            const GlyphCache::Glyph &glyph, int x, int y) noexcept
 {
-  const uint8_t *src = (const uint8_t *)bitmap.buffer;
-  int width = bitmap.width, height = bitmap.rows;
-  int pitch = bitmap.pitch;
+  const uint8_t *src = glyph.bitmap.get();
+  if (src == nullptr)
+    return;
+
+  int width = glyph.bitmap_width, height = glyph.bitmap_height;
+  const int pitch = glyph.bitmap_width;
 
   if (x < 0) {
     src -= x;
@@ -335,50 +314,6 @@ RenderGlyph(uint8_t *buffer, unsigned buffer_width, unsigned buffer_height,
     MixLine(buffer, src, width);
 }
 
-static void
-ConvertMono(unsigned char *dest, const unsigned char *src, unsigned n) noexcept
-{
-  for (; n >= 8; n -= 8, ++src) {
-    for (unsigned i = 0x80; i != 0; i >>= 1)
-      *dest++ = (*src & i) ? 0xff : 0x00;
-  }
-
-  for (unsigned i = 0x80; n > 0; i >>= 1, --n)
-    *dest++ = (*src & i) ? 0xff : 0x00;
-}
-
-static void
-ConvertMono(FT_Bitmap &dest, const FT_Bitmap &src) noexcept
-{
-  dest = src;
-  dest.pitch = dest.width;
-  dest.buffer = new unsigned char[dest.pitch * dest.rows];
-
-  unsigned char *d = dest.buffer, *s = src.buffer;
-  for (unsigned y = 0; y < unsigned(dest.rows);
-       ++y, d += dest.pitch, s += src.pitch)
-    ConvertMono(d, s, dest.width);
-}
-
-static void
-RenderGlyph(uint8_t *buffer, size_t width, size_t height,
-            FT_GlyphSlot glyph, int x, int y) noexcept
-{
-  FT_Error error = FT_Render_Glyph(glyph, render_mode);
-  if (error)
-    return;
-
-  if (IsMono()) {
-    /* with anti-aliasing disabled, FreeType writes each pixel in one
-       bit; hack: convert it to 1 byte per pixel and then render it */
-    FT_Bitmap bitmap;
-    ConvertMono(bitmap, glyph->bitmap);
-    RenderGlyph(buffer, width, height, bitmap, x, y);
-    delete[] bitmap.buffer;
-  } else
-    RenderGlyph(buffer, width, height, glyph->bitmap, x, y);
-}
-
 void
 Font::Render(tstring_view text, const PixelSize size,
              void *_buffer) const noexcept
@@ -386,9 +321,8 @@ Font::Render(tstring_view text, const PixelSize size,
   uint8_t *buffer = (uint8_t *)_buffer;
   std::fill_n(buffer, BufferSize(size), 0);
 
-  ForEachGlyph(face, ascent_height, text,
-               [size, buffer](int x, int y, const FT_GlyphSlot glyph){
-      RenderGlyph(buffer, size.width, size.height, glyph,
-                  x, y);
+  ForEachGlyph(*glyphs, ascent_height, text,
+               [size, buffer](int x, int y, const GlyphCache::Glyph &glyph){
+      RenderGlyph(buffer, size.width, size.height, glyph, x, y);
     });
 }
@@ -0,0 +1,187 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "GlyphCache.hpp"
+#include "Init.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+static constexpr FT_Long
+FT_FLOOR(FT_Long x) noexcept
+{
+  return (x & -64) / 64;
+}
+
+static constexpr FT_Long
+FT_CEIL(FT_Long x) noexcept
+{
+  return FT_FLOOR(x + 63);
+}
+
+static void
+ConvertMono(uint8_t *dest, const uint8_t *src, unsigned n) noexcept
+{
+  for (; n >= 8; n -= 8, ++src) {
+    for (unsigned i = 0x80; i != 0; i >>= 1)
+      *dest++ = (*src & i) ? 0xff : 0x00;
+  }
+
+  for (unsigned i = 0x80; n > 0; i >>= 1, --n)
+    *dest++ = (*src & i) ? 0xff : 0x00;
+}
+
+/**
+ * Copy a FreeType bitmap to a new buffer with one byte per pixel and
+ * no padding.
+ */
+static std::unique_ptr<uint8_t[]>
+CopyBitmap(const FT_Bitmap &src) noexcept
+{
+  const unsigned width = src.width, height = src.rows;
+  std::unique_ptr<uint8_t[]> dest{new uint8_t[width * height]};
+
+  const uint8_t *s = src.buffer;
+  uint8_t *d = dest.get();
+  for (unsigned y = 0; y < height; ++y, s += src.pitch, d += width) {
+    if (src.pixel_mode == FT_PIXEL_MODE_MONO)
+      /* with anti-aliasing disabled, FreeType writes each pixel in
+         one bit */
+      ConvertMono(d, s, width);
+    else
+      std::copy_n(s, width, d);
+  }
+
+  return dest;
+}
+
+GlyphCache::GlyphCache(FT_Face _face, FT_Int32 _load_flags,
+                       FT_Render_Mode _render_mode) noexcept
+  :face(_face), load_flags(_load_flags), render_mode(_render_mode),
+   has_kerning(FT_HAS_KERNING(_face))
+{
+}
+
+GlyphCache::~GlyphCache() noexcept
+{
+  for (auto &i : fast)
+    delete i.load(std::memory_order_relaxed);
+}
+
+const GlyphCache::Glyph &
+GlyphCache::Load(unsigned ch) noexcept
+{
+  const std::lock_guard lock{mutex};
+
+  /* check again, another thread may have loaded it meanwhile */
+  if (ch < N_FAST) {
+    if (const Glyph *glyph = fast[ch].load(std::memory_order_relaxed))
+      return *glyph;
+  } else if (auto i = slow.find(ch); i != slow.end())
+    return *i->second;
+
+  auto glyph = std::make_unique<Glyph>();
+  glyph->fast = ch < N_FAST;
+
+  {
+#ifndef ENABLE_OPENGL
+    const std::lock_guard ft_lock{FreeType::mutex};
+#endif
+
+    Render(*glyph, ch);
+  }
+
+  if (ch >= N_FAST)
+    return *slow.emplace(ch, std::move(glyph)).first->second;
+
+  /* publish the complete glyph; readers don't lock */
+  const Glyph *result = glyph.release();
+  fast[ch].store(result, std::memory_order_release);
+  return *result;
+}
+
+void
+GlyphCache::Render(Glyph &glyph, unsigned ch) noexcept
+{
+  const FT_UInt i = FT_Get_Char_Index(face, ch);
+  if (i == 0)
+    return;
+
+  if (FT_Load_Glyph(face, i, load_flags))
+    return;
+
+  const FT_GlyphSlot slot = face->glyph;
+  const FT_Glyph_Metrics &metrics = slot->metrics;
+
+  glyph.index = i;
+  glyph.bearing_x = FT_FLOOR(metrics.horiBearingX);
+  glyph.bearing_y = FT_FLOOR(metrics.horiBearingY);
+  glyph.width = FT_CEIL(metrics.width);
+  glyph.advance = FT_CEIL(metrics.horiAdvance);
+
+  if (FT_Render_Glyph(slot, render_mode) == 0 &&
+      slot->bitmap.width > 0 && slot->bitmap.rows > 0) {
+    glyph.bitmap = CopyBitmap(slot->bitmap);
+    glyph.bitmap_width = slot->bitmap.width;
+    glyph.bitmap_height = slot->bitmap.rows;
+  }
+
+  if (has_kerning)
+    LoadKerning(glyph);
+}
+
+void
+GlyphCache::LoadKerning(Glyph &glyph) noexcept
+{
+  if (fast_indices.empty()) {
+    for (unsigned ch = 0; ch < N_FAST; ++ch)
+      if (FT_UInt i = FT_Get_Char_Index(face, ch); i != 0)
+        fast_indices.push_back(i);
+
+    std::sort(fast_indices.begin(), fast_indices.end());
+    fast_indices.erase(std::unique(fast_indices.begin(), fast_indices.end()),
+                       fast_indices.end());
+  }
+
+  for (const FT_UInt left : fast_indices) {
+    FT_Vector delta;
+    if (FT_Get_Kerning(face, left, glyph.index, ft_kerning_default,
+                       &delta) == 0 &&
+        (delta.x >> 6) != 0)
+      glyph.kerning.emplace_back(left, delta.x >> 6);
+  }
+}
+
+int
+GlyphCache::GetKerning(const Glyph &left, const Glyph &right) noexcept
+{
+  assert(left.index != 0);
+  assert(right.index != 0);
+
+  if (!has_kerning)
+    return 0;
+
+  if (left.fast) {
+    auto i = std::lower_bound(right.kerning.begin(), right.kerning.end(),
+                              left.index,
+                              [](const auto &a, FT_UInt b){
+                                return a.first < b;
+                              });
+    return i != right.kerning.end() && i->first == left.index
+      ? i->second
+      : 0;
+  }
+
+  /* rare: not cached */
+
+#ifndef ENABLE_OPENGL
+  const std::lock_guard ft_lock{FreeType::mutex};
+#endif
+
+  FT_Vector delta;
+  if (FT_Get_Kerning(face, left.index, right.index, ft_kerning_default,
+                     &delta))
+    return 0;
+
+  return delta.x >> 6;
+}
@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "thread/Mutex.hxx"
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * Caches the metrics and the rendered bitmaps of the glyphs of one
+ * FreeType face.  Once all glyphs of a string have been seen, it can
+ * be measured and composed without calling FreeType.
+ *
+ * Lookups of code points below #N_FAST don't lock a mutex: each slot
+ * is written only once, and the #Glyph it points to is immutable.
+ * This covers the digits, units and labels on the map and in the
+ * InfoBoxes, which change every second.  All other code points are
+ * kept in a map protected by a mutex.
+ */
+class GlyphCache {
+public:
+  /**
+   * Code points below this value (Latin, Greek and Cyrillic) are
+   * looked up without locking.
+   */
+  static constexpr unsigned N_FAST = 0x500;
+
+  struct Glyph {
+    /**
+     * The FreeType glyph index; 0 if the font does not have this
+     * glyph (it is skipped then).
+     */
+    FT_UInt index = 0;
+
+    /**
+     * Was this glyph obtained from the lock-free table?  Only those
+     * are cached as the left side of kerning pairs, see #kerning.
+     */
+    bool fast = false;
+
+    /**
+     * The horizontal and vertical bearing in pixels.
+     */
+    int bearing_x = 0, bearing_y = 0;
+
+    /**
+     * The width of the glyph and the horizontal advance in pixels.
+     */
+    unsigned width = 0, advance = 0;
+
+    /**
+     * The rendered glyph with one byte per pixel and no padding;
+     * nullptr if FreeType failed to render it.
+     */
+    std::unique_ptr<uint8_t[]> bitmap;
+    unsigned bitmap_width = 0, bitmap_height = 0;
+
+    /**
+     * Kerning distances [pixels] with this glyph on the right side
+     * and a #fast glyph on the left side, sorted by the left glyph
+     * index.  Pairs without kerning are omitted.
+     */
+    std::vector<std::pair<FT_UInt, int>> kerning;
+  };
+
+private:
+  const FT_Face face;
+  const FT_Int32 load_flags;
+  const FT_Render_Mode render_mode;
+  const bool has_kerning;
+
+  std::array<std::atomic<const Glyph *>, N_FAST> fast{};
+
+  /**
+   * Protects #slow and #fast_indices, and serialises insertions into
+   * #fast.
+   */
+  Mutex mutex;
+
+  std::unordered_map<unsigned, std::unique_ptr<Glyph>> slow;
+
+  /**
+   * The sorted glyph indices of all code points below #N_FAST; these
+   * are the left glyphs whose kerning gets cached.  Initialised when
+   * the first glyph is loaded.
+   */
+  std::vector<FT_UInt> fast_indices;
+
+public:
+  GlyphCache(FT_Face _face, FT_Int32 _load_flags,
+             FT_Render_Mode _render_mode) noexcept;
+  ~GlyphCache() noexcept;
+
+  GlyphCache(const GlyphCache &) = delete;
+  GlyphCache &operator=(const GlyphCache &) = delete;
+
+  bool HasKerning() const noexcept {
+    return has_kerning;
+  }
+
+  /**
+   * Look up a glyph, loading it with FreeType on the first call.
+   * This method is thread-safe.
+   */
+  const Glyph &Get(unsigned ch) noexcept {
+    if (ch < N_FAST)
+      if (const Glyph *glyph = fast[ch].load(std::memory_order_acquire))
+        return *glyph;
+
+    return Load(ch);
+  }
+
+  /**
+   * Returns the kerning distance [pixels] between two glyphs which
+   * were obtained by Get().  This method is thread-safe.
+   */
+  int GetKerning(const Glyph &left, const Glyph &right) noexcept;
+
+private:
+  const Glyph &Load(unsigned ch) noexcept;
+
+  /**
+   * Load and render a glyph.  The caller must hold the FreeType
+   * mutex.
+   */
+  void Render(Glyph &glyph, unsigned ch) noexcept;
+
+  void LoadKerning(Glyph &glyph) noexcept;
+};
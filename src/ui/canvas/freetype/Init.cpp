@@ -17,6 +17,10 @@
 
 namespace FreeType {
 
+#ifndef ENABLE_OPENGL
+Mutex mutex;
+#endif
+
 #ifdef KOBO
 bool mono = true;
 #endif
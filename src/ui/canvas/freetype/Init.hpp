@@ -3,10 +3,22 @@
 
 #pragma once
 
+#ifndef ENABLE_OPENGL
+#include "thread/Mutex.hxx"
+#endif
+
 typedef struct FT_FaceRec_ *FT_Face;
 
 namespace FreeType {
 
+#ifndef ENABLE_OPENGL
+/**
+ * libfreetype is not thread-safe; this global Mutex is used to
+ * protect libfreetype from multi-threaded access.
+ */
+extern Mutex mutex;
+#endif
+
 #ifdef KOBO
 /**
  * Are we using monochrome font rendering mode on the Kobo?  This
@@ -5,10 +5,16 @@
 #include "ui/canvas/Bitmap.hpp"
 #include "ui/canvas/Util.hpp"
 #include "Optimised.hpp"
-#include "RasterCanvas.hpp"
+#include "SDLRasterCanvas.hpp"
+#include "CommandList.hpp"
 #include "ui/canvas/custom/Cache.hpp"
+#include "ui/canvas/Font.hpp"
 #include "Math/Angle.hpp"
 
+#ifdef USE_FREETYPE
+#include "util/AllocatedArray.hxx"
+#endif
+
 #ifdef __ARM_NEON__
 #include "NEON.hpp"
 #endif
@@ -23,28 +29,79 @@
 
 #include <algorithm>
 #include <cassert>
+#include <climits>
 #include <string.h>
 
-class SDLRasterCanvas : public RasterCanvas<ActivePixelTraits> {
-public:
-  SDLRasterCanvas(WritableImageBuffer<ActivePixelTraits> buffer)
-    :RasterCanvas<ActivePixelTraits>(buffer) {}
+/**
+ * Execute a drawing operation, or record it if the #Canvas is in
+ * deferred mode.
+ *
+ * @param top, bottom the range of rows which may be modified by the
+ * operation
+ */
+template<typename F>
+static void
+Rasterise(CanvasCommandList *command_list,
+          WritableImageBuffer<ActivePixelTraits> buffer,
+          int top, int bottom, F &&f) noexcept
+{
+  if (command_list != nullptr) {
+    command_list->Add(buffer, top, bottom, std::forward<F>(f));
+  } else {
+    SDLRasterCanvas canvas(buffer);
+    f(canvas);
+  }
+}
 
-  static constexpr ActivePixelTraits::color_type Import(Color color) {
-#ifdef GREYSCALE
-    return Luminosity8(color.GetLuminosity());
-#else
-    return BGRA8Color(color.Red(), color.Green(), color.Blue(), color.Alpha());
-#endif
+/**
+ * Determine the range of rows touched by lines through the specified
+ * points.
+ *
+ * @param margin the number of rows added on both sides
+ */
+[[gnu::pure]]
+static std::pair<int, int>
+GetRowRange(const BulkPixelPoint *points, unsigned n,
+            unsigned margin) noexcept
+{
+  if (n == 0)
+    return {0, 0};
+
+  int top = points[0].y, bottom = points[0].y;
+  for (unsigned i = 1; i < n; ++i) {
+    top = std::min(top, points[i].y);
+    bottom = std::max(bottom, points[i].y);
   }
-};
+
+  return {top - int(margin), bottom + int(margin) + 1};
+}
+
+void
+Canvas::BeginDeferred(CanvasCommandList &list) noexcept
+{
+  assert(command_list == nullptr);
+
+  list.Begin(buffer);
+  command_list = &list;
+}
+
+void
+Canvas::EndDeferred() noexcept
+{
+  assert(command_list != nullptr);
+
+  command_list->Execute();
+  command_list = nullptr;
+}
 
 void
 Canvas::DrawOutlineRectangle(PixelRect r, Color color) noexcept
 {
-  SDLRasterCanvas canvas(buffer);
-  canvas.DrawRectangle(r.left, r.top, r.right, r.bottom,
-                       canvas.Import(color));
+  Rasterise(command_list, buffer, r.top, r.bottom,
+            [r, color](SDLRasterCanvas &canvas){
+              canvas.DrawRectangle(r.left, r.top, r.right, r.bottom,
+                                   canvas.Import(color));
+            });
 }
 
 void
@@ -53,9 +110,11 @@ Canvas::DrawFilledRectangle(PixelRect r, Color color) noexcept
   if (r.IsEmpty())
     return;
 
-  SDLRasterCanvas canvas(buffer);
-  canvas.FillRectangle(r.left, r.top, r.right, r.bottom,
-                       canvas.Import(color));
+  Rasterise(command_list, buffer, r.top, r.bottom,
+            [r, color](SDLRasterCanvas &canvas){
+              canvas.FillRectangle(r.left, r.top, r.right, r.bottom,
+                                   canvas.Import(color));
+            });
 }
 
 void
@@ -83,9 +142,16 @@ DrawPolyline(Canvas &canvas, [[maybe_unused]] PixelOperations operations, const
 void
 Canvas::DrawPolyline(const BulkPixelPoint *p, unsigned cPoints)
 {
-  SDLRasterCanvas canvas(buffer);
-  ::DrawPolyline(canvas, ActivePixelTraits(), pen,
-                 p, cPoints, false);
+  const auto [top, bottom] = GetRowRange(p, cPoints, pen.GetWidth());
+
+  if (command_list != nullptr)
+    p = command_list->Copy(p, cPoints);
+
+  Rasterise(command_list, buffer, top, bottom,
+            [pen=pen, p, cPoints](SDLRasterCanvas &canvas){
+              ::DrawPolyline(canvas, ActivePixelTraits(), pen,
+                             p, cPoints, false);
+            });
 }
 
 void
@@ -94,27 +160,36 @@ Canvas::DrawPolygon(const BulkPixelPoint *lppt, unsigned cPoints)
   if (brush.IsHollow() && !pen.IsDefined())
     return;
 
-  SDLRasterCanvas canvas(buffer);
+  const auto [top, bottom] = GetRowRange(lppt, cPoints, pen.GetWidth());
 
-  if (!brush.IsHollow()) {
-    const auto color = canvas.Import(brush.GetColor());
-    if (brush.GetColor().IsOpaque())
-      canvas.FillPolygon(lppt, cPoints, color);
-    else
-      canvas.FillPolygon(lppt, cPoints, color,
-                         AlphaPixelOperations<ActivePixelTraits>(brush.GetColor().Alpha()));
-  }
+  if (command_list != nullptr)
+    lppt = command_list->Copy(lppt, cPoints);
 
-  if (IsPenOverBrush())
-    ::DrawPolyline(canvas, ActivePixelTraits(), pen,
-                   lppt, cPoints, true);
+  Rasterise(command_list, buffer, top, bottom,
+            [brush=brush, pen=pen, outline=IsPenOverBrush(),
+             lppt, cPoints](SDLRasterCanvas &canvas){
+              if (!brush.IsHollow()) {
+                const auto color = canvas.Import(brush.GetColor());
+                if (brush.GetColor().IsOpaque())
+                  canvas.FillPolygon(lppt, cPoints, color);
+                else
+                  canvas.FillPolygon(lppt, cPoints, color,
+                                     AlphaPixelOperations<ActivePixelTraits>(brush.GetColor().Alpha()));
+              }
+
+              if (outline)
+                ::DrawPolyline(canvas, ActivePixelTraits(), pen,
+                               lppt, cPoints, true);
+            });
 }
 
 void
 Canvas::DrawHLine(int x1, int x2, int y, Color color)
 {
-  SDLRasterCanvas canvas(buffer);
-  canvas.DrawHLine(x1, x2, y, canvas.Import(color));
+  Rasterise(command_list, buffer, y, y + 1,
+            [x1, x2, y, color](SDLRasterCanvas &canvas){
+              canvas.DrawHLine(x1, x2, y, canvas.Import(color));
+            });
 }
 
 void
@@ -122,45 +197,55 @@ Canvas::DrawLine(PixelPoint a, PixelPoint b) noexcept
 {
   const unsigned thickness = pen.GetWidth();
   const unsigned mask = pen.GetMask();
+  const Color color = pen.GetColor();
 
-  SDLRasterCanvas canvas(buffer);
-  const auto color = canvas.Import(pen.GetColor());
-  if (thickness > 1) {
-    unsigned mask_position = 0;
-    canvas.DrawThickLine(a.x, a.y, b.x, b.y, thickness, color,
-                         mask, mask_position);
-  } else
-      canvas.DrawLine(a.x, a.y, b.x, b.y, color, mask);
+  Rasterise(command_list, buffer,
+            std::min(a.y, b.y) - int(thickness),
+            std::max(a.y, b.y) + int(thickness) + 1,
+            [a, b, thickness, mask, color](SDLRasterCanvas &canvas){
+              if (thickness > 1) {
+                unsigned mask_position = 0;
+                canvas.DrawThickLine(a.x, a.y, b.x, b.y, thickness,
+                                     canvas.Import(color),
+                                     mask, mask_position);
+              } else
+                canvas.DrawLine(a.x, a.y, b.x, b.y, canvas.Import(color),
+                                mask);
+            });
 }
 
 void
 Canvas::DrawCircle(PixelPoint center, unsigned radius) noexcept
 {
-  SDLRasterCanvas canvas(buffer);
+  const int margin = radius + pen.GetWidth() + 1;
 
-  if (!brush.IsHollow()) {
-    const auto color = canvas.Import(brush.GetColor());
+  Rasterise(command_list, buffer, center.y - margin, center.y + margin,
+            [brush=brush, pen=pen, outline=IsPenOverBrush(),
+             center, radius](SDLRasterCanvas &canvas){
+              if (!brush.IsHollow()) {
+                const auto color = canvas.Import(brush.GetColor());
 
-    if (brush.GetColor().IsOpaque())
-      canvas.FillCircle(center.x, center.y, radius, color);
-    else
-      canvas.FillCircle(center.x, center.y, radius, color,
-                        AlphaPixelOperations<ActivePixelTraits>(brush.GetColor().Alpha()));
-  }
+                if (brush.GetColor().IsOpaque())
+                  canvas.FillCircle(center.x, center.y, radius, color);
+                else
+                  canvas.FillCircle(center.x, center.y, radius, color,
+                                    AlphaPixelOperations<ActivePixelTraits>(brush.GetColor().Alpha()));
+              }
 
-  if (IsPenOverBrush()) {
-    if (pen.GetWidth() < 2) {
-      canvas.DrawCircle(center.x, center.y, radius,
-                        canvas.Import(pen.GetColor()));
-      return;
-    }
-
-    // no thickCircleColor in SDL_gfx, so need to emulate it with multiple draws (slow!)
-    for (int i= (pen.GetWidth()/2); i>= -(int)(pen.GetWidth()-1)/2; --i) {
-      canvas.DrawCircle(center.x, center.y, radius + i,
-                        canvas.Import(pen.GetColor()));
-    }
-  }
+              if (outline) {
+                if (pen.GetWidth() < 2) {
+                  canvas.DrawCircle(center.x, center.y, radius,
+                                    canvas.Import(pen.GetColor()));
+                  return;
+                }
+
+                // no thickCircleColor in SDL_gfx, so need to emulate it with multiple draws (slow!)
+                for (int i= (pen.GetWidth()/2); i>= -(int)(pen.GetWidth()-1)/2; --i) {
+                  canvas.DrawCircle(center.x, center.y, radius + i,
+                                    canvas.Import(pen.GetColor()));
+                }
+              }
+            });
 }
 
 void
@@ -202,10 +287,7 @@ Canvas::DrawArc(PixelPoint center, unsigned radius,
 const PixelSize
 Canvas::CalcTextSize(tstring_view text) const noexcept
 {
-#ifdef UNICODE
-  const WideToUTF8Converter text2(text);
-#else
-  const std::string_view text2 = text;
+#ifndef UNICODE
   assert(ValidateUTF8(text));
 #endif
 
@@ -214,14 +296,56 @@ Canvas::CalcTextSize(tstring_view text) const noexcept
   if (font == nullptr)
     return size;
 
+#ifdef USE_FREETYPE
+  /* the glyph metrics are cached by the Font */
+  return font->TextSize(text);
+#else
+#ifdef UNICODE
+  const WideToUTF8Converter text2(text);
+#else
+  const std::string_view text2 = text;
+#endif
+
   /* see if the TextCache can handle this request */
   size = TextCache::LookupSize(*font, text2);
   if (size.height > 0)
     return size;
 
   return TextCache::GetSize(*font, text2);
+#endif
+}
+
+#ifdef USE_FREETYPE
+
+/**
+ * Compose the text from the Font's cached glyphs into a buffer owned
+ * by the calling thread.  This needs neither FreeType (after the
+ * glyphs have been seen once) nor the #TextCache and its global
+ * mutex.  The result is valid until the next call in the same
+ * thread.
+ */
+static TextCache::Result
+RenderText(const Font *font, tstring_view text) noexcept
+{
+  if (font == nullptr || text.empty())
+    return nullptr;
+
+  assert(font->IsDefined());
+
+  static thread_local AllocatedArray<uint8_t> buffer;
+
+  const PixelSize size = font->TextSize(text);
+  const std::size_t buffer_size = font->BufferSize(size);
+  if (buffer_size == 0)
+    return nullptr;
+
+  buffer.GrowDiscard(buffer_size);
+  font->Render(text, size, buffer.data());
+  return {buffer.data(), size.width, size};
 }
 
+#else
+
 static TextCache::Result
 RenderText(const Font *font, tstring_view text) noexcept
 {
@@ -237,6 +361,8 @@ RenderText(const Font *font, tstring_view text) noexcept
 #endif
 }
 
+#endif
+
 template<typename Operations>
 static void
 CopyTextRectangle(SDLRasterCanvas &canvas, int x, int y,
@@ -267,6 +393,28 @@ CopyTextRectangle(SDLRasterCanvas &canvas, int x, int y,
   }
 }
 
+/**
+ * Draw (or record) the text bitmap returned by RenderText().
+ */
+static void
+CopyTextRectangle(CanvasCommandList *command_list,
+                  WritableImageBuffer<ActivePixelTraits> buffer,
+                  PixelPoint p, unsigned width, TextCache::Result s,
+                  Color text_color, Color background_color, bool opaque)
+{
+  if (command_list != nullptr)
+    /* the buffer returned by RenderText() will be overwritten by
+       the next call */
+    s.data = command_list->Copy(static_cast<const uint8_t *>(s.data),
+                                s.pitch * s.size.height);
+
+  Rasterise(command_list, buffer, p.y, p.y + int(s.size.height),
+            [=](SDLRasterCanvas &canvas){
+              CopyTextRectangle(canvas, p.x, p.y, width, s.size.height, s,
+                                text_color, background_color, opaque);
+            });
+}
+
 void
 Canvas::DrawText(PixelPoint p, tstring_view text) noexcept
 {
@@ -278,8 +426,7 @@ Canvas::DrawText(PixelPoint p, tstring_view text) noexcept
   if (!s)
     return;
 
-  SDLRasterCanvas canvas(buffer);
-  CopyTextRectangle(canvas, p.x, p.y, s.size.width, s.size.height, s,
+  CopyTextRectangle(command_list, buffer, p, s.size.width, s,
                     text_color, background_color,
                     background_mode == OPAQUE);
 }
@@ -295,10 +442,8 @@ Canvas::DrawTransparentText(PixelPoint p, tstring_view text) noexcept
   if (s.data == nullptr)
     return;
 
-  SDLRasterCanvas canvas(buffer);
-  ColoredAlphaPixelOperations<ActivePixelTraits, GreyscalePixelTraits>
-    transparent(canvas.Import(text_color));
-  CopyTextRectangle(canvas, p.x, p.y, s.size.width, s.size.height, transparent, s);
+  CopyTextRectangle(command_list, buffer, p, s.size.width, s,
+                    text_color, background_color, false);
 }
 
 void
@@ -325,11 +470,9 @@ Canvas::DrawClippedText(PixelPoint p, unsigned width,
   if (width > s.size.width)
     width = s.size.width;
 
-  SDLRasterCanvas canvas(buffer);
-  CopyTextRectangle(canvas, p.x, p.y, width, s.size.height, s,
+  CopyTextRectangle(command_list, buffer, p, width, s,
                     text_color, background_color,
                     background_mode == OPAQUE);
-
 }
 
 static bool
@@ -354,6 +497,32 @@ Clip(int &position, unsigned &length, unsigned max,
   return true;
 }
 
+/**
+ * Copy (or record copying) a rectangle with the specified pixel
+ * operations.
+ */
+template<typename PixelOperations>
+static void
+CopyRectangle(CanvasCommandList *command_list,
+              WritableImageBuffer<ActivePixelTraits> buffer,
+              PixelPoint dest_position, PixelSize dest_size,
+              ConstImageBuffer<ActivePixelTraits> src,
+              PixelPoint src_position,
+              PixelOperations operations) noexcept
+{
+  if (command_list != nullptr)
+    src = command_list->Snapshot(src, src_position, dest_size);
+
+  Rasterise(command_list, buffer,
+            dest_position.y, dest_position.y + int(dest_size.height),
+            [=](SDLRasterCanvas &canvas){
+              canvas.CopyRectangle(dest_position.x, dest_position.y,
+                                   dest_size.width, dest_size.height,
+                                   src.At(src_position.x, src_position.y),
+                                   src.pitch, operations);
+            });
+}
+
 void
 Canvas::Copy(PixelPoint dest_position, PixelSize dest_size,
              ConstImageBuffer src, PixelPoint src_position) noexcept
@@ -362,10 +531,17 @@ Canvas::Copy(PixelPoint dest_position, PixelSize dest_size,
       !Clip(dest_position.y, dest_size.height, GetHeight(), src_position.y))
     return;
 
-  SDLRasterCanvas canvas(buffer);
-  canvas.CopyRectangle(dest_position.x, dest_position.y,
-                       dest_size.width, dest_size.height,
-                       src.At(src_position.x, src_position.y), src.pitch);
+  if (command_list != nullptr)
+    src = command_list->Snapshot(src, src_position, dest_size);
+
+  Rasterise(command_list, buffer,
+            dest_position.y, dest_position.y + int(dest_size.height),
+            [=](SDLRasterCanvas &canvas){
+              canvas.CopyRectangle(dest_position.x, dest_position.y,
+                                   dest_size.width, dest_size.height,
+                                   src.At(src_position.x, src_position.y),
+                                   src.pitch);
+            });
 }
 
 void
@@ -404,13 +580,20 @@ Canvas::CopyTransparentWhite(PixelPoint dest_position, PixelSize dest_size,
       !Clip(dest_position.y, dest_size.height, GetHeight(), src_position.y))
     return;
 
-  SDLRasterCanvas canvas(buffer);
-  TransparentPixelOperations<ActivePixelTraits> operations(canvas.Import(COLOR_WHITE));
-  canvas.CopyRectangle(dest_position.x, dest_position.y,
-                       dest_size.width, dest_size.height,
-                       src.buffer.At(src_position.x, src_position.y),
-                       src.buffer.pitch,
-                       operations);
+  ConstImageBuffer src_buffer = src.buffer;
+  if (command_list != nullptr)
+    src_buffer = command_list->Snapshot(src_buffer, src_position, dest_size);
+
+  Rasterise(command_list, buffer,
+            dest_position.y, dest_position.y + int(dest_size.height),
+            [=](SDLRasterCanvas &canvas){
+              TransparentPixelOperations<ActivePixelTraits> operations(canvas.Import(COLOR_WHITE));
+              canvas.CopyRectangle(dest_position.x, dest_position.y,
+                                   dest_size.width, dest_size.height,
+                                   src_buffer.At(src_position.x, src_position.y),
+                                   src_buffer.pitch,
+                                   operations);
+            });
 }
 
 void
@@ -422,12 +605,18 @@ Canvas::StretchTransparentWhite(PixelPoint dest_position, PixelSize dest_size,
       !Clip(dest_position.y, dest_size.height, GetHeight(), src_position.y))
     return;
 
-  SDLRasterCanvas canvas(buffer);
-  TransparentPixelOperations<ActivePixelTraits> operations(canvas.Import(COLOR_WHITE));
-  canvas.ScaleRectangle(dest_position, dest_size,
-                        src.At(src_position.x, src_position.y),
-                        src.pitch, src_size,
-                        operations);
+  if (command_list != nullptr)
+    src = command_list->Snapshot(src, src_position, src_size);
+
+  Rasterise(command_list, buffer,
+            dest_position.y, dest_position.y + int(dest_size.height),
+            [=](SDLRasterCanvas &canvas){
+              TransparentPixelOperations<ActivePixelTraits> operations(canvas.Import(COLOR_WHITE));
+              canvas.ScaleRectangle(dest_position, dest_size,
+                                    src.At(src_position.x, src_position.y),
+                                    src.pitch, src_size,
+                                    operations);
+            });
 }
 
 void
@@ -436,17 +625,22 @@ Canvas::StretchNot(const Bitmap &_src)
   assert(_src.IsDefined());
 
   ConstImageBuffer src = _src.GetNative();
-  const unsigned src_x = 0, src_y = 0;
-  const unsigned dest_x = 0, dest_y = 0;
+  PixelPoint src_position{0, 0};
+  const PixelSize src_size{src.width, src.height};
   const auto dest_size = GetSize();
 
-  SDLRasterCanvas canvas(buffer);
-  BitNotPixelOperations<ActivePixelTraits> operations;
+  if (command_list != nullptr)
+    src = command_list->Snapshot(src, src_position, src_size);
 
-  canvas.ScaleRectangle({dest_x, dest_y}, dest_size,
-                        src.At(src_x, src_y),
-                        src.pitch, {src.width, src.height},
-                        operations);
+  Rasterise(command_list, buffer, 0, dest_size.height,
+            [=](SDLRasterCanvas &canvas){
+              BitNotPixelOperations<ActivePixelTraits> operations;
+
+              canvas.ScaleRectangle({0, 0}, dest_size,
+                                    src.At(src_position.x, src_position.y),
+                                    src.pitch, src_size,
+                                    operations);
+            });
 }
 
 void
@@ -460,11 +654,16 @@ Canvas::Stretch(PixelPoint dest_position, PixelSize dest_size,
     return;
   }
 
-  SDLRasterCanvas canvas(buffer);
+  if (command_list != nullptr)
+    src = command_list->Snapshot(src, src_position, src_size);
 
-  canvas.ScaleRectangle(dest_position, dest_size,
-                        src.At(src_position.x, src_position.y),
-                        src.pitch, src_size);
+  Rasterise(command_list, buffer,
+            dest_position.y, dest_position.y + int(dest_size.height),
+            [=](SDLRasterCanvas &canvas){
+              canvas.ScaleRectangle(dest_position, dest_size,
+                                    src.At(src_position.x, src_position.y),
+                                    src.pitch, src_size);
+            });
 }
 
 void
@@ -515,51 +714,44 @@ Canvas::StretchMono(PixelPoint dest_position, PixelSize dest_size,
     /* paranoid sanity check; shouldn't ever happen */
     return;
 
-  SDLRasterCanvas canvas(buffer);
+  if (command_list != nullptr)
+    src = command_list->Snapshot(src, src_position, src_size);
 
-  OpaqueTextPixelOperations<ActivePixelTraits, GreyscalePixelTraits>
-    opaque(canvas.Import(fg_color), canvas.Import(bg_color));
+  Rasterise(command_list, buffer,
+            dest_position.y, dest_position.y + int(dest_size.height),
+            [=](SDLRasterCanvas &canvas){
+              OpaqueTextPixelOperations<ActivePixelTraits, GreyscalePixelTraits>
+                opaque(canvas.Import(fg_color), canvas.Import(bg_color));
 
-  canvas.ScaleRectangle<decltype(opaque), GreyscalePixelTraits>
-    (dest_position, dest_size,
-     src.At(src_position.x, src_position.y), src.pitch, src_size,
-     opaque);
+              canvas.ScaleRectangle<decltype(opaque), GreyscalePixelTraits>
+                (dest_position, dest_size,
+                 src.At(src_position.x, src_position.y), src.pitch, src_size,
+                 opaque);
+            });
 }
 
 void
 Canvas::CopyNot(PixelPoint dest_position, PixelSize dest_size,
                 ConstImageBuffer src, PixelPoint src_position) noexcept
 {
-  SDLRasterCanvas canvas(buffer);
-
-  canvas.CopyRectangle(dest_position.x, dest_position.y,
-                       dest_size.width, dest_size.height,
-                       src.At(src_position.x, src_position.y), src.pitch,
-                       BitNotPixelOperations<ActivePixelTraits>());
+  ::CopyRectangle(command_list, buffer, dest_position, dest_size,
+                  src, src_position, BitNotPixelOperations<ActivePixelTraits>());
 }
 
 void
 Canvas::CopyOr(PixelPoint dest_position, PixelSize dest_size,
                ConstImageBuffer src, PixelPoint src_position) noexcept
 {
-  SDLRasterCanvas canvas(buffer);
-
-  canvas.CopyRectangle(dest_position.x, dest_position.y,
-                       dest_size.width, dest_size.height,
-                       src.At(src_position.x, src_position.y), src.pitch,
-                       BitOrPixelOperations<ActivePixelTraits>());
+  ::CopyRectangle(command_list, buffer, dest_position, dest_size,
+                  src, src_position, BitOrPixelOperations<ActivePixelTraits>());
 }
 
 void
 Canvas::CopyNotOr(PixelPoint dest_position, PixelSize dest_size,
                   ConstImageBuffer src, PixelPoint src_position) noexcept
 {
-  SDLRasterCanvas canvas(buffer);
-
-  canvas.CopyRectangle(dest_position.x, dest_position.y,
-                       dest_size.width, dest_size.height,
-                       src.At(src_position.x, src_position.y), src.pitch,
-                       BitNotOrPixelOperations<ActivePixelTraits>());
+  ::CopyRectangle(command_list, buffer, dest_position, dest_size,
+                  src, src_position, BitNotOrPixelOperations<ActivePixelTraits>());
 }
 
 void
@@ -575,12 +767,8 @@ void
 Canvas::CopyAnd(PixelPoint dest_position, PixelSize dest_size,
                 ConstImageBuffer src, PixelPoint src_position) noexcept
 {
-  SDLRasterCanvas canvas(buffer);
-
-  canvas.CopyRectangle(dest_position.x, dest_position.y,
-                       dest_size.width, dest_size.height,
-                       src.At(src_position.x, src_position.y), src.pitch,
-                       BitAndPixelOperations<ActivePixelTraits>());
+  ::CopyRectangle(command_list, buffer, dest_position, dest_size,
+                  src, src_position, BitAndPixelOperations<ActivePixelTraits>());
 }
 
 void
@@ -631,14 +819,10 @@ Canvas::AlphaBlend(PixelPoint dest_position, PixelSize dest_size,
 {
   // TODO: support scaling
 
-  SDLRasterCanvas canvas(buffer);
-
   AlphaPixelOperations<ActivePixelTraits> operations(alpha);
 
-  canvas.CopyRectangle(dest_position.x, dest_position.y,
-                       dest_size.width, dest_size.height,
-                       src.At(src_position.x, src_position.y), src.pitch,
-                       operations);
+  ::CopyRectangle(command_list, buffer, dest_position, dest_size,
+                  src, src_position, operations);
 }
 
 void
@@ -660,16 +844,12 @@ Canvas::AlphaBlendNotWhite(PixelPoint dest_position, PixelSize dest_size,
 {
   // TODO: support scaling
 
-  SDLRasterCanvas canvas(buffer);
-
   NotWhiteCondition<ActivePixelTraits> c;
   NotWhiteAlphaPixelOperations<ActivePixelTraits> operations(c,
                                                              PortableAlphaPixelOperations<ActivePixelTraits>(alpha));
 
-  canvas.CopyRectangle(dest_position.x, dest_position.y,
-                       dest_size.width, dest_size.height,
-                       src.At(src_position.x, src_position.y), src.pitch,
-                       operations);
+  ::CopyRectangle(command_list, buffer, dest_position, dest_size,
+                  src, src_position, operations);
 }
 
 void
@@ -25,6 +25,7 @@
 
 class Angle;
 class Bitmap;
+class CanvasCommandList;
 
 /**
  * Base drawable canvas class
@@ -46,6 +47,12 @@ protected:
     OPAQUE, TRANSPARENT
   } background_mode = OPAQUE;
 
+  /**
+   * If not nullptr, then drawing operations are recorded in this
+   * list instead of being executed immediately.
+   */
+  CanvasCommandList *command_list = nullptr;
+
 public:
   Canvas()
     :buffer(WritableImageBuffer<ActivePixelTraits>::Empty()) {}
@@ -73,6 +80,28 @@ public:
     return buffer.data != nullptr;
   }
 
+  /**
+   * Switch to deferred mode: all drawing operations are recorded in
+   * the specified list, until EndDeferred() rasterises them in
+   * parallel.  #SubCanvas instances created meanwhile record in the
+   * same list.
+   *
+   * Source images are copied when the operation is recorded, but
+   * this #Canvas must not be read by other code until
+   * EndDeferred().
+   */
+  void BeginDeferred(CanvasCommandList &list) noexcept;
+
+  /**
+   * Rasterise all operations recorded since BeginDeferred() and
+   * switch back to immediate mode.
+   */
+  void EndDeferred() noexcept;
+
+  bool IsDeferred() const noexcept {
+    return command_list != nullptr;
+  }
+
   PixelSize GetSize() const {
     return { buffer.width, buffer.height };
   }
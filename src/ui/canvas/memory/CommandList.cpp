@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "CommandList.hpp"
+#include "SDLRasterCanvas.hpp"
+#include "thread/Parallel.hpp"
+
+#include <cassert>
+
+/**
+ * The size of a memory block allocated by
+ * CanvasCommandList::Allocate().
+ */
+static constexpr std::size_t BLOCK_SIZE = 64 * 1024;
+
+/**
+ * Split the buffer into this many bands per thread; this balances
+ * the load when some bands have more detail than others.
+ */
+static constexpr unsigned BANDS_PER_THREAD = 2;
+
+/**
+ * Don't make bands smaller than this number of rows; each band
+ * replays all operations touching it, and this overhead would
+ * outweigh the gain.
+ */
+static constexpr unsigned MIN_BAND_HEIGHT = 32;
+
+CanvasCommandList::CanvasCommandList() noexcept = default;
+CanvasCommandList::~CanvasCommandList() noexcept = default;
+
+void
+CanvasCommandList::SetMaxThreads(unsigned _max_threads) noexcept
+{
+  if (_max_threads == max_threads)
+    return;
+
+  max_threads = _max_threads;
+
+  /* the pool's thread limit is fixed; create a new one on demand */
+  pool.reset();
+}
+
+void
+CanvasCommandList::Add(WritableImageBuffer<ActivePixelTraits> buffer,
+                       int top, int bottom,
+                       Invoke invoke, const void *function) noexcept
+{
+  assert(target.data != nullptr);
+  assert(buffer.pitch == target.pitch);
+
+  const auto delta = reinterpret_cast<const std::byte *>(buffer.data) -
+    reinterpret_cast<const std::byte *>(target.data);
+  assert(delta >= 0);
+
+  const int offset = delta / std::ptrdiff_t(target.pitch);
+
+  top = std::max(top, 0);
+  bottom = std::min(bottom, int(buffer.height));
+  if (top >= bottom)
+    /* not visible */
+    return;
+
+  commands.push_back({buffer, offset, offset + top, offset + bottom,
+                      invoke, function});
+}
+
+void *
+CanvasCommandList::Allocate(std::size_t size) noexcept
+{
+  constexpr std::size_t align = alignof(std::max_align_t);
+  size = (size + align - 1) & ~(align - 1);
+
+  if (blocks.empty() || blocks.back().size - blocks.back().fill < size)
+    blocks.emplace_back(std::max(size, BLOCK_SIZE));
+
+  Block &block = blocks.back();
+  void *p = block.data.get() + block.fill;
+  block.fill += size;
+  return p;
+}
+
+bool
+CanvasCommandList::OverlapsTarget(const void *begin,
+                                  const void *end) const noexcept
+{
+  const void *target_begin = target.data;
+  const void *target_end = target.At(0, target.height);
+
+  return std::less<const void *>{}(begin, target_end) &&
+    !std::less<const void *>{}(end, target_begin);
+}
+
+inline void
+CanvasCommandList::ExecuteBand(int top, int bottom) const noexcept
+{
+  for (const auto &i : commands) {
+    if (i.bottom <= top || i.top >= bottom)
+      continue;
+
+    SDLRasterCanvas canvas(i.buffer);
+    canvas.SetRowClip(top - i.offset, bottom - i.offset);
+    i.invoke(i.function, canvas);
+  }
+}
+
+void
+CanvasCommandList::Execute() noexcept
+{
+  const unsigned height = target.height;
+  const unsigned n_threads = max_threads > 0
+    ? max_threads
+    : GetProcessorCount();
+  const unsigned n_bands = std::min(n_threads * BANDS_PER_THREAD,
+                                    height / MIN_BAND_HEIGHT);
+
+  if (commands.empty()) {
+  } else if (n_threads <= 1 || n_bands <= 1)
+    ExecuteBand(0, height);
+  else {
+    if (pool == nullptr)
+      pool = std::make_unique<ParallelPool>("Rasterise", n_threads);
+
+    pool->For(n_bands, [this, height, n_bands](unsigned i){
+      ExecuteBand(height * i / n_bands, height * (i + 1) / n_bands);
+    });
+  }
+
+  Clear();
+}
+
+void
+CanvasCommandList::Clear() noexcept
+{
+  commands.clear();
+
+  if (blocks.size() > 1) {
+    /* replace the blocks with one large block, to avoid allocations
+       in the next frame */
+    std::size_t size = 0;
+    for (const auto &i : blocks)
+      size += i.size;
+
+    blocks.clear();
+    blocks.emplace_back(size);
+  } else if (!blocks.empty())
+    blocks.front().fill = 0;
+}
@@ -0,0 +1,253 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Buffer.hpp"
+#include "ActivePixelTraits.hpp"
+#include "ui/dim/Point.hpp"
+#include "ui/dim/Size.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+class SDLRasterCanvas;
+class ParallelPool;
+
+/**
+ * A list of drawing operations recorded by a #Canvas in deferred
+ * mode (see Canvas::BeginDeferred()).  Execute() splits the target
+ * buffer into horizontal bands and rasterises them in parallel; each
+ * band replays the operations which touch it in the recorded order,
+ * with a row clip (see RasterCanvas::SetRowClip()).  The result is
+ * bit-identical to drawing immediately.
+ *
+ * Point arrays, rendered text and source images are copied into
+ * memory owned by this object, because the caller may modify them
+ * before the list is executed.  So are the operations themselves:
+ * each one is a function object stored in this memory, invoked
+ * through a plain function pointer.
+ */
+class CanvasCommandList {
+  /**
+   * Invoke the function object recorded by Add().
+   */
+  using Invoke = void (*)(const void *function, SDLRasterCanvas &canvas);
+
+  struct Command {
+    /**
+     * The buffer to draw on; this is the target buffer or a portion
+     * of it (see #SubCanvas).
+     */
+    WritableImageBuffer<ActivePixelTraits> buffer;
+
+    /**
+     * The target buffer row of the first row of #buffer.
+     */
+    int offset;
+
+    /**
+     * The range of target buffer rows which may be modified by this
+     * command.  Bands which do not overlap skip the command.
+     */
+    int top, bottom;
+
+    Invoke invoke;
+
+    /**
+     * The function object, allocated with Allocate().
+     */
+    const void *function;
+  };
+
+  struct Block {
+    std::unique_ptr<std::byte[]> data;
+    std::size_t size, fill = 0;
+
+    explicit Block(std::size_t _size) noexcept
+      :data(new std::byte[_size]), size(_size) {}
+  };
+
+  WritableImageBuffer<ActivePixelTraits> target =
+    WritableImageBuffer<ActivePixelTraits>::Empty();
+
+  std::vector<Command> commands;
+
+  /**
+   * Memory for the data referenced by #commands.
+   */
+  std::vector<Block> blocks;
+
+  /**
+   * The maximum number of threads; 0 means one per processor.
+   */
+  unsigned max_threads = 0;
+
+  /**
+   * The threads which rasterise the bands.  They are created by the
+   * first Execute() call which needs them and kept for all following
+   * ones, because Execute() runs at least once per frame.
+   */
+  std::unique_ptr<ParallelPool> pool;
+
+public:
+  CanvasCommandList() noexcept;
+  ~CanvasCommandList() noexcept;
+
+  CanvasCommandList(const CanvasCommandList &) = delete;
+  CanvasCommandList &operator=(const CanvasCommandList &) = delete;
+
+  /**
+   * Limit the number of threads used by Execute(); 1 rasterises all
+   * bands in the calling thread.
+   *
+   * @param _max_threads the maximum number of threads; 0 means one
+   * per processor
+   */
+  void SetMaxThreads(unsigned _max_threads) noexcept;
+
+  /**
+   * Start recording operations for the specified buffer.
+   */
+  void Begin(WritableImageBuffer<ActivePixelTraits> _target) noexcept {
+    Clear();
+    target = _target;
+  }
+
+  bool IsEmpty() const noexcept {
+    return commands.empty();
+  }
+
+  std::size_t GetSize() const noexcept {
+    return commands.size();
+  }
+
+  /**
+   * Record an operation.
+   *
+   * @param buffer the buffer to draw on; it must be the target
+   * buffer or a portion of it
+   * @param top, bottom the range of rows of #buffer which may be
+   * modified by the operation; this is only used to skip bands, a
+   * conservative value is always correct
+   * @param function a function object accepting a #SDLRasterCanvas
+   * reference; it is copied, and its destructor is never called
+   */
+  template<typename F>
+  void Add(WritableImageBuffer<ActivePixelTraits> buffer,
+           int top, int bottom, F &&function) noexcept;
+
+  /**
+   * Allocate memory which remains valid until Clear().
+   */
+  [[gnu::malloc]] [[gnu::returns_nonnull]]
+  void *Allocate(std::size_t size) noexcept;
+
+  template<typename T>
+  const T *Copy(const T *src, std::size_t n) noexcept {
+    T *dest = static_cast<T *>(Allocate(n * sizeof(T)));
+    std::copy_n(src, n, dest);
+    return dest;
+  }
+
+  /**
+   * Copy a portion of a source image, because the source may be
+   * modified before the operation reading it is executed.  If the
+   * source is the target buffer, all pending operations are executed
+   * first.
+   *
+   * @param position the top-left corner of the portion to be copied;
+   * it is set to the corresponding position in the returned buffer
+   */
+  template<AnyPixelTraits PixelTraits>
+  ConstImageBuffer<PixelTraits> Snapshot(ConstImageBuffer<PixelTraits> src,
+                                         PixelPoint &position,
+                                         PixelSize size) noexcept;
+
+  /**
+   * Rasterise all recorded operations and clear the list.
+   */
+  void Execute() noexcept;
+
+  /**
+   * Discard all recorded operations.
+   */
+  void Clear() noexcept;
+
+private:
+  /**
+   * Does the specified memory range overlap with the target buffer?
+   */
+  [[gnu::pure]]
+  bool OverlapsTarget(const void *begin, const void *end) const noexcept;
+
+  /**
+   * Append a #Command unless it is not visible.
+   */
+  void Add(WritableImageBuffer<ActivePixelTraits> buffer,
+           int top, int bottom,
+           Invoke invoke, const void *function) noexcept;
+
+  void ExecuteBand(int top, int bottom) const noexcept;
+};
+
+template<typename F>
+void
+CanvasCommandList::Add(WritableImageBuffer<ActivePixelTraits> buffer,
+                       int top, int bottom, F &&function) noexcept
+{
+  using T = std::decay_t<F>;
+  static_assert(std::is_trivially_destructible_v<T>,
+                "the memory is released without calling destructors");
+  static_assert(alignof(T) <= alignof(std::max_align_t));
+
+  const T *f = new(Allocate(sizeof(T))) T(std::forward<F>(function));
+
+  Add(buffer, top, bottom,
+      [](const void *_f, SDLRasterCanvas &canvas){
+        (*static_cast<const T *>(_f))(canvas);
+      }, f);
+}
+
+template<AnyPixelTraits PixelTraits>
+ConstImageBuffer<PixelTraits>
+CanvasCommandList::Snapshot(ConstImageBuffer<PixelTraits> src,
+                            PixelPoint &position, PixelSize size) noexcept
+{
+  /* only the intersection with the source image is copied; the
+     operation doesn't read other pixels */
+  const int x1 = std::max(position.x, 0), y1 = std::max(position.y, 0);
+  const int x2 = std::min(position.x + int(size.width), int(src.width));
+  const int y2 = std::min(position.y + int(size.height), int(src.height));
+
+  const std::size_t pitch =
+    PixelTraits::CalcIncrement(size.width) *
+    sizeof(typename PixelTraits::color_type);
+  const std::size_t row_size = x2 > x1
+    ? PixelTraits::CalcIncrement(x2 - x1) *
+      sizeof(typename PixelTraits::color_type)
+    : 0;
+
+  if (row_size > 0 && y2 > y1 &&
+      OverlapsTarget(src.At(x1, y1), src.At(x2, y2 - 1)))
+    /* reading from the target buffer: its pixels must be final */
+    Execute();
+
+  const auto data = static_cast<typename PixelTraits::pointer>
+    (Allocate(pitch * size.height));
+
+  if (row_size > 0)
+    for (int y = y1; y < y2; ++y)
+      std::memcpy(PixelTraits::At(data, pitch,
+                                  x1 - position.x, y - position.y),
+                  src.At(x1, y), row_size);
+
+  position = {0, 0};
+  return {data, pitch, size.width, size.height};
+}
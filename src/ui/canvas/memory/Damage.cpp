@@ -0,0 +1,149 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Damage.hpp"
+
+#include <algorithm>
+
+#include <string.h>
+
+void
+DamageTracker::Resize(unsigned _width, unsigned _height,
+                      unsigned _bytes_per_pixel) noexcept
+{
+  width = _width;
+  height = _height;
+  bytes_per_pixel = _bytes_per_pixel;
+  row_size = std::size_t(width) * bytes_per_pixel;
+
+  previous.ResizeDiscard(row_size * height);
+  dirty_columns.ResizeDiscard((width + TILE_SIZE - 1) / TILE_SIZE);
+  valid = false;
+}
+
+static void
+Union(PixelRect &a, const PixelRect &b) noexcept
+{
+  a.left = std::min(a.left, b.left);
+  a.top = std::min(a.top, b.top);
+  a.right = std::max(a.right, b.right);
+  a.bottom = std::max(a.bottom, b.bottom);
+}
+
+inline void
+DamageTracker::AddRect(const PixelRect &rc) noexcept
+{
+  if (overflow) {
+    Union(rects.front(), rc);
+    return;
+  }
+
+  /* extend a rectangle of the previous tile row with the same
+     horizontal extent */
+  for (auto &i : rects) {
+    if (i.bottom == rc.top && i.left == rc.left && i.right == rc.right) {
+      i.bottom = rc.bottom;
+      return;
+    }
+  }
+
+  if (!rects.full()) {
+    rects.push_back(rc);
+    return;
+  }
+
+  /* too many rectangles: collapse them into their bounding box */
+  PixelRect box = rc;
+  for (const auto &i : rects)
+    Union(box, i);
+
+  rects.clear();
+  rects.push_back(box);
+  overflow = true;
+}
+
+inline void
+DamageTracker::AddRow(unsigned top, unsigned bottom) noexcept
+{
+  const unsigned n_columns = dirty_columns.size();
+
+  for (unsigned column = 0; column < n_columns;) {
+    if (!dirty_columns[column]) {
+      ++column;
+      continue;
+    }
+
+    const unsigned begin = column;
+    while (column < n_columns && dirty_columns[column])
+      ++column;
+
+    AddRect(PixelRect(begin * TILE_SIZE, top,
+                      std::min(column * TILE_SIZE, width), bottom));
+  }
+}
+
+std::span<const PixelRect>
+DamageTracker::Update(const void *data, std::size_t pitch,
+                      unsigned _width, unsigned _height,
+                      unsigned _bytes_per_pixel) noexcept
+{
+  if (_width != width || _height != height ||
+      _bytes_per_pixel != bytes_per_pixel)
+    Resize(_width, _height, _bytes_per_pixel);
+
+  rects.clear();
+  overflow = false;
+
+  const std::byte *src = (const std::byte *)data;
+  std::byte *dest = previous.data();
+
+  if (!valid) {
+    for (unsigned y = 0; y < height; ++y)
+      memcpy(dest + y * row_size, src + y * pitch, row_size);
+
+    valid = true;
+    if (width > 0 && height > 0)
+      rects.push_back(PixelRect(0, 0, width, height));
+    return rects;
+  }
+
+  const std::size_t tile_bytes = std::size_t(TILE_SIZE) * bytes_per_pixel;
+  const unsigned n_columns = dirty_columns.size();
+
+  for (unsigned top = 0; top < height; top += TILE_SIZE) {
+    const unsigned bottom = std::min(top + TILE_SIZE, height);
+
+    std::fill(dirty_columns.begin(), dirty_columns.end(), false);
+    bool any_dirty = false;
+
+    for (unsigned y = top; y < bottom; ++y) {
+      const std::byte *s = src + y * pitch;
+      std::byte *d = dest + y * row_size;
+
+      /* quick check for the common case of an unchanged row */
+      if (!any_dirty && memcmp(s, d, row_size) == 0)
+        continue;
+
+      for (unsigned column = 0; column < n_columns; ++column) {
+        const std::size_t offset = column * tile_bytes;
+        const std::size_t length = std::min(tile_bytes, row_size - offset);
+
+        if (dirty_columns[column]) {
+          /* already known to be dirty; just update the copy */
+          memcpy(d + offset, s + offset, length);
+        } else if (memcmp(s + offset, d + offset, length) != 0) {
+          /* the rows above within this tile are identical, so only
+             this row and the following ones need to be copied */
+          memcpy(d + offset, s + offset, length);
+          dirty_columns[column] = true;
+          any_dirty = true;
+        }
+      }
+    }
+
+    if (any_dirty)
+      AddRow(top, bottom);
+  }
+
+  return rects;
+}
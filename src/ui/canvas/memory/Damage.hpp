@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Buffer.hpp"
+#include "ui/dim/Rect.hpp"
+#include "util/AllocatedArray.hxx"
+#include "util/StaticArray.hxx"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+/**
+ * Finds the regions of an image buffer which have changed since the
+ * previous frame.  It keeps a copy of the previous frame and compares
+ * it tile by tile; the dirty tiles are merged into a small number of
+ * rectangles which can be submitted as partial display updates
+ * (e.g. to an e-ink controller).
+ */
+class DamageTracker {
+public:
+  /**
+   * The width and height of one tile in pixels.
+   */
+  static constexpr unsigned TILE_SIZE = 32;
+
+  /**
+   * The maximum number of rectangles returned by Update().  If more
+   * would be needed, they are replaced by their bounding box.
+   */
+  static constexpr std::size_t MAX_RECTS = 8;
+
+private:
+  /**
+   * A copy of the previous frame.
+   */
+  AllocatedArray<std::byte> previous;
+
+  /**
+   * One flag per tile column of the current tile row.
+   */
+  AllocatedArray<bool> dirty_columns;
+
+  std::size_t row_size = 0;
+  unsigned width = 0, height = 0, bytes_per_pixel = 0;
+
+  /**
+   * Is #previous valid?  If not, the next Update() reports the whole
+   * frame.
+   */
+  bool valid = false;
+
+  /**
+   * Did #rects overflow during the current Update()?  Then it
+   * contains only the bounding box.
+   */
+  bool overflow;
+
+  StaticArray<PixelRect, MAX_RECTS> rects;
+
+public:
+  /**
+   * Forget the previous frame; the next Update() will report the
+   * whole frame as damaged.  Call this when the screen contents were
+   * modified behind our back.
+   */
+  void Reset() noexcept {
+    valid = false;
+  }
+
+  /**
+   * Compare the new frame with the previous one and remember it for
+   * the next call.
+   *
+   * @return the damaged rectangles (empty if nothing has changed);
+   * the span is valid until the next call
+   */
+  template<AnyPixelTraits PixelTraits>
+  std::span<const PixelRect> Update(ConstImageBuffer<PixelTraits> src) noexcept {
+    return Update(src.data, src.pitch, src.width, src.height,
+                  sizeof(typename PixelTraits::color_type));
+  }
+
+  std::span<const PixelRect> Update(const void *data, std::size_t pitch,
+                                    unsigned width, unsigned height,
+                                    unsigned bytes_per_pixel) noexcept;
+
+private:
+  void Resize(unsigned _width, unsigned _height,
+              unsigned _bytes_per_pixel) noexcept;
+
+  /**
+   * Add the dirty tile columns of one tile row to #rects.
+   */
+  void AddRow(unsigned top, unsigned bottom) noexcept;
+
+  void AddRect(const PixelRect &rc) noexcept;
+};
@@ -5,15 +5,27 @@
 
 #include <algorithm>
 
+#ifdef __ARM_NEON__
+#include <arm_neon.h>
+#endif
+
+/**
+ * The value of a white pixel: all bits set, which is white in all
+ * frame buffer formats we support.
+ */
+template<typename T>
+static constexpr T WHITE = T(~T(0));
+
 // Code adapted from imx.60 linux kernel EPD driver by Daiyu Ko <dko@freescale.com>
 //
 
-void
-Dither::DitherGreyscale(const uint8_t *gcc_restrict src,
-                        unsigned src_pitch,
-                        uint8_t *gcc_restrict dest,
-                        unsigned dest_pitch,
-                        unsigned width, unsigned height) noexcept
+template<typename T>
+inline void
+Dither::DitherErrorDiffusion(const uint8_t *gcc_restrict src,
+                             unsigned src_pitch,
+                             T *gcc_restrict dest,
+                             unsigned dest_pitch,
+                             unsigned width, unsigned height) noexcept
 {
   const unsigned width_2 = width + 2;
   allocated_error_dist_buffer.GrowDiscard(width_2 * 2u);
@@ -31,15 +43,13 @@ Dither::DitherGreyscale(const uint8_t *gcc_restrict src,
 
     /* scan the line and convert the Y8 to BW */
     for (unsigned column = 0; column < width; ++column) {
-      ErrorDistType bwPix = e0 + src[column];
+      int bwPix = e0 + src[column];
 
-      uint8_t color = 0;
-      if (bwPix >= 128) {
-        --color;
-        bwPix -= 255;
-      }
-
-      dest[column] = color;
+      /* branchless, because the outcome is unpredictable by
+         design */
+      const bool white = bwPix >= 128;
+      dest[column] = white ? WHITE<T> : T(0);
+      bwPix -= white ? 255 : 0;
 
       /* modify the error distribution buffer */
 
@@ -58,6 +68,138 @@ Dither::DitherGreyscale(const uint8_t *gcc_restrict src,
     *err_dist_l1 = e1;
 
     src += src_pitch;
-    dest += dest_pitch;
+    dest = (T *)((uint8_t *)dest + dest_pitch);
+  }
+}
+
+/**
+ * The 8x8 Bayer matrix.  A pixel becomes white if its value is larger
+ * than 4 times the matrix element plus one, which yields 50% white
+ * pixels for the value 128 and no white pixels for 0.
+ */
+static constexpr uint8_t bayer_matrix[8][8] = {
+  {  0, 32,  8, 40,  2, 34, 10, 42 },
+  { 48, 16, 56, 24, 50, 18, 58, 26 },
+  { 12, 44,  4, 36, 14, 46,  6, 38 },
+  { 60, 28, 52, 20, 62, 30, 54, 22 },
+  {  3, 35, 11, 43,  1, 33,  9, 41 },
+  { 51, 19, 59, 27, 49, 17, 57, 25 },
+  { 15, 47,  7, 39, 13, 45,  5, 37 },
+  { 63, 31, 55, 23, 61, 29, 53, 21 },
+};
+
+/**
+ * The number of pixels processed in one step by DitherOrderedRow().
+ * The threshold pattern repeats after 8 pixels; 16 fills one 128 bit
+ * SIMD register with 8 bit pixels.
+ */
+static constexpr unsigned ORDERED_CHUNK = 16;
+
+template<typename T>
+gcc_always_inline
+static inline void
+DitherOrderedChunk(const uint8_t *gcc_restrict src, T *gcc_restrict dest,
+                   const uint8_t *gcc_restrict threshold) noexcept
+{
+  /* a fixed trip count the compiler can vectorise */
+  for (unsigned i = 0; i < ORDERED_CHUNK; ++i)
+    dest[i] = src[i] > threshold[i] ? WHITE<T> : T(0);
+}
+
+#ifdef __ARM_NEON__
+
+template<>
+gcc_always_inline
+inline void
+DitherOrderedChunk(const uint8_t *gcc_restrict src, uint8_t *gcc_restrict dest,
+                   const uint8_t *gcc_restrict threshold) noexcept
+{
+  vst1q_u8(dest, vcgtq_u8(vld1q_u8(src), vld1q_u8(threshold)));
+}
+
+#endif
+
+template<typename T>
+static void
+DitherOrderedRow(const uint8_t *gcc_restrict src, T *gcc_restrict dest,
+                 unsigned width, unsigned x, unsigned y) noexcept
+{
+  /* the thresholds of this row, beginning at the screen column x */
+  uint8_t threshold[ORDERED_CHUNK];
+  for (unsigned i = 0; i < ORDERED_CHUNK; ++i)
+    threshold[i] = bayer_matrix[y % 8][(x + i) % 8] * 4 + 1;
+
+  unsigned column = 0;
+  for (; column + ORDERED_CHUNK <= width; column += ORDERED_CHUNK)
+    DitherOrderedChunk(src + column, dest + column, threshold);
+
+  for (; column < width; ++column)
+    dest[column] = src[column] > threshold[column % ORDERED_CHUNK]
+      ? WHITE<T> : T(0);
+}
+
+template<typename T>
+static void
+DitherOrdered(const uint8_t *gcc_restrict src, unsigned src_pitch,
+              T *gcc_restrict dest, unsigned dest_pitch,
+              unsigned width, unsigned height,
+              unsigned x, unsigned y) noexcept
+{
+  for (; height; --height, ++y) {
+    DitherOrderedRow(src, dest, width, x, y);
+
+    src += src_pitch;
+    dest = (T *)((uint8_t *)dest + dest_pitch);
   }
 }
+
+template<typename T>
+inline void
+Dither::Dispatch(const uint8_t *gcc_restrict src, unsigned src_pitch,
+                 T *gcc_restrict dest, unsigned dest_pitch,
+                 unsigned width, unsigned height,
+                 unsigned x, unsigned y) noexcept
+{
+  switch (mode) {
+  case Mode::ERROR_DIFFUSION:
+    DitherErrorDiffusion(src, src_pitch, dest, dest_pitch, width, height);
+    break;
+
+  case Mode::ORDERED:
+    DitherOrdered(src, src_pitch, dest, dest_pitch, width, height, x, y);
+    break;
+  }
+}
+
+void
+Dither::DitherGreyscale(const uint8_t *gcc_restrict src,
+                        unsigned src_pitch,
+                        uint8_t *gcc_restrict dest,
+                        unsigned dest_pitch,
+                        unsigned width, unsigned height,
+                        unsigned x, unsigned y) noexcept
+{
+  Dispatch(src, src_pitch, dest, dest_pitch, width, height, x, y);
+}
+
+void
+Dither::DitherGreyscale(const uint8_t *gcc_restrict src,
+                        unsigned src_pitch,
+                        uint16_t *gcc_restrict dest,
+                        unsigned dest_pitch,
+                        unsigned width, unsigned height,
+                        unsigned x, unsigned y) noexcept
+{
+  Dispatch(src, src_pitch, dest, dest_pitch, width, height, x, y);
+}
+
+void
+Dither::DitherGreyscale(const uint8_t *gcc_restrict src,
+                        unsigned src_pitch,
+                        uint32_t *gcc_restrict dest,
+                        unsigned dest_pitch,
+                        unsigned width, unsigned height,
+                        unsigned x, unsigned y) noexcept
+{
+  Dispatch(src, src_pitch, dest, dest_pitch, width, height, x, y);
+}
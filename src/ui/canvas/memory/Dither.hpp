@@ -8,15 +8,83 @@
 
 #include <cstdint>
 
+/**
+ * Converts a greyscale image to black and white.  The output pixels
+ * are 0 (black) or all bits set (white); they can be written directly
+ * to a frame buffer with 8, 16 or 32 bits per pixel.
+ */
 class Dither {
-  typedef int ErrorDistType; // must be wider than 8bits
+public:
+  enum class Mode : uint8_t {
+    /**
+     * Sierra Lite error diffusion.  This looks best, but each pixel
+     * depends on its left and upper neighbours, which makes it
+     * inherently serial.
+     */
+    ERROR_DIFFUSION,
+
+    /**
+     * Ordered dithering with an 8x8 Bayer matrix.  Each pixel is
+     * compared with a fixed threshold, which vectorises well.  The
+     * pattern depends only on the screen position, therefore a
+     * partial update looks exactly like the same region of a full
+     * update.
+     */
+    ORDERED,
+  };
+
+private:
+  typedef int16_t ErrorDistType; // must be wider than 8bits
 
   AllocatedArray<ErrorDistType> allocated_error_dist_buffer;
 
+  Mode mode = Mode::ERROR_DIFFUSION;
+
 public:
+  Mode GetMode() const noexcept {
+    return mode;
+  }
+
+  void SetMode(Mode _mode) noexcept {
+    mode = _mode;
+  }
+
+  /**
+   * @param dest_pitch the destination pitch in bytes
+   * @param x, y the screen position of the first pixel; it aligns the
+   * pattern of #Mode::ORDERED
+   */
   void DitherGreyscale(const uint8_t *gcc_restrict src,
                        unsigned src_pitch,
                        uint8_t *gcc_restrict dest,
                        unsigned dest_pitch,
-                       unsigned width, unsigned height) noexcept;
+                       unsigned width, unsigned height,
+                       unsigned x=0, unsigned y=0) noexcept;
+
+  void DitherGreyscale(const uint8_t *gcc_restrict src,
+                       unsigned src_pitch,
+                       uint16_t *gcc_restrict dest,
+                       unsigned dest_pitch,
+                       unsigned width, unsigned height,
+                       unsigned x=0, unsigned y=0) noexcept;
+
+  void DitherGreyscale(const uint8_t *gcc_restrict src,
+                       unsigned src_pitch,
+                       uint32_t *gcc_restrict dest,
+                       unsigned dest_pitch,
+                       unsigned width, unsigned height,
+                       unsigned x=0, unsigned y=0) noexcept;
+
+private:
+  template<typename T>
+  void Dispatch(const uint8_t *gcc_restrict src, unsigned src_pitch,
+                T *gcc_restrict dest, unsigned dest_pitch,
+                unsigned width, unsigned height,
+                unsigned x, unsigned y) noexcept;
+
+  template<typename T>
+  void DitherErrorDiffusion(const uint8_t *gcc_restrict src,
+                            unsigned src_pitch,
+                            T *gcc_restrict dest, unsigned dest_pitch,
+                            unsigned width, unsigned height) noexcept;
 };
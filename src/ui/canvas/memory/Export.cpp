@@ -35,7 +35,8 @@ CopyFromGreyscale(
                   bool enable_dither,
 #endif
                   void *dest_pixels, unsigned dest_pitch, [[maybe_unused]] unsigned dest_bpp,
-                  ConstImageBuffer<GreyscalePixelTraits> src)
+                  ConstImageBuffer<GreyscalePixelTraits> src,
+                  [[maybe_unused]] PixelPoint position)
 {
   const uint8_t *src_pixels = reinterpret_cast<const uint8_t *>(src.data);
 
@@ -52,22 +53,24 @@ CopyFromGreyscale(
 
 #ifdef DITHER
 
+#ifdef KOBO
   dither.DitherGreyscale(src_pixels, src.pitch,
-                         (uint8_t *)dest_pixels,
-                         dest_pitch,
-                         width, height);
-
-#ifndef KOBO
-  if (dest_bpp == 4) {
-    const unsigned n_pixels = (dest_pitch / dest_bpp)
-      * height;
-    int32_t *d = (int32_t *)dest_pixels + n_pixels;
-    const int8_t *end = (int8_t *)dest_pixels;
-    const int8_t *s = end + n_pixels;
-
-    while (s != end)
-      *--d = *--s;
-  }
+                         (uint8_t *)dest_pixels, dest_pitch,
+                         width, height, position.x, position.y);
+#else
+  /* dither directly into the frame buffer format */
+  if (dest_bpp == 4)
+    dither.DitherGreyscale(src_pixels, src.pitch,
+                           (uint32_t *)dest_pixels, dest_pitch,
+                           width, height, position.x, position.y);
+  else if (dest_bpp == 2)
+    dither.DitherGreyscale(src_pixels, src.pitch,
+                           (uint16_t *)dest_pixels, dest_pitch,
+                           width, height, position.x, position.y);
+  else
+    dither.DitherGreyscale(src_pixels, src.pitch,
+                           (uint8_t *)dest_pixels, dest_pitch,
+                           width, height, position.x, position.y);
 #endif
 
 #else
@@ -6,6 +6,7 @@
 #include "Concepts.hpp"
 #include "PixelTraits.hpp"
 #include "ui/canvas/PortableColor.hpp"
+#include "ui/dim/Point.hpp"
 #include "util/Compiler.h"
 
 #ifdef DITHER
@@ -64,6 +65,14 @@ BGRAToRGB565(RGB565Color *dest, const BGRA8Color *src, unsigned n)
 
 #ifdef GREYSCALE
 
+/**
+ * Convert a greyscale image to the frame buffer format.  With
+ * dithering, the black and white pixels are written directly in the
+ * destination format.
+ *
+ * @param position the screen position of the source image; it aligns
+ * the ordered dithering pattern
+ */
 void
 CopyFromGreyscale(
 #ifdef DITHER
@@ -73,7 +82,8 @@ CopyFromGreyscale(
                   bool enable_dither,
 #endif
                   void *dest_pixels, unsigned dest_pitch, unsigned dest_bpp,
-                  ConstImageBuffer<GreyscalePixelTraits> src);
+                  ConstImageBuffer<GreyscalePixelTraits> src,
+                  PixelPoint position={});
 
 #else
 
@@ -10,6 +10,7 @@
 #include "ui/dim/Point.hpp"
 #include "util/AllocatedArray.hxx"
 
+#include <algorithm>
 #include <cassert>
 
 /*
@@ -42,13 +43,31 @@ public:
 private:
   WritableImageBuffer<PixelTraits> buffer;
 
+  /**
+   * Only the rows in the range [clip_top, clip_bottom) are written.
+   * Unlike the buffer size, this does not affect the geometry: a
+   * primitive drawn in several row ranges results in exactly the same
+   * pixels as drawing it once without a row range.  This allows
+   * rasterising horizontal bands of one buffer in parallel.
+   */
+  int clip_top = 0, clip_bottom;
+
   AllocatedArray<int> polygon_buffer;
   AllocatedArray<BresenhamIterator> edge_buffer;
 
 public:
   RasterCanvas(WritableImageBuffer<PixelTraits> _buffer,
                PixelTraits _traits=PixelTraits()) noexcept
-    :PixelTraits(_traits), buffer(_buffer) {}
+    :PixelTraits(_traits), buffer(_buffer), clip_bottom(_buffer.height) {}
+
+  /**
+   * Restrict all subsequent drawing operations to the specified rows
+   * (see #clip_top).
+   */
+  void SetRowClip(int top, int bottom) noexcept {
+    clip_top = std::max(top, 0);
+    clip_bottom = std::min(bottom, int(buffer.height));
+  }
 
 protected:
   PixelTraits &GetPixelTraits() noexcept {
@@ -60,7 +79,8 @@ protected:
   }
 
   constexpr bool Check(unsigned x, unsigned y) const noexcept {
-    return buffer.Check(x, y);
+    return buffer.Check(x, y) &&
+      int(y) >= clip_top && int(y) < clip_bottom;
   }
 
   pointer At(unsigned x, unsigned y) noexcept {
@@ -248,14 +268,14 @@ public:
     if (x1 < 0)
       x1 = 0;
 
-    if (y1 < 0)
-      y1 = 0;
+    if (y1 < clip_top)
+      y1 = clip_top;
 
     if (x2 > int(buffer.width))
       x2 = buffer.width;
 
-    if (y2 > int(buffer.height))
-      y2 = buffer.height;
+    if (y2 > clip_bottom)
+      y2 = clip_bottom;
 
     if (x1 >= x2 || y1 >= y2)
       return;
@@ -275,7 +295,7 @@ public:
   template<AnyFillPixelOperation PixelOperations>
   void DrawHLine(int x1, int x2, int y, color_type c,
                  PixelOperations operations) noexcept {
-    if (y < 0 || unsigned(y) >= buffer.height)
+    if (y < clip_top || y >= clip_bottom)
       return;
 
     if (x1 < 0)
@@ -302,11 +322,11 @@ public:
     if (x < 0 || unsigned(x) >= buffer.width)
       return;
 
-    if (y1 < 0)
-      y1 = 0;
+    if (y1 < clip_top)
+      y1 = clip_top;
 
-    if (y2 > int(buffer.height))
-      y2 = buffer.height;
+    if (y2 > clip_bottom)
+      y2 = clip_bottom;
 
     if (y1 >= y2)
       return;
@@ -349,6 +369,13 @@ public:
     std::ptrdiff_t pixx = PixelTraits::CalcIncrement(sx) * sizeof(*p);
     std::ptrdiff_t pixy = sy * static_cast<std::ptrdiff_t>(buffer.pitch);
 
+    /* the line has already been clipped to the buffer, therefore
+       checking the address is enough to apply the row clip */
+    const const_pointer clip_begin =
+      PixelTraits::NextRow(const_pointer(buffer.data), buffer.pitch, clip_top);
+    const const_pointer clip_end =
+      PixelTraits::NextRow(const_pointer(buffer.data), buffer.pitch, clip_bottom);
+
     if (dx < dy) {
       std::swap(dx, dy);
       std::swap(pixx, pixy);
@@ -357,7 +384,8 @@ public:
     unsigned lmp = line_mask_position;
 
     for (int x = 0, y = 0; x < dx; x++, p = PixelTraits::NextByte(p, pixx)) {
-      if ((lmp++ | line_mask) == unsigned(-1))
+      if ((lmp++ | line_mask) == unsigned(-1) &&
+          p >= clip_begin && p < clip_end)
         PixelTraits::WritePixel(p, c);
 
       y += dy;
@@ -501,7 +529,7 @@ public:
 
     // perform scans
 
-    for (int y = miny; y <= maxy; y++) {
+    for (int y = miny; y <= maxy && y < clip_bottom; y++) {
 
       bool changed = false;
 
@@ -803,10 +831,12 @@ public:
                      typename SPT::const_rpointer src, unsigned src_pitch,
                      PixelOperations operations) noexcept {
     unsigned src_x = 0, src_y = 0;
+    y -= clip_top;
     if (!ClipAxis(x, w, buffer.width, src_x) ||
-        !ClipAxis(y, h, buffer.height, src_y))
+        !ClipAxis(y, h, clip_bottom - clip_top, src_y))
       return;
 
+    y += clip_top;
     src = SPT::At(src, src_pitch, src_x, src_y);
 
     pointer p = At(x, y);
@@ -868,10 +898,15 @@ public:
     typename SPT::const_rpointer old_src = nullptr;
 
     unsigned j = 0;
+    int y = dest_position.y;
     rpointer dest = At(dest_position.x, dest_position.y);
-    for (unsigned i = dest_size.height; i > 0; --i,
+    for (unsigned i = dest_size.height; i > 0; --i, ++y,
            dest = PixelTraits::NextRow(dest, buffer.pitch, 1)) {
-      if (src == old_src) {
+      if (y < clip_top || y >= clip_bottom) {
+        /* outside of the row clip: don't write, but keep scaling
+           the source rows exactly as if it were drawn */
+        old_src = nullptr;
+      } else if (src == old_src) {
         /* the previous iteration has already scaled this row: copy
            the previous destination row to the current destination
            row, to avoid redundant ScalePixels() calls */
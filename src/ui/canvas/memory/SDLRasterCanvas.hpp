@@ -0,0 +1,27 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "PixelOperations.hpp"
+#include "RasterCanvas.hpp"
+#include "ActivePixelTraits.hpp"
+#include "ui/canvas/PortableColor.hpp"
+#include "ui/canvas/Color.hpp"
+
+/**
+ * The #RasterCanvas used by the memory #Canvas.
+ */
+class SDLRasterCanvas : public RasterCanvas<ActivePixelTraits> {
+public:
+  SDLRasterCanvas(WritableImageBuffer<ActivePixelTraits> buffer)
+    :RasterCanvas<ActivePixelTraits>(buffer) {}
+
+  static constexpr ActivePixelTraits::color_type Import(Color color) {
+#ifdef GREYSCALE
+    return Luminosity8(color.GetLuminosity());
+#else
+    return BGRA8Color(color.Red(), color.Green(), color.Blue(), color.Alpha());
+#endif
+  }
+};
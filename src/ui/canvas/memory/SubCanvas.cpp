@@ -19,4 +19,8 @@ SubCanvas::SubCanvas(Canvas &canvas,
   buffer.data = buffer.At(_offset.x, _offset.y);
   buffer.width = ClipMax(buffer.width, _offset.x, _size.width);
   buffer.height = ClipMax(buffer.height, _offset.y, _size.height);
+
+  /* draw in the parent's command list, so the order of operations is
+     kept */
+  command_list = canvas.command_list;
 }
@@ -197,20 +197,15 @@ CopyFromGreyscale(
 
 #ifdef DITHER
 
-  dither.DitherGreyscale(src_pixels, src.pitch,
-                         dest_pixels,
-                         dest_pitch / bytes_per_pixel,
-                         width, height);
-  if (bytes_per_pixel == 4) {
-    const unsigned n_pixels = (dest_pitch / bytes_per_pixel)
-      * height;
-    int32_t *d = (int32_t *)dest_pixels + n_pixels;
-    const int8_t *end = (int8_t *)dest_pixels;
-    const int8_t *s = end + n_pixels;
-
-    while (s != end)
-      *--d = *--s;
-  }
+  /* dither directly into the texture format */
+  if (bytes_per_pixel == 4)
+    dither.DitherGreyscale(src_pixels, src.pitch,
+                           (uint32_t *)dest_pixels, dest_pitch,
+                           width, height);
+  else
+    dither.DitherGreyscale(src_pixels, src.pitch,
+                           (uint16_t *)dest_pixels, dest_pitch,
+                           width, height);
 
 #else
 
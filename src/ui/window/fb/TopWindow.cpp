@@ -20,6 +20,10 @@ TopWindow::CheckResize() noexcept
 
   if (screen->CheckResize())
     Resize(screen->GetSize());
+  else
+    /* the size is unchanged (e.g. rotated by 180 degrees), but the
+       screen still needs to be redrawn */
+    Invalidate();
 }
 
 #endif
@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "tstring.hpp"
+#include "tstring_view.hxx"
+
+#include <memory>
+
+class StringPool;
+
+/**
+ * An immutable string whose buffer may be shared by many instances.
+ * Copying it only increments a reference count, and a #StringPool
+ * can make equal strings share one buffer.  An empty string does not
+ * allocate any memory.
+ */
+class SharedString {
+  friend class StringPool;
+
+public:
+  using value_type = tstring::value_type;
+
+private:
+  static constexpr value_type empty_string[1]{};
+
+  std::shared_ptr<const tstring> value;
+
+public:
+  SharedString() noexcept = default;
+
+  SharedString(tstring_view s)
+    :value(s.empty() ? nullptr : std::make_shared<const tstring>(s)) {}
+
+  SharedString(const value_type *s)
+    :SharedString(tstring_view{s}) {}
+
+  SharedString(const tstring &s)
+    :SharedString(tstring_view{s}) {}
+
+  void assign(tstring_view s) {
+    *this = SharedString{s};
+  }
+
+  bool empty() const noexcept {
+    return value == nullptr;
+  }
+
+  const value_type *c_str() const noexcept {
+    return value != nullptr ? value->c_str() : empty_string;
+  }
+
+  operator tstring_view() const noexcept {
+    return value != nullptr ? tstring_view{*value} : tstring_view{};
+  }
+
+  bool operator==(const SharedString &other) const noexcept {
+    return value == other.value ||
+      tstring_view{*this} == tstring_view{other};
+  }
+};
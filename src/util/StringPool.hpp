@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "SharedString.hpp"
+
+#include <functional>
+#include <unordered_set>
+
+/**
+ * Makes equal #SharedString instances share one buffer.  The pool
+ * keeps a reference to each distinct string until Clear() is called;
+ * strings which are still in use elsewhere survive that.
+ */
+class StringPool {
+  using Pointer = std::shared_ptr<const tstring>;
+
+  struct Hash {
+    std::size_t operator()(const Pointer &p) const noexcept {
+      return std::hash<tstring>{}(*p);
+    }
+  };
+
+  struct Equal {
+    bool operator()(const Pointer &a, const Pointer &b) const noexcept {
+      return *a == *b;
+    }
+  };
+
+  std::unordered_set<Pointer, Hash, Equal> strings;
+
+public:
+  /**
+   * Replace the buffer of the specified string with the pool's copy
+   * of the same text, adding it to the pool if there is none yet.
+   */
+  void Intern(SharedString &s) {
+    if (s.value == nullptr)
+      return;
+
+    s.value = *strings.insert(s.value).first;
+  }
+
+  std::size_t size() const noexcept {
+    return strings.size();
+  }
+
+  void Clear() noexcept {
+    strings.clear();
+  }
+};
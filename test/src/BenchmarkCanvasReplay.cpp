@@ -0,0 +1,312 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Render a synthetic moving-map frame with the memory canvas, once
+ * immediately and once through a #CanvasCommandList with various
+ * numbers of threads, and compare the durations.  The frame resembles
+ * what MapWindow draws on a Kobo: a stretched terrain image,
+ * topography polygons and lines, airspace areas with dashed outlines,
+ * a trail, waypoint symbols and a few copies from off-screen
+ * buffers.  All passes must produce the same pixels.
+ */
+
+#include "ui/canvas/Canvas.hpp"
+#include "ui/canvas/memory/CommandList.hpp"
+#include "ui/canvas/memory/SDLRasterCanvas.hpp"
+#include "Screen/Debug.hpp"
+#include "thread/Parallel.hpp"
+#include "system/Args.hpp"
+#include "util/StringCompare.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+using Buffer = WritableImageBuffer<ActivePixelTraits>;
+
+struct Options {
+  unsigned width = 1072, height = 1448;
+
+  unsigned frames = 50;
+};
+
+/**
+ * A deterministic pseudo-random number generator.
+ */
+class Random {
+  uint32_t state = 1;
+
+public:
+  unsigned operator()(unsigned max) noexcept {
+    state = state * 1103515245 + 12345;
+    return (state >> 8) % max;
+  }
+};
+
+/**
+ * The primitives of one map frame.
+ */
+struct Frame {
+  struct Shape {
+    std::vector<BulkPixelPoint> points;
+    Brush brush;
+    Pen pen;
+  };
+
+  Buffer terrain, overlay;
+
+  std::vector<Shape> topography, airspaces, lines;
+
+  std::vector<BulkPixelPoint> trail;
+
+  std::vector<PixelPoint> waypoints;
+
+  Frame(const Options &options) noexcept;
+
+  ~Frame() noexcept {
+    terrain.Free();
+    overlay.Free();
+  }
+
+  void Draw(Canvas &canvas, Canvas &overlay_canvas) const noexcept;
+};
+
+static std::vector<BulkPixelPoint>
+RandomShape(Random &random, PixelPoint center, unsigned radius,
+            unsigned n) noexcept
+{
+  std::vector<BulkPixelPoint> points;
+  points.reserve(n);
+
+  /* a star-shaped polygon around the center */
+  for (unsigned i = 0; i < n; ++i) {
+    const double angle = 2 * 3.14159265 * i / n;
+    const double r = radius * (0.5 + random(100) / 200.);
+    points.push_back({center.x + int(r * std::cos(angle)),
+                      center.y + int(r * std::sin(angle))});
+  }
+
+  return points;
+}
+
+Frame::Frame(const Options &options) noexcept
+{
+  const int width = options.width, height = options.height;
+  Random random;
+
+  /* the terrain renderer produces a quantised image which gets
+     stretched to the screen */
+  terrain.Allocate(options.width / 2, options.height / 2);
+  for (unsigned y = 0; y < terrain.height; ++y)
+    for (unsigned x = 0; x < terrain.width; ++x)
+      *terrain.At(x, y) =
+        SDLRasterCanvas::Import(Color((x * 7 + y * 3) & 0xff,
+                                      (x + y * 5) & 0xff, 0x80));
+
+  overlay.Allocate(options.width, options.height);
+
+  for (unsigned i = 0; i < 400; ++i)
+    topography.push_back({
+        RandomShape(random, {int(random(width)), int(random(height))},
+                    10 + random(80), 6 + random(30)),
+        Brush(Color(0x80 + random(0x80), 0xc0, 0x80 + random(0x40))),
+        Pen(),
+      });
+
+  for (unsigned i = 0; i < 150; ++i) {
+    std::vector<BulkPixelPoint> points;
+    PixelPoint p{int(random(width)), int(random(height))};
+    for (unsigned j = 0, n = 5 + random(40); j < n; ++j) {
+      points.push_back(p);
+      p.x += int(random(60)) - 30;
+      p.y += int(random(60)) - 30;
+    }
+
+    lines.push_back({
+        std::move(points),
+        Brush(),
+        Pen(1 + random(3), Color(0x40, 0x40, 0x80 + random(0x80))),
+      });
+  }
+
+  for (unsigned i = 0; i < 30; ++i)
+    airspaces.push_back({
+        RandomShape(random, {int(random(width)), int(random(height))},
+                    100 + random(400), 32 + random(64)),
+        Brush(Color(0xff, 0, 0).WithAlpha(0x40)),
+        Pen(Pen::DASH1, 3, Color(0xc0, 0, 0)),
+      });
+
+  PixelPoint p{width / 2, height / 2};
+  for (unsigned i = 0; i < 600; ++i) {
+    trail.push_back(p);
+    p.x = std::clamp(p.x + int(random(21)) - 10, 0, width - 1);
+    p.y = std::clamp(p.y + int(random(21)) - 10, 0, height - 1);
+  }
+
+  for (unsigned i = 0; i < 150; ++i)
+    waypoints.push_back({int(random(width)), int(random(height))});
+}
+
+void
+Frame::Draw(Canvas &canvas, Canvas &overlay_canvas) const noexcept
+{
+  canvas.Stretch(terrain);
+
+  for (const auto &i : topography) {
+    canvas.Select(i.brush);
+    canvas.SelectNullPen();
+    canvas.DrawPolygon(i.points.data(), i.points.size());
+  }
+
+  for (const auto &i : lines) {
+    canvas.Select(i.pen);
+    canvas.DrawPolyline(i.points.data(), i.points.size());
+  }
+
+  /* airspace areas are drawn into a separate buffer and blended */
+  overlay_canvas.ClearWhite();
+  for (const auto &i : airspaces) {
+    overlay_canvas.Select(i.brush);
+    overlay_canvas.SelectNullPen();
+    overlay_canvas.DrawPolygon(i.points.data(), i.points.size());
+  }
+
+  canvas.CopyTransparentWhite({0, 0}, canvas.GetSize(),
+                              overlay_canvas, {0, 0});
+
+  canvas.SelectHollowBrush();
+  for (const auto &i : airspaces) {
+    canvas.Select(i.pen);
+    canvas.DrawPolygon(i.points.data(), i.points.size());
+  }
+
+  canvas.Select(Pen(4, COLOR_BLUE));
+  canvas.DrawPolyline(trail.data(), trail.size());
+
+  canvas.Select(Brush(COLOR_WHITE));
+  canvas.Select(Pen(2, COLOR_BLACK));
+  for (const auto &i : waypoints) {
+    canvas.DrawCircle(i, 8);
+    canvas.DrawFilledRectangle({i.x + 10, i.y - 6, i.x + 60, i.y + 6},
+                               COLOR_WHITE);
+    canvas.DrawOutlineRectangle({i.x + 10, i.y - 6, i.x + 60, i.y + 6},
+                                COLOR_BLACK);
+  }
+}
+
+static bool
+Equals(const Buffer &a, const Buffer &b) noexcept
+{
+  for (unsigned y = 0; y < a.height; ++y)
+    if (std::memcmp(a.At(0, y), b.At(0, y),
+                    a.width * sizeof(*a.data)) != 0)
+      return false;
+
+  return true;
+}
+
+/**
+ * @param list the command list, or nullptr for immediate mode
+ * @return the mean frame duration [ms]
+ */
+static double
+Measure(const Options &options, const Frame &frame,
+        Buffer &buffer, CanvasCommandList *list) noexcept
+{
+  Canvas canvas(buffer);
+  Canvas overlay_canvas(frame.overlay);
+
+  const auto start = Clock::now();
+
+  for (unsigned i = 0; i < options.frames; ++i) {
+    if (list != nullptr)
+      canvas.BeginDeferred(*list);
+
+    frame.Draw(canvas, overlay_canvas);
+
+    if (list != nullptr)
+      canvas.EndDeferred();
+  }
+
+  const std::chrono::duration<double, std::milli> duration =
+    Clock::now() - start;
+  return duration.count() / options.frames;
+}
+
+static void
+ParseCommandLine(Args &args, Options &options)
+{
+  while (!args.IsEmpty()) {
+    const char *arg = args.GetNext();
+
+    if (const char *value = StringAfterPrefix(arg, "--width=")) {
+      options.width = std::max(64UL, strtoul(value, nullptr, 10));
+    } else if (const char *value = StringAfterPrefix(arg, "--height=")) {
+      options.height = std::max(64UL, strtoul(value, nullptr, 10));
+    } else if (const char *value = StringAfterPrefix(arg, "--frames=")) {
+      options.frames = std::max(1UL, strtoul(value, nullptr, 10));
+    } else
+      args.UsageError();
+  }
+}
+
+int
+main(int argc, char **argv)
+{
+  Args args(argc, argv,
+            "[--width=PIXELS] [--height=PIXELS] [--frames=N]");
+
+  Options options;
+  ParseCommandLine(args, options);
+
+  /* the memory canvas doesn't need any global initialisation */
+  ScreenInitialized();
+
+  int result = EXIT_SUCCESS;
+
+  {
+    const Frame frame(options);
+
+    Buffer expected, actual;
+    expected.Allocate(options.width, options.height);
+    actual.Allocate(options.width, options.height);
+
+    printf("%ux%u, %u frames, %u processors\n",
+           options.width, options.height, options.frames,
+           GetProcessorCount());
+
+    const double immediate = Measure(options, frame, expected, nullptr);
+    printf("%-12s %8.2f ms/frame\n", "immediate", immediate);
+
+    CanvasCommandList list;
+    for (unsigned n_threads = 1; n_threads <= 4; ++n_threads) {
+      list.SetMaxThreads(n_threads);
+      const double deferred = Measure(options, frame, actual, &list);
+
+      char name[32];
+      snprintf(name, sizeof(name), "%u thread%s", n_threads,
+               n_threads > 1 ? "s" : "");
+      printf("%-12s %8.2f ms/frame  %5.2fx%s\n", name, deferred,
+             immediate / deferred,
+             Equals(expected, actual) ? "" : "  MISMATCH");
+
+      if (!Equals(expected, actual))
+        result = EXIT_FAILURE;
+    }
+
+    expected.Free();
+    actual.Free();
+  }
+
+  ScreenDeinitialized();
+
+  return result;
+}
@@ -0,0 +1,146 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Simulate a large number of moving SkyLines tracking clients in
+ * #CloudClientContainer and measure the cost of location updates and
+ * range queries.  The query results are verified against a linear
+ * scan.
+ */
+
+#include "Cloud/Client.hpp"
+#include "Geo/Boost/RangeBox.hpp"
+#include "net/IPv4Address.hxx"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+static constexpr unsigned N_CLIENTS = 10000;
+static constexpr unsigned N_STEPS = 60;
+static constexpr unsigned N_QUERIES = 1000;
+static constexpr double RANGE = 50000;
+
+struct SimulatedClient {
+  uint64_t key;
+  GeoPoint location;
+
+  /**
+   * The movement per step in degrees (about 100 m).
+   */
+  GeoPoint velocity;
+};
+
+using Clock = std::chrono::steady_clock;
+
+static double
+Seconds(Clock::duration d)
+{
+  return std::chrono::duration<double>(d).count();
+}
+
+[[gnu::pure]]
+static bool
+IsInBox(const GeoPoint &p, const GeoPoint &location, double range)
+{
+  const auto box = BoostRangeBox(location, range);
+  const auto &sw = box.min_corner(), &ne = box.max_corner();
+
+  if (p.latitude < sw.latitude || p.latitude > ne.latitude)
+    return false;
+
+  return sw.longitude <= ne.longitude
+    ? p.longitude >= sw.longitude && p.longitude <= ne.longitude
+    : p.longitude >= sw.longitude || p.longitude <= ne.longitude;
+}
+
+static unsigned
+LinearCount(const CloudClientContainer &clients,
+            const GeoPoint &location, double range)
+{
+  unsigned n = 0;
+  for (const auto &client : clients)
+    if (IsInBox(client.location, location, range))
+      ++n;
+  return n;
+}
+
+int
+main()
+{
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<double> longitude_distribution(5, 15);
+  std::uniform_real_distribution<double> latitude_distribution(44, 49);
+  std::uniform_real_distribution<double> velocity_distribution(-0.001, 0.001);
+
+  std::vector<SimulatedClient> simulated;
+  simulated.reserve(N_CLIENTS);
+  for (unsigned i = 0; i < N_CLIENTS; ++i)
+    simulated.push_back({
+        0x10000 + i,
+        GeoPoint(Angle::Degrees(longitude_distribution(rng)),
+                 Angle::Degrees(latitude_distribution(rng))),
+        GeoPoint(Angle::Degrees(velocity_distribution(rng)),
+                 Angle::Degrees(velocity_distribution(rng))),
+      });
+
+  const IPv4Address address(127, 0, 0, 1, 5597);
+
+  CloudClientContainer clients;
+  for (const auto &i : simulated)
+    clients.Make(address, i.key, i.location, 1000);
+
+  Clock::duration update_duration{}, query_duration{};
+  unsigned long n_results = 0;
+  unsigned n_errors = 0;
+
+  for (unsigned step = 0; step < N_STEPS; ++step) {
+    for (auto &i : simulated)
+      i.location += i.velocity;
+
+    const auto update_start = Clock::now();
+    for (const auto &i : simulated)
+      clients.Make(address, i.key, i.location, 1000);
+    update_duration += Clock::now() - update_start;
+
+    const auto query_start = Clock::now();
+    for (unsigned q = 0; q < N_QUERIES; ++q) {
+      const auto &location = simulated[(step * N_QUERIES + q) % N_CLIENTS].location;
+      for ([[maybe_unused]] const auto &i : clients.QueryWithinRange(location, RANGE))
+        ++n_results;
+    }
+    query_duration += Clock::now() - query_start;
+
+    /* verify a few queries */
+    for (unsigned q = 0; q < 4; ++q) {
+      const auto &location = simulated[(step * 97 + q * 2551) % N_CLIENTS].location;
+
+      unsigned n = 0;
+      for (const auto &i : clients.QueryWithinRange(location, RANGE)) {
+        if (!IsInBox(i->location, location, RANGE))
+          ++n_errors;
+        ++n;
+      }
+
+      if (n != LinearCount(clients, location, RANGE))
+        ++n_errors;
+    }
+  }
+
+  const unsigned long n_updates = (unsigned long)N_CLIENTS * N_STEPS;
+  const unsigned long n_queries = (unsigned long)N_QUERIES * N_STEPS;
+
+  printf("clients\t%u\n", N_CLIENTS);
+  printf("updates/s\t%.0f\n", n_updates / Seconds(update_duration));
+  printf("queries/s\t%.0f\n", n_queries / Seconds(query_duration));
+  printf("results/query\t%.1f\n", double(n_results) / n_queries);
+
+  if (n_errors > 0) {
+    fprintf(stderr, "%u wrong query results\n", n_errors);
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Measure the conversion of a greyscale frame to the black and white
+ * e-ink frame buffer, with each #Dither::Mode and frame buffer depth.
+ * The default size is the screen of the Kobo Glo HD and Clara HD.
+ */
+
+#include "ui/canvas/memory/Dither.hpp"
+#include "system/Args.hpp"
+#include "util/StringCompare.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+  unsigned width = 1072, height = 1448;
+
+  unsigned frames = 50;
+};
+
+/**
+ * @return the mean frame duration [ms]
+ */
+template<typename T>
+static double
+Measure(const Options &options, Dither &dither,
+        const std::vector<uint8_t> &src) noexcept
+{
+  std::vector<T> dest(options.width * options.height);
+
+  const auto start = Clock::now();
+
+  for (unsigned i = 0; i < options.frames; ++i)
+    dither.DitherGreyscale(src.data(), options.width,
+                           dest.data(), options.width * sizeof(T),
+                           options.width, options.height);
+
+  const std::chrono::duration<double, std::milli> duration =
+    Clock::now() - start;
+  return duration.count() / options.frames;
+}
+
+static void
+ParseCommandLine(Args &args, Options &options)
+{
+  while (!args.IsEmpty()) {
+    const char *arg = args.GetNext();
+
+    if (const char *value = StringAfterPrefix(arg, "--width=")) {
+      options.width = std::max(1UL, strtoul(value, nullptr, 10));
+    } else if (const char *value = StringAfterPrefix(arg, "--height=")) {
+      options.height = std::max(1UL, strtoul(value, nullptr, 10));
+    } else if (const char *value = StringAfterPrefix(arg, "--frames=")) {
+      options.frames = std::max(1UL, strtoul(value, nullptr, 10));
+    } else
+      args.UsageError();
+  }
+}
+
+int
+main(int argc, char **argv)
+{
+  Args args(argc, argv,
+            "[--width=PIXELS] [--height=PIXELS] [--frames=N]");
+
+  Options options;
+  ParseCommandLine(args, options);
+
+  /* a map-like image: smooth gradients with some detail */
+  std::vector<uint8_t> src(options.width * options.height);
+  for (unsigned y = 0; y < options.height; ++y)
+    for (unsigned x = 0; x < options.width; ++x)
+      src[y * options.width + x] = (x / 4 + y / 3 + (x * y) % 7 * 9) & 0xff;
+
+  printf("%ux%u, %u frames\n", options.width, options.height,
+         options.frames);
+
+  static constexpr struct {
+    Dither::Mode mode;
+    const char *name;
+  } modes[] = {
+    { Dither::Mode::ERROR_DIFFUSION, "error diffusion" },
+    { Dither::Mode::ORDERED, "ordered" },
+  };
+
+  Dither dither;
+  for (const auto &i : modes) {
+    dither.SetMode(i.mode);
+
+    printf("%-16s  8 bpp %7.2f ms/frame\n", i.name,
+           Measure<uint8_t>(options, dither, src));
+    printf("%-16s 16 bpp %7.2f ms/frame\n", i.name,
+           Measure<uint16_t>(options, dither, src));
+    printf("%-16s 32 bpp %7.2f ms/frame\n", i.name,
+           Measure<uint32_t>(options, dither, src));
+  }
+
+  return EXIT_SUCCESS;
+}
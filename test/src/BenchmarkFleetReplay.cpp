@@ -0,0 +1,369 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Replay a fleet of IGC files concurrently, each through its own
+ * #GlideComputer instance (air data, task, contest, airspace
+ * warnings, route/reach with terrain), and measure the latency of
+ * each calculation stage and the total throughput.
+ *
+ * After each flight, all contest solvers are run exhaustively on the
+ * flight's trace to measure them individually.
+ */
+
+#include "DebugReplayIGC.hpp"
+#include "Computer/GlideComputer.hpp"
+#include "Computer/GlideComputerInterface.hpp"
+#include "Computer/Settings.hpp"
+#include "Engine/Waypoint/Waypoints.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Task/TaskManager.hpp"
+#include "Engine/Task/Ordered/OrderedTask.hpp"
+#include "Engine/Contest/ContestManager.hpp"
+#include "Engine/Contest/Solvers/Contests.hpp"
+#include "Task/ProtectedTaskManager.hpp"
+#include "Task/TaskFile.hpp"
+#include "Terrain/RasterTerrain.hpp"
+#include "Operation/Operation.hpp"
+#include "system/Args.hpp"
+#include "system/Path.hpp"
+#include "thread/Parallel.hpp"
+#include "util/StringAPI.hxx"
+#include "util/StringCompare.hxx"
+#include "util/PrintException.hxx"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+/* fake symbols: */
+
+#include "Input/InputQueue.hpp"
+#include "Logger/Logger.hpp"
+
+bool InputEvents::processGlideComputer(unsigned) { return false; }
+void Logger::LogStartEvent([[maybe_unused]] const NMEAInfo &gps_info) {}
+void Logger::LogFinishEvent([[maybe_unused]] const NMEAInfo &gps_info) {}
+void Logger::LogPoint([[maybe_unused]] const NMEAInfo &gps_info) {}
+
+/* done with fake symbols. */
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * A latency histogram with power-of-two nanosecond buckets.
+ */
+class LatencyHistogram {
+  static constexpr unsigned N_BUCKETS = 40;
+
+  std::array<unsigned long, N_BUCKETS> buckets{};
+
+  unsigned long n = 0;
+  unsigned long long sum = 0, max = 0;
+
+public:
+  void Add(Clock::duration d) noexcept {
+    const unsigned long long ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+
+    ++buckets[std::min<unsigned>(std::bit_width(ns), N_BUCKETS - 1)];
+    ++n;
+    sum += ns;
+    max = std::max(max, ns);
+  }
+
+  void Add(const LatencyHistogram &other) noexcept {
+    for (unsigned i = 0; i < N_BUCKETS; ++i)
+      buckets[i] += other.buckets[i];
+    n += other.n;
+    sum += other.sum;
+    max = std::max(max, other.max);
+  }
+
+  unsigned long GetCount() const noexcept {
+    return n;
+  }
+
+  double GetSeconds() const noexcept {
+    return sum / 1e9;
+  }
+
+  /**
+   * Return the upper bound of the bucket containing the given
+   * quantile.
+   */
+  [[gnu::pure]]
+  unsigned long long GetQuantile(double q) const noexcept {
+    const unsigned long threshold = (unsigned long)(q * n);
+    unsigned long count = 0;
+    for (unsigned i = 0; i < N_BUCKETS; ++i) {
+      count += buckets[i];
+      if (count > threshold)
+        return std::min(1ULL << i, max);
+    }
+
+    return max;
+  }
+
+  void Print(const char *name) const noexcept {
+    if (n == 0)
+      return;
+
+    printf("%-24s %9lu %11.0f %11llu %11llu %11llu %11llu\n",
+           name, n, double(sum) / n,
+           GetQuantile(0.5), GetQuantile(0.9), GetQuantile(0.99), max);
+  }
+
+  void PrintBuckets(const char *name) const noexcept {
+    if (n == 0)
+      return;
+
+    printf("\n%s [ns]\n", name);
+
+    unsigned first = 0;
+    while (buckets[first] == 0)
+      ++first;
+
+    unsigned last = N_BUCKETS - 1;
+    while (buckets[last] == 0)
+      --last;
+
+    for (unsigned i = first; i <= last; ++i) {
+      const unsigned width = (unsigned)((buckets[i] * 50 + n - 1) / n);
+      printf("  < %11llu %9lu %s\n", 1ULL << i, buckets[i],
+             std::string(width, '#').c_str());
+    }
+  }
+};
+
+static constexpr Contest ALL_CONTESTS[] = {
+  Contest::OLC_SPRINT,
+  Contest::OLC_FAI,
+  Contest::OLC_CLASSIC,
+  Contest::OLC_LEAGUE,
+  Contest::OLC_PLUS,
+  Contest::XCONTEST,
+  Contest::DHV_XC,
+  Contest::SIS_AT,
+  Contest::NET_COUPE,
+  Contest::DMST,
+  Contest::WEGLIDE_FREE,
+  Contest::WEGLIDE_DISTANCE,
+  Contest::WEGLIDE_FAI,
+  Contest::WEGLIDE_OR,
+  Contest::CHARRON,
+};
+
+static constexpr std::size_t N_CONTESTS = std::size(ALL_CONTESTS);
+
+struct FlightResult {
+  LatencyHistogram gps, idle;
+  std::array<LatencyHistogram, N_CONTESTS> contests;
+
+  unsigned long n_fixes = 0;
+
+  bool error = false;
+};
+
+struct Options {
+  unsigned n_threads = 0;
+  unsigned repeat = 1;
+  Contest contest = Contest::OLC_PLUS;
+  bool solvers = true;
+};
+
+static Contest
+ParseContest(const char *name)
+{
+  for (const auto contest : ALL_CONTESTS)
+    if (StringIsEqualIgnoreCase(ContestToString(contest), name))
+      return contest;
+
+  fprintf(stderr, "Unknown contest: %s\n", name);
+  exit(EXIT_FAILURE);
+}
+
+static void
+ReplayFlight(Path path, RasterTerrain *terrain, const Options &options,
+             FlightResult &result)
+{
+  std::unique_ptr<DebugReplay> replay(DebugReplayIGC::Create(path));
+  if (!replay) {
+    result.error = true;
+    return;
+  }
+
+  ComputerSettings settings;
+  settings.SetDefaults();
+  settings.polar.glide_polar_task = GlidePolar(1);
+  settings.contest.enable = true;
+  settings.contest.contest = options.contest;
+  settings.task.route_planner.mode = RoutePlannerConfig::Mode::BOTH;
+  settings.task.route_planner.reach_calc_mode =
+    RoutePlannerConfig::ReachMode::TURNING;
+
+  const Waypoints waypoints;
+  Airspaces airspaces;
+
+  TaskManager task_manager(settings.task, waypoints);
+  task_manager.SetGlidePolar(settings.polar.glide_polar_task);
+
+  GlideComputerTaskEvents task_events;
+  task_manager.SetTaskEvents(task_events);
+
+  ProtectedTaskManager protected_task_manager(task_manager, settings.task);
+
+  /* fly the task declared in the IGC file, if there is one */
+  try {
+    if (auto task = TaskFile::GetTask(path, settings.task, nullptr, 0))
+      protected_task_manager.TaskCommit(*task);
+  } catch (...) {
+    PrintException(std::current_exception());
+  }
+
+  GlideComputer glide_computer(settings, waypoints, airspaces,
+                               protected_task_manager, task_events);
+  glide_computer.SetTerrain(terrain);
+  glide_computer.SetContestIncremental(false);
+  glide_computer.Initialise();
+
+  while (replay->Next()) {
+    glide_computer.ReadBlackboard(replay->Basic());
+
+    auto start = Clock::now();
+    glide_computer.ProcessGPS();
+    auto end = Clock::now();
+    result.gps.Add(end - start);
+
+    /* the replay runs much faster than real time, which would
+       throttle ProcessIdle() in CalculationThread; run it after each
+       fix instead, as with a 1 Hz GPS */
+    start = end;
+    glide_computer.ProcessIdle();
+    result.idle.Add(Clock::now() - start);
+
+    ++result.n_fixes;
+  }
+
+  if (!options.solvers)
+    return;
+
+  const auto &trace = glide_computer.GetTraceComputer();
+  for (std::size_t i = 0; i < N_CONTESTS; ++i) {
+    ContestManager contest_manager(ALL_CONTESTS[i], trace.GetFull(),
+                                   trace.GetContest(), trace.GetSprint());
+
+    const auto start = Clock::now();
+    contest_manager.SolveExhaustive();
+    result.contests[i].Add(Clock::now() - start);
+  }
+}
+
+static void
+ParseCommandLine(Args &args, Options &options,
+                 std::vector<std::string> &files, std::string &terrain_path)
+{
+  while (!args.IsEmpty()) {
+    const char *arg = args.GetNext();
+
+    if (const char *value = StringAfterPrefix(arg, "--threads=")) {
+      options.n_threads = strtoul(value, nullptr, 10);
+    } else if (const char *value = StringAfterPrefix(arg, "--repeat=")) {
+      options.repeat = std::max(1UL, strtoul(value, nullptr, 10));
+    } else if (const char *value = StringAfterPrefix(arg, "--terrain=")) {
+      terrain_path = value;
+    } else if (const char *value = StringAfterPrefix(arg, "--contest=")) {
+      options.contest = ParseContest(value);
+    } else if (StringIsEqual(arg, "--no-solvers")) {
+      options.solvers = false;
+    } else if (*arg == '-') {
+      args.UsageError();
+    } else
+      files.emplace_back(arg);
+  }
+
+  if (files.empty())
+    args.UsageError();
+}
+
+int
+main(int argc, char **argv)
+try {
+  Args args(argc, argv,
+            "[--threads=N] [--repeat=N] [--terrain=FILE.xcm] "
+            "[--contest=NAME] [--no-solvers] FILE.igc ...");
+
+  Options options;
+  std::vector<std::string> files;
+  std::string terrain_path;
+  ParseCommandLine(args, options, files, terrain_path);
+
+  /* the terrain is shared by all flights, just like the map and the
+     calculation thread share it */
+  std::unique_ptr<RasterTerrain> terrain;
+  if (!terrain_path.empty()) {
+    NullOperationEnvironment operation;
+    terrain = RasterTerrain::OpenTerrain(nullptr, Path(terrain_path.c_str()),
+                                         operation);
+  }
+
+  const unsigned n_flights = files.size() * options.repeat;
+  std::vector<FlightResult> results(n_flights);
+
+  const unsigned n_threads = options.n_threads > 0
+    ? options.n_threads
+    : GetProcessorCount();
+
+  const auto start = Clock::now();
+  ParallelFor(n_flights, [&](unsigned i){
+    ReplayFlight(Path(files[i % files.size()].c_str()), terrain.get(),
+                 options, results[i]);
+  }, n_threads);
+  const double wall = std::chrono::duration<double>(Clock::now() - start).count();
+
+  FlightResult total;
+  unsigned n_errors = 0;
+  for (const auto &i : results) {
+    total.gps.Add(i.gps);
+    total.idle.Add(i.idle);
+    for (std::size_t j = 0; j < N_CONTESTS; ++j)
+      total.contests[j].Add(i.contests[j]);
+    total.n_fixes += i.n_fixes;
+    if (i.error)
+      ++n_errors;
+  }
+
+  printf("flights\t%u\n", n_flights);
+  printf("threads\t%u\n", std::min(n_threads, n_flights));
+  printf("fixes\t%lu\n", total.n_fixes);
+  printf("wall time [s]\t%.3f\n", wall);
+  printf("fixes/s\t%.0f\n", total.n_fixes / wall);
+  printf("fixes/s per thread\t%.0f\n",
+         total.n_fixes / (total.gps.GetSeconds() + total.idle.GetSeconds()));
+
+  printf("\n%-24s %9s %11s %11s %11s %11s %11s\n",
+         "stage [ns]", "count", "mean", "p50", "p90", "p99", "max");
+  total.gps.Print("ProcessGPS");
+  total.idle.Print("ProcessIdle");
+  for (std::size_t i = 0; i < N_CONTESTS; ++i)
+    total.contests[i].Print(ContestToString(ALL_CONTESTS[i]));
+
+  total.gps.PrintBuckets("ProcessGPS");
+  total.idle.PrintBuckets("ProcessIdle");
+
+  if (n_errors > 0) {
+    fprintf(stderr, "%u flights could not be loaded\n", n_errors);
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
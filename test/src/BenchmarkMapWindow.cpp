@@ -0,0 +1,375 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Render the moving map along a fixed camera path (pan, zoom, rotate)
+ * without user interaction, and report the duration of each frame
+ * and of each #MapLayer.  Terrain, topography, airspace and waypoints
+ * are loaded from one map file; the default is the Benalla fixture
+ * from test/data.
+ *
+ * The frames are rendered with the memory canvas into an image
+ * buffer, so no display is needed (e.g. "make VFB=y").  The program
+ * is built only with the memory canvas: OpenGL would need a headless
+ * (surfaceless EGL or OSMesa) context, which this tool does not
+ * create.
+ *
+ * With --dump=DIR, each frame is written to DIR as a PPM file, to
+ * compare the output of two builds pixel by pixel.
+ *
+ * --renderer=deferred rasterises the frames in parallel bands (see MapWindow::SetDeferredRendering()); the
+ * default is "immediate", like in XCSoar.
+ */
+
+#define ENABLE_CMDLINE
+#define ENABLE_MAIN_WINDOW
+#define ENABLE_LOOK
+#define USAGE "[-WxH] [--frames=N] [--no-layers] [--renderer=immediate|deferred] [--dump=DIR] [FILE.xcm]\n" \
+  "Renders with the memory canvas only; OpenGL builds are not supported."
+#include "Main.hpp"
+#include "MapWindow/MapWindow.hpp"
+#include "MapWindow/FrameProfiler.hpp"
+#include "Terrain/RasterTerrain.hpp"
+#include "Topography/TopographyStore.hpp"
+#include "Blackboard/DeviceBlackboard.hpp"
+#include "Airspace/AirspaceParser.hpp"
+#include "Engine/Waypoint/Waypoints.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Waypoint/Factory.hpp"
+#include "Waypoint/WaypointFileType.hpp"
+#include "Waypoint/WaypointReader.hpp"
+#include "Operation/ConsoleOperationEnvironment.hpp"
+#include "io/ZipArchive.hpp"
+#include "io/ZipLineReader.hpp"
+#include "io/FileOutputStream.hxx"
+#include "io/BufferedOutputStream.hxx"
+#include "io/StdioOutputStream.hxx"
+#include "system/Path.hpp"
+#include "thread/Debug.hpp"
+#include "util/StringCompare.hxx"
+#include "util/StringFormat.hpp"
+
+#include "ui/canvas/Canvas.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <numeric>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+void
+DeviceBlackboard::SetStartupLocation([[maybe_unused]] const GeoPoint &loc,
+                                     [[maybe_unused]] const double alt) noexcept
+{
+}
+
+#ifndef NDEBUG
+
+bool
+InDrawThread()
+{
+  return InMainThread();
+}
+
+#endif
+
+static AllocatedPath map_path;
+static AllocatedPath dump_path;
+static unsigned n_frames = 64;
+static bool profile_layers = true;
+static bool deferred = false;
+
+static void
+ParseCommandLine(Args &args)
+{
+  while (!args.IsEmpty()) {
+    const char *arg = args.GetNext();
+
+    if (const char *value = StringAfterPrefix(arg, "--frames=")) {
+      n_frames = std::max(1UL, strtoul(value, nullptr, 10));
+    } else if (StringIsEqual(arg, "--no-layers")) {
+      profile_layers = false;
+    } else if (StringIsEqual(arg, "--renderer=immediate")) {
+      deferred = false;
+    } else if (StringIsEqual(arg, "--renderer=deferred")) {
+      deferred = true;
+    } else if (const char *value = StringAfterPrefix(arg, "--dump=")) {
+      dump_path = Path(value);
+    } else if (*arg != '-' && map_path == nullptr) {
+      map_path = Path(arg);
+    } else
+      args.UsageError();
+  }
+
+  if (map_path == nullptr)
+    map_path = Path("test/data/benalla9.xcm");
+}
+
+struct View {
+  GeoPoint location;
+
+  /**
+   * The width of the screen [m], see MapWindowProjection::SetMapScale().
+   */
+  double scale;
+
+  Angle angle;
+};
+
+/**
+ * The camera path: pan east, zoom out and back in, rotate once, and
+ * finally all of it at the same time.  Each part takes a quarter of
+ * the frames.
+ */
+[[gnu::pure]]
+static View
+GetView(const GeoPoint center, unsigned frame) noexcept
+{
+  const unsigned part_length = std::max(n_frames / 4, 1U);
+  const unsigned part = std::min(frame / part_length, 3U);
+  const double t = std::min(double(frame - part * part_length) / part_length,
+                            1.);
+  const double wave = std::sin(t * M_PI);
+
+  View view{center, 10000, Angle::Zero()};
+
+  switch (part) {
+  case 0:
+    view.location.longitude += Angle::Degrees(0.2 * t);
+    break;
+
+  case 1:
+    view.scale *= std::pow(20, wave);
+    break;
+
+  case 2:
+    view.angle = Angle::FullCircle() * t;
+    break;
+
+  case 3:
+    view.location.longitude -= Angle::Degrees(0.2 * t);
+    view.location.latitude += Angle::Degrees(0.1 * wave);
+    view.scale *= std::pow(4, wave);
+    view.angle = -Angle::FullCircle() * t;
+    break;
+  }
+
+  return view;
+}
+
+class BenchmarkMapWindow final : public MapWindow {
+public:
+  using MapWindow::MapWindow;
+
+  void SetView(const View &view) noexcept {
+    visible_projection.SetGeoLocation(view.location);
+    visible_projection.SetMapScale(view.scale);
+    visible_projection.SetScreenAngle(view.angle);
+    visible_projection.UpdateScreenBounds();
+  }
+
+  /**
+   * Load the topography shapes and terrain tiles for the current
+   * view.  The draw thread does this between two frames.
+   */
+  void Update() noexcept {
+    UpdateTopography();
+    while (UpdateTerrain()) {}
+  }
+
+  /**
+   * Render one frame, like the draw thread does.
+   */
+  void RenderFrame(Canvas &canvas) noexcept {
+    const std::lock_guard lock{mutex};
+    OnPaintBuffer(canvas);
+  }
+};
+
+static void
+GenerateBlackboard(BenchmarkMapWindow &map, GeoPoint location,
+                   const ComputerSettings &settings_computer,
+                   const MapSettings &settings_map) noexcept
+{
+  MoreData nmea_info;
+  DerivedInfo derived_info;
+
+  nmea_info.Reset();
+  nmea_info.clock = TimeStamp{FloatDuration{1}};
+  nmea_info.time = TimeStamp{FloatDuration{1297230000}};
+  nmea_info.alive.Update(nmea_info.clock);
+  nmea_info.location = location;
+  nmea_info.location_available.Update(nmea_info.clock);
+  nmea_info.track = Angle::Degrees(90);
+  nmea_info.track_available.Update(nmea_info.clock);
+  nmea_info.ground_speed = 50;
+  nmea_info.ground_speed_available.Update(nmea_info.clock);
+  nmea_info.gps_altitude = 1500;
+  nmea_info.gps_altitude_available.Update(nmea_info.clock);
+
+  derived_info.Reset();
+  derived_info.terrain_valid = true;
+
+  map.ReadBlackboard(nmea_info, derived_info, settings_computer,
+                     settings_map);
+}
+
+/**
+ * Write a frame as binary PPM.
+ *
+ * @param pixel a function returning the RGB value of the given pixel
+ */
+template<typename F>
+static void
+WritePPM(Path path, PixelSize size, F &&pixel)
+{
+  FileOutputStream file{path};
+  BufferedOutputStream os{file};
+
+  os.Fmt("P6\n{} {}\n255\n", size.width, size.height);
+
+  for (unsigned y = 0; y < size.height; ++y) {
+    for (unsigned x = 0; x < size.width; ++x) {
+      const auto [r, g, b] = pixel(x, y);
+      os.Write(char(r));
+      os.Write(char(g));
+      os.Write(char(b));
+    }
+  }
+
+  os.Flush();
+  file.Commit();
+}
+
+struct RGB {
+  uint8_t r, g, b;
+};
+
+[[gnu::const]]
+static RGB
+ToRGB(ActivePixelTraits::color_type c) noexcept
+{
+#ifdef GREYSCALE
+  const uint8_t l = c.GetLuminosity();
+  return {l, l, l};
+#else
+  return {c.Red(), c.Green(), c.Blue()};
+#endif
+}
+
+void
+Main(TestMainWindow &main_window)
+{
+  ConsoleOperationEnvironment operation;
+
+  /* the TopographyFile instances read from the archive while
+     rendering, so it must stay open */
+  ZipArchive archive{map_path};
+
+  TopographyStore topography;
+  {
+    ZipLineReaderA reader(archive.get(), "topology.tpl");
+    topography.Load(operation, reader, nullptr, archive.get());
+  }
+
+  auto terrain = RasterTerrain::OpenTerrain(nullptr, map_path, operation);
+
+  Waypoints way_points;
+  if (archive.Exists("waypoints.xcw")) {
+    ReadWaypointFile(archive.get(), "waypoints.xcw",
+                     WaypointFileType::WINPILOT, way_points,
+                     WaypointFactory(WaypointOrigin::MAP, terrain.get()),
+                     operation);
+    way_points.Optimise();
+  }
+
+  Airspaces airspaces;
+  if (archive.Exists("airspace.txt")) {
+    ZipLineReader reader(archive.get(), "airspace.txt", Charset::AUTO);
+    ParseAirspaceFile(airspaces, reader, operation);
+    airspaces.Optimise();
+  }
+
+  ComputerSettings settings_computer;
+  settings_computer.SetDefaults();
+
+  MapSettings settings_map;
+  settings_map.SetDefaults();
+
+  const GeoPoint center = terrain->GetTerrainCenter();
+
+  BenchmarkMapWindow map(look->map, look->traffic);
+  map.SetWaypoints(&way_points);
+  map.SetAirspaces(&airspaces);
+  map.SetTopography(&topography);
+  map.SetTerrain(terrain.get());
+  map.Create(main_window, main_window.GetClientRect());
+  main_window.SetFullWindow(map);
+
+  GenerateBlackboard(map, center, settings_computer, settings_map);
+
+  auto &profiler = map.GetFrameProfiler();
+  profiler.SetEnabled(profile_layers);
+
+  map.SetDeferredRendering(deferred);
+
+  const PixelSize size = map.GetSize();
+
+  WritableImageBuffer<ActivePixelTraits> buffer;
+  buffer.Allocate(size.width, size.height);
+  Canvas canvas{buffer};
+
+  printf("%ux%u, %u frames, %s renderer\n", size.width, size.height, n_frames,
+         deferred ? "deferred" : "immediate");
+  printf("frame\tupdate [ms]\trender [ms]\n");
+
+  std::vector<double> durations;
+
+  for (unsigned i = 0; i < n_frames; ++i) {
+    map.SetView(GetView(center, i));
+
+    const auto update_start = Clock::now();
+    map.Update();
+
+    const auto render_start = Clock::now();
+    map.RenderFrame(canvas);
+    const auto render_end = Clock::now();
+
+    const std::chrono::duration<double, std::milli> update =
+      render_start - update_start;
+    const std::chrono::duration<double, std::milli> render =
+      render_end - render_start;
+    durations.push_back(render.count());
+    printf("%u\t%.2f\t%.2f\n", i, update.count(), render.count());
+
+    if (dump_path != nullptr) {
+      TCHAR name[32];
+      StringFormatUnsafe(name, _T("frame-%03u.ppm"), i);
+      const auto path = AllocatedPath::Build(dump_path, name);
+
+      WritePPM(path, size, [&](unsigned x, unsigned y){
+        return ToRGB(*buffer.At(x, y));
+      });
+    }
+  }
+
+  std::sort(durations.begin(), durations.end());
+  const double sum = std::accumulate(durations.begin(), durations.end(), 0.);
+  printf("\nrender [ms]: mean %.2f, median %.2f, max %.2f\n",
+         sum / durations.size(), durations[durations.size() / 2],
+         durations.back());
+
+  if (profile_layers) {
+    /* the profiler keeps only the most recent frames */
+    printf("\n");
+    StdioOutputStream stdout_os{stdout};
+    BufferedOutputStream os{stdout_os};
+    profiler.Write(os);
+    os.Flush();
+  }
+
+  buffer.Free();
+}
@@ -0,0 +1,204 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Measure the throughput of the tone synthesiser kernel (compared
+ * with the original per-sample loop) and the duration of simulated
+ * audio callbacks of #VarioSynthesiser while another thread keeps
+ * posting new vario values.
+ */
+
+#include "Audio/VarioSynthesiser.hpp"
+#include "Math/FastTrig.hpp"
+#include "system/Args.hpp"
+#include "util/StringCompare.hxx"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr unsigned sample_rate = 44100;
+
+struct Options {
+  /**
+   * The number of samples per audio callback.
+   */
+  unsigned buffer_size = 512;
+
+  /**
+   * The duration of synthesised audio per test [s].
+   */
+  unsigned seconds = 600;
+
+  /**
+   * The rate of SetVario() calls [Hz]; 0 means as fast as possible,
+   * which stresses the parameter mailbox.
+   */
+  unsigned update_rate = 0;
+};
+
+/**
+ * The per-sample implementation which was used before the block
+ * kernel, for comparison.
+ */
+class ReferenceToneSynthesiser {
+  unsigned volume = 100, angle = 0, increment = 0;
+
+public:
+  void SetTone(unsigned tone_hz) noexcept {
+    increment = ISINETABLE.size() * tone_hz / sample_rate;
+  }
+
+  void Synthesise(int16_t *buffer, size_t n) noexcept {
+    for (int16_t *end = buffer + n; buffer != end; ++buffer) {
+      *buffer = ISINETABLE[angle] * (32767 / 1024) * (int)volume / 100;
+      angle = (angle + increment) & (ISINETABLE.size() - 1);
+    }
+  }
+};
+
+/**
+ * Prevent the compiler from discarding the synthesised samples.
+ */
+static volatile int16_t sink;
+
+template<typename S>
+static double
+MeasureThroughput(S &synthesiser, const Options &options) noexcept
+{
+  std::vector<int16_t> buffer(options.buffer_size);
+  const unsigned long n_callbacks =
+    (unsigned long)options.seconds * sample_rate / options.buffer_size;
+
+  const auto start = Clock::now();
+  for (unsigned long i = 0; i < n_callbacks; ++i) {
+    synthesiser.Synthesise(buffer.data(), buffer.size());
+    sink = buffer[i % buffer.size()];
+  }
+
+  const double wall = std::chrono::duration<double>(Clock::now() - start).count();
+  return n_callbacks * options.buffer_size / wall;
+}
+
+static void
+PrintThroughput(const char *name, double samples_per_second) noexcept
+{
+  printf("%-12s %8.2f Msamples/s  %8.0fx realtime\n",
+         name, samples_per_second / 1e6, samples_per_second / sample_rate);
+}
+
+/**
+ * Post a slowly oscillating vario value until #stop is set.
+ */
+static void
+UpdateVario(VarioSynthesiser &synthesiser, const Options &options,
+            const std::atomic_bool &stop, unsigned long &n_updates) noexcept
+{
+  const auto interval = options.update_rate > 0
+    ? std::chrono::microseconds(1000000 / options.update_rate)
+    : std::chrono::microseconds::zero();
+
+  while (!stop.load(std::memory_order_relaxed)) {
+    synthesiser.SetVario(4 * std::sin(n_updates * 0.01));
+    ++n_updates;
+
+    if (interval > interval.zero())
+      std::this_thread::sleep_for(interval);
+  }
+}
+
+static void
+MeasureCallbacks(const Options &options) noexcept
+{
+  VarioSynthesiser synthesiser(sample_rate);
+  synthesiser.SetVario(1);
+
+  std::atomic_bool stop{false};
+  unsigned long n_updates = 0;
+  std::thread updater(UpdateVario, std::ref(synthesiser), std::cref(options),
+                      std::cref(stop), std::ref(n_updates));
+
+  std::vector<int16_t> buffer(options.buffer_size);
+  const unsigned long n_callbacks =
+    (unsigned long)options.seconds * sample_rate / options.buffer_size;
+  std::vector<uint32_t> durations(n_callbacks);
+
+  for (unsigned long i = 0; i < n_callbacks; ++i) {
+    const auto start = Clock::now();
+    synthesiser.Synthesise(buffer.data(), buffer.size());
+    durations[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    sink = buffer[i % buffer.size()];
+  }
+
+  stop = true;
+  updater.join();
+
+  unsigned long long sum = 0;
+  for (const auto i : durations)
+    sum += i;
+
+  std::sort(durations.begin(), durations.end());
+
+  const double deadline_us = options.buffer_size * 1e6 / sample_rate;
+
+  printf("\n%lu callbacks of %u samples (deadline %.0f us), %lu vario updates\n",
+         n_callbacks, options.buffer_size, deadline_us, n_updates);
+  printf("mean %.2f us  p50 %.2f us  p99 %.2f us  p99.9 %.2f us  max %.2f us\n",
+         sum / 1000. / n_callbacks,
+         durations[n_callbacks / 2] / 1000.,
+         durations[n_callbacks * 99 / 100] / 1000.,
+         durations[n_callbacks * 999 / 1000] / 1000.,
+         durations.back() / 1000.);
+  printf("worst case uses %.2f%% of the deadline\n",
+         durations.back() / 10. / deadline_us);
+}
+
+static void
+ParseCommandLine(Args &args, Options &options)
+{
+  while (!args.IsEmpty()) {
+    const char *arg = args.GetNext();
+
+    if (const char *value = StringAfterPrefix(arg, "--buffer=")) {
+      options.buffer_size = std::max(1UL, strtoul(value, nullptr, 10));
+    } else if (const char *value = StringAfterPrefix(arg, "--seconds=")) {
+      options.seconds = std::max(1UL, strtoul(value, nullptr, 10));
+    } else if (const char *value = StringAfterPrefix(arg, "--updates=")) {
+      options.update_rate = strtoul(value, nullptr, 10);
+    } else
+      args.UsageError();
+  }
+}
+
+int
+main(int argc, char **argv)
+{
+  Args args(argc, argv,
+            "[--buffer=SAMPLES] [--seconds=N] [--updates=HZ]");
+
+  Options options;
+  ParseCommandLine(args, options);
+
+  ReferenceToneSynthesiser reference;
+  reference.SetTone(1000);
+  PrintThroughput("per-sample", MeasureThroughput(reference, options));
+
+  ToneSynthesiser tone(sample_rate);
+  tone.SetTone(1000);
+  PrintThroughput("block", MeasureThroughput(tone, options));
+
+  VarioSynthesiser vario(sample_rate);
+  vario.SetVario(2);
+  PrintThroughput("vario", MeasureThroughput(vario, options));
+
+  MeasureCallbacks(options);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,147 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Regression test for AbortTask and AlternateTask: the lists
+ * calculated for a fixed set of landables must not change when the
+ * glide solver is optimised.  The expected values were recorded with
+ * the per-candidate solver which AbortTask used before
+ * SolveCandidates() was introduced.
+ */
+
+#include "Engine/Task/Unordered/AlternateTask.hpp"
+#include "Engine/Task/TaskBehaviour.hpp"
+#include "Engine/GlideSolvers/GlidePolar.hpp"
+#include "Engine/Navigation/Aircraft.hpp"
+#include "Engine/Waypoint/Waypoints.hpp"
+#include "Geo/GeoVector.hpp"
+#include "util/StaticString.hxx"
+#include "TestUtil.hpp"
+
+#include <string.h>
+
+static const GeoPoint center(Angle::Degrees(7.85), Angle::Degrees(51.4));
+
+/**
+ * Add a deterministic pattern of airfields, outlandings and (not
+ * landable) turn points at various distances and elevations.
+ */
+static void
+AddWaypoints(Waypoints &waypoints)
+{
+  for (unsigned i = 0; i < 60; ++i) {
+    const GeoVector vector(2000. + 1500. * i,
+                           Angle::Degrees((i * 137) % 360));
+
+    Waypoint waypoint{vector.EndPoint(center)};
+    waypoint.origin = WaypointOrigin::PRIMARY;
+    waypoint.elevation = (i * 53) % 700;
+    waypoint.has_elevation = true;
+
+    StaticString<16> name;
+    if (i % 3 == 0) {
+      name.Format(_T("A%u"), i);
+      waypoint.type = Waypoint::Type::AIRFIELD;
+      waypoint.flags.turn_point = true;
+    } else if (i % 3 == 1) {
+      name.Format(_T("L%u"), i);
+      waypoint.type = Waypoint::Type::OUTLANDING;
+    } else {
+      name.Format(_T("T%u"), i);
+      waypoint.flags.turn_point = true;
+    }
+
+    waypoint.name = name;
+    waypoints.Append(std::move(waypoint));
+  }
+
+  waypoints.Optimise();
+}
+
+struct Scenario {
+  double altitude, mc, wind_speed;
+
+  /**
+   * The AbortTask points in order, then the alternates with their
+   * altitude difference [m].
+   */
+  const char *expected;
+};
+
+static constexpr Scenario scenarios[] = {
+  { 400, 0, 0,
+    "A0 L1 A3 L4 A6 L7 A9 L10 A12 L13 |"
+    " A0:54 A3:-209 L1:-34 A6:-471 L4:-296 L13:-1084" },
+  { 800, 0, 0,
+    "A0 A3 L1 L4 A6 L7 A9 L10 A12 L13 |"
+    " A3:191 A0:454 L1:366 L4:104 A6:-71 L13:-684" },
+  { 800, 2, 0,
+    "A0 A3 L1 L4 A6 L7 A9 L10 A12 L13 |"
+    " A3:143 A0:439 L1:340 L4:44 A6:-153 L13:-844" },
+  { 1500, 1, 0,
+    "A0 A3 A6 A9 A12 A15 A18 A27 L1 L4 |"
+    " A3:874 A0:1149 L1:1057 A6:600 L4:783 A9:326" },
+  { 1500, 1, 10,
+    "A0 A3 A6 A9 A15 A27 A18 L1 L4 L7 |"
+    " A3:898 A0:1147 L1:1068 A6:651 L4:771 A9:356" },
+  { 2500, 3, 15,
+    "A0 A3 A6 A9 A12 A24 A15 A27 A21 A18 |"
+    " A3:1845 A24:469 A0:2126 A6:1566 A21:526 A9:1213" },
+};
+
+static void
+Format(const AlternateTask &task, StaticString<1024> &buffer)
+{
+  buffer.clear();
+
+  for (unsigned i = 0; i < task.TaskSize(); ++i)
+    buffer.AppendFormat(_T("%s "), task.GetAlternate(i).GetWaypoint().name.c_str());
+
+  buffer.append(_T("|"));
+
+  for (const auto &i : task.GetAlternates())
+    buffer.AppendFormat(_T(" %s:%.0f"), i.waypoint->name.c_str(),
+                        i.solution.altitude_difference);
+}
+
+int
+main()
+{
+  plan_tests(std::size(scenarios));
+
+  Waypoints waypoints;
+  AddWaypoints(waypoints);
+
+  TaskBehaviour task_behaviour;
+  task_behaviour.SetDefaults();
+
+  for (const auto &scenario : scenarios) {
+    const GlidePolar glide_polar(scenario.mc);
+
+    AircraftState state;
+    state.Reset();
+    state.location = center;
+    state.altitude = scenario.altitude;
+    state.flying = true;
+    state.time = TimeStamp{FloatDuration{36000}};
+    state.wind = SpeedVector(Angle::Degrees(270), scenario.wind_speed);
+
+    /* inactive, as the TaskManager keeps it while an ordered task
+       is being flown */
+    AlternateTask task(task_behaviour, waypoints);
+    task.SetActive(false);
+    task.SetTaskDestination(GeoVector(60000, Angle::Degrees(45))
+                            .EndPoint(center));
+    task.Update(state, state, glide_polar);
+
+    StaticString<1024> actual;
+    Format(task, actual);
+
+    if (!ok(strcmp(actual, scenario.expected) == 0,
+            "altitude=%.0f mc=%.0f wind=%.0f",
+            scenario.altitude, scenario.mc, scenario.wind_speed))
+      diag("\"%s\"", actual.c_str());
+  }
+
+  return exit_status();
+}
@@ -0,0 +1,216 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "ui/canvas/Canvas.hpp"
+#include "ui/canvas/SubCanvas.hpp"
+#include "ui/canvas/memory/CommandList.hpp"
+#include "Screen/Debug.hpp"
+#include "Math/Angle.hpp"
+#include "TestUtil.hpp"
+
+#include <cstring>
+#include <vector>
+
+static constexpr unsigned width = 317, height = 233;
+
+using Buffer = WritableImageBuffer<ActivePixelTraits>;
+
+/**
+ * A deterministic pseudo-random number generator, so all passes draw
+ * the same scene.
+ */
+class Random {
+  uint32_t state = 42;
+
+public:
+  unsigned operator()(unsigned max) noexcept {
+    state = state * 1103515245 + 12345;
+    return (state >> 8) % max;
+  }
+
+  int Coordinate(unsigned max) noexcept {
+    /* some points are outside of the canvas */
+    return int((*this)(max + 80)) - 40;
+  }
+
+  Color NextColor() noexcept {
+    return Color((*this)(256), (*this)(256), (*this)(256));
+  }
+};
+
+static void
+FillSource(Buffer &src) noexcept
+{
+  Canvas canvas(src);
+  canvas.ClearWhite();
+
+  Random random;
+  for (unsigned i = 0; i < 10; ++i) {
+    canvas.Select(Brush(random.NextColor()));
+    canvas.SelectNullPen();
+    canvas.DrawCircle({random.Coordinate(src.width),
+                       random.Coordinate(src.height)},
+                      random(20) + 2);
+  }
+}
+
+static void
+DrawScene(Canvas &canvas, Canvas &scratch,
+          ConstImageBuffer<ActivePixelTraits> src) noexcept
+{
+  Random random;
+
+  canvas.Clear(COLOR_WHITE);
+
+  std::vector<BulkPixelPoint> points;
+  for (unsigned i = 0; i < 40; ++i) {
+    points.resize(3 + random(10));
+    for (auto &p : points)
+      p = {random.Coordinate(width), random.Coordinate(height)};
+
+    if (random(4) == 0)
+      canvas.SelectHollowBrush();
+    else if (random(3) == 0)
+      canvas.Select(Brush(random.NextColor().WithAlpha(random(256))));
+    else
+      canvas.Select(Brush(random.NextColor()));
+
+    canvas.Select(Pen(random(2) ? Pen::SOLID : Pen::DASH1,
+                      random(5), random.NextColor()));
+
+    if (random(3) == 0)
+      canvas.DrawPolyline(points.data(), points.size());
+    else
+      canvas.DrawPolygon(points.data(), points.size());
+
+    /* the caller may reuse its point buffer immediately */
+    for (auto &p : points)
+      p = {0, 0};
+  }
+
+  for (unsigned i = 0; i < 30; ++i) {
+    canvas.Select(Pen(random(2) ? Pen::SOLID : Pen::DASH1,
+                      1 + random(4), random.NextColor()));
+    canvas.DrawLine({random.Coordinate(width), random.Coordinate(height)},
+                    {random.Coordinate(width), random.Coordinate(height)});
+  }
+
+  for (unsigned i = 0; i < 20; ++i) {
+    canvas.Select(Pen(1 + random(3), random.NextColor()));
+    if (random(3) == 0)
+      canvas.SelectHollowBrush();
+    else
+      canvas.Select(Brush(random.NextColor().WithAlpha(128 + random(128))));
+
+    canvas.DrawCircle({random.Coordinate(width), random.Coordinate(height)},
+                      random(60));
+  }
+
+  canvas.Select(Brush(COLOR_YELLOW));
+  canvas.Select(Pen(2, COLOR_BLACK));
+  canvas.DrawSegment({150, 120}, 70, Angle::Degrees(20), Angle::Degrees(200));
+  canvas.DrawAnnulus({100, 80}, 20, 50,
+                     Angle::Degrees(-30), Angle::Degrees(90));
+
+  /* image operations */
+  canvas.Copy({-20, 150}, {100, 90}, src, {10, 5});
+  canvas.Stretch({200, 10}, {150, 230}, src, {3, 7}, {50, 40});
+  canvas.CopyOr({30, 40}, {60, 60}, src, {0, 0});
+  canvas.CopyAnd({90, 170}, {60, 60}, src, {20, 20});
+  canvas.AlphaBlend({160, 90}, {80, 80}, src, {0, 0}, {80, 80}, 100);
+
+  /* the scratch canvas is modified after it has been copied; the
+     command list must have copied its pixels */
+  scratch.ClearWhite();
+  scratch.Select(Brush(COLOR_RED));
+  scratch.SelectNullPen();
+  scratch.DrawCircle({40, 40}, 30);
+  canvas.CopyTransparentWhite({250, 160}, {80, 80}, scratch, {0, 0});
+  scratch.Clear(COLOR_BLUE);
+
+  /* reads pixels drawn by previous commands */
+  canvas.InvertRectangle({100, 100, 220, 190});
+
+  {
+    SubCanvas sub(canvas, {40, 90}, {100, 100});
+    sub.Select(Brush(COLOR_GREEN));
+    sub.Select(Pen(3, COLOR_BLUE));
+    sub.DrawCircle({50, 50}, 45);
+    sub.DrawLine({0, 0}, {100, 100});
+  }
+
+  canvas.Select(Pen(1, COLOR_BLACK));
+  canvas.DrawOutlineRectangle({5, 5, 300, 220}, COLOR_RED);
+  canvas.DrawHLine(0, width, height / 2, COLOR_BLACK);
+}
+
+static bool
+Equals(const Buffer &a, const Buffer &b) noexcept
+{
+  for (unsigned y = 0; y < height; ++y)
+    if (std::memcmp(a.At(0, y), b.At(0, y),
+                    width * sizeof(*a.data)) != 0)
+      return false;
+
+  return true;
+}
+
+int main()
+{
+  static constexpr unsigned thread_counts[] = {1, 2, 3, 4, 8};
+
+  plan_tests(std::size(thread_counts) + 2);
+
+  /* the memory canvas doesn't need any global initialisation */
+  ScreenInitialized();
+
+  Buffer src, scratch_buffer, expected, actual;
+  src.Allocate(120, 100);
+  scratch_buffer.Allocate(80, 80);
+  expected.Allocate(width, height);
+  actual.Allocate(width, height);
+
+  FillSource(src);
+
+  Canvas scratch(scratch_buffer);
+
+  Canvas expected_canvas(expected);
+  DrawScene(expected_canvas, scratch, src);
+
+  CanvasCommandList list;
+
+  for (const unsigned n : thread_counts) {
+    list.SetMaxThreads(n);
+
+    Canvas canvas(actual);
+    canvas.Clear(COLOR_BLACK);
+
+    canvas.BeginDeferred(list);
+    DrawScene(canvas, scratch, src);
+    canvas.EndDeferred();
+
+    ok(Equals(expected, actual), "deferred with %u threads", n);
+  }
+
+  /* operations outside of the buffer are not recorded */
+  {
+    Canvas canvas(actual);
+    canvas.BeginDeferred(list);
+    canvas.Select(Brush(COLOR_BLACK));
+    canvas.SelectNullPen();
+    canvas.DrawCircle({0, -500}, 100);
+    ok1(list.IsEmpty());
+    canvas.DrawCircle({0, 0}, 100);
+    ok1(list.GetSize() == 1);
+    canvas.EndDeferred();
+  }
+
+  src.Free();
+  scratch_buffer.Free();
+  expected.Free();
+  actual.Free();
+
+  ScreenDeinitialized();
+
+  return exit_status();
+}
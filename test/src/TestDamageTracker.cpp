@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "ui/canvas/memory/Damage.hpp"
+#include "TestUtil.hpp"
+
+#include <array>
+#include <cstdint>
+
+static constexpr unsigned width = 100, height = 70;
+
+/* deliberately larger than the width to test the pitch */
+static constexpr std::size_t pitch = 128;
+
+static std::array<uint8_t, pitch * height> frame;
+
+static std::span<const PixelRect>
+Update(DamageTracker &damage) noexcept
+{
+  return damage.Update(frame.data(), pitch, width, height, 1);
+}
+
+static bool
+Equals(const PixelRect &a, const PixelRect &b) noexcept
+{
+  return a.left == b.left && a.top == b.top &&
+    a.right == b.right && a.bottom == b.bottom;
+}
+
+int main()
+{
+  plan_tests(21);
+
+  DamageTracker damage;
+
+  /* the first frame is damaged completely */
+  auto rects = Update(damage);
+  ok1(rects.size() == 1);
+  ok1(Equals(rects[0], PixelRect(0, 0, width, height)));
+
+  /* nothing has changed */
+  ok1(Update(damage).empty());
+
+  /* changes in the padding beyond the width are ignored */
+  frame[pitch - 1] = 0xff;
+  ok1(Update(damage).empty());
+
+  /* one pixel: one tile */
+  frame[40 * pitch + 33] = 0xff;
+  rects = Update(damage);
+  ok1(rects.size() == 1);
+  ok1(Equals(rects[0], PixelRect(32, 32, 64, 64)));
+
+  ok1(Update(damage).empty());
+
+  /* the right and bottom tiles are clipped */
+  frame[69 * pitch + 99] = 0xff;
+  rects = Update(damage);
+  ok1(rects.size() == 1);
+  ok1(Equals(rects[0], PixelRect(96, 64, 100, 70)));
+
+  /* adjacent tiles in one row are merged horizontally, tile rows
+     with the same extent vertically */
+  frame[10 * pitch + 1] = 1;
+  frame[10 * pitch + 40] = 1;
+  frame[50 * pitch + 1] = 1;
+  frame[50 * pitch + 40] = 1;
+  rects = Update(damage);
+  ok1(rects.size() == 1);
+  ok1(Equals(rects[0], PixelRect(0, 0, 64, 64)));
+
+  /* different extents are not merged */
+  frame[10 * pitch + 1] = 2;
+  frame[50 * pitch + 70] = 2;
+  rects = Update(damage);
+  ok1(rects.size() == 2);
+  ok1(Equals(rects[0], PixelRect(0, 0, 32, 32)));
+  ok1(Equals(rects[1], PixelRect(64, 32, 96, 64)));
+
+  /* the copy of the previous frame was updated with the change */
+  frame[50 * pitch + 70] = 3;
+  rects = Update(damage);
+  ok1(rects.size() == 1);
+  ok1(Equals(rects[0], PixelRect(64, 32, 96, 64)));
+
+  /* Reset() damages the whole frame */
+  damage.Reset();
+  rects = Update(damage);
+  ok1(rects.size() == 1);
+  ok1(Equals(rects[0], PixelRect(0, 0, width, height)));
+
+  /* too many rectangles collapse into their bounding box */
+  DamageTracker small;
+  std::array<uint8_t, 320 * 40> wide{};
+  small.Update(wide.data(), 320, 320, 40, 1);
+  for (unsigned i = 0; i < 5; ++i) {
+    wide[i * 64] = 1;
+    wide[32 * 320 + i * 64 + 32] = 1;
+  }
+
+  rects = small.Update(wide.data(), 320, 320, 40, 1);
+  ok1(rects.size() == 1);
+  ok1(Equals(rects[0], PixelRect(0, 0, 320, 40)));
+
+  /* a new size damages everything */
+  rects = small.Update(wide.data(), 320, 160, 40, 1);
+  ok1(rects.size() == 1 && Equals(rects[0], PixelRect(0, 0, 160, 40)));
+
+  return exit_status();
+}
@@ -0,0 +1,128 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "ui/canvas/memory/Dither.hpp"
+#include "TestUtil.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static constexpr unsigned width = 101, height = 37;
+
+static std::vector<uint8_t>
+Fill(uint8_t value) noexcept
+{
+  return std::vector<uint8_t>(width * height, value);
+}
+
+static std::vector<uint8_t>
+Gradient() noexcept
+{
+  std::vector<uint8_t> v(width * height);
+  for (unsigned y = 0; y < height; ++y)
+    for (unsigned x = 0; x < width; ++x)
+      v[y * width + x] = (x * 255 / (width - 1) + y * 3) & 0xff;
+  return v;
+}
+
+template<typename T>
+static std::vector<T>
+Run(Dither &dither, const std::vector<uint8_t> &src) noexcept
+{
+  std::vector<T> dest(width * height, 0x42);
+  dither.DitherGreyscale(src.data(), width,
+                         dest.data(), width * sizeof(T),
+                         width, height);
+  return dest;
+}
+
+/**
+ * Returns the number of white pixels, or -1 if there is a pixel
+ * which is neither black nor white.
+ */
+static int
+CountWhite(const std::vector<uint8_t> &v) noexcept
+{
+  int n = 0;
+  for (const auto i : v) {
+    if (i == 0xff)
+      ++n;
+    else if (i != 0)
+      return -1;
+  }
+
+  return n;
+}
+
+/**
+ * Does the wide output contain the same pixels as the 8 bit output?
+ */
+template<typename T>
+static bool
+SameAs(const std::vector<T> &wide, const std::vector<uint8_t> &narrow) noexcept
+{
+  for (std::size_t i = 0; i < narrow.size(); ++i)
+    if (wide[i] != (narrow[i] != 0 ? T(~T(0)) : T(0)))
+      return false;
+
+  return true;
+}
+
+static void
+TestMode(Dither::Mode mode) noexcept
+{
+  Dither dither;
+  dither.SetMode(mode);
+
+  ok1(CountWhite(Run<uint8_t>(dither, Fill(0))) == 0);
+  ok1(CountWhite(Run<uint8_t>(dither, Fill(255))) == int(width * height));
+
+  /* mid grey yields half of the pixels white */
+  const int n = CountWhite(Run<uint8_t>(dither, Fill(128)));
+  ok1(n > 0 && std::abs(n - int(width * height / 2)) <= int(width));
+
+  const auto gradient = Gradient();
+  const auto narrow = Run<uint8_t>(dither, gradient);
+  ok1(CountWhite(narrow) >= 0);
+  ok1(SameAs(Run<uint16_t>(dither, gradient), narrow));
+  ok1(SameAs(Run<uint32_t>(dither, gradient), narrow));
+}
+
+/**
+ * The ordered pattern of a partial update equals the same region of a
+ * full update.
+ */
+static void
+TestOrderedPartial() noexcept
+{
+  Dither dither;
+  dither.SetMode(Dither::Mode::ORDERED);
+
+  const auto src = Gradient();
+  const auto full = Run<uint8_t>(dither, src);
+
+  static constexpr unsigned x = 13, y = 5, w = 40, h = 20;
+  std::vector<uint8_t> partial(w * h);
+  dither.DitherGreyscale(src.data() + y * width + x, width,
+                         partial.data(), w, w, h, x, y);
+
+  bool equal = true;
+  for (unsigned row = 0; row < h; ++row)
+    if (std::memcmp(partial.data() + row * w,
+                    full.data() + (y + row) * width + x, w) != 0)
+      equal = false;
+
+  ok1(equal);
+}
+
+int main()
+{
+  plan_tests(13);
+
+  TestMode(Dither::Mode::ERROR_DIFFUSION);
+  TestMode(Dither::Mode::ORDERED);
+  TestOrderedPartial();
+
+  return exit_status();
+}
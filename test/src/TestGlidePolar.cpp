@@ -20,6 +20,7 @@ private:
   void TestBallast();
   void TestBugs();
   void TestMC();
+  void TestSpeedToFly();
 };
 
 void
@@ -145,6 +146,50 @@ GlidePolarTest::TestMC()
   ok1(equals(polar.GetVBestLD(), 25.830434162));
 }
 
+/**
+ * Find the speed to fly by scanning the whole speed range.
+ */
+static double
+ScanSpeedToFly(const GlidePolar &polar, double net_sink_rate,
+               double head_wind)
+{
+  double best_v = polar.GetVMin(), best_f = 1e9;
+  for (double v = polar.GetVMin(); v <= polar.GetVMax(); v += 0.001) {
+    if (v - head_wind < 1)
+      continue;
+
+    const double f = (polar.MSinkRate(v) + net_sink_rate) / (v - head_wind);
+    if (f < best_f) {
+      best_f = f;
+      best_v = v;
+    }
+  }
+
+  return best_v;
+}
+
+void
+GlidePolarTest::TestSpeedToFly()
+{
+  polar.SetMC(0);
+  ok1(equals(polar.SpeedToFly(0, 0), polar.GetVBestLD()));
+  ok1(equals(polar.SpeedToFly(0, 5), polar.GetBestGlideRatioSpeed(5)));
+
+  polar.SetMC(2);
+  ok1(equals(polar.SpeedToFly(0, 0), polar.GetVBestLD()));
+  ok1(equals(polar.SpeedToFly(1, 0), ScanSpeedToFly(polar, 1, 0), 3));
+  ok1(equals(polar.SpeedToFly(2, -5), ScanSpeedToFly(polar, 2, -5), 3));
+  ok1(equals(polar.SpeedToFly(-1, 10), ScanSpeedToFly(polar, -1, 10), 3));
+
+  // strong lift: fly as slow as possible
+  ok1(equals(polar.SpeedToFly(-5, 0), polar.GetVMin()));
+
+  // strong sink: fly as fast as allowed
+  ok1(equals(polar.SpeedToFly(20, 0), polar.GetVMax()));
+
+  polar.SetMC(0);
+}
+
 void
 GlidePolarTest::Run()
 {
@@ -153,11 +198,12 @@ GlidePolarTest::Run()
   TestBallast();
   TestBugs();
   TestMC();
+  TestSpeedToFly();
 }
 
 int main()
 {
-  plan_tests(46);
+  plan_tests(54);
 
   GlidePolarTest test;
   test.Run();
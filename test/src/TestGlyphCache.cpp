@@ -0,0 +1,216 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Verify that Font::TextSize() and Font::Render() produce the same
+ * output with the #GlyphCache as laying out the text with FreeType
+ * directly, the way it was done before the cache existed.
+ */
+
+#include "ui/canvas/Font.hpp"
+#include "ui/canvas/freetype/GlyphCache.hpp"
+#include "Look/FontDescription.hpp"
+#include "Screen/Debug.hpp"
+#include "util/UTF8.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <memory>
+
+static constexpr const char *strings[] = {
+  "Hello World",
+  /* pairs which are kerned in most fonts */
+  "AVATAR Tower WAVE Yo To LT",
+  "1234.5 km/h -0.7 m/s",
+  "Größe Ärger ÉTÉ",
+  /* code points above GlyphCache::N_FAST */
+  "€ 100 ‰ “V”",
+  /* glyphs which the font doesn't have are skipped */
+  "A\xe2\xbf\xb0V",
+};
+
+/**
+ * Grants access to the FreeType face and allows replacing the glyph
+ * cache.
+ */
+class TestFont : public Font {
+public:
+  FT_Face GetFace() const noexcept {
+    return face;
+  }
+
+  void SetGlyphCache(GlyphCache *_glyphs) noexcept {
+    delete glyphs;
+    glyphs = _glyphs;
+  }
+};
+
+static constexpr FT_Long
+FT_FLOOR(FT_Long x) noexcept
+{
+  return (x & -64) / 64;
+}
+
+static constexpr FT_Long
+FT_CEIL(FT_Long x) noexcept
+{
+  return FT_FLOOR(x + 63);
+}
+
+/**
+ * The glyph layout loop of the old Font implementation, which loads
+ * each glyph with FreeType.
+ */
+template<typename F>
+static void
+ForEachGlyph(FT_Face face, FT_Int32 load_flags, unsigned ascent_height,
+             const char *text, F &&f) noexcept
+{
+  const bool use_kerning = FT_HAS_KERNING(face);
+
+  int x = 0;
+  FT_UInt prev_index = 0;
+
+  while (*text != 0) {
+    const auto n = NextUTF8(text);
+    text = n.second;
+
+    const FT_UInt i = FT_Get_Char_Index(face, n.first);
+    if (i == 0)
+      continue;
+
+    if (FT_Load_Glyph(face, i, load_flags))
+      continue;
+
+    const FT_GlyphSlot glyph = face->glyph;
+    const FT_Glyph_Metrics &metrics = glyph->metrics;
+
+    if (use_kerning) {
+      if (prev_index != 0) {
+        FT_Vector delta;
+        FT_Get_Kerning(face, prev_index, i, ft_kerning_default, &delta);
+        x += delta.x >> 6;
+      }
+
+      prev_index = i;
+    }
+
+    f(x + FT_FLOOR(metrics.horiBearingX),
+      int(ascent_height) - FT_FLOOR(metrics.horiBearingY),
+      glyph);
+
+    x += FT_CEIL(metrics.horiAdvance);
+  }
+}
+
+static PixelSize
+ReferenceTextSize(const TestFont &font, FT_Int32 load_flags,
+                  const char *text) noexcept
+{
+  int maxx = 0;
+
+  ForEachGlyph(font.GetFace(), load_flags, font.GetAscentHeight(), text,
+               [&maxx](int x, int, const FT_GlyphSlot glyph){
+      const FT_Glyph_Metrics &metrics = glyph->metrics;
+      const int glyph_minx = FT_FLOOR(metrics.horiBearingX);
+      const int glyph_maxx = glyph_minx + FT_CEIL(metrics.width);
+      maxx = std::max(maxx, x + glyph_maxx);
+    });
+
+  return PixelSize{unsigned(maxx), font.GetHeight()};
+}
+
+static void
+ReferenceRender(const TestFont &font, FT_Int32 load_flags,
+                FT_Render_Mode render_mode,
+                const char *text, PixelSize size, uint8_t *buffer) noexcept
+{
+  std::fill_n(buffer, Font::BufferSize(size), 0);
+
+  ForEachGlyph(font.GetFace(), load_flags, font.GetAscentHeight(), text,
+               [=](int x, int y, const FT_GlyphSlot glyph){
+      if (FT_Render_Glyph(glyph, render_mode))
+        return;
+
+      const FT_Bitmap &bitmap = glyph->bitmap;
+      for (int row = 0; row < int(bitmap.rows); ++row) {
+        const int dest_y = y + row;
+        if (dest_y < 0 || dest_y >= int(size.height))
+          continue;
+
+        const uint8_t *src = bitmap.buffer + row * bitmap.pitch;
+        for (int column = 0; column < int(bitmap.width); ++column) {
+          const int dest_x = x + column;
+          if (dest_x < 0 || dest_x >= int(size.width))
+            continue;
+
+          const uint8_t value = bitmap.pixel_mode == FT_PIXEL_MODE_MONO
+            ? ((src[column / 8] & (0x80 >> (column % 8))) ? 0xff : 0x00)
+            : src[column];
+          buffer[dest_y * size.width + dest_x] |= value;
+        }
+      }
+    });
+}
+
+/**
+ * Compare TextSize() and Render() with the reference, twice: once
+ * while the cache is being filled and once from the cache.
+ */
+static void
+Compare(const TestFont &font, FT_Int32 load_flags,
+        FT_Render_Mode render_mode, const char *mode) noexcept
+{
+  for (const char *text : strings) {
+    const PixelSize expected_size =
+      ReferenceTextSize(font, load_flags, text);
+
+    const std::size_t buffer_size = Font::BufferSize(expected_size);
+    const auto expected = std::make_unique<uint8_t[]>(buffer_size);
+    const auto actual = std::make_unique<uint8_t[]>(buffer_size);
+    ReferenceRender(font, load_flags, render_mode, text, expected_size,
+                    expected.get());
+
+    for (unsigned pass = 0; pass < 2; ++pass) {
+      const PixelSize size = font.TextSize(text);
+      ok(size == expected_size, "%s TextSize pass %u: %s",
+         mode, pass, text);
+
+      font.Render(text, expected_size, actual.get());
+      ok(std::memcmp(actual.get(), expected.get(), buffer_size) == 0,
+         "%s Render pass %u: %s", mode, pass, text);
+    }
+  }
+}
+
+int
+main()
+{
+  plan_tests(1 + 2 * std::size(strings) * 2 * 2);
+
+  ScreenInitialized();
+  Font::Initialise();
+
+  TestFont font;
+  font.Load(FontDescription(24));
+
+  /* the kerning code paths are only covered by a font with a
+     kerning table */
+  ok1(FT_HAS_KERNING(font.GetFace()));
+
+  Compare(font, FT_LOAD_DEFAULT, FT_RENDER_MODE_NORMAL, "normal");
+
+  /* the mode used on e-paper displays (see IsMono() in Font.cpp) */
+  const FT_Int32 mono_flags = FT_LOAD_DEFAULT | FT_LOAD_TARGET_MONO;
+  font.SetGlyphCache(new GlyphCache(font.GetFace(), mono_flags,
+                                    FT_RENDER_MODE_MONO));
+  Compare(font, mono_flags, FT_RENDER_MODE_MONO, "mono");
+
+  font.Destroy();
+  Font::Deinitialise();
+  ScreenDeinitialized();
+
+  return exit_status();
+}
@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Renderer/LabelBlock.hpp"
+#include "TestUtil.hpp"
+
+#include <vector>
+
+/**
+ * Compare with a brute force test against all previous rectangles.
+ */
+static void
+TestRandom() noexcept
+{
+  LabelBlock label_block;
+  std::vector<PixelRect> placed;
+
+  uint32_t state = 1;
+  auto random = [&state](unsigned max){
+    state = state * 1103515245 + 12345;
+    return (state >> 8) % max;
+  };
+
+  bool equal = true;
+  for (unsigned i = 0; i < 5000; ++i) {
+    const int x = int(random(1200)) - 100, y = int(random(900)) - 100;
+    const PixelRect rc{x, y,
+                       x + 1 + int(random(150)), y + 1 + int(random(40))};
+
+    bool expected = true;
+    for (const auto &j : placed)
+      if (j.OverlapsWith(rc))
+        expected = false;
+
+    if (expected)
+      placed.push_back(rc);
+
+    if (label_block.check(rc) != expected)
+      equal = false;
+  }
+
+  ok1(equal);
+  ok1(label_block.size() == placed.size());
+}
+
+/**
+ * The label layers share one #LabelBlock, and the first label placed
+ * wins.  MapWindow::Render() therefore places the waypoint labels
+ * before the airspace labels; this verifies that an airspace label
+ * cannot hide a task or landable waypoint label in that order.
+ */
+static void
+TestLayerPriority() noexcept
+{
+  LabelBlock label_block;
+
+  /* waypoint layer */
+  const PixelRect waypoint{100, 100, 180, 116};
+  ok1(label_block.check(waypoint));
+
+  /* airspace layer: the overlapping label is skipped, the other one
+     is drawn */
+  ok1(!label_block.check({150, 110, 250, 140}));
+  ok1(label_block.check({300, 110, 400, 140}));
+
+  /* topography layer */
+  ok1(!label_block.check({90, 95, 110, 105}));
+
+  /* the waypoint label keeps its place */
+  ok1(label_block.size() == 2);
+}
+
+int main()
+{
+  plan_tests(14);
+
+  LabelBlock label_block;
+
+  ok1(label_block.check({10, 10, 50, 20}));
+  ok1(!label_block.check({40, 15, 90, 25}));
+
+  /* touching the right edge counts as overlap, like
+     PixelRect::OverlapsWith() */
+  ok1(!label_block.check({50, 10, 60, 20}));
+
+  /* a tall rectangle spanning several cells */
+  ok1(!label_block.check({30, -200, 35, 400}));
+
+  /* more labels than the old per-bucket limit of 64 in one row */
+  bool all = true;
+  for (int i = 0; i < 200; ++i)
+    all &= label_block.check({i * 10, 100, i * 10 + 8, 110});
+  ok1(all);
+  ok1(!label_block.check({1995, 105, 1996, 106}));
+
+  label_block.reset();
+  ok1(label_block.check({40, 15, 90, 25}));
+
+  TestRandom();
+  TestLayerPriority();
+
+  return exit_status();
+}
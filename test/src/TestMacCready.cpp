@@ -10,6 +10,8 @@
 
 #include "TestUtil.hpp"
 
+#include <vector>
+
 static GlideSettings glide_settings;
 static GlidePolar glide_polar(0);
 
@@ -109,6 +111,39 @@ TestWind(const SpeedVector &wind)
   Test(100000, 4000, wind);
 }
 
+/**
+ * Check that MacCready::SolveEach() produces the same results as
+ * solving each task individually.
+ */
+static void
+TestSolveEach()
+{
+  std::vector<GlideState> tasks;
+  for (const double distance : {0., 1000., 10000., 100000.})
+    for (const double altitude : {-500., 0., 500., 4000.})
+      for (const double wind : {0., 5., 30.})
+        tasks.emplace_back(GeoVector(distance, Angle::Degrees(30)),
+                           2000, 2000 + altitude,
+                           SpeedVector(Angle::Zero(), wind));
+
+  std::vector<GlideResult> results(tasks.size());
+  MacCready::SolveEach(glide_settings, glide_polar, tasks, results);
+
+  bool equal = true;
+  for (std::size_t i = 0; i < tasks.size(); ++i) {
+    const auto expected =
+      MacCready::Solve(glide_settings, glide_polar, tasks[i]);
+    if (results[i].validity != expected.validity ||
+        (expected.IsOk() &&
+         (results[i].time_elapsed != expected.time_elapsed ||
+          results[i].height_glide != expected.height_glide ||
+          results[i].height_climb != expected.height_climb)))
+      equal = false;
+  }
+
+  ok1(equal);
+}
+
 static void
 TestAll()
 {
@@ -118,11 +153,12 @@ TestAll()
   TestWind(SpeedVector(Angle::Zero(), 10));
   TestWind(SpeedVector(Angle::Zero(), 15));
   TestWind(SpeedVector(Angle::Zero(), 30));
+  TestSolveEach();
 }
 
 int main()
 {
-  plan_tests(2103);
+  plan_tests(2108);
 
   glide_settings.SetDefaults();
 
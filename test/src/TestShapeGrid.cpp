@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Topography/ShapeGrid.hpp"
+#include "TestUtil.hpp"
+
+#include <vector>
+
+static GeoBounds
+MakeBounds(double west, double south, double east, double north) noexcept
+{
+  return GeoBounds(GeoPoint(Angle::Degrees(west), Angle::Degrees(north)),
+                   GeoPoint(Angle::Degrees(east), Angle::Degrees(south)));
+}
+
+/**
+ * Compare with a brute force test of all shapes.
+ */
+static void
+TestRandom(double west) noexcept
+{
+  uint32_t state = 1;
+  auto random = [&state](double max){
+    state = state * 1103515245 + 12345;
+    return max * ((state >> 8) % 10000) / 10000.;
+  };
+
+  std::vector<GeoBounds> shapes;
+  for (unsigned i = 0; i < 2000; ++i) {
+    const double x = west + random(3), y = 47 + random(2);
+    shapes.push_back(MakeBounds(x, y, x + random(0.2), y + random(0.1)));
+  }
+
+  /* a few long shapes, like rivers */
+  for (unsigned i = 0; i < 20; ++i) {
+    const double x = west + random(1), y = 47 + random(1);
+    shapes.push_back(MakeBounds(x, y, x + 2, y + random(1)));
+  }
+
+  ShapeGrid grid;
+  grid.Build(shapes);
+
+  bool equal = true, sorted = true;
+  std::vector<uint32_t> result;
+  for (unsigned i = 0; i < 200; ++i) {
+    const double x = west - 0.5 + random(4), y = 46.5 + random(3);
+    const auto area = MakeBounds(x, y, x + random(1), y + random(0.5));
+
+    grid.Query(area, result);
+
+    for (std::size_t j = 1; j < result.size(); ++j)
+      if (result[j - 1] >= result[j])
+        sorted = false;
+
+    std::vector<uint32_t> expected, found;
+    for (uint32_t j = 0; j < shapes.size(); ++j)
+      if (area.Overlaps(shapes[j]))
+        expected.push_back(j);
+
+    for (const auto j : result)
+      if (area.Overlaps(shapes[j]))
+        found.push_back(j);
+
+    if (found != expected)
+      equal = false;
+  }
+
+  ok1(equal);
+  ok1(sorted);
+}
+
+int main()
+{
+  plan_tests(7);
+
+  ShapeGrid grid;
+  std::vector<uint32_t> result;
+
+  /* an empty grid finds nothing */
+  grid.Build({});
+  grid.Query(MakeBounds(7, 47, 8, 48), result);
+  ok1(result.empty());
+
+  /* a single point-like shape */
+  const GeoBounds point[] = {MakeBounds(7.5, 47.5, 7.5, 47.5)};
+  grid.Build(point);
+  grid.Query(MakeBounds(7, 47, 8, 48), result);
+  ok1(result.size() == 1 && result.front() == 0);
+  grid.Query(MakeBounds(8, 47, 9, 48), result);
+  ok1(result.empty());
+
+  TestRandom(7);
+
+  /* shapes crossing the date line */
+  TestRandom(178.5);
+
+  return exit_status();
+}
@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Computer/StageTimer.hpp"
+#include "TestUtil.hpp"
+
+using std::chrono::microseconds;
+
+int main()
+{
+  plan_tests(20);
+
+  StageStatistics statistics;
+
+  auto s = statistics.GetSnapshot();
+  ok1(s.count == 0);
+  ok1(s.n == 0);
+
+  for (unsigned i = 1; i <= 10; ++i)
+    statistics.Add(microseconds(i * 100));
+
+  s = statistics.GetSnapshot();
+  ok1(s.count == 10);
+  ok1(s.n == 10);
+  ok1(s.last == 1000);
+  ok1(s.mean == 550);
+  ok1(s.p50 == 600);
+  ok1(s.p90 == 1000);
+  ok1(s.max == 1000);
+  ok1(s.max_ever == 1000);
+
+  /* 100 goes into [64,128), 200 into [128,256), 300..500 into
+     [256,512), 600..1000 into [512,1024) */
+  ok1(s.histogram[2] == 1);
+  ok1(s.histogram[3] == 1);
+  ok1(s.histogram[4] == 3);
+  ok1(s.histogram[5] == 5);
+
+  /* overwrite the whole window with small samples; the maximum
+     since startup survives */
+  for (unsigned i = 0; i < StageStatistics::N_SAMPLES; ++i)
+    statistics.Add(microseconds(10));
+
+  s = statistics.GetSnapshot();
+  ok1(s.count == 10 + StageStatistics::N_SAMPLES);
+  ok1(s.n == StageStatistics::N_SAMPLES);
+  ok1(s.max == 10);
+  ok1(s.max_ever == 1000);
+  ok1(s.histogram[0] == StageStatistics::N_SAMPLES);
+
+  /* huge samples end up in the last bucket */
+  statistics.Add(std::chrono::seconds(10));
+  s = statistics.GetSnapshot();
+  ok1(s.histogram[StageStatistics::N_BUCKETS - 1] == 1);
+
+  return exit_status();
+}
@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Engine/Trace/Trace.hpp"
+#include "Engine/Trace/Vector.hpp"
+#include "TestUtil.hpp"
+
+using std::chrono::seconds;
+
+static void
+Append(Trace &trace, unsigned i)
+{
+  const GeoPoint location(Angle::Degrees(7 + i * 0.001),
+                          Angle::Degrees(51 + (i % 7) * 0.001));
+  trace.push_back(TracePoint(location, seconds{i * 10}, 1000. + i, 0., 0));
+}
+
+static bool
+Equals(const TracePointVector &a, const Trace &b)
+{
+  TracePointVector v;
+  b.GetPoints(v);
+
+  if (a.size() != v.size())
+    return false;
+
+  for (unsigned i = 0; i < v.size(); ++i)
+    if (a[i].GetTime() != v[i].GetTime() ||
+        a[i].GetLocation() != v[i].GetLocation())
+      return false;
+
+  return true;
+}
+
+int main()
+{
+  plan_tests(11);
+
+  Trace trace({}, Trace::null_time, 64);
+
+  TracePointVector v;
+  ok1(!trace.SyncPoints(v));
+  ok1(v.empty());
+
+  for (unsigned i = 0; i < 10; ++i)
+    Append(trace, i);
+
+  trace.GetPoints(v);
+  ok1(v.size() == 10);
+
+  /* no news */
+  ok1(!trace.SyncPoints(v));
+  ok1(v.size() == 10);
+
+  /* append without thinning: only the new points get copied */
+  const Serial modify_serial = trace.GetModifySerial();
+  for (unsigned i = 10; i < 30; ++i)
+    Append(trace, i);
+
+  ok1(trace.GetModifySerial() == modify_serial);
+  ok1(trace.SyncPoints(v));
+  ok1(v.size() == 30);
+  ok1(Equals(v, trace));
+
+  /* fill the trace until it gets thinned; now the copy is stale and
+     the modify serial says so */
+  for (unsigned i = 30; i < 100; ++i)
+    Append(trace, i);
+
+  ok1(trace.GetModifySerial() != modify_serial);
+  ok1(trace.size() < 100);
+
+  return exit_status();
+}
@@ -0,0 +1,131 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Audio/VarioSynthesiser.hpp"
+#include "Math/FastTrig.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+
+static constexpr unsigned sample_rate = 44100;
+
+[[gnu::pure]]
+static int
+MaxAmplitude(const int16_t *buffer, size_t n) noexcept
+{
+  int result = 0;
+  for (size_t i = 0; i < n; ++i)
+    result = std::max(result, std::abs((int)buffer[i]));
+  return result;
+}
+
+[[gnu::pure]]
+static size_t
+CountZeroRuns(const int16_t *buffer, size_t n, size_t min_length) noexcept
+{
+  size_t runs = 0, length = 0;
+  for (size_t i = 0; i < n; ++i) {
+    if (buffer[i] == 0) {
+      if (++length == min_length)
+        ++runs;
+    } else
+      length = 0;
+  }
+
+  return runs;
+}
+
+/**
+ * Compare the block kernel with the original per-sample
+ * implementation.
+ */
+static bool
+CompareWithReference(unsigned tone_hz, unsigned volume, size_t chunk)
+{
+  ToneSynthesiser tone(sample_rate);
+  tone.SetTone(tone_hz);
+  tone.SetVolume(volume);
+
+  const unsigned increment = ISINETABLE.size() * tone_hz / sample_rate;
+  unsigned angle = 0;
+
+  std::array<int16_t, 1000> buffer;
+  for (unsigned pass = 0; pass < 10; ++pass) {
+    for (size_t i = 0; i < buffer.size(); i += chunk)
+      tone.Synthesise(buffer.data() + i, std::min(chunk, buffer.size() - i));
+
+    for (const auto sample : buffer) {
+      const int expected = ISINETABLE[angle] * (32767 / 1024) * (int)volume / 100;
+      angle = (angle + increment) & (ISINETABLE.size() - 1);
+
+      if (std::abs(sample - expected) > 1)
+        return false;
+    }
+  }
+
+  return true;
+}
+
+int main()
+{
+  plan_tests(14);
+
+  ok1(CompareWithReference(500, 100, 1000));
+  ok1(CompareWithReference(1500, 100, 7));
+  ok1(CompareWithReference(200, 37, 64));
+  ok1(CompareWithReference(880, 0, 100));
+
+  VarioSynthesiser synthesiser(sample_rate);
+  std::array<int16_t, sample_rate> buffer;
+
+  /* silent until the first value arrives */
+  synthesiser.Synthesise(buffer.data(), buffer.size());
+  ok1(MaxAmplitude(buffer.data(), buffer.size()) == 0);
+
+  /* continuous tone while sinking */
+  synthesiser.SetVario(-2);
+  synthesiser.Synthesise(buffer.data(), buffer.size());
+  ok1(MaxAmplitude(buffer.data(), buffer.size()) > 30000);
+  ok1(CountZeroRuns(buffer.data(), buffer.size(), 100) == 0);
+
+  /* the volume is applied with the next block */
+  synthesiser.SetVolume(50);
+  synthesiser.Synthesise(buffer.data(), buffer.size());
+  ok1(MaxAmplitude(buffer.data(), buffer.size()) < 16000);
+  ok1(MaxAmplitude(buffer.data(), buffer.size()) > 15000);
+  synthesiser.SetVolume(100);
+
+  /* climbing: tone interrupted by silence; at +5 m/s, the period is
+     150 ms, i.e. nearly 7 beeps per second */
+  synthesiser.SetVario(5);
+  synthesiser.Synthesise(buffer.data(), buffer.size());
+  const size_t beeps = CountZeroRuns(buffer.data(), buffer.size(), 1000);
+  ok1(beeps >= 6 && beeps <= 7);
+
+  /* dead band */
+  synthesiser.SetDeadBand(true);
+  synthesiser.SetDeadBandRange(-0.5, 0.5);
+  synthesiser.SetVario(0.2);
+  synthesiser.Synthesise(buffer.data(), buffer.size());
+  /* the current sine wave is finished first */
+  ok1(MaxAmplitude(buffer.data() + 1000, buffer.size() - 1000) == 0);
+
+  synthesiser.SetVario(-1);
+  synthesiser.Synthesise(buffer.data(), buffer.size());
+  ok1(MaxAmplitude(buffer.data(), buffer.size()) > 30000);
+
+  /* explicit silence */
+  synthesiser.SetSilence();
+  synthesiser.Synthesise(buffer.data(), buffer.size());
+  ok1(MaxAmplitude(buffer.data() + 1000, buffer.size() - 1000) == 0);
+
+  /* the parameters of the last update win */
+  synthesiser.SetVario(-1);
+  synthesiser.SetSilence();
+  synthesiser.Synthesise(buffer.data(), buffer.size());
+  ok1(MaxAmplitude(buffer.data() + 1000, buffer.size() - 1000) == 0);
+
+  return exit_status();
+}
@@ -0,0 +1,105 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Topography/VertexPool.hpp"
+#include "TestUtil.hpp"
+
+#include <vector>
+
+/**
+ * Allocate and free random ranges, and check that allocated ranges
+ * never overlap.
+ */
+static void
+TestRandom() noexcept
+{
+  VertexPool pool;
+  std::vector<VertexPool::Range> ranges;
+
+  /* which vertices are in use by which range */
+  std::vector<int> owner;
+
+  uint32_t state = 1;
+  auto random = [&state](unsigned max){
+    state = state * 1103515245 + 12345;
+    return (state >> 8) % max;
+  };
+
+  bool disjoint = true, used = true;
+  unsigned max_end = 0;
+
+  for (unsigned i = 0; i < 20000; ++i) {
+    if (!ranges.empty() && random(2) == 0) {
+      const unsigned n = random(ranges.size());
+      const auto range = ranges[n];
+      pool.Free(range);
+      for (unsigned j = 0; j < range.size; ++j)
+        owner[range.offset + j] = -1;
+
+      ranges[n] = ranges.back();
+      ranges.pop_back();
+    } else {
+      const unsigned size = 1 + random(100);
+      const VertexPool::Range range{pool.Allocate(size), size};
+      if (owner.size() < pool.GetEnd())
+        owner.resize(pool.GetEnd(), -1);
+
+      for (unsigned j = 0; j < size; ++j) {
+        if (owner[range.offset + j] >= 0)
+          disjoint = false;
+        owner[range.offset + j] = int(i);
+      }
+
+      ranges.push_back(range);
+    }
+
+    unsigned sum = 0;
+    for (const auto &r : ranges)
+      sum += r.size;
+    if (pool.GetUsed() != sum)
+      used = false;
+
+    if (pool.GetEnd() > max_end)
+      max_end = pool.GetEnd();
+  }
+
+  ok1(disjoint);
+  ok1(used);
+
+  /* holes are reused: with ~50% occupancy, the pool does not grow
+     much beyond the peak usage */
+  ok1(max_end < 2 * 100 * 100);
+
+  for (const auto &r : ranges)
+    pool.Free(r);
+  ok1(pool.GetEnd() == 0);
+}
+
+int main()
+{
+  plan_tests(12);
+
+  VertexPool pool;
+  ok1(pool.Allocate(10) == 0);
+  ok1(pool.Allocate(20) == 10);
+  ok1(pool.Allocate(30) == 30);
+
+  /* a hole is reused before appending */
+  pool.Free({10, 20});
+  ok1(pool.Allocate(5) == 10);
+  ok1(pool.Allocate(20) == 60);
+  ok1(pool.Allocate(15) == 15);
+
+  /* freeing the last range shrinks the pool, including adjacent
+     holes */
+  pool.Free({10, 5});
+  pool.Free({15, 15});
+  pool.Free({60, 20});
+  pool.Free({30, 30});
+  ok1(pool.GetEnd() == 10);
+  ok1(pool.GetUsed() == 10);
+
+  TestRandom();
+
+  return exit_status();
+}
@@ -3,6 +3,8 @@
 
 #include "Waypoint/WaypointReader.hpp"
 #include "Waypoint/WaypointReaderBase.hpp"
+#include "Waypoint/WaypointReaderSeeYou.hpp"
+#include "Waypoint/WaypointReaderWinPilot.hpp"
 #include "Engine/Waypoint/Waypoints.hpp"
 #include "Terrain/RasterMap.hpp"
 #include "Units/System.hpp"
@@ -12,9 +14,12 @@
 #include "util/StringAPI.hxx"
 #include "util/ExtractParameters.hpp"
 #include "Operation/Operation.hpp"
+#include "io/LineReader.hpp"
 
 #include <vector>
 
+#include <stdio.h>
+
 static void
 TestExtractParameters()
 {
@@ -300,6 +305,148 @@ TestSeeYou(wp_vector org_wp)
   }
 }
 
+/**
+ * Serves lines from memory.
+ */
+class MemoryLineReader final : public TLineReader {
+  std::vector<tstring> lines;
+  std::size_t position = 0;
+  tstring current;
+
+public:
+  explicit MemoryLineReader(std::vector<tstring> &&_lines) noexcept
+    :lines(std::move(_lines)) {}
+
+  TCHAR *ReadLine() override {
+    if (position >= lines.size())
+      return nullptr;
+
+    current = lines[position++];
+    return current.data();
+  }
+
+  long GetSize() const override {
+    return lines.size();
+  }
+
+  long Tell() const override {
+    return position;
+  }
+};
+
+/**
+ * Parse a SeeYou file which is large enough to be parsed by several
+ * threads, and whose task section begins in the middle of a window.
+ */
+static void
+TestSeeYouLarge()
+{
+  constexpr unsigned n_waypoints = 12000, n_ignored = 5000;
+
+  std::vector<tstring> lines;
+  lines.emplace_back(_T("name,code,country,lat,lon,elev,style,rwdir,rwlen,freq,desc"));
+
+  TCHAR buffer[256];
+  for (unsigned i = 0; i < n_waypoints + n_ignored; ++i) {
+    if (i == n_waypoints)
+      lines.emplace_back(_T("-----Related Tasks-----"));
+
+    _stprintf(buffer,
+              _T("\"%s%u\",\"W%u\",DE,%02u%06.3fN,00700.000E,%um,1,,,,\"\""),
+              i < n_waypoints ? _T("WP") : _T("IGN"), i, i,
+              45 + i / 6000, (i % 6000) / 100., i % 1000);
+    lines.emplace_back(buffer);
+  }
+
+  MemoryLineReader reader(std::move(lines));
+  WaypointReaderSeeYou parser(WaypointFactory(WaypointOrigin::NONE));
+  parser.SetMaxThreads(4);
+  Waypoints way_points;
+  NullOperationEnvironment operation;
+  parser.Parse(way_points, reader, operation);
+
+  ok1(parser.GetParallelWindows() > 0);
+  ok1(way_points.size() == n_waypoints);
+  ok1(way_points.LookupName(_T("IGN12000")) == nullptr);
+
+  /* the ids must follow the file order, and all fields must have
+     been parsed */
+  bool ordered = true, complete = true;
+  unsigned last_id = 0;
+  for (unsigned i = 0; i < n_waypoints; ++i) {
+    _stprintf(buffer, _T("WP%u"), i);
+    const auto wp = way_points.LookupName(buffer);
+    if (wp == nullptr) {
+      complete = false;
+      break;
+    }
+
+    if (i > 0 && wp->id <= last_id)
+      ordered = false;
+    last_id = wp->id;
+
+    if (!wp->has_elevation || wp->elevation != i % 1000 ||
+        fabs(wp->location.latitude.Degrees() -
+             (45 + i / 6000 + (i % 6000) / 6000.)) > 0.0001)
+      complete = false;
+  }
+
+  ok1(complete);
+  ok1(ordered);
+}
+
+/**
+ * Parse a large WinPilot file which has no leading comment line; the
+ * reader must switch to parallel parsing after the first line.
+ */
+static void
+TestWinPilotLarge()
+{
+  constexpr unsigned n_waypoints = 12000;
+
+  std::vector<tstring> lines;
+
+  TCHAR buffer[256];
+  for (unsigned i = 0; i < n_waypoints; ++i) {
+    _stprintf(buffer, _T("%u,%02u:%06.3fN,007:00.000E,%uM,T,WP%u,"),
+              i + 1, 45 + i / 6000, (i % 6000) / 100., i % 1000, i);
+    lines.emplace_back(buffer);
+  }
+
+  MemoryLineReader reader(std::move(lines));
+  WaypointReaderWinPilot parser(WaypointFactory(WaypointOrigin::NONE));
+  parser.SetMaxThreads(4);
+  Waypoints way_points;
+  NullOperationEnvironment operation;
+  parser.Parse(way_points, reader, operation);
+
+  ok1(parser.GetParallelWindows() > 0);
+  ok1(way_points.size() == n_waypoints);
+
+  bool ordered = true, complete = true;
+  unsigned last_id = 0;
+  for (unsigned i = 0; i < n_waypoints; ++i) {
+    _stprintf(buffer, _T("WP%u"), i);
+    const auto wp = way_points.LookupName(buffer);
+    if (wp == nullptr) {
+      complete = false;
+      break;
+    }
+
+    if (i > 0 && wp->id <= last_id)
+      ordered = false;
+    last_id = wp->id;
+
+    if (!wp->has_elevation || wp->elevation != i % 1000 ||
+        fabs(wp->location.latitude.Degrees() -
+             (45 + i / 6000 + (i % 6000) / 6000.)) > 0.0001)
+      complete = false;
+  }
+
+  ok1(complete);
+  ok1(ordered);
+}
+
 static void
 TestZanderWaypoint(const Waypoint org_wp, const Waypoint *wp)
 {
@@ -543,12 +690,14 @@ int main()
 {
   wp_vector org_wp = CreateOriginalWaypoints();
 
-  plan_tests(513);
+  plan_tests(522);
 
   TestExtractParameters();
 
   TestWinPilot(org_wp);
+  TestWinPilotLarge();
   TestSeeYou(org_wp);
+  TestSeeYouLarge();
   TestZander(org_wp);
   TestFS(org_wp);
   TestFS_UTM(org_wp);
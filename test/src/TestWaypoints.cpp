@@ -38,7 +38,7 @@ public:
 };
 
 static void
-AddSpiralWaypoints(Waypoints &waypoints,
+AddSpiralWaypoints(Waypoints &waypoints, WaypointOrigin origin,
                    const GeoPoint &center = GeoPoint(Angle::Degrees(51.4),
                                                      Angle::Degrees(7.85)),
                    Angle angle_start = Angle::Degrees(0),
@@ -58,6 +58,7 @@ AddSpiralWaypoints(Waypoints &waypoints,
     vector.bearing = angle_start + angle_step * i;
 
     Waypoint waypoint{vector.EndPoint(center)};
+    waypoint.origin = origin;
     waypoint.original_id = i;
     waypoint.elevation = i * 10 - 500;
     waypoint.has_elevation = true;
@@ -279,20 +280,83 @@ TestReplace(Waypoints& waypoints, unsigned id)
   return wp != NULL && wp->name != oldName && wp->name == _T("Fred");
 }
 
-int
-main(int argc, char** argv)
+static void
+TestMixed(Waypoints &waypoints, const GeoPoint &center)
 {
-  if (!ParseArgs(argc, argv))
-    return 0;
+  /* a user waypoint next to the bulk-loaded file waypoints */
+  Waypoint user{GeoVector(100, Angle::Degrees(90)).EndPoint(center)};
+  user.origin = WaypointOrigin::USER;
+  user.name = _T("User");
+  auto ptr = waypoints.Append(std::move(user));
+
+  ok1(waypoints.size() == 152);
 
-  plan_tests(52);
+  waypoints.Optimise();
+  ok1(waypoints.GetNearest(ptr->location, 10) == ptr);
+  ok1(waypoints.GetNearest(center, 10)->original_id == 0);
+  TestRangeVisitor(waypoints, center, 1000000, 152);
+  ok1(waypoints.LookupName(_T("User")) == ptr);
+
+  waypoints.Erase(std::move(ptr));
+  waypoints.Optimise();
+  ok1(waypoints.size() == 151);
+}
+
+/**
+ * Check the memory sharing of the bulk store: equal comments share
+ * one buffer, and a pointer which outlives Clear() keeps only its own
+ * chunk of records alive.
+ */
+static void
+TestBulkSharing()
+{
+  const GeoPoint center(Angle::Degrees(51.4), Angle::Degrees(7.85));
 
+  Waypoints waypoints;
+  for (unsigned i = 0; i < 1000; ++i) {
+    Waypoint waypoint{center};
+    waypoint.origin = WaypointOrigin::PRIMARY;
+
+    StaticString<32> name;
+    name.Format(_T("WP %u"), i);
+    waypoint.name = name;
+
+    if (i % 2 == 1)
+      waypoint.comment = _T("Grass runway, no fuel, PPR");
+
+    waypoints.Append(std::move(waypoint));
+  }
+
+  waypoints.Optimise();
+
+  WaypointPtr survivor = waypoints.LookupName(_T("WP 1"));
+  ok1(survivor->comment == SharedString(_T("Grass runway, no fuel, PPR")));
+  ok1(survivor->comment.c_str() ==
+      waypoints.LookupName(_T("WP 999"))->comment.c_str());
+  ok1(waypoints.LookupName(_T("WP 2"))->comment.empty());
+
+  /* "WP 0" is in the same chunk as "WP 1", "WP 999" is not */
+  const std::weak_ptr<const Waypoint> same_chunk =
+    waypoints.LookupName(_T("WP 0"));
+  const std::weak_ptr<const Waypoint> other_chunk =
+    waypoints.LookupName(_T("WP 999"));
+
+  waypoints.Clear();
+
+  ok1(!same_chunk.expired());
+  ok1(other_chunk.expired());
+  ok1(survivor->comment == SharedString(_T("Grass runway, no fuel, PPR")));
+}
+
+static void
+TestWaypoints(WaypointOrigin origin)
+{
   Waypoints waypoints;
   GeoPoint center(Angle::Degrees(51.4), Angle::Degrees(7.85));
 
   // AddSpiralWaypoints creates 151 waypoints from
   // 0km to 150km distance in 1km steps
-  AddSpiralWaypoints(waypoints, center);
+  AddSpiralWaypoints(waypoints, origin, center);
 
   ok1(!waypoints.IsEmpty());
   ok1(waypoints.size() == 151);
@@ -302,6 +366,7 @@ main(int argc, char** argv)
   TestRangeVisitor(waypoints, center);
   TestGetNearest(waypoints, center);
   TestIterator(waypoints);
+  TestMixed(waypoints, center);
 
   ok(TestCopy(waypoints), "waypoint copy", 0);
   ok(TestErase(waypoints, 3), "waypoint erase", 0);
@@ -311,6 +376,22 @@ main(int argc, char** argv)
   waypoints.Clear();
   ok1(waypoints.IsEmpty());
   ok1(waypoints.size() == 0);
+}
+
+int
+main(int argc, char** argv)
+{
+  if (!ParseArgs(argc, argv))
+    return 0;
+
+  plan_tests(2 * 58 + 6);
+
+  /* user waypoints are stored in a QuadTree */
+  TestWaypoints(WaypointOrigin::USER);
+
+  /* waypoints from files are stored in BulkWaypoints */
+  TestWaypoints(WaypointOrigin::PRIMARY);
+  TestBulkSharing();
 
   return exit_status();
 }
@@ -35,7 +35,7 @@ ZeroFinderTest::f(const double x) noexcept
 
 int main()
 {
-  plan_tests(18);
+  plan_tests(22);
 
   ZeroFinderTest zf(-100, 100, 0);
   ok1(equals(zf.find_zero(-150), -1));
@@ -43,6 +43,11 @@ int main()
   // ok1(equals(zf.find_zero(140), 2.5)); ???
   ok1(equals(zf.find_zero(140), -1));
 
+  // a bracket around the second root finds that one
+  ok1(equals(zf.find_zero_near(2.4, 0.5), 2.5));
+  // no zero in the bracket: search the whole range
+  ok1(equals(zf.find_zero_near(50, 1), -1));
+
   ok1(equals(zf.find_min(-150), 0.75));
   ok1(equals(zf.find_min(0), 0.75));
   ok1(equals(zf.find_min(150), 0.75));
@@ -56,11 +61,13 @@ int main()
   ok1(equals(zf3.find_zero(-150), 1.584963));
   ok1(equals(zf3.find_zero(1), 1.584963));
   ok1(equals(zf3.find_zero(140), 1.584963));
+  ok1(equals(zf3.find_zero_near(1.5, 0.2), 1.584963));
 
   ZeroFinderTest zf4(0, M_PI + 1, 2);
   ok1(equals(zf4.find_zero(-150), M_PI_2));
   ok1(equals(zf4.find_zero(1), M_PI_2));
   ok1(equals(zf4.find_zero(140), M_PI_2));
+  ok1(equals(zf4.find_zero_near(1.5, 0.1), M_PI_2));
 
   ok1(equals(zf4.find_min(-150), M_PI));
   ok1(equals(zf4.find_min(1), M_PI));